@@ -37,7 +37,8 @@ public class EscapeIT : ModuleRules
             "PhysicsCore",
             "LevelSequence",       
             "MovieScene",        
-            "MovieSceneTracks"
+            "MovieSceneTracks",
+            "AssetRegistry"
         });
 
         PublicIncludePaths.AddRange(new string[] {
@@ -0,0 +1,432 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/AIDecisionTrace.h"
+#include "EscapeIT.h"
+#include "BehaviorTree/BTNode.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace AIDecisionTrace
+{
+	// 'AITR'
+	static constexpr uint32 FileMagic = 0x52544941;
+	static constexpr uint32 FileVersion = 1;
+
+	static int32 Enabled = 0;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("ai.Trace.Enabled"),
+		Enabled,
+		TEXT("1 = ghi quyết định của NPC vào ring buffer (ai.Trace.Flush để ghi ra đĩa)"));
+
+	static int32 RecordsPerAgent = 4096;
+	static FAutoConsoleVariableRef CVarRecordsPerAgent(
+		TEXT("ai.Trace.RecordsPerAgent"),
+		RecordsPerAgent,
+		TEXT("Kích thước ring buffer mỗi agent (áp dụng cho agent mới)"));
+
+	static FAutoConsoleCommandWithWorldAndArgs FlushCommand(
+		TEXT("ai.Trace.Flush"),
+		TEXT("ai.Trace.Flush [Path]: ghi trace quyết định của NPC ra file"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UAIDecisionTraceSubsystem* Trace = UAIDecisionTraceSubsystem::Get(World))
+			{
+				Trace->Flush(Args.Num() > 0 ? Args[0] : FString());
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld ResetCommand(
+		TEXT("ai.Trace.Reset"),
+		TEXT("Xóa trace quyết định của NPC đang giữ trong bộ nhớ"),
+		FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+		{
+			if (UAIDecisionTraceSubsystem* Trace = UAIDecisionTraceSubsystem::Get(World))
+			{
+				Trace->Reset();
+			}
+		}));
+
+	/** Đo thời gian của một lần Record* vào Stats */
+	struct FScopedRecordTimer
+	{
+		explicit FScopedRecordTimer(FAIDecisionTraceStats& InStats)
+			: Stats(InStats)
+			, StartCycles(FPlatformTime::Cycles64())
+		{
+		}
+
+		~FScopedRecordTimer()
+		{
+			++Stats.NumRecords;
+			Stats.RecordSeconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		}
+
+		FAIDecisionTraceStats& Stats;
+		uint64 StartCycles;
+	};
+
+	static const TCHAR* LexType(EAITraceEventType Type)
+	{
+		switch (Type)
+		{
+		case EAITraceEventType::NodeActivated:     return TEXT("Activate");
+		case EAITraceEventType::TaskFinished:      return TEXT("Finish");
+		case EAITraceEventType::BlackboardChanged: return TEXT("Blackboard");
+		case EAITraceEventType::Stimulus:          return TEXT("Stimulus");
+		default:                                   return TEXT("?");
+		}
+	}
+
+	static const TCHAR* LexResult(uint8 Result)
+	{
+		switch (static_cast<EBTNodeResult::Type>(Result))
+		{
+		case EBTNodeResult::Succeeded:  return TEXT("Succeeded");
+		case EBTNodeResult::Failed:     return TEXT("Failed");
+		case EBTNodeResult::Aborted:    return TEXT("Aborted");
+		case EBTNodeResult::InProgress: return TEXT("InProgress");
+		default:                        return TEXT("?");
+		}
+	}
+}
+
+// ============================================
+// FILE
+// ============================================
+
+bool FAIDecisionTraceFile::Save(const FString& Path) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = AIDecisionTrace::FileMagic;
+	uint32 Version = AIDecisionTrace::FileVersion;
+	uint32 SeedValue = Seed;
+	FString Map = MapName;
+	TArray<FString> StringTable = Strings;
+	int32 NumAgents = Agents.Num();
+
+	Writer << Magic << Version << SeedValue << Map << StringTable << NumAgents;
+
+	for (const FAgent& Agent : Agents)
+	{
+		FString Name = Agent.Name;
+		uint64 Total = Agent.TotalRecorded;
+		int32 NumRecords = Agent.Records.Num();
+		Writer << Name << Total << NumRecords;
+
+		// Bản ghi là POD cố định 28 byte -> ghi nguyên khối
+		Writer.Serialize(const_cast<FAITraceRecord*>(Agent.Records.GetData()), NumRecords * sizeof(FAITraceRecord));
+	}
+
+	return FFileHelper::SaveArrayToFile(Bytes, *Path);
+}
+
+bool FAIDecisionTraceFile::Load(const FString& Path)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	Reader << Magic << Version;
+	if (Magic != AIDecisionTrace::FileMagic || Version != AIDecisionTrace::FileVersion)
+	{
+		return false;
+	}
+
+	int32 NumAgents = 0;
+	Reader << Seed << MapName << Strings << NumAgents;
+	if (Reader.IsError() || NumAgents < 0)
+	{
+		return false;
+	}
+
+	Agents.SetNum(NumAgents);
+	for (FAgent& Agent : Agents)
+	{
+		int32 NumRecords = 0;
+		Reader << Agent.Name << Agent.TotalRecorded << NumRecords;
+
+		if (Reader.IsError() || NumRecords < 0 || Reader.TotalSize() - Reader.Tell() < NumRecords * static_cast<int64>(sizeof(FAITraceRecord)))
+		{
+			return false;
+		}
+
+		Agent.Records.SetNumUninitialized(NumRecords);
+		Reader.Serialize(Agent.Records.GetData(), NumRecords * sizeof(FAITraceRecord));
+	}
+
+	return !Reader.IsError();
+}
+
+const FString& FAIDecisionTraceFile::GetString(uint32 Id) const
+{
+	static const FString Invalid(TEXT("<invalid>"));
+	return Strings.IsValidIndex(Id) ? Strings[Id] : Invalid;
+}
+
+FString FAIDecisionTraceFile::DescribeRecord(const FAITraceRecord& Record) const
+{
+	FString Detail;
+	switch (Record.Type)
+	{
+	case EAITraceEventType::NodeActivated:
+		Detail = GetString(Record.Id);
+		break;
+
+	case EAITraceEventType::TaskFinished:
+		Detail = FString::Printf(TEXT("%s -> %s"), *GetString(Record.Id), AIDecisionTrace::LexResult(Record.Code));
+		break;
+
+	case EAITraceEventType::BlackboardChanged:
+		Detail = FString::Printf(TEXT("%s = %s (%.0f, %.0f, %.0f)"), *GetString(Record.Id),
+			Record.Code ? TEXT("true") : TEXT("false"), Record.Value.X, Record.Value.Y, Record.Value.Z);
+		break;
+
+	case EAITraceEventType::Stimulus:
+		Detail = FString::Printf(TEXT("%s %s at (%.0f, %.0f, %.0f)"), *GetString(Record.Id),
+			Record.Code ? TEXT("sensed") : TEXT("lost"), Record.Value.X, Record.Value.Y, Record.Value.Z);
+		break;
+	}
+
+	return FString::Printf(TEXT("frame %u (%.3f s) %s %s"), Record.Frame, Record.Time, AIDecisionTrace::LexType(Record.Type), *Detail);
+}
+
+// ============================================
+// SUBSYSTEM
+// ============================================
+
+void UAIDecisionTraceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	StartFrame = GFrameCounter;
+
+	// Cùng seed -> hai lần chạy so được với nhau bằng AITraceDiff
+	if (FParse::Value(FCommandLine::Get(), TEXT("AITraceSeed="), Seed))
+	{
+		FMath::RandInit(Seed);
+		FMath::SRandInit(Seed);
+	}
+}
+
+void UAIDecisionTraceSubsystem::Deinitialize()
+{
+	Reset();
+
+	Super::Deinitialize();
+}
+
+UAIDecisionTraceSubsystem* UAIDecisionTraceSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UAIDecisionTraceSubsystem>() : nullptr;
+}
+
+bool UAIDecisionTraceSubsystem::IsEnabled()
+{
+	static const bool bCommandLine = FParse::Param(FCommandLine::Get(), TEXT("AITrace"));
+	return AIDecisionTrace::Enabled != 0 || bCommandLine;
+}
+
+// ============================================
+// RECORD
+// ============================================
+
+FAITraceRecord& UAIDecisionTraceSubsystem::AddRecord(const AActor* Agent, EAITraceEventType Type)
+{
+	uint16 AgentIndex;
+	if (const uint16* Existing = AgentIndices.Find(Agent))
+	{
+		AgentIndex = *Existing;
+	}
+	else
+	{
+		AgentIndex = static_cast<uint16>(Agents.Num());
+		AgentIndices.Add(Agent, AgentIndex);
+
+		FAgentTrace& NewAgent = Agents.AddDefaulted_GetRef();
+		NewAgent.Name = GetNameSafe(Agent);
+		NewAgent.Capacity = FMath::Max(1, AIDecisionTrace::RecordsPerAgent);
+		NewAgent.Ring.Reserve(NewAgent.Capacity);
+	}
+
+	FAgentTrace& Trace = Agents[AgentIndex];
+	++Trace.TotalRecorded;
+
+	FAITraceRecord* Record;
+	if (Trace.Ring.Num() < Trace.Capacity)
+	{
+		Record = &Trace.Ring.AddDefaulted_GetRef();
+	}
+	else
+	{
+		// Đầy: ghi đè bản ghi cũ nhất
+		Record = &Trace.Ring[Trace.Head];
+		Trace.Head = (Trace.Head + 1) % Trace.Ring.Num();
+	}
+
+	const UWorld* World = GetWorld();
+	Record->Frame = static_cast<uint32>(GFrameCounter - StartFrame);
+	Record->Time = World ? static_cast<float>(World->GetTimeSeconds()) : 0.0f;
+	Record->Agent = AgentIndex;
+	Record->Type = Type;
+	Record->Code = 0;
+	Record->Id = 0;
+	Record->Value = FVector3f::ZeroVector;
+	return *Record;
+}
+
+uint32 UAIDecisionTraceSubsystem::InternString(const FString& String)
+{
+	if (const uint32* Existing = StringIds.Find(String))
+	{
+		return *Existing;
+	}
+
+	const uint32 Id = Strings.Add(String);
+	StringIds.Add(String, Id);
+	return Id;
+}
+
+uint32 UAIDecisionTraceSubsystem::InternName(FName Name)
+{
+	if (const uint32* Existing = NameIds.Find(Name))
+	{
+		return *Existing;
+	}
+
+	const uint32 Id = InternString(Name.ToString());
+	NameIds.Add(Name, Id);
+	return Id;
+}
+
+uint32 UAIDecisionTraceSubsystem::InternNode(const UBTNode* Node)
+{
+	if (const uint32* Existing = NodeIds.Find(Node))
+	{
+		return *Existing;
+	}
+
+	// Tên node có thể trùng trong một tree -> kèm execution index
+	const FString Description = Node
+		? FString::Printf(TEXT("%s/%d %s"), *GetNameSafe(Node->GetTreeAsset()), Node->GetExecutionIndex(), *Node->GetNodeName())
+		: FString(TEXT("None"));
+
+	const uint32 Id = InternString(Description);
+	NodeIds.Add(Node, Id);
+	return Id;
+}
+
+void UAIDecisionTraceSubsystem::RecordNodeActivated(const AActor* Agent, const UBTNode* Node)
+{
+	AIDecisionTrace::FScopedRecordTimer Timer(Stats);
+
+	FAITraceRecord& Record = AddRecord(Agent, EAITraceEventType::NodeActivated);
+	Record.Id = InternNode(Node);
+}
+
+void UAIDecisionTraceSubsystem::RecordTaskFinished(const AActor* Agent, const UBTNode* Node, EBTNodeResult::Type Result)
+{
+	AIDecisionTrace::FScopedRecordTimer Timer(Stats);
+
+	FAITraceRecord& Record = AddRecord(Agent, EAITraceEventType::TaskFinished);
+	Record.Id = InternNode(Node);
+	Record.Code = static_cast<uint8>(Result);
+}
+
+void UAIDecisionTraceSubsystem::RecordBlackboardChange(const AActor* Agent, FName Key, bool bValue, const FVector& Value)
+{
+	AIDecisionTrace::FScopedRecordTimer Timer(Stats);
+
+	FAITraceRecord& Record = AddRecord(Agent, EAITraceEventType::BlackboardChanged);
+	Record.Id = InternName(Key);
+	Record.Code = bValue ? 1 : 0;
+	Record.Value = FVector3f(Value);
+}
+
+void UAIDecisionTraceSubsystem::RecordStimulus(const AActor* Agent, FName Sense, bool bSensed, const FVector& Location)
+{
+	AIDecisionTrace::FScopedRecordTimer Timer(Stats);
+
+	FAITraceRecord& Record = AddRecord(Agent, EAITraceEventType::Stimulus);
+	Record.Id = InternName(Sense);
+	Record.Code = bSensed ? 1 : 0;
+	Record.Value = FVector3f(Location);
+}
+
+void UAIDecisionTraceSubsystem::TraceTaskFinished(UBehaviorTreeComponent& OwnerComp, const UBTNode* Node, EBTNodeResult::Type Result)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	if (UAIDecisionTraceSubsystem* Trace = Get(&OwnerComp))
+	{
+		Trace->RecordTaskFinished(OwnerComp.GetOwner(), Node, Result);
+	}
+}
+
+// ============================================
+// OUTPUT
+// ============================================
+
+bool UAIDecisionTraceSubsystem::Flush(FString Path)
+{
+	const UWorld* World = GetWorld();
+	const FString MapName = World ? World->GetMapName() : FString();
+
+	if (Path.IsEmpty())
+	{
+		Path = FPaths::ProjectSavedDir() / TEXT("AITraces") / FString::Printf(TEXT("%s_%s.aitrace"), *MapName, *FDateTime::Now().ToString());
+	}
+
+	FAIDecisionTraceFile File;
+	File.Seed = Seed;
+	File.MapName = MapName;
+	File.Strings = Strings;
+	File.Agents.Reserve(Agents.Num());
+
+	for (const FAgentTrace& Trace : Agents)
+	{
+		FAIDecisionTraceFile::FAgent& Agent = File.Agents.AddDefaulted_GetRef();
+		Agent.Name = Trace.Name;
+		Agent.TotalRecorded = Trace.TotalRecorded;
+
+		// Ring -> thứ tự thời gian: [Head, end) rồi [0, Head)
+		Agent.Records.Reserve(Trace.Ring.Num());
+		Agent.Records.Append(Trace.Ring.GetData() + Trace.Head, Trace.Ring.Num() - Trace.Head);
+		Agent.Records.Append(Trace.Ring.GetData(), Trace.Head);
+	}
+
+	const bool bSaved = File.Save(Path);
+	UE_LOG(LogEscapeIT, Display, TEXT("AIDecisionTrace: %s %d agent(s) to %s"),
+		bSaved ? TEXT("wrote") : TEXT("FAILED to write"), File.Agents.Num(), *Path);
+	return bSaved;
+}
+
+void UAIDecisionTraceSubsystem::Reset()
+{
+	Agents.Empty();
+	AgentIndices.Empty();
+	Strings.Empty();
+	StringIds.Empty();
+	NameIds.Empty();
+	NodeIds.Empty();
+	StartFrame = GFrameCounter;
+}
@@ -0,0 +1,402 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/AIDirectorSubsystem.h"
+#include "EscapeIT.h"
+#include "EscapeITCharacter.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "Actor/Components/SanityComponent.h"
+#include "Algo/BinarySearch.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+
+namespace AIDirector
+{
+	/** Chạy các kịch bản cấp token trên pool rời, không cần NPC thật. Test != null thì mỗi check fail là một lỗi của test */
+	static bool RunValidation(FAutomationTestBase* Test = nullptr)
+	{
+		int32 NumFailed = 0;
+		auto Check = [&NumFailed, Test](bool bCondition, const TCHAR* Description)
+		{
+			if (!bCondition)
+			{
+				++NumFailed;
+				if (Test)
+				{
+					Test->AddError(Description);
+				}
+			}
+			UE_LOG(LogEscapeIT, Display, TEXT("AIDirector: [%s] %s"), bCondition ? TEXT("PASS") : TEXT("FAIL"), Description);
+		};
+
+		// ---- Capacity ----
+		FAIDirectorTokenSettings Chase;
+		Chase.MaxTokens = 2;
+		Chase.MinTokens = 1;
+		Chase.ScaleAtZeroSanity = 0.5f;
+		Chase.ReductionPerRecentScare = 0.25f;
+
+		Check(FAIDirectorTokenPool::ComputeCapacity(Chase, 1.0f, 0, MAX_dbl) == 2, TEXT("full sanity grants MaxTokens"));
+		Check(FAIDirectorTokenPool::ComputeCapacity(Chase, 0.0f, 0, MAX_dbl) == 1, TEXT("zero sanity scales capacity down"));
+		Check(FAIDirectorTokenPool::ComputeCapacity(Chase, 1.0f, 4, 30.0) == 1, TEXT("recent scares never drop below MinTokens"));
+
+		FAIDirectorTokenSettings JumpScare;
+		JumpScare.MaxTokens = 1;
+		JumpScare.ScaleAtZeroSanity = 0.25f;
+		JumpScare.ReductionPerRecentScare = 1.0f;
+		JumpScare.CooldownAfterScare = 20.0f;
+
+		Check(FAIDirectorTokenPool::ComputeCapacity(JumpScare, 1.0f, 0, MAX_dbl) == 1, TEXT("jump scare available when calm"));
+		Check(FAIDirectorTokenPool::ComputeCapacity(JumpScare, 1.0f, 1, 5.0) == 0, TEXT("jump scare locked during cooldown"));
+		Check(FAIDirectorTokenPool::ComputeCapacity(JumpScare, 1.0f, 1, 25.0) == 0, TEXT("jump scare suppressed by recent scare history"));
+		Check(FAIDirectorTokenPool::ComputeCapacity(JumpScare, 0.2f, 0, MAX_dbl) == 0, TEXT("jump scare suppressed at low sanity"));
+
+		// ---- Allocation ----
+		UObject* A = NewObject<UObject>(GetTransientPackage());
+		UObject* B = NewObject<UObject>(GetTransientPackage());
+		UObject* C = NewObject<UObject>(GetTransientPackage());
+		UObject* D = NewObject<UObject>(GetTransientPackage());
+		constexpr float Margin = 200.0f;
+
+		FAIDirectorTokenPool Pool;
+		Pool.SetCapacity(2);
+
+		FObjectKey Revoked;
+		Check(Pool.TryAcquire(A, -500.0f, Margin) && Pool.TryAcquire(B, -300.0f, Margin), TEXT("grants up to capacity"));
+		Check(Pool.TryAcquire(A, -500.0f, Margin) && Pool.Num() == 2, TEXT("re-acquire by holder is idempotent"));
+		Check(!Pool.TryAcquire(C, -1000.0f, Margin) && Pool.Num() == 2, TEXT("lower priority is refused when full"));
+		Check(!Pool.TryAcquire(C, -400.0f, Margin), TEXT("priority inside preempt margin is refused"));
+		Check(Pool.TryAcquire(D, -100.0f, Margin, &Revoked) && Revoked == FObjectKey(A) && !Pool.Contains(A), TEXT("higher priority preempts lowest holder"));
+
+		TArray<FObjectKey> RevokedKeys;
+		Pool.SetCapacity(1, &RevokedKeys);
+		Check(Pool.Num() == 1 && Pool.Contains(D) && RevokedKeys.Num() == 1 && RevokedKeys[0] == FObjectKey(B), TEXT("shrinking capacity revokes lowest priority"));
+
+		Check(Pool.Release(D) && Pool.Num() == 0, TEXT("release frees the token"));
+		Check(Pool.TryAcquire(C, -1000.0f, Margin), TEXT("freed token is granted to next requester"));
+
+		Pool.SetCapacity(0, &RevokedKeys);
+		Check(Pool.Num() == 0 && !Pool.TryAcquire(A, 0.0f, Margin), TEXT("zero capacity grants nothing"));
+
+		// ---- Scare pacing ----
+		// Như RefreshCapacities ngay sau NotifyScare của holder vừa được cấp JumpScare
+		FAIDirectorTokenPool ScarePool;
+		ScarePool.SetCapacity(FAIDirectorTokenPool::ComputeCapacity(JumpScare, 1.0f, 0, MAX_dbl));
+		ScarePool.SetAcquireLimit(FAIDirectorTokenPool::ComputeCapacity(JumpScare, 1.0f, 0, MAX_dbl));
+		Check(ScarePool.TryAcquire(A, -100.0f, Margin), TEXT("jump scare granted when calm"));
+
+		RevokedKeys.Reset();
+		ScarePool.SetCapacity(FAIDirectorTokenPool::ComputeCapacity(JumpScare, 1.0f, 0, MAX_dbl), &RevokedKeys);
+		ScarePool.SetAcquireLimit(FAIDirectorTokenPool::ComputeCapacity(JumpScare, 1.0f, 1, 0.0));
+		Check(RevokedKeys.Num() == 0 && ScarePool.Contains(A), TEXT("scare cooldown keeps the current jump scare holder"));
+		Check(ScarePool.TryAcquire(A, -100.0f, Margin), TEXT("holder re-acquires during cooldown"));
+		Check(!ScarePool.TryAcquire(B, 1000.0f, Margin) && ScarePool.Contains(A), TEXT("cooldown refuses new holders and preemption"));
+
+		Check(ScarePool.Release(A) && !ScarePool.TryAcquire(A, -100.0f, Margin), TEXT("released token is not re-granted during cooldown"));
+
+		ScarePool.SetAcquireLimit(FAIDirectorTokenPool::ComputeCapacity(JumpScare, 1.0f, 0, MAX_dbl));
+		Check(ScarePool.TryAcquire(B, -100.0f, Margin), TEXT("jump scare available again after scare history expires"));
+
+		UE_LOG(LogEscapeIT, Display, TEXT("AIDirector: validation %s (%d failed)"), NumFailed == 0 ? TEXT("passed") : TEXT("FAILED"), NumFailed);
+		return NumFailed == 0;
+	}
+
+	static FAutoConsoleCommand ValidateCommand(
+		TEXT("ai.Director.Validate"),
+		TEXT("Kiểm tra logic cấp/thu hồi token của AI director"),
+		FConsoleCommandDelegate::CreateStatic([]() { RunValidation(); }));
+}
+
+// ============================================
+// TOKEN POOL
+// ============================================
+
+int32 FAIDirectorTokenPool::IndexOf(FObjectKey Holder) const
+{
+	return Holders.IndexOfByPredicate([Holder](const FHolder& Entry) { return Entry.Key == Holder; });
+}
+
+int32 FAIDirectorTokenPool::FindLowestPriority() const
+{
+	int32 Lowest = INDEX_NONE;
+	for (int32 i = 0; i < Holders.Num(); ++i)
+	{
+		if (Lowest == INDEX_NONE || Holders[i].Priority < Holders[Lowest].Priority)
+		{
+			Lowest = i;
+		}
+	}
+	return Lowest;
+}
+
+bool FAIDirectorTokenPool::TryAcquire(FObjectKey Holder, float Priority, float PreemptMargin, FObjectKey* OutRevoked)
+{
+	if (const int32 Index = IndexOf(Holder); Index != INDEX_NONE)
+	{
+		Holders[Index].Priority = Priority;
+		return true;
+	}
+
+	const int32 Limit = GetAcquireLimit();
+	if (Holders.Num() < Limit)
+	{
+		Holders.Add({ Holder, Priority });
+		return true;
+	}
+
+	// Đang giữ nhiều hơn giới hạn cấp mới (vd. cooldown sau scare): không đổi holder
+	if (Holders.Num() > Limit)
+	{
+		return false;
+	}
+
+	// Đầy: chỉ giành được từ holder thấp nhất khi hơn hẳn PreemptMargin
+	const int32 Lowest = FindLowestPriority();
+	if (Lowest == INDEX_NONE || Priority <= Holders[Lowest].Priority + PreemptMargin)
+	{
+		return false;
+	}
+
+	if (OutRevoked)
+	{
+		*OutRevoked = Holders[Lowest].Key;
+	}
+	Holders[Lowest] = { Holder, Priority };
+	return true;
+}
+
+bool FAIDirectorTokenPool::Release(FObjectKey Holder)
+{
+	const int32 Index = IndexOf(Holder);
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	Holders.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	return true;
+}
+
+void FAIDirectorTokenPool::SetCapacity(int32 NewCapacity, TArray<FObjectKey>* OutRevoked)
+{
+	Capacity = FMath::Max(0, NewCapacity);
+
+	while (Holders.Num() > Capacity)
+	{
+		const int32 Lowest = FindLowestPriority();
+		if (OutRevoked)
+		{
+			OutRevoked->Add(Holders[Lowest].Key);
+		}
+		Holders.RemoveAtSwap(Lowest, 1, EAllowShrinking::No);
+	}
+}
+
+void FAIDirectorTokenPool::RemoveStaleHolders()
+{
+	Holders.RemoveAllSwap([](const FHolder& Entry) { return Entry.Key.ResolveObjectPtr() == nullptr; }, EAllowShrinking::No);
+}
+
+int32 FAIDirectorTokenPool::ComputeCapacity(const FAIDirectorTokenSettings& Settings, float SanityPercent, int32 NumRecentScares, double TimeSinceLastScare)
+{
+	// Cooldown thắng cả MinTokens: vừa scare xong thì khóa hẳn
+	if (TimeSinceLastScare < Settings.CooldownAfterScare)
+	{
+		return 0;
+	}
+
+	const float SanityScale = FMath::Lerp(Settings.ScaleAtZeroSanity, 1.0f, FMath::Clamp(SanityPercent, 0.0f, 1.0f));
+	const float Scale = FMath::Max(0.0f, SanityScale - Settings.ReductionPerRecentScare * NumRecentScares);
+
+	const int32 MaxTokens = FMath::Max(0, Settings.MaxTokens);
+	return FMath::Clamp(FMath::RoundToInt(MaxTokens * Scale), FMath::Min(Settings.MinTokens, MaxTokens), MaxTokens);
+}
+
+// ============================================
+// SUBSYSTEM
+// ============================================
+
+UAIDirectorSubsystem::UAIDirectorSubsystem()
+{
+	FAIDirectorTokenSettings& Chase = TokenSettings[static_cast<int32>(EAIDirectorToken::Chase)];
+	Chase.MaxTokens = 2;
+	Chase.MinTokens = 1;
+	Chase.ScaleAtZeroSanity = 0.5f;
+	Chase.ReductionPerRecentScare = 0.25f;
+
+	FAIDirectorTokenSettings& Investigate = TokenSettings[static_cast<int32>(EAIDirectorToken::Investigate)];
+	Investigate.MaxTokens = 3;
+	Investigate.MinTokens = 1;
+	Investigate.ScaleAtZeroSanity = 0.67f;
+
+	FAIDirectorTokenSettings& JumpScare = TokenSettings[static_cast<int32>(EAIDirectorToken::JumpScare)];
+	JumpScare.MaxTokens = 1;
+	JumpScare.ScaleAtZeroSanity = 0.25f;
+	JumpScare.ReductionPerRecentScare = 0.5f;
+	JumpScare.CooldownAfterScare = 20.0f;
+
+	FAIDirectorTokenSettings& DoorBreach = TokenSettings[static_cast<int32>(EAIDirectorToken::DoorBreach)];
+	DoorBreach.MaxTokens = 1;
+	DoorBreach.ScaleAtZeroSanity = 0.5f;
+	DoorBreach.ReductionPerRecentScare = 0.5f;
+	DoorBreach.CooldownAfterScare = 5.0f;
+}
+
+UAIDirectorSubsystem* UAIDirectorSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UAIDirectorSubsystem>() : nullptr;
+}
+
+void UAIDirectorSubsystem::Deinitialize()
+{
+	for (FAIDirectorTokenPool& Pool : Pools)
+	{
+		Pool.Reset();
+	}
+	ScareTimes.Empty();
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// TOKENS
+// ============================================
+
+bool UAIDirectorSubsystem::TryAcquireToken(EAIDirectorToken Token, const UObject* Holder, float Priority)
+{
+	if (!Holder || Token >= EAIDirectorToken::Count)
+	{
+		return false;
+	}
+
+	RefreshCapacities();
+
+	FObjectKey Revoked;
+	const bool bGranted = Pools[static_cast<int32>(Token)].TryAcquire(Holder, Priority, PreemptMargin, &Revoked);
+	if (bGranted && Revoked != FObjectKey())
+	{
+		UE_LOG(LogEscapeIT, Verbose, TEXT("AIDirector: %s token moved from %s to %s"),
+			*UEnum::GetValueAsString(Token), *GetNameSafe(Revoked.ResolveObjectPtr()), *GetNameSafe(Holder));
+	}
+
+	return bGranted;
+}
+
+void UAIDirectorSubsystem::ReleaseToken(EAIDirectorToken Token, const UObject* Holder)
+{
+	if (Holder && Token < EAIDirectorToken::Count)
+	{
+		Pools[static_cast<int32>(Token)].Release(Holder);
+	}
+}
+
+void UAIDirectorSubsystem::ReleaseAllTokens(const UObject* Holder)
+{
+	if (!Holder)
+	{
+		return;
+	}
+
+	for (FAIDirectorTokenPool& Pool : Pools)
+	{
+		Pool.Release(Holder);
+	}
+}
+
+bool UAIDirectorSubsystem::HasToken(EAIDirectorToken Token, const UObject* Holder)
+{
+	if (!Holder || Token >= EAIDirectorToken::Count)
+	{
+		return false;
+	}
+
+	// Refresh trước để token bị thu hồi do capacity giảm được thấy ngay
+	RefreshCapacities();
+	return Pools[static_cast<int32>(Token)].Contains(Holder);
+}
+
+int32 UAIDirectorSubsystem::GetCapacity(EAIDirectorToken Token)
+{
+	RefreshCapacities();
+	return Token < EAIDirectorToken::Count ? Pools[static_cast<int32>(Token)].GetCapacity() : 0;
+}
+
+// ============================================
+// PACING
+// ============================================
+
+void UAIDirectorSubsystem::NotifyScare()
+{
+	if (const UWorld* World = GetWorld())
+	{
+		ScareTimes.Add(World->GetTimeSeconds());
+		RefreshCapacities(true);
+	}
+}
+
+int32 UAIDirectorSubsystem::GetNumRecentScares()
+{
+	RefreshCapacities();
+	return ScareTimes.Num();
+}
+
+float UAIDirectorSubsystem::GetPlayerSanityPercent()
+{
+	UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(this);
+	const AEscapeITCharacter* Player = WorldState ? Cast<AEscapeITCharacter>(WorldState->GetPlayer()) : nullptr;
+	const USanityComponent* Sanity = Player ? Player->GetSanityComponent() : nullptr;
+
+	return Sanity ? Sanity->GetSanityPercent() : 1.0f;
+}
+
+void UAIDirectorSubsystem::RefreshCapacities(bool bForce)
+{
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	const double Now = World->GetTimeSeconds();
+	if (!bForce && LastRefreshTime >= 0.0 && Now - LastRefreshTime < RefreshInterval)
+	{
+		return;
+	}
+	LastRefreshTime = Now;
+
+	// Bỏ scare đã ra khỏi cửa sổ (thêm theo thứ tự thời gian -> cắt đầu mảng)
+	const int32 NumExpired = Algo::LowerBound(ScareTimes, Now - ScareHistoryWindow);
+	if (NumExpired > 0)
+	{
+		ScareTimes.RemoveAt(0, NumExpired, EAllowShrinking::No);
+	}
+
+	const double TimeSinceLastScare = ScareTimes.Num() > 0 ? Now - ScareTimes.Last() : MAX_dbl;
+	const float SanityPercent = GetPlayerSanityPercent();
+
+	// Scare vừa xảy ra (thường do chính holder JumpScare) chỉ chặn cấp mới; sanity thấp mới thu hồi
+	for (int32 i = 0; i < static_cast<int32>(EAIDirectorToken::Count); ++i)
+	{
+		Pools[i].RemoveStaleHolders();
+		Pools[i].SetCapacity(FAIDirectorTokenPool::ComputeCapacity(TokenSettings[i], SanityPercent, 0, MAX_dbl));
+		Pools[i].SetAcquireLimit(FAIDirectorTokenPool::ComputeCapacity(TokenSettings[i], SanityPercent, ScareTimes.Num(), TimeSinceLastScare));
+	}
+}
+
+// ============================================
+// AUTOMATION
+// ============================================
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAIDirectorTokenPoolTest, "EscapeIT.AI.Director.Validate",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAIDirectorTokenPoolTest::RunTest(const FString& Parameters)
+{
+	return AIDirector::RunValidation(this);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,461 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/AISignificanceSubsystem.h"
+#include "EscapeIT.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "AI/ChaseMovementSubsystem.h"
+#include "AI/NPCBlackboardSchema.h"
+#include "AI/NPC_AIController.h"
+#include "AI/NPC.h"
+#include "AI/NPCSkeletalMeshComponent.h"
+#include "AI/NPCAnimationBudgetSubsystem.h"
+#include "AI/NPCSightSubsystem.h"
+#include "AI/AIDirectorSubsystem.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "EngineUtils.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("AISignificance Evaluate"), STAT_AISignificanceEvaluate, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Significance Critical"), STAT_AISignificanceCritical, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Significance High"), STAT_AISignificanceHigh, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Significance Medium"), STAT_AISignificanceMedium, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Significance Low"), STAT_AISignificanceLow, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AI Significance Dormant"), STAT_AISignificanceDormant, STATGROUP_EscapeIT);
+
+namespace AISignificance
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("ai.Significance.Enabled"),
+		bEnabled,
+		TEXT("0 = mọi NPC update full rate (dùng để so sánh chi phí AI với/không có LOD)"));
+
+	static bool bDormancyEnabled = true;
+	static FAutoConsoleVariableRef CVarDormancy(
+		TEXT("ai.Significance.Dormancy"),
+		bDormancyEnabled,
+		TEXT("0 = NPC xa nhất dừng ở Low thay vì ngủ đông"));
+
+	constexpr int32 ToIndex(EAISignificance Level) { return static_cast<int32>(Level); }
+
+	/** Những gì phải giữ nguyên qua một vòng ngủ đông */
+	struct FDormancySnapshot
+	{
+		// Bool lưu ở X
+		TArray<FVector> BlackboardValues;
+		FVector PlayerLastKnownLocation = FVector::ZeroVector;
+		float PlayerConfidence = 0.0f;
+		FVector NoiseLastKnownLocation = FVector::ZeroVector;
+		float NoiseConfidence = 0.0f;
+		FVector Location = FVector::ZeroVector;
+		const UBTNode* ActiveNode = nullptr;
+
+		static FDormancySnapshot Capture(const ANPC& NPC, const ANPC_AIController& Controller)
+		{
+			FDormancySnapshot Snapshot;
+
+			if (const UBlackboardComponent* Blackboard = Controller.GetBlackboardComponent())
+			{
+				const FNPCBlackboardKeys& Keys = FNPCBlackboardKeys::Get(Blackboard->GetBlackboardAsset());
+				for (const FNPCBlackboardKeyDesc& Desc : NPCBlackboard::GetSchema())
+				{
+					const FBlackboard::FKey Key = Keys[Desc.Key];
+					if (Key == FBlackboard::InvalidKey)
+					{
+						continue;
+					}
+					Snapshot.BlackboardValues.Add(Desc.KeyType == UBlackboardKeyType_Bool::StaticClass()
+						? FVector(Blackboard->GetValue<UBlackboardKeyType_Bool>(Key) ? 1.0 : 0.0, 0.0, 0.0)
+						: Blackboard->GetValue<UBlackboardKeyType_Vector>(Key));
+				}
+			}
+
+			Snapshot.PlayerLastKnownLocation = Controller.GetPlayerMemory().LastKnownLocation;
+			Snapshot.PlayerConfidence = Controller.GetPlayerMemory().Confidence;
+			Snapshot.NoiseLastKnownLocation = Controller.GetNoiseMemory().LastKnownLocation;
+			Snapshot.NoiseConfidence = Controller.GetNoiseMemory().Confidence;
+			Snapshot.Location = NPC.GetActorLocation();
+
+			if (const UBehaviorTreeComponent* BehaviorTree = Cast<UBehaviorTreeComponent>(Controller.GetBrainComponent()))
+			{
+				Snapshot.ActiveNode = BehaviorTree->GetActiveNode();
+			}
+			return Snapshot;
+		}
+
+		bool operator==(const FDormancySnapshot& Other) const
+		{
+			return BlackboardValues == Other.BlackboardValues
+				&& PlayerLastKnownLocation == Other.PlayerLastKnownLocation && PlayerConfidence == Other.PlayerConfidence
+				&& NoiseLastKnownLocation == Other.NoiseLastKnownLocation && NoiseConfidence == Other.NoiseConfidence
+				&& Location == Other.Location && ActiveNode == Other.ActiveNode;
+		}
+	};
+
+	/**
+	 * Cho mọi NPC trong world ngủ đông rồi thức dậy ngay trong frame, kiểm tra từng thứ đã dừng/chạy lại
+	 * và blackboard, memory, node BT đang chạy, move đang dở giữ nguyên. Chạy headless:
+	 *   UnrealEditor-Cmd EscapeIT.uproject <Map> -game -nullrhi -ExecCmds="ai.Significance.ValidateDormancy"
+	 */
+	static bool RunDormancyValidation(UWorld* World)
+	{
+		int32 NumNPCs = 0;
+		int32 NumFailed = 0;
+
+		UNPCSightSubsystem* Sight = UNPCSightSubsystem::Get(World);
+		UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(World);
+
+		for (TActorIterator<ANPC> It(World); It; ++It)
+		{
+			ANPC& NPC = **It;
+			ANPC_AIController* Controller = NPC.GetController<ANPC_AIController>();
+			if (NPC.IsPooled() || !Controller || !Controller->GetBlackboardComponent())
+			{
+				continue;
+			}
+			++NumNPCs;
+
+			auto Check = [&NumFailed, &NPC](bool bCondition, const TCHAR* Description)
+			{
+				if (!bCondition)
+				{
+					++NumFailed;
+					UE_LOG(LogEscapeIT, Error, TEXT("AISignificance: [FAIL] %s: %s"), *NPC.GetName(), Description);
+				}
+			};
+
+			const UBrainComponent* Brain = Controller->GetBrainComponent();
+			const UPathFollowingComponent* PathFollowing = Controller->GetPathFollowingComponent();
+			const UCharacterMovementComponent* Movement = NPC.GetCharacterMovement();
+			const USkeletalMeshComponent* MeshComponent = NPC.GetMesh();
+
+			const bool bWasDormant = NPC.IsDormant();
+			NPC.SetDormant(false);
+
+			const FDormancySnapshot Before = FDormancySnapshot::Capture(NPC, *Controller);
+			const EPathFollowingStatus::Type MoveStatusBefore = PathFollowing ? PathFollowing->GetStatus() : EPathFollowingStatus::Idle;
+
+			// ---- Ngủ ----
+			NPC.SetDormant(true);
+
+			Check(Controller->IsDormant(), TEXT("controller follows pawn into dormancy"));
+			Check(!Brain || Brain->IsPaused(), TEXT("behavior tree is paused"));
+			Check(!PathFollowing || PathFollowing->GetStatus() != EPathFollowingStatus::Moving, TEXT("path following is paused"));
+			Check(!Sight || !Sight->IsObserverRegistered(Controller), TEXT("sight observer is unregistered"));
+			Check(!NPC.IsActorTickEnabled() && !Controller->IsActorTickEnabled(), TEXT("actor ticks are off"));
+			Check(!Movement || !Movement->IsComponentTickEnabled(), TEXT("movement tick is off"));
+			Check(!MeshComponent || !MeshComponent->IsComponentTickEnabled(), TEXT("mesh tick is off"));
+			Check(NPC.GetCapsuleComponent()->GetCollisionEnabled() == ECollisionEnabled::QueryOnly, TEXT("capsule collision reduced to query"));
+
+			bool bHoldsToken = false;
+			for (int32 Token = 0; Director && Token < static_cast<int32>(EAIDirectorToken::Count); ++Token)
+			{
+				bHoldsToken |= Director->HasToken(static_cast<EAIDirectorToken>(Token), Controller);
+			}
+			Check(!bHoldsToken, TEXT("director tokens are released"));
+
+			Check(FDormancySnapshot::Capture(NPC, *Controller) == Before, TEXT("state unchanged while dormant"));
+
+			// ---- Thức ----
+			NPC.SetDormant(false);
+
+			Check(!Controller->IsDormant(), TEXT("controller wakes with pawn"));
+			Check(!Brain || !Brain->IsPaused(), TEXT("behavior tree resumes"));
+			Check(!PathFollowing || PathFollowing->GetStatus() == MoveStatusBefore, TEXT("path following resumes"));
+			Check(!Sight || Sight->IsObserverRegistered(Controller), TEXT("sight observer is registered again"));
+			Check(!Movement || Movement->IsComponentTickEnabled(), TEXT("movement tick is back on"));
+			Check(!MeshComponent || MeshComponent->IsComponentTickEnabled(), TEXT("mesh tick is back on"));
+			Check(FDormancySnapshot::Capture(NPC, *Controller) == Before, TEXT("blackboard, memory and active node survive the round trip"));
+
+			NPC.SetDormant(bWasDormant);
+		}
+
+		UE_LOG(LogEscapeIT, Display, TEXT("AISignificance: dormancy validation %s (%d NPCs, %d failed checks)"),
+			NumFailed == 0 ? TEXT("passed") : TEXT("FAILED"), NumNPCs, NumFailed);
+		return NumFailed == 0;
+	}
+
+	static FAutoConsoleCommandWithWorld ValidateDormancyCommand(
+		TEXT("ai.Significance.ValidateDormancy"),
+		TEXT("Cho mọi NPC ngủ đông rồi thức dậy, kiểm tra trạng thái giữ nguyên"),
+		FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World) { RunDormancyValidation(World); }));
+}
+
+UAISignificanceSubsystem::UAISignificanceSubsystem()
+{
+	using namespace AISignificance;
+
+	// Critical/High: full rate
+	Levels[ToIndex(EAISignificance::High)].MaxDistance = 1500.0f;
+
+	FAISignificanceLevelSettings& Medium = Levels[ToIndex(EAISignificance::Medium)];
+	Medium.MaxDistance = 4000.0f;
+	Medium.BehaviorTreeTickInterval = 0.1f;
+	Medium.MovementTickInterval = 0.033f;
+	Medium.AnimationTickInterval = 0.066f;
+	Medium.CrowdAvoidanceQuality = ECrowdAvoidanceQuality::Medium;
+
+	FAISignificanceLevelSettings& Low = Levels[ToIndex(EAISignificance::Low)];
+	Low.MaxDistance = 8000.0f;
+	Low.BehaviorTreeTickInterval = 0.5f;
+	Low.MovementTickInterval = 0.1f;
+	Low.AnimationTickInterval = 0.25f;
+	Low.bSightEnabled = false;
+	Low.CrowdAvoidanceQuality = ECrowdAvoidanceQuality::Low;
+	Low.bCrowdSimulationEnabled = false;
+	Low.bPreloadAnimations = false;
+
+	// Dormant không dùng rate (mọi thứ dừng hẳn); giữ giống Low cho character không phải ANPC
+	Levels[ToIndex(EAISignificance::Dormant)] = Low;
+	Levels[ToIndex(EAISignificance::Dormant)].MaxDistance = 0.0f;
+}
+
+UAISignificanceSubsystem* UAISignificanceSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UAISignificanceSubsystem>() : nullptr;
+}
+
+void UAISignificanceSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	for (int32& Count : LevelCounts)
+	{
+		Count = 0;
+	}
+
+	SET_DWORD_STAT(STAT_AISignificanceCritical, 0);
+	SET_DWORD_STAT(STAT_AISignificanceHigh, 0);
+	SET_DWORD_STAT(STAT_AISignificanceMedium, 0);
+	SET_DWORD_STAT(STAT_AISignificanceLow, 0);
+	SET_DWORD_STAT(STAT_AISignificanceDormant, 0);
+
+	Super::Deinitialize();
+}
+
+TStatId UAISignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAISignificanceSubsystem, STATGROUP_Tickables);
+}
+
+// ============================================
+// NPC
+// ============================================
+
+void UAISignificanceSubsystem::RegisterNPC(ACharacter* NPC)
+{
+	if (!NPC || Entries.ContainsByPredicate([NPC](const FSignificanceEntry& Entry) { return Entry.NPC.Get() == NPC; }))
+	{
+		return;
+	}
+
+	// Bắt đầu ở Critical (full rate) cho tới lần đánh giá đầu tiên
+	FSignificanceEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.NPC = NPC;
+
+	// Đánh giá ngay ở tick tới
+	TimeSinceEvaluation = EvaluationInterval;
+}
+
+void UAISignificanceSubsystem::UnregisterNPC(ACharacter* NPC)
+{
+	const int32 Index = Entries.IndexOfByPredicate([NPC](const FSignificanceEntry& Entry) { return Entry.NPC.Get() == NPC; });
+	if (Index != INDEX_NONE)
+	{
+		Entries.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	}
+}
+
+EAISignificance UAISignificanceSubsystem::GetSignificance(const ACharacter* NPC) const
+{
+	const FSignificanceEntry* Entry = Entries.FindByPredicate([NPC](const FSignificanceEntry& Candidate) { return Candidate.NPC.Get() == NPC; });
+	return Entry ? Entry->Level : EAISignificance::Critical;
+}
+
+int32 UAISignificanceSubsystem::GetNumInLevel(EAISignificance Level) const
+{
+	return Level < EAISignificance::Count ? LevelCounts[AISignificance::ToIndex(Level)] : 0;
+}
+
+// ============================================
+// EVALUATE
+// ============================================
+
+void UAISignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceEvaluation += DeltaTime;
+
+	const bool bEnabledChanged = AISignificance::bEnabled != bWasEnabled;
+	if (TimeSinceEvaluation < EvaluationInterval && !bEnabledChanged)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_AISignificanceEvaluate);
+
+	const float Elapsed = TimeSinceEvaluation;
+	TimeSinceEvaluation = 0.0f;
+	bWasEnabled = AISignificance::bEnabled;
+
+	for (int32& Count : LevelCounts)
+	{
+		Count = 0;
+	}
+
+	for (int32 i = Entries.Num() - 1; i >= 0; --i)
+	{
+		FSignificanceEntry& Entry = Entries[i];
+		ACharacter* NPC = Entry.NPC.Get();
+		if (!NPC)
+		{
+			Entries.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		Entry.TimeInLevel += Elapsed;
+
+		const EAISignificance Desired = AISignificance::bEnabled ? EvaluateLevel(Entry, NPC) : EAISignificance::Critical;
+
+		// Lên mức áp ngay, xuống mức phải chờ đủ MinTimeInLevel (tắt LOD thì áp ngay)
+		const bool bPromote = Desired < Entry.Level;
+		const bool bDemote = Desired > Entry.Level && (Entry.TimeInLevel >= MinTimeInLevel || bEnabledChanged);
+		if (bPromote || bDemote)
+		{
+			Entry.Level = Desired;
+			Entry.TimeInLevel = 0.0f;
+			Entry.bApplied = false;
+		}
+
+		if (!Entry.bApplied || bEnabledChanged)
+		{
+			Entry.bApplied = ApplyLevel(NPC, Entry.Level);
+		}
+
+		++LevelCounts[AISignificance::ToIndex(Entry.Level)];
+	}
+
+	SET_DWORD_STAT(STAT_AISignificanceCritical, LevelCounts[AISignificance::ToIndex(EAISignificance::Critical)]);
+	SET_DWORD_STAT(STAT_AISignificanceHigh, LevelCounts[AISignificance::ToIndex(EAISignificance::High)]);
+	SET_DWORD_STAT(STAT_AISignificanceMedium, LevelCounts[AISignificance::ToIndex(EAISignificance::Medium)]);
+	SET_DWORD_STAT(STAT_AISignificanceLow, LevelCounts[AISignificance::ToIndex(EAISignificance::Low)]);
+	SET_DWORD_STAT(STAT_AISignificanceDormant, LevelCounts[AISignificance::ToIndex(EAISignificance::Dormant)]);
+}
+
+EAISignificance UAISignificanceSubsystem::EvaluateLevel(const FSignificanceEntry& Entry, ACharacter* NPC) const
+{
+	AAIController* Controller = NPC->GetController<AAIController>();
+
+	// ---- BT state: đang thấy/đuổi/điều tra thì luôn full rate ----
+	if (Controller)
+	{
+		const FNPCBlackboard BB(Controller->GetBlackboardComponent());
+		if (BB.IsValid() && (BB.GetCanSeePlayer() || BB.GetIsPlayerBeingChased() || BB.GetHasHeardSound() || BB.GetIsInvestigating()))
+		{
+			return EAISignificance::Critical;
+		}
+
+		const UChaseMovementSubsystem* ChaseMovement = UChaseMovementSubsystem::Get(this);
+		if (ChaseMovement && ChaseMovement->GetChaseStatus(Controller) != EChaseMoveStatus::None)
+		{
+			return EAISignificance::Critical;
+		}
+	}
+
+	// ---- Khoảng cách (đọc từ snapshot đã tính batch) ----
+	UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(this);
+	const float Distance = WorldState ? WorldState->GetDistanceToPlayer(NPC) : 0.0f;
+	EAISignificance Level = GetDistanceLevel(Distance, Entry.Level);
+
+	// ---- Không được render thì hạ thêm một mức ----
+	if (Level < EAISignificance::Low && !NPC->WasRecentlyRendered(RenderedTolerance))
+	{
+		Level = static_cast<EAISignificance>(AISignificance::ToIndex(Level) + 1);
+	}
+
+	// ---- Chỉ ngủ đông khi không ai nhìn thấy (NPC đứng hình giữa chừng rất lộ) ----
+	if (Level == EAISignificance::Dormant && (!AISignificance::bDormancyEnabled || NPC->WasRecentlyRendered(RenderedTolerance)))
+	{
+		Level = EAISignificance::Low;
+	}
+
+	return Level;
+}
+
+EAISignificance UAISignificanceSubsystem::GetDistanceLevel(float Distance, EAISignificance CurrentLevel) const
+{
+	using namespace AISignificance;
+
+	EAISignificance Level = EAISignificance::Dormant;
+	for (int32 i = ToIndex(EAISignificance::High); i < ToIndex(EAISignificance::Dormant); ++i)
+	{
+		if (Distance <= Levels[i].MaxDistance)
+		{
+			Level = static_cast<EAISignificance>(i);
+			break;
+		}
+	}
+
+	// Hysteresis: chỉ rời mức khoảng cách hiện tại khi đã vượt ngưỡng của nó thêm HysteresisDistance
+	const bool bCurrentIsDistanceLevel = CurrentLevel > EAISignificance::Critical && CurrentLevel < EAISignificance::Dormant;
+	if (bCurrentIsDistanceLevel && Level > CurrentLevel && Distance <= Levels[ToIndex(CurrentLevel)].MaxDistance + HysteresisDistance)
+	{
+		return CurrentLevel;
+	}
+
+	return Level;
+}
+
+bool UAISignificanceSubsystem::ApplyLevel(ACharacter* NPC, EAISignificance Level) const
+{
+	const FAISignificanceLevelSettings& Settings = Levels[AISignificance::ToIndex(Level)];
+
+	// Ngủ đông thay cho mọi rate bên dưới; thức dậy thì áp lại rate của mức mới
+	if (ANPC* NPCPawn = Cast<ANPC>(NPC))
+	{
+		if (Level == EAISignificance::Dormant)
+		{
+			// Chưa có controller thì chưa dừng được BT/perception -> thử lại ở lần sau
+			if (!NPCPawn->GetController())
+			{
+				return false;
+			}
+			NPCPawn->SetDormant(true);
+			return true;
+		}
+		NPCPawn->SetDormant(false);
+
+		if (Settings.bPreloadAnimations)
+		{
+			NPCPawn->PreloadAnimations();
+		}
+	}
+
+	if (UCharacterMovementComponent* Movement = NPC->GetCharacterMovement())
+	{
+		Movement->SetComponentTickInterval(Settings.MovementTickInterval);
+	}
+
+	if (USkeletalMeshComponent* Mesh = NPC->GetMesh())
+	{
+		// Mesh của NPC do UNPCAnimationBudgetSubsystem chia tick rate, tick interval chồng lên sẽ lệch nhịp
+		const bool bBudgeted = UNPCAnimationBudgetSubsystem::IsEnabled() && Mesh->IsA<UNPCSkeletalMeshComponent>();
+		Mesh->SetComponentTickInterval(bBudgeted ? 0.0f : Settings.AnimationTickInterval);
+	}
+
+	ANPC_AIController* Controller = NPC->GetController<ANPC_AIController>();
+	if (!Controller)
+	{
+		return false;
+	}
+
+	Controller->SetUpdateRates(Settings.BehaviorTreeTickInterval, Settings.bSightEnabled);
+	Controller->SetCrowdAvoidance(Settings.CrowdAvoidanceQuality, Settings.bCrowdSimulationEnabled);
+	return true;
+}
@@ -0,0 +1,393 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/AIWorldStateSubsystem.h"
+#include "EscapeIT.h"
+#include "EscapeITCharacter.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("AIWorldState Update"), STAT_AIWorldStateUpdate, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AIWorldState NPCs"), STAT_AIWorldStateNPCs, STATGROUP_EscapeIT);
+
+namespace AIWorldState
+{
+	// CheckPlayerDistance, UpdatePlayerLocation, ChasePlayer: mỗi NPC đọc player ba lần mỗi frame
+	constexpr int32 NumServicesPerNPC = 3;
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("ai.WorldState.Benchmark"),
+		TEXT("ai.WorldState.Benchmark <MaxNPCs> <NumFrames>: so chi phí đọc khoảng cách tới player kiểu cũ với snapshot theo số NPC"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(World))
+			{
+				WorldState->RunBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 200, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 600);
+			}
+		}));
+}
+
+UAIWorldStateSubsystem* UAIWorldStateSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UAIWorldStateSubsystem>() : nullptr;
+}
+
+void UAIWorldStateSubsystem::Deinitialize()
+{
+	NPCs.Empty();
+	NPCKeys.Empty();
+	NPCLocations.Empty();
+	NPCForwards.Empty();
+	DistancesToPlayer.Empty();
+	BearingsToPlayer.Empty();
+	NPCIndices.Empty();
+	SET_DWORD_STAT(STAT_AIWorldStateNPCs, 0);
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// NPC
+// ============================================
+
+void UAIWorldStateSubsystem::RegisterNPC(APawn* NPC)
+{
+	if (!NPC || NPCIndices.Contains(NPC))
+	{
+		return;
+	}
+
+	const int32 Index = NPCs.Add(NPC);
+	NPCKeys.Add(NPC);
+	NPCLocations.Add(NPC->GetActorLocation());
+	NPCForwards.Add(NPC->GetActorForwardVector());
+	DistancesToPlayer.Add(MAX_flt);
+	BearingsToPlayer.Add(0.0f);
+	NPCIndices.Add(NPC, Index);
+
+	// Giá trị của NPC mới phải được tính ngay ở lần đọc tới
+	CapturedFrame = MAX_uint64;
+	SET_DWORD_STAT(STAT_AIWorldStateNPCs, NPCs.Num());
+}
+
+void UAIWorldStateSubsystem::UnregisterNPC(APawn* NPC)
+{
+	if (const int32* Index = NPCIndices.Find(NPC))
+	{
+		RemoveNPCAt(*Index);
+	}
+}
+
+void UAIWorldStateSubsystem::RemoveNPCAt(int32 Index)
+{
+	// Dùng key thay vì weak ptr: NPC đã bị destroy vẫn gỡ được khỏi map
+	NPCIndices.Remove(NPCKeys[Index]);
+
+	NPCs.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	NPCKeys.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	NPCLocations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	NPCForwards.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	DistancesToPlayer.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	BearingsToPlayer.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	// Phần tử cuối được swap vào Index
+	if (NPCs.IsValidIndex(Index))
+	{
+		NPCIndices.Add(NPCKeys[Index], Index);
+	}
+
+	SET_DWORD_STAT(STAT_AIWorldStateNPCs, NPCs.Num());
+}
+
+// ============================================
+// PLAYER
+// ============================================
+
+const FAIPlayerSnapshot& UAIWorldStateSubsystem::GetPlayerSnapshot()
+{
+	EnsureUpToDate();
+	return PlayerSnapshot;
+}
+
+ACharacter* UAIWorldStateSubsystem::GetPlayer()
+{
+	EnsureUpToDate();
+	return Player.Get();
+}
+
+void UAIWorldStateSubsystem::NotifyPlayerNoise(float Loudness)
+{
+	const UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	// Giữ noise lớn nhất sau khi trừ phần đã decay
+	const double Now = World->GetTimeSeconds();
+	const float CurrentLevel = LastNoiseTime < 0.0
+		? 0.0f
+		: FMath::Max(0.0f, LastNoiseLoudness - NoiseDecayPerSecond * static_cast<float>(Now - LastNoiseTime));
+
+	LastNoiseLoudness = FMath::Max(CurrentLevel, Loudness);
+	LastNoiseTime = Now;
+	PlayerSnapshot.NoiseLevel = LastNoiseLoudness;
+}
+
+// ============================================
+// QUERIES
+// ============================================
+
+float UAIWorldStateSubsystem::GetDistanceToPlayer(const AActor* NPC)
+{
+	EnsureUpToDate();
+
+	if (!PlayerSnapshot.bValid || !NPC)
+	{
+		return MAX_flt;
+	}
+
+	if (const int32* Index = NPCIndices.Find(NPC))
+	{
+		return DistancesToPlayer[*Index];
+	}
+
+	return FVector::Dist(NPC->GetActorLocation(), PlayerSnapshot.Location);
+}
+
+float UAIWorldStateSubsystem::GetBearingToPlayer(const AActor* NPC)
+{
+	EnsureUpToDate();
+
+	if (!PlayerSnapshot.bValid || !NPC)
+	{
+		return 0.0f;
+	}
+
+	if (const int32* Index = NPCIndices.Find(NPC))
+	{
+		return BearingsToPlayer[*Index];
+	}
+
+	const FVector ToPlayer = PlayerSnapshot.Location - NPC->GetActorLocation();
+	const FVector Forward = NPC->GetActorForwardVector();
+	return FMath::RadiansToDegrees(FMath::Atan2(Forward.X * ToPlayer.Y - Forward.Y * ToPlayer.X, Forward.X * ToPlayer.X + Forward.Y * ToPlayer.Y));
+}
+
+// ============================================
+// UPDATE
+// ============================================
+
+void UAIWorldStateSubsystem::EnsureUpToDate()
+{
+	if (CapturedFrame == GFrameCounter)
+	{
+		return;
+	}
+	CapturedFrame = GFrameCounter;
+
+	SCOPE_CYCLE_COUNTER(STAT_AIWorldStateUpdate);
+
+	UWorld* World = GetWorld();
+
+	// ---- Player ----
+	ACharacter* PlayerCharacter = Player.Get();
+	if (!PlayerCharacter)
+	{
+		PlayerCharacter = UGameplayStatics::GetPlayerCharacter(World, 0);
+		Player = PlayerCharacter;
+	}
+
+	PlayerSnapshot.bValid = PlayerCharacter != nullptr;
+	if (PlayerCharacter)
+	{
+		PlayerSnapshot.Location = PlayerCharacter->GetActorLocation();
+		PlayerSnapshot.Velocity = PlayerCharacter->GetVelocity();
+		PlayerSnapshot.Forward = PlayerCharacter->GetActorForwardVector();
+		PlayerSnapshot.bIsCrouched = PlayerCharacter->bIsCrouched;
+
+		if (const AEscapeITCharacter* EscapeCharacter = Cast<AEscapeITCharacter>(PlayerCharacter))
+		{
+			PlayerSnapshot.Stance = EscapeCharacter->GetMovementState();
+		}
+	}
+
+	if (World && LastNoiseTime >= 0.0)
+	{
+		const float Elapsed = static_cast<float>(World->GetTimeSeconds() - LastNoiseTime);
+		PlayerSnapshot.NoiseLevel = FMath::Max(0.0f, LastNoiseLoudness - NoiseDecayPerSecond * Elapsed);
+	}
+
+	// ---- NPC: gom vị trí rồi tính trên mảng liền nhau ----
+	for (int32 i = NPCs.Num() - 1; i >= 0; --i)
+	{
+		const APawn* NPC = NPCs[i].Get();
+		if (!NPC)
+		{
+			RemoveNPCAt(i);
+			continue;
+		}
+
+		NPCLocations[i] = NPC->GetActorLocation();
+		NPCForwards[i] = NPC->GetActorForwardVector();
+	}
+
+	if (!PlayerSnapshot.bValid)
+	{
+		for (float& Distance : DistancesToPlayer)
+		{
+			Distance = MAX_flt;
+		}
+		return;
+	}
+
+	const FVector PlayerLocation = PlayerSnapshot.Location;
+	const int32 NumNPCs = NPCs.Num();
+	for (int32 i = 0; i < NumNPCs; ++i)
+	{
+		const FVector ToPlayer = PlayerLocation - NPCLocations[i];
+		const FVector& Forward = NPCForwards[i];
+
+		DistancesToPlayer[i] = ToPlayer.Size();
+
+		// Góc có dấu trên mặt phẳng XY: atan2(cross.Z, dot)
+		const float Cross = Forward.X * ToPlayer.Y - Forward.Y * ToPlayer.X;
+		const float Dot = Forward.X * ToPlayer.X + Forward.Y * ToPlayer.Y;
+		BearingsToPlayer[i] = FMath::RadiansToDegrees(FMath::Atan2(Cross, Dot));
+	}
+}
+
+// ============================================
+// BENCHMARK
+// ============================================
+
+void UAIWorldStateSubsystem::RunBenchmark(int32 MaxNPCs, int32 NumFrames)
+{
+	UWorld* World = GetWorld();
+	if (!World || MaxNPCs <= 0 || NumFrames <= 0)
+	{
+		return;
+	}
+
+	if (!GetPlayer())
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("AIWorldState benchmark: no player character, only the lookup cost is measured"));
+	}
+
+	// Pawn tạm đặt trên cao, xa level; APawn gốc không có root nên thêm scene component để có vị trí/hướng
+	const FVector Center(0.0f, 0.0f, 100000.0f);
+	FRandomStream Random(MaxNPCs);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	TArray<TObjectPtr<APawn>> BenchmarkPawns;
+	BenchmarkPawns.Reserve(MaxNPCs);
+	for (int32 i = 0; i < MaxNPCs; ++i)
+	{
+		APawn* Pawn = World->SpawnActor<APawn>(Center, FRotator::ZeroRotator, SpawnParams);
+		if (!Pawn)
+		{
+			continue;
+		}
+
+		USceneComponent* Root = NewObject<USceneComponent>(Pawn, TEXT("BenchmarkRoot"));
+		Pawn->SetRootComponent(Root);
+		Root->RegisterComponent();
+		Pawn->SetActorLocationAndRotation(
+			Center + FVector(Random.FRandRange(-3000.0f, 3000.0f), Random.FRandRange(-3000.0f, 3000.0f), 0.0f),
+			FRotator(0.0f, Random.FRandRange(0.0f, 360.0f), 0.0f));
+		BenchmarkPawns.Add(Pawn);
+	}
+
+	TArray<float> Results;
+	double FirstNsPerNPC = 0.0;
+	double LastNsPerNPC = 0.0;
+	int32 FirstNumNPCs = 0;
+	int32 LastNumNPCs = 0;
+
+	for (int32 Divisor = 8; Divisor >= 1; Divisor /= 2)
+	{
+		const int32 NumNPCs = FMath::Max(BenchmarkPawns.Num() / Divisor, 1);
+		if (NumNPCs > BenchmarkPawns.Num() || NumNPCs == LastNumNPCs)
+		{
+			continue;
+		}
+
+		for (int32 i = 0; i < NumNPCs; ++i)
+		{
+			RegisterNPC(BenchmarkPawns[i]);
+		}
+		Results.SetNumUninitialized(NumNPCs * AIWorldState::NumServicesPerNPC);
+
+		uint64 LegacyCycles = 0;
+		uint64 SnapshotCycles = 0;
+
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			// NPC đi lang thang giữa các frame (không tính vào thời gian đo)
+			for (int32 i = 0; i < NumNPCs; ++i)
+			{
+				BenchmarkPawns[i]->AddActorWorldOffset(FVector(Random.FRandRange(-20.0f, 20.0f), Random.FRandRange(-20.0f, 20.0f), 0.0f));
+			}
+
+			// ---- Cách cũ: mỗi service tự lấy player và tự tính khoảng cách ----
+			const uint64 LegacyStart = FPlatformTime::Cycles64();
+			for (int32 i = 0; i < NumNPCs; ++i)
+			{
+				const APawn* Pawn = BenchmarkPawns[i];
+				for (int32 Service = 0; Service < AIWorldState::NumServicesPerNPC; ++Service)
+				{
+					const ACharacter* PlayerCharacter = UGameplayStatics::GetPlayerCharacter(World, 0);
+					Results[i * AIWorldState::NumServicesPerNPC + Service] = PlayerCharacter
+						? FVector::Dist(Pawn->GetActorLocation(), PlayerCharacter->GetActorLocation())
+						: MAX_flt;
+				}
+			}
+			LegacyCycles += FPlatformTime::Cycles64() - LegacyStart;
+
+			// ---- Snapshot: batch một lần ở lần đọc đầu tiên, service đọc giá trị đã tính ----
+			CapturedFrame = MAX_uint64;
+			const uint64 SnapshotStart = FPlatformTime::Cycles64();
+			for (int32 i = 0; i < NumNPCs; ++i)
+			{
+				const APawn* Pawn = BenchmarkPawns[i];
+				for (int32 Service = 0; Service < AIWorldState::NumServicesPerNPC; ++Service)
+				{
+					Results[i * AIWorldState::NumServicesPerNPC + Service] = GetDistanceToPlayer(Pawn);
+				}
+			}
+			SnapshotCycles += FPlatformTime::Cycles64() - SnapshotStart;
+		}
+
+		const double LegacyMs = FPlatformTime::ToMilliseconds64(LegacyCycles) / NumFrames;
+		const double SnapshotMs = FPlatformTime::ToMilliseconds64(SnapshotCycles) / NumFrames;
+		const double SnapshotNsPerNPC = SnapshotMs * 1.0e6 / NumNPCs;
+
+		UE_LOG(LogEscapeIT, Display, TEXT("AIWorldState benchmark: %d NPC(s) (%d registered), %d read(s) per NPC: per-service lookup %.3f ms/frame (%.1f ns per NPC), snapshot %.3f ms/frame (%.1f ns per NPC)"),
+			NumNPCs, GetNumNPCs(), AIWorldState::NumServicesPerNPC, LegacyMs, LegacyMs * 1.0e6 / NumNPCs, SnapshotMs, SnapshotNsPerNPC);
+
+		if (FirstNumNPCs == 0)
+		{
+			FirstNumNPCs = NumNPCs;
+			FirstNsPerNPC = SnapshotNsPerNPC;
+		}
+		LastNumNPCs = NumNPCs;
+		LastNsPerNPC = SnapshotNsPerNPC;
+	}
+
+	for (APawn* Pawn : BenchmarkPawns)
+	{
+		UnregisterNPC(Pawn);
+		Pawn->Destroy();
+	}
+	CapturedFrame = MAX_uint64;
+
+	// Tuyến tính -> chi phí mỗi NPC gần như không đổi khi số NPC tăng
+	UE_LOG(LogEscapeIT, Display, TEXT("AIWorldState benchmark: snapshot cost per NPC %.1f ns at %d NPC(s) vs %.1f ns at %d NPC(s) (%.2fx)"),
+		FirstNsPerNPC, FirstNumNPCs, LastNsPerNPC, LastNumNPCs, FirstNsPerNPC > 0.0 ? LastNsPerNPC / FirstNsPerNPC : 0.0);
+}
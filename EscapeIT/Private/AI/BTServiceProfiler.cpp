@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/BTServiceProfiler.h"
+#include "EscapeIT.h"
+#include "BehaviorTree/BTNode.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+namespace BTServiceProfiler
+{
+	static bool bEnabled = false;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("ai.ServiceProfiler.Enabled"),
+		bEnabled,
+		TEXT("Đếm số lần service BT event-driven chạy và output đổi (0 = tắt)"));
+
+	static FAutoConsoleCommandWithWorld DumpCommand(
+		TEXT("ai.ServiceProfiler.Dump"),
+		TEXT("Log số lần tick / tính lại / output đổi của từng service, theo tree"),
+		FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+		{
+			if (const UBTServiceProfilerSubsystem* Profiler = UBTServiceProfilerSubsystem::Get(World))
+			{
+				Profiler->Dump();
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld ResetCommand(
+		TEXT("ai.ServiceProfiler.Reset"),
+		TEXT("Xóa số liệu của service profiler"),
+		FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+		{
+			if (UBTServiceProfilerSubsystem* Profiler = UBTServiceProfilerSubsystem::Get(World))
+			{
+				Profiler->Reset();
+			}
+		}));
+
+	static const TCHAR* TriggerNames[] = { TEXT("activation"), TEXT("key"), TEXT("moved"), TEXT("band"), TEXT("requested"), TEXT("stale") };
+	static_assert(UE_ARRAY_COUNT(TriggerNames) == UE_ARRAY_COUNT(FBTServiceProfile::NumRunsByTrigger), "Mỗi bit của EBTServiceTrigger cần một tên");
+
+	static double Percent(int64 Part, int64 Total)
+	{
+		return Total > 0 ? 100.0 * static_cast<double>(Part) / static_cast<double>(Total) : 0.0;
+	}
+}
+
+UBTServiceProfilerSubsystem* UBTServiceProfilerSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UBTServiceProfilerSubsystem>() : nullptr;
+}
+
+bool UBTServiceProfilerSubsystem::IsEnabled()
+{
+	return BTServiceProfiler::bEnabled;
+}
+
+void UBTServiceProfilerSubsystem::Deinitialize()
+{
+	Reset();
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// RECORD
+// ============================================
+
+FBTServiceProfile& UBTServiceProfilerSubsystem::FindOrAddProfile(const UBTNode* Service)
+{
+	if (const int32* Index = ProfileIndices.Find(Service))
+	{
+		return Profiles[*Index];
+	}
+
+	const UBehaviorTree* Tree = Service->GetTreeAsset();
+
+	const int32 Index = Profiles.AddDefaulted();
+	Profiles[Index].TreeName = GetNameSafe(Tree);
+	Profiles[Index].ServiceName = Service->GetNodeName();
+	ProfileIndices.Add(Service, Index);
+	return Profiles[Index];
+}
+
+void UBTServiceProfilerSubsystem::RecordPoll(const UBTNode* Service)
+{
+	if (Service)
+	{
+		++FindOrAddProfile(Service).NumPolls;
+	}
+}
+
+void UBTServiceProfilerSubsystem::RecordRun(const UBTNode* Service, EBTServiceTrigger Triggers, bool bOutputChanged, double Seconds)
+{
+	if (!Service)
+	{
+		return;
+	}
+
+	FBTServiceProfile& Profile = FindOrAddProfile(Service);
+	++Profile.NumRuns;
+	Profile.NumChanges += bOutputChanged ? 1 : 0;
+	Profile.RunSeconds += Seconds;
+
+	for (int32 Bit = 0; Bit < UE_ARRAY_COUNT(Profile.NumRunsByTrigger); ++Bit)
+	{
+		if (EnumHasAnyFlags(Triggers, static_cast<EBTServiceTrigger>(1 << Bit)))
+		{
+			++Profile.NumRunsByTrigger[Bit];
+		}
+	}
+}
+
+// ============================================
+// OUTPUT
+// ============================================
+
+void UBTServiceProfilerSubsystem::Dump() const
+{
+	if (Profiles.Num() == 0)
+	{
+		UE_LOG(LogEscapeIT, Display, TEXT("ServiceProfiler: nothing recorded%s"), IsEnabled() ? TEXT("") : TEXT(" (ai.ServiceProfiler.Enabled is 0)"));
+		return;
+	}
+
+	TArray<const FBTServiceProfile*> Sorted;
+	for (const FBTServiceProfile& Profile : Profiles)
+	{
+		Sorted.Add(&Profile);
+	}
+	Sorted.Sort([](const FBTServiceProfile& A, const FBTServiceProfile& B)
+	{
+		return A.TreeName != B.TreeName ? A.TreeName < B.TreeName : A.ServiceName < B.ServiceName;
+	});
+
+	const FString* CurrentTree = nullptr;
+	for (const FBTServiceProfile* Profile : Sorted)
+	{
+		if (!CurrentTree || *CurrentTree != Profile->TreeName)
+		{
+			CurrentTree = &Profile->TreeName;
+			UE_LOG(LogEscapeIT, Display, TEXT("ServiceProfiler: tree %s"), **CurrentTree);
+		}
+
+		FString Triggers;
+		for (int32 Bit = 0; Bit < UE_ARRAY_COUNT(Profile->NumRunsByTrigger); ++Bit)
+		{
+			if (Profile->NumRunsByTrigger[Bit] > 0)
+			{
+				Triggers += FString::Printf(TEXT(" %s=%lld"), BTServiceProfiler::TriggerNames[Bit], Profile->NumRunsByTrigger[Bit]);
+			}
+		}
+
+		UE_LOG(LogEscapeIT, Display, TEXT("ServiceProfiler:   %-28s %8lld poll(s), %7lld run(s) (%5.1f%%), %7lld change(s) (%5.1f%% of runs), %.2f us/run,%s"),
+			*Profile->ServiceName, Profile->NumPolls,
+			Profile->NumRuns, BTServiceProfiler::Percent(Profile->NumRuns, Profile->NumPolls),
+			Profile->NumChanges, BTServiceProfiler::Percent(Profile->NumChanges, Profile->NumRuns),
+			Profile->NumRuns > 0 ? Profile->RunSeconds * 1.0e6 / Profile->NumRuns : 0.0,
+			*Triggers);
+	}
+}
+
+void UBTServiceProfilerSubsystem::Reset()
+{
+	Profiles.Reset();
+	ProfileIndices.Reset();
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/BlackBoardDecorator/BTDecorator_DirectorToken.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+
+UBTDecorator_DirectorToken::UBTDecorator_DirectorToken()
+{
+	NodeName = TEXT("Director Token");
+
+	bNotifyTick = true;
+	bNotifyCeaseRelevant = true;
+
+	// Chỉ abort chính nhánh này khi mất token
+	bAllowAbortNone = true;
+	bAllowAbortLowerPri = false;
+	bAllowAbortChildNodes = true;
+	FlowAbortMode = EBTFlowAbortMode::Self;
+}
+
+bool UBTDecorator_DirectorToken::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
+{
+	AAIController* AICon = OwnerComp.GetAIOwner();
+	UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(AICon);
+	if (!AICon || !Director)
+	{
+		return Director == nullptr;
+	}
+
+	float Priority = 0.0f;
+	if (bPreferCloserToPlayer)
+	{
+		if (UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(AICon))
+		{
+			Priority = -WorldState->GetDistanceToPlayer(AICon->GetPawn());
+		}
+	}
+
+	return Director->TryAcquireToken(Token, AICon, Priority);
+}
+
+void UBTDecorator_DirectorToken::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
+
+	AAIController* AICon = OwnerComp.GetAIOwner();
+	UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(AICon);
+	if (AICon && Director && !Director->HasToken(Token, AICon))
+	{
+		ConditionalFlowAbort(OwnerComp, EBTDecoratorAbortRequest::ConditionResultChanged);
+	}
+}
+
+void UBTDecorator_DirectorToken::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	if (UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(OwnerComp.GetAIOwner()))
+	{
+		Director->ReleaseToken(Token, OwnerComp.GetAIOwner());
+	}
+
+	Super::OnCeaseRelevant(OwnerComp, NodeMemory);
+}
+
+FString UBTDecorator_DirectorToken::GetStaticDescription() const
+{
+	return FString::Printf(TEXT("%s: %s"), *Super::GetStaticDescription(), *UEnum::GetDisplayValueAsText(Token).ToString());
+}
@@ -19,7 +19,14 @@ void UBTService_ChangeSpeed::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp,
 	{
 		if (auto* const NPC = Cast<ANPC>(Cont->GetPawn()))
 		{
-			NPC->GetCharacterMovement()->MaxWalkSpeed = Speed;
+			if (bUseSpeedProfile)
+			{
+				NPC->SetSpeedProfile(SpeedProfile);
+			}
+			else
+			{
+				NPC->GetCharacterMovement()->MaxWalkSpeed = Speed;
+			}
 		}
 	}
 }
@@ -5,38 +5,97 @@
 #include "AI/NPC.h"
 #include "GameFramework/Character.h"
 #include "Kismet/GameplayStatics.h"
+#include "AI/NPCBlackboardSchema.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "AI/AIDirectorSubsystem.h"
 
 UBTService_CheckPlayerDistance::UBTService_CheckPlayerDistance()
 {
     NodeName = TEXT("Check Player Distance");
-    // Set interval để service chạy thường xuyên hơn
+    // Chỉ còn là chu kỳ kiểm tra band khoảng cách (đã tính sẵn trong UAIWorldStateSubsystem)
     Interval = 0.1f; // Kiểm tra mỗi 0.1 giây
     RandomDeviation = 0.05f;
 }
 
-void UBTService_CheckPlayerDistance::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+void UBTService_CheckPlayerDistance::InitializeFromAsset(UBehaviorTree& Asset)
 {
-    Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
+    // Band duy nhất: trong / ngoài tầm jump scare
+    DistanceBands.Reset();
+    DistanceBands.Add(TriggerDistance);
 
+    Super::InitializeFromAsset(Asset);
+}
+
+void UBTService_CheckPlayerDistance::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+    InitializeNodeMemory<FBTCheckPlayerDistanceMemory>(NodeMemory, InitType);
+}
+
+void UBTService_CheckPlayerDistance::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+    CleanupNodeMemory<FBTCheckPlayerDistanceMemory>(NodeMemory, CleanupType);
+}
+
+void UBTService_CheckPlayerDistance::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+    Super::OnBecomeRelevant(OwnerComp, NodeMemory);
+
+    // Blackboard có thể đã bị reset (NPC lấy lại từ pool) trong lúc nhánh không chạy
+    CastInstanceNodeMemory<FBTCheckPlayerDistanceMemory>(NodeMemory)->bCanJumpScare =
+        FNPCBlackboard(OwnerComp.GetBlackboardComponent()).GetCanJumpScare();
+}
+
+bool UBTService_CheckPlayerDistance::Recompute(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
     AAIController* AICon = OwnerComp.GetAIOwner();
-    ANPC* NPC = Cast<ANPC>(AICon->GetPawn());
-    UWorld* World = OwnerComp.GetWorld();
-    ACharacter* Player = UGameplayStatics::GetPlayerCharacter(World, 0);
+    ANPC* NPC = AICon ? Cast<ANPC>(AICon->GetPawn()) : nullptr;
+    UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(AICon);
     UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
 
-    if (!AICon) return;
-    if (!NPC) return;
-    if (!World) return;
-    if (!Player) return;
-    if (!BlackboardComp) return;
+    if (!AICon) return false;
+    if (!NPC) return false;
+    if (!WorldState) return false;
+    if (!BlackboardComp) return false;
+
+    // Khoảng cách đã được tính sẵn trong snapshot của frame
+    const float Distance = WorldState->GetDistanceToPlayer(NPC);
+    const bool bInRange = Distance <= TriggerDistance;
+
+    FBTCheckPlayerDistanceMemory* Memory = CastInstanceNodeMemory<FBTCheckPlayerDistanceMemory>(NodeMemory);
+    const bool bWasScaring = Memory->bCanJumpScare;
+    bool bCanJump = bInRange;
+
+    // Jumpscare phải có token của director; scare đã bắt đầu thì giữ tới khi player ra khỏi tầm hoặc token bị thu hồi
+    if (UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(AICon))
+    {
+        if (!bInRange)
+        {
+            Director->ReleaseToken(EAIDirectorToken::JumpScare, AICon);
+        }
+        else
+        {
+            if (bWasScaring)
+            {
+                // Sanity tụt có thể thu hồi token rồi cấp cho NPC khác -> không để hai scare chạy cùng lúc
+                bCanJump = Director->HasToken(EAIDirectorToken::JumpScare, AICon);
+            }
+            else
+            {
+                bCanJump = Director->TryAcquireToken(EAIDirectorToken::JumpScare, AICon, -Distance);
+                if (bCanJump)
+                {
+                    Director->NotifyScare();
+                }
+            }
 
-    // Tính khoảng cách
-    float Dist = FVector::Dist(NPC->GetActorLocation(), Player->GetActorLocation());
-    bool bCanJump = Dist <= TriggerDistance;
+            // Trong tầm không có trigger nào báo thu hồi/trả token: kiểm tra lại ở lần sau (chờ token hoặc xem còn giữ không)
+            RequestRecompute(NodeMemory);
+        }
+    }
 
-    // Set value vào blackboard - đảm bảo key name chính xác
-    BlackboardComp->SetValueAsBool(TEXT("bCanJumpScare"), bCanJump);
+    // Set value vào blackboard - key ID đã resolve sẵn theo schema
+    Memory->bCanJumpScare = bCanJump;
+    FNPCBlackboard(BlackboardComp).SetCanJumpScare(bCanJump);
 
-    // Debug: In ra giá trị trong blackboard
-    bool CurrentValue = BlackboardComp->GetValueAsBool(TEXT("bCanJumpScare"));
+    return bCanJump != bWasScaring;
 }
\ No newline at end of file
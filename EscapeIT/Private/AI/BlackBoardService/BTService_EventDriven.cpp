@@ -0,0 +1,248 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/BlackBoardService/BTService_EventDriven.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "Engine/World.h"
+
+UBTService_EventDriven::UBTService_EventDriven()
+{
+	NodeName = TEXT("Event Driven Service");
+
+	bNotifyBecomeRelevant = true;
+	bNotifyCeaseRelevant = true;
+	bNotifyTick = true;
+
+	// Lần kiểm tra đầu tiên ngay khi nhánh bắt đầu, không chờ hết Interval
+	bCallTickOnSearchStart = true;
+}
+
+void UBTService_EventDriven::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BBAsset = GetBlackboardAsset())
+	{
+		for (FBlackboardKeySelector& Key : ObservedKeys)
+		{
+			Key.ResolveSelectedKey(*BBAsset);
+		}
+	}
+
+	DistanceBands.Sort();
+}
+
+void UBTService_EventDriven::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FBTEventDrivenServiceMemory>(NodeMemory, InitType);
+}
+
+void UBTService_EventDriven::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FBTEventDrivenServiceMemory>(NodeMemory, CleanupType);
+}
+
+// ============================================
+// RELEVANCE
+// ============================================
+
+void UBTService_EventDriven::GatherObservedKeyIds(const UBlackboardComponent& BlackboardComp, TArray<FBlackboard::FKey, TInlineAllocator<8>>& OutKeyIds) const
+{
+	const FNPCBlackboardKeys& Keys = FNPCBlackboardKeys::Get(BlackboardComp.GetBlackboardAsset());
+	for (const ENPCBlackboardKey Key : ObservedSchemaKeys)
+	{
+		if (Keys[Key] != FBlackboard::InvalidKey)
+		{
+			OutKeyIds.AddUnique(Keys[Key]);
+		}
+	}
+
+	for (const FBlackboardKeySelector& Key : ObservedKeys)
+	{
+		if (Key.GetSelectedKeyID() != FBlackboard::InvalidKey)
+		{
+			OutKeyIds.AddUnique(Key.GetSelectedKeyID());
+		}
+	}
+}
+
+void UBTService_EventDriven::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	Super::OnBecomeRelevant(OwnerComp, NodeMemory);
+
+	UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent();
+	if (!BlackboardComp)
+	{
+		return;
+	}
+
+	TArray<FBlackboard::FKey, TInlineAllocator<8>> KeyIds;
+	GatherObservedKeyIds(*BlackboardComp, KeyIds);
+
+	for (const FBlackboard::FKey KeyId : KeyIds)
+	{
+		BlackboardComp->RegisterObserver(KeyId, this, FOnBlackboardChangeNotification::CreateUObject(this, &UBTService_EventDriven::OnObservedKeyChanged));
+	}
+}
+
+void UBTService_EventDriven::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	if (UBlackboardComponent* BlackboardComp = OwnerComp.GetBlackboardComponent())
+	{
+		BlackboardComp->UnregisterObserversFrom(this);
+	}
+
+	// Lần kích hoạt sau tính lại từ đầu
+	*CastInstanceNodeMemory<FBTEventDrivenServiceMemory>(NodeMemory) = FBTEventDrivenServiceMemory();
+
+	Super::OnCeaseRelevant(OwnerComp, NodeMemory);
+}
+
+EBlackboardNotificationResult UBTService_EventDriven::OnObservedKeyChanged(const UBlackboardComponent& BlackboardComp, FBlackboard::FKey ChangedKeyID)
+{
+	UBehaviorTreeComponent* BehaviorComp = Cast<UBehaviorTreeComponent>(BlackboardComp.GetBrainComponent());
+	const int32 InstanceIdx = BehaviorComp ? BehaviorComp->FindInstanceContainingNode(this) : INDEX_NONE;
+	if (InstanceIdx == INDEX_NONE)
+	{
+		return EBlackboardNotificationResult::RemoveObserver;
+	}
+
+	uint8* NodeMemory = BehaviorComp->GetNodeMemory(this, InstanceIdx);
+	CastInstanceNodeMemory<FBTEventDrivenServiceMemory>(NodeMemory)->PendingTriggers |= EBTServiceTrigger::BlackboardKey;
+
+	// Không tính lại ngay trong callback (service khác có thể đang ghi blackboard): đánh thức tree ở tick kế tiếp
+	SetNextTickTime(NodeMemory, 0.0f);
+	BehaviorComp->ScheduleNextTick(0.0f);
+
+	return EBlackboardNotificationResult::ContinueObserving;
+}
+
+// ============================================
+// TICK
+// ============================================
+
+int32 UBTService_EventDriven::GetDistanceBand(float Distance) const
+{
+	int32 Band = 0;
+	while (Band < DistanceBands.Num() && Distance > DistanceBands[Band])
+	{
+		++Band;
+	}
+	return Band;
+}
+
+void UBTService_EventDriven::RequestRecompute(uint8* NodeMemory) const
+{
+	CastInstanceNodeMemory<FBTEventDrivenServiceMemory>(NodeMemory)->PendingTriggers |= EBTServiceTrigger::Requested;
+}
+
+void UBTService_EventDriven::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	// Lên lịch lần kiểm tra kế tiếp
+	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
+
+	FBTEventDrivenServiceMemory* Memory = CastInstanceNodeMemory<FBTEventDrivenServiceMemory>(NodeMemory);
+	EBTServiceTrigger Triggers = Memory->PendingTriggers;
+
+	// ---- Tín hiệu world: chỉ so với giá trị đã tính sẵn trong frame ----
+	FVector PlayerLocation = Memory->LastPlayerLocation;
+	bool bHasPlayer = Memory->bHadPlayer;
+	int32 Band = Memory->DistanceBand;
+
+	if (bTriggerOnPlayerMove || DistanceBands.Num() > 0)
+	{
+		if (UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(&OwnerComp))
+		{
+			const FAIPlayerSnapshot& Snapshot = WorldState->GetPlayerSnapshot();
+			bHasPlayer = Snapshot.bValid;
+			PlayerLocation = Snapshot.Location;
+
+			if (bTriggerOnPlayerMove && (bHasPlayer != Memory->bHadPlayer
+				|| (bHasPlayer && FVector::DistSquared(PlayerLocation, Memory->LastPlayerLocation) > FMath::Square(PlayerMoveThreshold))))
+			{
+				Triggers |= EBTServiceTrigger::PlayerMoved;
+			}
+
+			if (DistanceBands.Num() > 0)
+			{
+				const AAIController* AICon = OwnerComp.GetAIOwner();
+				Band = GetDistanceBand(WorldState->GetDistanceToPlayer(AICon ? AICon->GetPawn() : nullptr));
+				if (Band != Memory->DistanceBand)
+				{
+					Triggers |= EBTServiceTrigger::DistanceBand;
+				}
+			}
+		}
+	}
+
+	const UWorld* World = OwnerComp.GetWorld();
+	const double Now = World ? World->GetTimeSeconds() : 0.0;
+	if (MaxStaleTime > 0.0f && Now - Memory->LastRunTime >= MaxStaleTime)
+	{
+		Triggers |= EBTServiceTrigger::Stale;
+	}
+
+	UBTServiceProfilerSubsystem* Profiler = UBTServiceProfilerSubsystem::IsEnabled() ? UBTServiceProfilerSubsystem::Get(&OwnerComp) : nullptr;
+	if (Profiler)
+	{
+		Profiler->RecordPoll(this);
+	}
+
+	if (Triggers == EBTServiceTrigger::None)
+	{
+		return;
+	}
+
+	// Xóa trước khi tính: Recompute có thể gọi RequestRecompute
+	Memory->PendingTriggers = EBTServiceTrigger::None;
+	Memory->LastPlayerLocation = PlayerLocation;
+	Memory->bHadPlayer = bHasPlayer;
+	Memory->DistanceBand = Band;
+	Memory->LastRunTime = Now;
+
+	const uint64 StartCycles = Profiler ? FPlatformTime::Cycles64() : 0;
+	const bool bOutputChanged = Recompute(OwnerComp, NodeMemory);
+
+	if (Profiler)
+	{
+		Profiler->RecordRun(this, Triggers, bOutputChanged, FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles));
+	}
+}
+
+FString UBTService_EventDriven::GetStaticDescription() const
+{
+	TArray<FString> Triggers;
+
+	for (const ENPCBlackboardKey Key : ObservedSchemaKeys)
+	{
+		Triggers.Add(NPCBlackboard::GetKeyDesc(Key).Name.ToString());
+	}
+
+	for (const FBlackboardKeySelector& Key : ObservedKeys)
+	{
+		if (Key.IsSet())
+		{
+			Triggers.Add(Key.SelectedKeyName.ToString());
+		}
+	}
+
+	if (bTriggerOnPlayerMove)
+	{
+		Triggers.Add(FString::Printf(TEXT("player moved > %.0f cm"), PlayerMoveThreshold));
+	}
+
+	for (const float Band : DistanceBands)
+	{
+		Triggers.Add(FString::Printf(TEXT("distance %.0f cm"), Band));
+	}
+
+	if (MaxStaleTime > 0.0f)
+	{
+		Triggers.Add(FString::Printf(TEXT("every %.1fs"), MaxStaleTime));
+	}
+
+	return FString::Printf(TEXT("%s\nRecompute on: %s"), *Super::GetStaticDescription(), *FString::Join(Triggers, TEXT(", ")));
+}
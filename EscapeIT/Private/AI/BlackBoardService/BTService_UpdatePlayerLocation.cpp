@@ -4,35 +4,55 @@
 #include "AI/BlackBoardService/BTService_UpdatePlayerLocation.h"
 
 #include "BehaviorTree/BlackboardComponent.h"
-#include "Kismet/GameplayStatics.h"
-#include "GameFramework/Character.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "AI/NPCBlackboardSchema.h"
+#include "AI/AIWorldStateSubsystem.h"
 
 UBTService_UpdatePlayerLocation::UBTService_UpdatePlayerLocation()
 {
 	NodeName = TEXT("UpdatePlayerLocation");
 	
+	// Chỉ còn là chu kỳ kiểm tra player đã đi đủ xa chưa
 	Interval = 0.5f;
 	RandomDeviation = 0.1f;
 	
-	bCallTickOnSearchStart = true;
 	bTickIntervals = true;
+
+	ObservedSchemaKeys.Add(ENPCBlackboardKey::CanSeePlayer);
+	bTriggerOnPlayerMove = true;
+	PlayerMoveThreshold = 50.0f;
+
+	BlackboardKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_UpdatePlayerLocation, BlackboardKey));
 }
 
-void UBTService_UpdatePlayerLocation::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+void UBTService_UpdatePlayerLocation::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BBAsset = GetBlackboardAsset())
+	{
+		BlackboardKey.ResolveSelectedKey(*BBAsset);
+	}
+}
+
+bool UBTService_UpdatePlayerLocation::Recompute(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
-	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
-	
 	UBlackboardComponent * BB = OwnerComp.GetBlackboardComponent();
 
-	if (!BB) return;
+	if (!BB) return false;
 	
-	bool bCanSeePlayer = BB->GetValueAsBool(TEXT("CanSeePlayer"));
-	if (!bCanSeePlayer) return;
+	bool bCanSeePlayer = FNPCBlackboard(BB).GetCanSeePlayer();
+	if (!bCanSeePlayer) return false;
 
-	if (ACharacter * Char = UGameplayStatics::GetPlayerCharacter(GetWorld(),0))
+	if (UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(&OwnerComp))
 	{
-		FVector PlayerLocation = Char->GetActorLocation();
-		
-		BB->SetValueAsVector(GetSelectedBlackboardKey(),PlayerLocation);
+		const FAIPlayerSnapshot& Snapshot = WorldState->GetPlayerSnapshot();
+		if (Snapshot.bValid)
+		{
+			BB->SetValueAsVector(BlackboardKey.GetSelectedKeyID(), Snapshot.Location);
+			return true;
+		}
 	}
+
+	return false;
 }
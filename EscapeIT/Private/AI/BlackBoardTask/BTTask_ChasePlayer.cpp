@@ -6,12 +6,18 @@
 #include "Kismet/GameplayStatics.h"
 #include "AIController.h"
 #include "Navigation/PathFollowingComponent.h"
+#include "AI/ChaseMovementSubsystem.h"
+#include "AI/NPCBlackboardSchema.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "AI/AIDirectorSubsystem.h"
+#include "AI/AIDecisionTrace.h"
 
 UBTTask_ChasePlayer::UBTTask_ChasePlayer(FObjectInitializer const& ObjectInitializer) 
     : UBTTask_BlackboardBase{ ObjectInitializer }
 {
     NodeName = TEXT("Chase Player");
     bNotifyTick = true; // Quan trọng: Cho phép TickTask được gọi
+    bNotifyTaskFinished = true;
 }
 
 EBTNodeResult::Type UBTTask_ChasePlayer::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
@@ -28,46 +34,33 @@ EBTNodeResult::Type UBTTask_ChasePlayer::ExecuteTask(UBehaviorTreeComponent& Own
     if (!NPC)
         return EBTNodeResult::Failed;
 
+    UChaseMovementSubsystem* ChaseMovement = UChaseMovementSubsystem::Get(AICon);
+    if (!ChaseMovement)
+        return EBTNodeResult::Failed;
+
     // Lấy vị trí target từ blackboard (nên là Vector)
+    // BTService_UpdatePlayerLocation là nơi duy nhất ghi key này
     FVector TargetLocation = BB->GetValueAsVector(GetSelectedBlackboardKey());
 
     if (TargetLocation.IsZero())
     {
         return EBTNodeResult::Failed;
     }
-    
-    bool bCanSeePlayer = BB->GetValueAsBool(TEXT("CanSeePlayer"));
 
-    if (bCanSeePlayer)
+    FBTChasePlayerMemory* Memory = CastInstanceNodeMemory<FBTChasePlayerMemory>(NodeMemory);
+    Memory->bHasChaseToken = false;
+
+    if (UpdateChaseToken(OwnerComp, *Memory, *ChaseMovement))
     {
-        if (auto* Player = Cast<ACharacter>(UGameplayStatics::GetPlayerCharacter(GetWorld(), 0)))
-        {
-            // Cập nhật vị trí người chơi liên tục
-            TargetLocation = Player->GetActorLocation();
-            BB->SetValueAsVector(GetSelectedBlackboardKey(), TargetLocation);
-        }
-        BB->SetValueAsBool(TEXT("IsPlayerBeingChased"), true);
+        UpdateChaseTarget(OwnerComp, *ChaseMovement);
     }
-    else
+    else if (!FNPCBlackboard(BB).GetCanSeePlayer())
     {
-        BB->SetValueAsBool(TEXT("IsPlayerBeingChased"), false);
+        // Không có token và không thấy player -> không có gì để đứng nhìn
+        return EBTNodeResult::Failed;
     }
-    
-    // Di chuyển đến vị trí
-    FAIRequestID RequestID = AICon->MoveToLocation(
-        TargetLocation,
-        AcceptanceRadius,
-        true,     // bStopOnOverlap
-        true,     // bUsePathfinding
-        false,    // bProjectDestinationToNavigation
-        true,     // bCanStrafe
-        nullptr,  // FilterClass
-        true      // bAllowPartialPath
-    );
-
-    return RequestID.IsValid()
-        ? EBTNodeResult::InProgress
-        : EBTNodeResult::Failed;
+
+    return EBTNodeResult::InProgress;
 }
 
 void UBTTask_ChasePlayer::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
@@ -75,38 +68,103 @@ void UBTTask_ChasePlayer::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* Nod
     Super::TickTask(OwnerComp, NodeMemory, DeltaSeconds);
 
     auto* AICon = Cast<ANPC_AIController>(OwnerComp.GetAIOwner());
-    if (!AICon)
+    UChaseMovementSubsystem* ChaseMovement = UChaseMovementSubsystem::Get(AICon);
+    if (!AICon || !ChaseMovement)
     {
         FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
         return;
     }
 
-    EPathFollowingStatus::Type Status = AICon->GetMoveStatus();
-    
-    if (Status == EPathFollowingStatus::Type::Idle)
+    FBTChasePlayerMemory* Memory = CastInstanceNodeMemory<FBTChasePlayerMemory>(NodeMemory);
+    if (!UpdateChaseToken(OwnerComp, *Memory, *ChaseMovement))
     {
-        FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+        // Hành vi rẻ: đứng nhìn, mất dấu player thì trả lại cho BT
+        UBlackboardComponent* BB = OwnerComp.GetBlackboardComponent();
+        if (!BB || !FNPCBlackboard(BB).GetCanSeePlayer())
+        {
+            FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+        }
+        return;
     }
-    else if (Status == EPathFollowingStatus::Type::Paused)
+
+    switch (ChaseMovement->GetChaseStatus(AICon))
     {
+    case EChaseMoveStatus::Reached:
+        FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+        return;
+
+    case EChaseMoveStatus::Failed:
+    case EChaseMoveStatus::None:
         FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+        return;
+
+    default:
+        break;
     }
-    
-    UBlackboardComponent* BB = OwnerComp.GetBlackboardComponent();
-    if (BB && BB->GetValueAsBool(TEXT("CanSeePlayer")))
+
+    // Chỉ cập nhật target; subsystem tự quyết định khi nào cần repath
+    UpdateChaseTarget(OwnerComp, *ChaseMovement);
+}
+
+bool UBTTask_ChasePlayer::UpdateChaseToken(UBehaviorTreeComponent& OwnerComp, FBTChasePlayerMemory& Memory, UChaseMovementSubsystem& ChaseMovement) const
+{
+    AAIController* AICon = OwnerComp.GetAIOwner();
+    UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(AICon);
+    UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(AICon);
+
+    // NPC gần player hơn được ưu tiên giữ token
+    const float Priority = WorldState ? -WorldState->GetDistanceToPlayer(AICon->GetPawn()) : 0.0f;
+    const bool bHasToken = !Director || Director->TryAcquireToken(EAIDirectorToken::Chase, AICon, Priority);
+
+    if (bHasToken && !Memory.bHasChaseToken)
+    {
+        FChaseRepathSettings Settings = RepathSettings;
+        Settings.AcceptanceRadius = AcceptanceRadius;
+
+        // Path request đi qua ChaseMovementSubsystem (async + budget), task chỉ theo dõi trạng thái
+        AICon->ClearFocus(EAIFocusPriority::Gameplay);
+        ChaseMovement.StartChase(AICon, Settings);
+    }
+    else if (!bHasToken)
     {
-        if (auto* Player = Cast<ACharacter>(UGameplayStatics::GetPlayerCharacter(GetWorld(), 0)))
+        if (Memory.bHasChaseToken)
         {
-            FVector NewLocation = Player->GetActorLocation();
-            BB->SetValueAsVector(GetSelectedBlackboardKey(), NewLocation);
-            
-            AICon->MoveToLocation(
-                NewLocation,
-                AcceptanceRadius,
-                true, true, false, true, nullptr, true
-            );
+            ChaseMovement.StopChase(AICon);
+            AICon->StopMovement();
+        }
+
+        if (UBlackboardComponent* BB = OwnerComp.GetBlackboardComponent())
+        {
+            FNPCBlackboard(BB).SetIsPlayerBeingChased(false);
+        }
+
+        if (AActor* Player = WorldState ? WorldState->GetPlayer() : nullptr)
+        {
+            AICon->SetFocus(Player, EAIFocusPriority::Gameplay);
         }
     }
+
+    Memory.bHasChaseToken = bHasToken;
+    return bHasToken;
+}
+
+void UBTTask_ChasePlayer::UpdateChaseTarget(UBehaviorTreeComponent& OwnerComp, UChaseMovementSubsystem& ChaseMovement) const
+{
+    AAIController* AICon = OwnerComp.GetAIOwner();
+    UBlackboardComponent* BB = OwnerComp.GetBlackboardComponent();
+    if (!AICon || !BB)
+    {
+        return;
+    }
+
+    const FNPCBlackboard TypedBB(BB);
+    const bool bCanSeePlayer = TypedBB.GetCanSeePlayer();
+    TypedBB.SetIsPlayerBeingChased(bCanSeePlayer);
+
+    // Thấy player -> bám actor (vị trí mới nhất mỗi frame), không thấy -> đi tới vị trí cuối cùng trong blackboard
+    UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(AICon);
+    const AActor* Player = (bCanSeePlayer && WorldState) ? WorldState->GetPlayer() : nullptr;
+    ChaseMovement.SetChaseTarget(AICon, Player, BB->GetValueAsVector(GetSelectedBlackboardKey()));
 }
 
 EBTNodeResult::Type UBTTask_ChasePlayer::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
@@ -118,8 +176,42 @@ EBTNodeResult::Type UBTTask_ChasePlayer::AbortTask(UBehaviorTreeComponent& Owner
     
     if (UBlackboardComponent* BB = OwnerComp.GetBlackboardComponent())
     {
-        BB->SetValueAsBool(TEXT("IsPlayerBeingChased"), false);
+        FNPCBlackboard(BB).SetIsPlayerBeingChased(false);
     }
     
     return EBTNodeResult::Aborted;
+}
+
+void UBTTask_ChasePlayer::OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult)
+{
+    AAIController* AICon = OwnerComp.GetAIOwner();
+    if (UChaseMovementSubsystem* ChaseMovement = UChaseMovementSubsystem::Get(AICon))
+    {
+        ChaseMovement->StopChase(AICon);
+    }
+
+    if (UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(AICon))
+    {
+        Director->ReleaseToken(EAIDirectorToken::Chase, AICon);
+    }
+
+    if (AICon)
+    {
+        AICon->ClearFocus(EAIFocusPriority::Gameplay);
+    }
+
+    CastInstanceNodeMemory<FBTChasePlayerMemory>(NodeMemory)->bHasChaseToken = false;
+    UAIDecisionTraceSubsystem::TraceTaskFinished(OwnerComp, this, TaskResult);
+
+    Super::OnTaskFinished(OwnerComp, NodeMemory, TaskResult);
+}
+
+void UBTTask_ChasePlayer::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+    InitializeNodeMemory<FBTChasePlayerMemory>(NodeMemory, InitType);
+}
+
+void UBTTask_ChasePlayer::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+    CleanupNodeMemory<FBTChasePlayerMemory>(NodeMemory, CleanupType);
 }
\ No newline at end of file
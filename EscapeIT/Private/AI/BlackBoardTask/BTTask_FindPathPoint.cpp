@@ -4,6 +4,7 @@
 #include "AI/NPC_AIController.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "AI/NPC.h"
+#include "AI/PatrolRouteSubsystem.h"
 
 UBTTask_FindPathPoint::UBTTask_FindPathPoint(FObjectInitializer const& ObjectInitializer) : UBTTask_BlackboardBase{ ObjectInitializer }
 {
@@ -20,9 +21,15 @@ EBTNodeResult::Type UBTTask_FindPathPoint::ExecuteTask(UBehaviorTreeComponent& O
 
 			if (auto* npc = Cast<ANPC>(cont->GetPawn()))
 			{
-				auto const Point = npc->GetPatrolPath()->GetPatrolPoint(Index);
+				APaTrolPath* const PatrolPath = npc->GetPatrolPath();
 
-				auto const GlobalPoint = npc->GetPatrolPath()->GetActorTransform().TransformPosition(Point);
+				// Point world space đã bake sẵn (đã chiếu lên navmesh); chưa có navmesh thì transform như cũ
+				UPatrolRouteSubsystem* const Routes = UPatrolRouteSubsystem::Get(cont);
+				const FBakedPatrolRoute* const Route = Routes ? Routes->GetRoute(PatrolPath) : nullptr;
+
+				auto const GlobalPoint = Route && Route->IsValidIndex(Index)
+					? Route->WorldPoints[Index]
+					: PatrolPath->GetActorTransform().TransformPosition(PatrolPath->GetPatrolPoint(Index));
 				bc->SetValueAsVector(PatrolPathVectorKey.SelectedKeyName, GlobalPoint);
 
 				FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
@@ -1,8 +1,7 @@
-
 #include "AI/BlackBoardTask/BTTask_FindRandomLocation.h"
-#include "NavigationSystem.h"
 #include "AI/NPC_AIController.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
 
 UBTTask_FindRandomLocation::UBTTask_FindRandomLocation(FObjectInitializer const& ObjectInitializer) : UBTTask_BlackboardBase{ ObjectInitializer }
 {
@@ -19,20 +18,64 @@ EBTNodeResult::Type UBTTask_FindRandomLocation::ExecuteTask(UBehaviorTreeCompone
 			//Get location npc ?? use to do origin
 			auto const Origin = npc->GetActorLocation();
 
-			//Get behavior system and create random location
-			if (auto* const NavSys = UNavigationSystemV1::GetCurrent(GetWorld()))
+			//Query chạy qua NavQuerySubsystem (worker thread + budget), task chờ kết quả
+			if (auto* const NavQuery = UNavQuerySubsystem::Get(cont))
 			{
-				FNavLocation Loc;
-				if (NavSys->GetRandomPointInNavigableRadius(Origin, SearchRadius, Loc))
-				{
-					OwnerComp.GetBlackboardComponent()->SetValueAsVector(GetSelectedBlackboardKey(), Loc.Location);
-				}
-
-				//Finish success
-				FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
-				return EBTNodeResult::Succeeded;
+				FBTFindRandomLocationMemory* Memory = CastInstanceNodeMemory<FBTFindRandomLocationMemory>(NodeMemory);
+				Memory->BatchId = NavQuery->SubmitBatch(
+					{ FNavQuery::RandomReachablePoint(Origin, SearchRadius) },
+					FOnNavQueryBatchComplete::CreateUObject(this, &UBTTask_FindRandomLocation::OnQueryComplete, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp)));
+
+				return Memory->BatchId != 0 ? EBTNodeResult::InProgress : EBTNodeResult::Failed;
 			}
 		}
 	}
 	return EBTNodeResult::Failed;
 }
+
+void UBTTask_FindRandomLocation::OnQueryComplete(TConstArrayView<FNavQueryResult> Results, TWeakObjectPtr<UBehaviorTreeComponent> WeakOwnerComp)
+{
+	UBehaviorTreeComponent* OwnerComp = WeakOwnerComp.Get();
+	if (!OwnerComp)
+	{
+		return;
+	}
+
+	if (uint8* NodeMemory = OwnerComp->GetNodeMemory(this, OwnerComp->FindInstanceContainingNode(this)))
+	{
+		CastInstanceNodeMemory<FBTFindRandomLocationMemory>(NodeMemory)->BatchId = 0;
+	}
+
+	if (Results.Num() > 0 && Results[0].bSuccess)
+	{
+		OwnerComp->GetBlackboardComponent()->SetValueAsVector(GetSelectedBlackboardKey(), Results[0].Location);
+	}
+
+	//Finish success (giữ hành vi cũ: không tìm được điểm vẫn succeed)
+	FinishLatentTask(*OwnerComp, EBTNodeResult::Succeeded);
+}
+
+EBTNodeResult::Type UBTTask_FindRandomLocation::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FBTFindRandomLocationMemory* Memory = CastInstanceNodeMemory<FBTFindRandomLocationMemory>(NodeMemory);
+	if (Memory->BatchId != 0)
+	{
+		if (UNavQuerySubsystem* NavQuery = UNavQuerySubsystem::Get(OwnerComp.GetOwner()))
+		{
+			NavQuery->CancelBatch(Memory->BatchId);
+		}
+		Memory->BatchId = 0;
+	}
+
+	return Super::AbortTask(OwnerComp, NodeMemory);
+}
+
+void UBTTask_FindRandomLocation::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FBTFindRandomLocationMemory>(NodeMemory, InitType);
+}
+
+void UBTTask_FindRandomLocation::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FBTFindRandomLocationMemory>(NodeMemory, CleanupType);
+}
@@ -29,23 +29,24 @@ EBTNodeResult::Type UBTTask_IncrementPathIndex::ExecuteTask(UBehaviorTreeCompone
 				auto const MinIndex = 0;
 				auto const MaxIndex = NoOfPoints - 1;
 				auto Index = BC->GetValueAsInt(GetSelectedBlackboardKey());
+				FBTIncrementPathIndexMemory* Memory = CastInstanceNodeMemory<FBTIncrementPathIndexMemory>(NodeMemory);
 
 				//change direction if we are at the first or last index if we are in bidirection mode
 				if (bBiDirectional)
 				{
-					if (Index >= MaxIndex && Direction == EDirectionType::Forward)
+					if (Index >= MaxIndex && !Memory->bReverse)
 					{
-						Direction = EDirectionType::Reverse;
+						Memory->bReverse = true;
 					}
-					else if (Index == MinIndex && Direction == EDirectionType::Reverse)
+					else if (Index == MinIndex && Memory->bReverse)
 					{
-						Direction = EDirectionType::Forward;
+						Memory->bReverse = false;
 					}
 				}
 
 
 				//write new value of index to blackboard
-				BC->SetValueAsInt(GetSelectedBlackboardKey(), (Direction == EDirectionType::Forward ? ++Index : --Index) % NoOfPoints);
+				BC->SetValueAsInt(GetSelectedBlackboardKey(), (!Memory->bReverse ? ++Index : --Index) % NoOfPoints);
 
 				//finish with success
 				FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
@@ -55,3 +56,21 @@ EBTNodeResult::Type UBTTask_IncrementPathIndex::ExecuteTask(UBehaviorTreeCompone
 	}
 	return EBTNodeResult::Failed;
 }
+
+void UBTTask_IncrementPathIndex::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FBTIncrementPathIndexMemory>(NodeMemory, InitType);
+}
+
+void UBTTask_IncrementPathIndex::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FBTIncrementPathIndexMemory>(NodeMemory, CleanupType);
+}
+
+void UBTTask_IncrementPathIndex::DescribeRuntimeValues(const UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTDescriptionVerbosity::Type Verbosity, TArray<FString>& Values) const
+{
+	Super::DescribeRuntimeValues(OwnerComp, NodeMemory, Verbosity, Values);
+
+	const FBTIncrementPathIndexMemory* Memory = CastInstanceNodeMemory<FBTIncrementPathIndexMemory>(NodeMemory);
+	Values.Add(FString::Printf(TEXT("direction: %s"), Memory->bReverse ? TEXT("reverse") : TEXT("forward")));
+}
@@ -6,6 +6,9 @@
 #include "BehaviorTree/BlackboardComponent.h"
 #include "AI/NPC.h"
 #include "AIController.h"
+#include "AI/NPCBlackboardSchema.h"
+#include "AI/AIDirectorSubsystem.h"
+#include "AI/AIDecisionTrace.h"
 
 UBTTask_InvestigateSound::UBTTask_InvestigateSound(FObjectInitializer const& ObjectInitializer)
 {
@@ -41,6 +44,15 @@ EBTNodeResult::Type UBTTask_InvestigateSound::ExecuteTask(UBehaviorTreeComponent
 	{
 		return EBTNodeResult::Failed;
 	}
+
+	// NPC gần tiếng động hơn được ưu tiên; không có token -> chỉ quay về phía tiếng động
+	UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(AICon);
+	const float Priority = -FVector::Dist(NPC->GetActorLocation(), SoundLocation);
+	if (Director && !Director->TryAcquireToken(EAIDirectorToken::Investigate, AICon, Priority))
+	{
+		FaceLocation(*AICon, SoundLocation);
+		return EBTNodeResult::Succeeded;
+	}
 	
 	FAIRequestID RequestID = AICon->MoveToLocation(
 		SoundLocation,
@@ -57,25 +69,60 @@ EBTNodeResult::Type UBTTask_InvestigateSound::ExecuteTask(UBehaviorTreeComponent
 		return EBTNodeResult::Failed;
 	}
 	
-	BlackboardComponent->SetValueAsBool("IsInvestigating", true);
+	FNPCBlackboard(BlackboardComponent).SetIsInvestigating(true);
 	
 	return EBTNodeResult::InProgress;
 }
 
+void UBTTask_InvestigateSound::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	Super::TickTask(OwnerComp, NodeMemory, DeltaSeconds);
+
+	// Token bị thu hồi (capacity giảm / NPC khác gần hơn) -> dừng lại, chỉ nhìn về phía tiếng động
+	AAIController* AICon = OwnerComp.GetAIOwner();
+	UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(AICon);
+	if (AICon && Director && !Director->HasToken(EAIDirectorToken::Investigate, AICon))
+	{
+		AICon->StopMovement();
+		if (const UBlackboardComponent* BlackboardComponent = OwnerComp.GetBlackboardComponent())
+		{
+			FaceLocation(*AICon, BlackboardComponent->GetValueAsVector(GetSelectedBlackboardKey()));
+		}
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+	}
+}
+
+void UBTTask_InvestigateSound::FaceLocation(AAIController& AICon, const FVector& Location)
+{
+	APawn* Pawn = AICon.GetPawn();
+	if (!Pawn)
+	{
+		return;
+	}
+
+	const FRotator Facing(0.0f, (Location - Pawn->GetActorLocation()).Rotation().Yaw, 0.0f);
+	AICon.SetControlRotation(Facing);
+	Pawn->SetActorRotation(Facing);
+}
+
 void UBTTask_InvestigateSound::OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory,
 	EBTNodeResult::Type TaskResult)
 {
 	Super::OnTaskFinished(OwnerComp, NodeMemory, TaskResult);
+
+	if (UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(OwnerComp.GetAIOwner()))
+	{
+		Director->ReleaseToken(EAIDirectorToken::Investigate, OwnerComp.GetAIOwner());
+	}
+
+	UAIDecisionTraceSubsystem::TraceTaskFinished(OwnerComp, this, TaskResult);
     
 	// Clear investigating flag
 	if (UBlackboardComponent* BB = OwnerComp.GetBlackboardComponent())
 	{
-		BB->SetValueAsBool("IsInvestigating", false);
+		FNPCBlackboard(BB).SetIsInvestigating(false);
         
 		// Clear sound location sau khi investigate xong
 		// BB->ClearValue(GetSelectedBlackboardKey());
-        
-		UE_LOG(LogTemp, Warning, TEXT("InvestigateSound: Task finished - %s"), 
-			TaskResult == EBTNodeResult::Succeeded ? TEXT("SUCCESS") : TEXT("FAILED"));
 	}
 }
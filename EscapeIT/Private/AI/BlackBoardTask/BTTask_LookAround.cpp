@@ -4,6 +4,7 @@
 #include "AI/BlackBoardTask/BTTask_LookAround.h"
 #include "AI/NPC_AIController.h"
 #include "AI/NPC.h"
+#include "AI/AIDecisionTrace.h"
 
 UBTTask_LookAround::UBTTask_LookAround(FObjectInitializer const& ObjectInitializer)
 	: UBTTaskNode(ObjectInitializer)
@@ -14,9 +15,7 @@ UBTTask_LookAround::UBTTask_LookAround(FObjectInitializer const& ObjectInitializ
 
 EBTNodeResult::Type UBTTask_LookAround::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
-	ElapsedTime = 0.0f;
-    
-	UE_LOG(LogTemp, Warning, TEXT("LookAround: Started looking around..."));
+	CastInstanceNodeMemory<FBTLookAroundMemory>(NodeMemory)->ElapsedTime = 0.0f;
     
 	return EBTNodeResult::InProgress;
 }
@@ -25,7 +24,8 @@ void UBTTask_LookAround::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* Node
 {
 	Super::TickTask(OwnerComp, NodeMemory, DeltaSeconds);
     
-	ElapsedTime += DeltaSeconds;
+	FBTLookAroundMemory* Memory = CastInstanceNodeMemory<FBTLookAroundMemory>(NodeMemory);
+	Memory->ElapsedTime += DeltaSeconds;
     
 	if (auto* AICon = Cast<ANPC_AIController>(OwnerComp.GetAIOwner()))
 	{
@@ -37,13 +37,31 @@ void UBTTask_LookAround::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* Node
 		}
 	}
     
-	if (ElapsedTime >= LookAroundDuration)
+	if (Memory->ElapsedTime >= LookAroundDuration)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("LookAround: Finished"));
+		UAIDecisionTraceSubsystem::TraceTaskFinished(OwnerComp, this, EBTNodeResult::Succeeded);
 		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
 	}
 }
 
+void UBTTask_LookAround::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FBTLookAroundMemory>(NodeMemory, InitType);
+}
+
+void UBTTask_LookAround::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FBTLookAroundMemory>(NodeMemory, CleanupType);
+}
+
+void UBTTask_LookAround::DescribeRuntimeValues(const UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTDescriptionVerbosity::Type Verbosity, TArray<FString>& Values) const
+{
+	Super::DescribeRuntimeValues(OwnerComp, NodeMemory, Verbosity, Values);
+
+	const FBTLookAroundMemory* Memory = CastInstanceNodeMemory<FBTLookAroundMemory>(NodeMemory);
+	Values.Add(FString::Printf(TEXT("elapsed: %.1fs / %.1fs"), Memory->ElapsedTime, LookAroundDuration));
+}
+
 
 
 
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/BlackBoardTask/BTTask_MoveAlongPatrolRoute.h"
+#include "AI/NPC.h"
+#include "AI/PaTrolPath.h"
+#include "AI/PatrolRouteSubsystem.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Navigation/CrowdFollowingComponent.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "Algo/Reverse.h"
+
+UBTTask_MoveAlongPatrolRoute::UBTTask_MoveAlongPatrolRoute(FObjectInitializer const& ObjectInitializer)
+	: UBTTask_BlackboardBase{ ObjectInitializer }
+{
+	NodeName = TEXT("Move Along Patrol Route");
+	bNotifyTick = true;
+}
+
+EBTNodeResult::Type UBTTask_MoveAlongPatrolRoute::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	AAIController* AICon = OwnerComp.GetAIOwner();
+	UBlackboardComponent* BB = OwnerComp.GetBlackboardComponent();
+	ANPC* NPC = AICon ? Cast<ANPC>(AICon->GetPawn()) : nullptr;
+	APaTrolPath* PatrolPath = NPC ? NPC->GetPatrolPath() : nullptr;
+	if (!BB || !PatrolPath)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	const int32 Index = BB->GetValueAsInt(GetSelectedBlackboardKey());
+	if (Index < 0 || Index >= PatrolPath->Num())
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	FBTMoveAlongPatrolRouteMemory* Memory = CastInstanceNodeMemory<FBTMoveAlongPatrolRouteMemory>(NodeMemory);
+	const int32 FromIndex = Memory->LastIndex;
+	Memory->LastIndex = Index;
+	Memory->MoveId = FAIRequestID::InvalidRequest;
+
+	UPatrolRouteSubsystem* RouteSubsystem = UPatrolRouteSubsystem::Get(AICon);
+	const FBakedPatrolRoute* Route = RouteSubsystem ? RouteSubsystem->GetRoute(PatrolPath) : nullptr;
+
+	const FVector Goal = Route
+		? Route->WorldPoints[Index]
+		: PatrolPath->GetActorTransform().TransformPosition(PatrolPath->GetPatrolPoint(Index));
+
+	FAIMoveRequest MoveRequest(Goal);
+	MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+	MoveRequest.SetReachTestIncludesAgentRadius(true);
+
+	// Crowd simulation chỉ đi theo corridor poly của FNavMeshPath; path chỉ có điểm của segment bake thì nó không đi được
+	const UCrowdFollowingComponent* CrowdFollowing = Cast<UCrowdFollowingComponent>(AICon->GetPathFollowingComponent());
+	const bool bCrowdSimulation = CrowdFollowing && CrowdFollowing->IsCrowdSimulationEnabled();
+
+	// ---- Đi theo segment đã bake nếu NPC đang ở đầu segment ----
+	bool bReversed = false;
+	const FBakedPatrolSegment* Segment = Route ? Route->FindSegment(FromIndex, Index, bReversed) : nullptr;
+	if (Segment && Segment->bReachable && !bCrowdSimulation)
+	{
+		TArray<FVector> PathPoints = Segment->PathPoints;
+		if (bReversed)
+		{
+			Algo::Reverse(PathPoints);
+		}
+
+		const FVector PawnLocation = NPC->GetNavAgentLocation();
+		UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(AICon->GetWorld());
+		const ANavigationData* NavData = NavSys ? NavSys->GetNavDataForProps(AICon->GetNavAgentPropertiesRef()) : nullptr;
+
+		if (NavData && PathPoints.Num() >= 2 && FVector::Dist2D(PawnLocation, PathPoints[0]) <= SegmentStartTolerance)
+		{
+			// Bắt đầu từ chỗ NPC đang đứng (trong tolerance, vẫn trên navmesh)
+			PathPoints[0] = PawnLocation;
+
+			FNavPathSharedPtr Path = MakeShared<FNavigationPath, ESPMode::ThreadSafe>(PathPoints, NPC);
+			Path->SetNavigationDataUsed(NavData);
+			Path->MarkReady();
+
+			Memory->MoveId = AICon->RequestMove(MoveRequest, Path);
+			if (Memory->MoveId.IsValid())
+			{
+				RouteSubsystem->NotifyBakedSegmentUsed();
+				return EBTNodeResult::InProgress;
+			}
+		}
+	}
+
+	// ---- Lần đầu / lệch route / crowd simulation: search path bình thường ----
+	const FPathFollowingRequestResult Result = AICon->MoveTo(MoveRequest);
+	switch (Result.Code)
+	{
+	case EPathFollowingRequestResult::AlreadyAtGoal:
+		return EBTNodeResult::Succeeded;
+
+	case EPathFollowingRequestResult::RequestSuccessful:
+		Memory->MoveId = Result.MoveId;
+		return EBTNodeResult::InProgress;
+
+	default:
+		return EBTNodeResult::Failed;
+	}
+}
+
+void UBTTask_MoveAlongPatrolRoute::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	Super::TickTask(OwnerComp, NodeMemory, DeltaSeconds);
+
+	AAIController* AICon = OwnerComp.GetAIOwner();
+	const UPathFollowingComponent* PathFollowing = AICon ? AICon->GetPathFollowingComponent() : nullptr;
+	if (!PathFollowing)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	const FBTMoveAlongPatrolRouteMemory* Memory = CastInstanceNodeMemory<FBTMoveAlongPatrolRouteMemory>(NodeMemory);
+
+	// Move khác đã thay thế move của task -> coi như bị huỷ
+	if (PathFollowing->GetCurrentRequestId() != Memory->MoveId && PathFollowing->GetStatus() != EPathFollowingStatus::Idle)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	if (PathFollowing->GetStatus() == EPathFollowingStatus::Idle)
+	{
+		FinishLatentTask(OwnerComp, PathFollowing->DidMoveReachGoal() ? EBTNodeResult::Succeeded : EBTNodeResult::Failed);
+	}
+}
+
+EBTNodeResult::Type UBTTask_MoveAlongPatrolRoute::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	if (AAIController* AICon = OwnerComp.GetAIOwner())
+	{
+		AICon->StopMovement();
+	}
+
+	// Không chắc NPC đã tới point nào -> lần sau search path bình thường
+	CastInstanceNodeMemory<FBTMoveAlongPatrolRouteMemory>(NodeMemory)->LastIndex = INDEX_NONE;
+
+	return Super::AbortTask(OwnerComp, NodeMemory);
+}
+
+void UBTTask_MoveAlongPatrolRoute::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FBTMoveAlongPatrolRouteMemory>(NodeMemory, InitType);
+}
+
+void UBTTask_MoveAlongPatrolRoute::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FBTMoveAlongPatrolRouteMemory>(NodeMemory, CleanupType);
+}
+
+void UBTTask_MoveAlongPatrolRoute::DescribeRuntimeValues(const UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTDescriptionVerbosity::Type Verbosity, TArray<FString>& Values) const
+{
+	Super::DescribeRuntimeValues(OwnerComp, NodeMemory, Verbosity, Values);
+
+	const FBTMoveAlongPatrolRouteMemory* Memory = CastInstanceNodeMemory<FBTMoveAlongPatrolRouteMemory>(NodeMemory);
+	Values.Add(FString::Printf(TEXT("last point: %d"), Memory->LastIndex));
+}
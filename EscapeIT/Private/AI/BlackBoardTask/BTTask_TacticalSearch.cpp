@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/BlackBoardTask/BTTask_TacticalSearch.h"
+#include "AI/NPC_AIController.h"
+#include "AI/NPCBlackboardSchema.h"
+#include "AI/TacticalSearchSubsystem.h"
+#include "AI/AIDecisionTrace.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "Navigation/PathFollowingComponent.h"
+
+UBTTask_TacticalSearch::UBTTask_TacticalSearch(FObjectInitializer const& ObjectInitializer)
+	: UBTTask_BlackboardBase{ ObjectInitializer }
+{
+	NodeName = TEXT("Tactical Search");
+	bNotifyTick = true;
+	bNotifyTaskFinished = true;
+}
+
+EBTNodeResult::Type UBTTask_TacticalSearch::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	AAIController* AICon = OwnerComp.GetAIOwner();
+	UBlackboardComponent* BB = OwnerComp.GetBlackboardComponent();
+	UTacticalSearchSubsystem* TacticalSearch = UTacticalSearchSubsystem::Get(AICon);
+	if (!AICon || !BB || !TacticalSearch)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	const FVector LastKnownLocation = BB->GetValueAsVector(GetSelectedBlackboardKey());
+	if (LastKnownLocation.IsZero())
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	// Hướng player đang chạy lúc mất dấu (nếu NPC còn nhớ)
+	FVector LastKnownVelocity = FVector::ZeroVector;
+	if (const ANPC_AIController* NPCController = Cast<ANPC_AIController>(AICon))
+	{
+		LastKnownVelocity = NPCController->GetPlayerMemory().Velocity;
+	}
+
+	FBTTacticalSearchMemory* Memory = CastInstanceNodeMemory<FBTTacticalSearchMemory>(NodeMemory);
+	Memory->CurrentPoint = 0;
+	Memory->MoveId = FAIRequestID::InvalidRequest;
+	Memory->NumPoints = TacticalSearch->PlanSearch(LastKnownLocation, LastKnownVelocity,
+		MakeArrayView(Memory->Points, FMath::Clamp(NumSearchPoints, 1, FBTTacticalSearchMemory::MaxPoints)));
+
+	if (!MoveToNextPoint(*AICon, *Memory))
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	FNPCBlackboard(BB).SetIsInvestigating(true);
+	return EBTNodeResult::InProgress;
+}
+
+bool UBTTask_TacticalSearch::MoveToNextPoint(AAIController& AICon, FBTTacticalSearchMemory& Memory) const
+{
+	for (; Memory.CurrentPoint < Memory.NumPoints; ++Memory.CurrentPoint)
+	{
+		FAIMoveRequest MoveRequest(Memory.Points[Memory.CurrentPoint]);
+		MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+		MoveRequest.SetReachTestIncludesAgentRadius(true);
+
+		const FPathFollowingRequestResult Result = AICon.MoveTo(MoveRequest);
+		if (Result.Code == EPathFollowingRequestResult::RequestSuccessful)
+		{
+			Memory.MoveId = Result.MoveId;
+			return true;
+		}
+	}
+
+	Memory.MoveId = FAIRequestID::InvalidRequest;
+	return false;
+}
+
+void UBTTask_TacticalSearch::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	Super::TickTask(OwnerComp, NodeMemory, DeltaSeconds);
+
+	AAIController* AICon = OwnerComp.GetAIOwner();
+	const UPathFollowingComponent* PathFollowing = AICon ? AICon->GetPathFollowingComponent() : nullptr;
+	if (!PathFollowing)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	FBTTacticalSearchMemory* Memory = CastInstanceNodeMemory<FBTTacticalSearchMemory>(NodeMemory);
+
+	// Move khác đã thay thế move của task -> coi như bị huỷ
+	if (PathFollowing->GetCurrentRequestId() != Memory->MoveId && PathFollowing->GetStatus() != EPathFollowingStatus::Idle)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	if (PathFollowing->GetStatus() != EPathFollowingStatus::Idle)
+	{
+		return;
+	}
+
+	// Tới nơi hay không thì cũng chuyển sang điểm tiếp theo
+	++Memory->CurrentPoint;
+	if (!MoveToNextPoint(*AICon, *Memory))
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+	}
+}
+
+EBTNodeResult::Type UBTTask_TacticalSearch::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	if (AAIController* AICon = OwnerComp.GetAIOwner())
+	{
+		AICon->StopMovement();
+	}
+
+	return Super::AbortTask(OwnerComp, NodeMemory);
+}
+
+void UBTTask_TacticalSearch::OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult)
+{
+	Super::OnTaskFinished(OwnerComp, NodeMemory, TaskResult);
+
+	UAIDecisionTraceSubsystem::TraceTaskFinished(OwnerComp, this, TaskResult);
+
+	if (UBlackboardComponent* BB = OwnerComp.GetBlackboardComponent())
+	{
+		FNPCBlackboard(BB).SetIsInvestigating(false);
+	}
+}
+
+void UBTTask_TacticalSearch::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FBTTacticalSearchMemory>(NodeMemory, InitType);
+}
+
+void UBTTask_TacticalSearch::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FBTTacticalSearchMemory>(NodeMemory, CleanupType);
+}
+
+void UBTTask_TacticalSearch::DescribeRuntimeValues(const UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTDescriptionVerbosity::Type Verbosity, TArray<FString>& Values) const
+{
+	Super::DescribeRuntimeValues(OwnerComp, NodeMemory, Verbosity, Values);
+
+	const FBTTacticalSearchMemory* Memory = CastInstanceNodeMemory<FBTTacticalSearchMemory>(NodeMemory);
+	Values.Add(FString::Printf(TEXT("search point: %d/%d"), FMath::Min(Memory->CurrentPoint + 1, Memory->NumPoints), Memory->NumPoints));
+}
@@ -0,0 +1,482 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/ChaseMovementSubsystem.h"
+#include "EscapeIT.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "NavigationPath.h"
+#include "NavMesh/NavMeshPath.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("ChaseMovement Tick"), STAT_ChaseMovementTick, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chase Path Searches"), STAT_ChasePathSearches, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chase Direct Moves"), STAT_ChaseDirectMoves, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chase Corridor Reuses"), STAT_ChaseCorridorReuses, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chase Deferred Repaths"), STAT_ChaseDeferredRepaths, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Chasers"), STAT_ChaseActiveChasers, STATGROUP_EscapeIT);
+
+namespace ChaseMovement
+{
+	FAIMoveRequest MakeMoveRequest(const FVector& Goal, const FChaseRepathSettings& Settings, bool bUsePathfinding)
+	{
+		// Giữ nguyên tham số MoveToLocation cũ của BTTask_ChasePlayer
+		FAIMoveRequest MoveRequest(Goal);
+		MoveRequest.SetAcceptanceRadius(Settings.AcceptanceRadius);
+		MoveRequest.SetReachTestIncludesAgentRadius(true);
+		MoveRequest.SetUsePathfinding(bUsePathfinding);
+		MoveRequest.SetProjectGoalLocation(false);
+		MoveRequest.SetCanStrafe(true);
+		MoveRequest.SetAllowPartialPath(true);
+		return MoveRequest;
+	}
+}
+
+UChaseMovementSubsystem* UChaseMovementSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UChaseMovementSubsystem>() : nullptr;
+}
+
+void UChaseMovementSubsystem::Deinitialize()
+{
+	// Query async còn bay sẽ không tìm thấy chaser nào và bị bỏ qua
+	for (FChaser& Chaser : Chasers)
+	{
+		UnbindMoveFinished(Chaser);
+	}
+	Chasers.Empty();
+	RepathCandidates.Empty();
+	SET_DWORD_STAT(STAT_ChaseActiveChasers, 0);
+
+	Super::Deinitialize();
+}
+
+TStatId UChaseMovementSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UChaseMovementSubsystem, STATGROUP_Tickables);
+}
+
+// ============================================
+// CHASERS
+// ============================================
+
+void UChaseMovementSubsystem::StartChase(AAIController* Controller, const FChaseRepathSettings& Settings)
+{
+	if (!Controller)
+	{
+		return;
+	}
+
+	FChaser* Chaser = FindChaser(Controller);
+	if (!Chaser)
+	{
+		Chaser = &Chasers.AddDefaulted_GetRef();
+		Chaser->Controller = Controller;
+		BindMoveFinished(*Chaser, *Controller);
+	}
+
+	Chaser->Settings = Settings;
+	Chaser->PendingQueryId = INVALID_NAVQUERYID;
+	Chaser->bMoveIssued = false;
+	Chaser->bPathFailed = false;
+	Chaser->TimeSinceRepath = 0.0f;
+	Chaser->MoveRequestId = FAIRequestID::InvalidRequest;
+	Chaser->FinishedMoveId = FAIRequestID::InvalidRequest;
+}
+
+void UChaseMovementSubsystem::StopChase(AAIController* Controller)
+{
+	for (int32 i = 0; i < Chasers.Num(); ++i)
+	{
+		if (Chasers[i].Controller.Get() != Controller)
+		{
+			continue;
+		}
+
+		UnbindMoveFinished(Chasers[i]);
+
+		if (bIsTicking)
+		{
+			// Đang duyệt mảng -> chỉ đánh dấu, dọn ở đầu Tick sau
+			Chasers[i].Controller.Reset();
+		}
+		else
+		{
+			Chasers.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		}
+		return;
+	}
+}
+
+void UChaseMovementSubsystem::SetChaseTarget(AAIController* Controller, const AActor* TargetActor, const FVector& TargetLocation)
+{
+	if (FChaser* Chaser = FindChaser(Controller))
+	{
+		Chaser->TargetActor = TargetActor;
+		Chaser->TargetLocation = TargetActor ? TargetActor->GetActorLocation() : TargetLocation;
+	}
+}
+
+EChaseMoveStatus UChaseMovementSubsystem::GetChaseStatus(const AAIController* Controller) const
+{
+	const FChaser* Chaser = FindChaser(Controller);
+	if (!Chaser)
+	{
+		return EChaseMoveStatus::None;
+	}
+
+	if (Chaser->bPathFailed)
+	{
+		return EChaseMoveStatus::Failed;
+	}
+
+	if (Chaser->PendingQueryId != INVALID_NAVQUERYID || !Chaser->bMoveIssued)
+	{
+		return EChaseMoveStatus::Pending;
+	}
+
+	// Idle không có nghĩa là tới nơi: move bị Blocked/OffPath/Aborted cũng về Idle
+	if (Chaser->FinishedMoveId.IsValid() && Chaser->FinishedMoveId == Chaser->MoveRequestId)
+	{
+		return Chaser->bFinishedMoveSucceeded ? EChaseMoveStatus::Reached : EChaseMoveStatus::Failed;
+	}
+
+	switch (Controller->GetMoveStatus())
+	{
+	case EPathFollowingStatus::Idle:
+		// Move của subsystem đã bị move khác thay thế
+	case EPathFollowingStatus::Paused:
+		return EChaseMoveStatus::Failed;
+	default:
+		return EChaseMoveStatus::Moving;
+	}
+}
+
+UChaseMovementSubsystem::FChaser* UChaseMovementSubsystem::FindChaser(const AAIController* Controller)
+{
+	return Controller ? Chasers.FindByPredicate([Controller](const FChaser& Chaser) { return Chaser.Controller.Get() == Controller; }) : nullptr;
+}
+
+const UChaseMovementSubsystem::FChaser* UChaseMovementSubsystem::FindChaser(const AAIController* Controller) const
+{
+	return Controller ? Chasers.FindByPredicate([Controller](const FChaser& Chaser) { return Chaser.Controller.Get() == Controller; }) : nullptr;
+}
+
+// ============================================
+// MOVE RESULT
+// ============================================
+
+void UChaseMovementSubsystem::BindMoveFinished(FChaser& Chaser, AAIController& Controller)
+{
+	if (UPathFollowingComponent* PathFollowing = Controller.GetPathFollowingComponent())
+	{
+		Chaser.MoveFinishedHandle = PathFollowing->OnRequestFinished.AddUObject(
+			this, &UChaseMovementSubsystem::OnMoveFinished, TWeakObjectPtr<const AAIController>(&Controller));
+	}
+}
+
+void UChaseMovementSubsystem::UnbindMoveFinished(FChaser& Chaser)
+{
+	const AAIController* Controller = Chaser.Controller.Get();
+	if (UPathFollowingComponent* PathFollowing = Controller ? Controller->GetPathFollowingComponent() : nullptr)
+	{
+		PathFollowing->OnRequestFinished.Remove(Chaser.MoveFinishedHandle);
+	}
+	Chaser.MoveFinishedHandle.Reset();
+}
+
+void UChaseMovementSubsystem::OnMoveFinished(FAIRequestID RequestID, const FPathFollowingResult& Result, TWeakObjectPtr<const AAIController> Controller)
+{
+	// Gọi cả khi move cũ bị abort bởi repath (mang ID cũ) và khi move mới xong ngay trong MoveTo
+	if (FChaser* Chaser = FindChaser(Controller.Get()))
+	{
+		Chaser->FinishedMoveId = RequestID;
+		Chaser->bFinishedMoveSucceeded = Result.IsSuccess();
+	}
+}
+
+void UChaseMovementSubsystem::RecordMoveRequest(const AAIController* Controller, FAIRequestID RequestId)
+{
+	if (FChaser* Chaser = FindChaser(Controller))
+	{
+		Chaser->MoveRequestId = RequestId;
+		Chaser->bPathFailed |= !RequestId.IsValid();
+	}
+}
+
+// ============================================
+// REPATH
+// ============================================
+
+bool UChaseMovementSubsystem::NeedsRepath(const FChaser& Chaser, const FVector& Goal) const
+{
+	if (Chaser.PendingQueryId != INVALID_NAVQUERYID || Chaser.bPathFailed)
+	{
+		return false;
+	}
+
+	if (!Chaser.bMoveIssued)
+	{
+		return true;
+	}
+
+	if (Chaser.TimeSinceRepath < Chaser.Settings.MinRepathInterval)
+	{
+		return false;
+	}
+
+	const float DriftSq = FVector::DistSquared(Goal, Chaser.PathGoal);
+	if (DriftSq > FMath::Square(Chaser.Settings.RepathDistance))
+	{
+		return true;
+	}
+
+	// Đã tới goal cũ -> để task kết thúc, không search lại chỉ vì hết giờ
+	if (Chaser.Controller->GetMoveStatus() == EPathFollowingStatus::Idle)
+	{
+		return false;
+	}
+
+	return Chaser.TimeSinceRepath >= Chaser.Settings.MaxRepathInterval
+		&& DriftSq > FMath::Square(Chaser.Settings.AcceptanceRadius * 0.5f);
+}
+
+bool UChaseMovementSubsystem::TryReuseCorridor(AAIController& Controller, const FVector& Goal) const
+{
+	UPathFollowingComponent* PathFollowing = Controller.GetPathFollowingComponent();
+	if (!PathFollowing || PathFollowing->GetStatus() != EPathFollowingStatus::Moving)
+	{
+		return false;
+	}
+
+	// Direct move không có corridor (FNavigationPath 2 điểm)
+	FNavPathSharedPtr Path = PathFollowing->GetPath();
+	FNavMeshPath* NavMeshPath = Path.IsValid() && Path->IsValid() ? Path->CastPath<FNavMeshPath>() : nullptr;
+	const ANavigationData* NavData = NavMeshPath ? NavMeshPath->GetNavigationDataUsed() : nullptr;
+	if (!NavData || NavMeshPath->IsPartial() || NavMeshPath->PathCorridor.Num() == 0)
+	{
+		return false;
+	}
+
+	FNavLocation ProjectedGoal;
+	if (!NavData->ProjectPoint(Goal, ProjectedGoal, NavData->GetDefaultQueryExtent())
+		|| !NavMeshPath->PathCorridor.Contains(ProjectedGoal.NodeRef))
+	{
+		return false;
+	}
+
+	// Đoạn cuối mới phải đi thẳng được: từ NPC nếu đang ở đoạn cuối, ngược lại từ điểm áp chót
+	TArray<FNavPathPoint>& PathPoints = NavMeshPath->GetPathPoints();
+	const int32 LastIndex = PathPoints.Num() - 1;
+	if (LastIndex < 1)
+	{
+		return false;
+	}
+
+	const APawn* Pawn = Controller.GetPawn();
+	const FVector SegmentStart = (int32)PathFollowing->GetCurrentPathIndex() >= LastIndex - 1
+		? Pawn->GetNavAgentLocation()
+		: PathPoints[LastIndex - 1].Location;
+
+	FVector HitLocation;
+	if (UNavigationSystemV1::NavigationRaycast(&Controller, SegmentStart, ProjectedGoal.Location, HitLocation, nullptr, &Controller))
+	{
+		return false;
+	}
+
+	PathPoints[LastIndex].Location = ProjectedGoal.Location;
+	PathPoints[LastIndex].NodeRef = ProjectedGoal.NodeRef;
+
+	// Giống path bám goal actor: path following nhận UpdatedDueToGoalMoved và cập nhật segment đang đi, giữ nguyên move request
+	NavMeshPath->DoneUpdating(ENavPathUpdateType::GoalMoved);
+	return true;
+}
+
+bool UChaseMovementSubsystem::IssueRepath(int32 ChaserIndex)
+{
+	// Ghi state trước khi gọi vào controller: MoveTo có thể broadcast và làm thay đổi Chasers
+	FChaser& Chaser = Chasers[ChaserIndex];
+	AAIController* Controller = Chaser.Controller.Get();
+	const APawn* Pawn = Controller->GetPawn();
+	const FChaseRepathSettings Settings = Chaser.Settings;
+	const FVector Goal = Chaser.TargetLocation;
+
+	Chaser.TimeSinceRepath = 0.0f;
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!NavSys)
+	{
+		Chaser.bPathFailed = true;
+		return false;
+	}
+
+	// Target lệch ít -> giữ corridor của path đang đi, chỉ dời điểm cuối
+	if (FVector::DistSquared(Goal, Chaser.PathGoal) <= FMath::Square(Settings.RepathDistance) && TryReuseCorridor(*Controller, Goal))
+	{
+		Chaser.PathGoal = Goal;
+
+		++Stats.CorridorReuses;
+		INC_DWORD_STAT(STAT_ChaseCorridorReuses);
+		return false;
+	}
+
+	// Target thấy thẳng trên navmesh -> đi thẳng, không cần search
+	if (Settings.bUseDirectMoveWhenClear)
+	{
+		FNavLocation ProjectedGoal;
+		FVector HitLocation;
+		if (NavSys->ProjectPointToNavigation(Goal, ProjectedGoal)
+			&& !UNavigationSystemV1::NavigationRaycast(Controller, Pawn->GetNavAgentLocation(), ProjectedGoal.Location, HitLocation, nullptr, Controller))
+		{
+			Chaser.PathGoal = Goal;
+			Chaser.bMoveIssued = true;
+			Chaser.MoveRequestId = FAIRequestID::InvalidRequest;
+
+			++Stats.DirectMoves;
+			INC_DWORD_STAT(STAT_ChaseDirectMoves);
+
+			const FPathFollowingRequestResult MoveResult = Controller->MoveTo(ChaseMovement::MakeMoveRequest(Goal, Settings, false));
+			RecordMoveRequest(Controller, MoveResult.MoveId);
+			return false;
+		}
+	}
+
+	FPathFindingQuery Query;
+	if (!Controller->BuildPathfindingQuery(ChaseMovement::MakeMoveRequest(Goal, Settings, true), Query))
+	{
+		Chaser.bPathFailed = true;
+		return false;
+	}
+
+	Chaser.PendingGoal = Goal;
+	Chaser.PendingQueryId = NavSys->FindPathAsync(
+		Controller->GetNavAgentPropertiesRef(),
+		Query,
+		FNavPathQueryDelegate::CreateUObject(this, &UChaseMovementSubsystem::OnPathFound),
+		EPathFindingMode::Regular);
+
+	++Stats.PathSearches;
+	++StatsWindowSearches;
+	INC_DWORD_STAT(STAT_ChasePathSearches);
+
+	return true;
+}
+
+void UChaseMovementSubsystem::OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	FChaser* Chaser = Chasers.FindByPredicate([QueryId](const FChaser& Entry) { return Entry.PendingQueryId == QueryId; });
+	if (!Chaser)
+	{
+		// Chaser đã StopChase hoặc đã gửi query mới
+		return;
+	}
+
+	Chaser->PendingQueryId = INVALID_NAVQUERYID;
+
+	AAIController* Controller = Chaser->Controller.Get();
+	if (!Controller || Result != ENavigationQueryResult::Success || !Path.IsValid())
+	{
+		Chaser->bPathFailed = true;
+		return;
+	}
+
+	const FVector Goal = Chaser->PendingGoal;
+	const FChaseRepathSettings Settings = Chaser->Settings;
+	Chaser->PathGoal = Goal;
+	Chaser->bMoveIssued = true;
+	Chaser->MoveRequestId = FAIRequestID::InvalidRequest;
+
+	Path->EnableRecalculationOnInvalidation(true);
+	const FAIRequestID RequestId = Controller->RequestMove(ChaseMovement::MakeMoveRequest(Goal, Settings, true), Path);
+	RecordMoveRequest(Controller, RequestId);
+}
+
+// ============================================
+// TICK
+// ============================================
+
+void UChaseMovementSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ChaseMovementTick);
+
+	StatsWindowTime += DeltaTime;
+	if (StatsWindowTime >= 1.0f)
+	{
+		Stats.PathSearchesPerSecond = StatsWindowSearches / StatsWindowTime;
+		StatsWindowTime = 0.0f;
+		StatsWindowSearches = 0;
+	}
+
+	// Dọn chaser đã mất controller/pawn
+	for (int32 i = Chasers.Num() - 1; i >= 0; --i)
+	{
+		const AAIController* Controller = Chasers[i].Controller.Get();
+		if (!Controller || !Controller->GetPawn())
+		{
+			UnbindMoveFinished(Chasers[i]);
+			Chasers.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ChaseActiveChasers, Chasers.Num());
+
+	if (Chasers.Num() == 0)
+	{
+		return;
+	}
+
+	RepathCandidates.Reset();
+	for (int32 i = 0; i < Chasers.Num(); ++i)
+	{
+		FChaser& Chaser = Chasers[i];
+		Chaser.TimeSinceRepath += DeltaTime;
+
+		if (const AActor* TargetActor = Chaser.TargetActor.Get())
+		{
+			Chaser.TargetLocation = TargetActor->GetActorLocation();
+		}
+
+		if (NeedsRepath(Chaser, Chaser.TargetLocation))
+		{
+			RepathCandidates.Add(i);
+		}
+	}
+
+	// Chaser chờ lâu nhất được ưu tiên -> chaser bị deferred không bị bỏ đói
+	RepathCandidates.Sort([this](int32 A, int32 B)
+	{
+		return Chasers[A].TimeSinceRepath > Chasers[B].TimeSinceRepath;
+	});
+
+	bIsTicking = true;
+
+	int32 SearchesThisFrame = 0;
+	for (int32 CandidateIndex = 0; CandidateIndex < RepathCandidates.Num(); ++CandidateIndex)
+	{
+		if (SearchesThisFrame >= MaxPathRequestsPerFrame)
+		{
+			const int32 NumDeferred = RepathCandidates.Num() - CandidateIndex;
+			Stats.Deferred += NumDeferred;
+			INC_DWORD_STAT_BY(STAT_ChaseDeferredRepaths, NumDeferred);
+			break;
+		}
+
+		const int32 ChaserIndex = RepathCandidates[CandidateIndex];
+		if (Chasers[ChaserIndex].Controller.IsValid() && IssueRepath(ChaserIndex))
+		{
+			++SearchesThisFrame;
+		}
+	}
+
+	bIsTicking = false;
+}
+
+void UChaseMovementSubsystem::ResetStats()
+{
+	Stats = FChaseMovementStats();
+	StatsWindowTime = 0.0f;
+	StatsWindowSearches = 0;
+}
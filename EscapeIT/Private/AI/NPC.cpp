@@ -8,14 +8,55 @@
 #include "EscapeITCharacter.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Components/WidgetComponent.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "AI/AISignificanceSubsystem.h"
+#include "AI/NPC_AIController.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "AI/NPCSkeletalMeshComponent.h"
+#include "EscapeIT.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 
-ANPC::ANPC()
+namespace NPCAnimation
+{
+	static UAnimMontage* Resolve(const TSoftObjectPtr<UAnimMontage>& Montage)
+	{
+		if (UAnimMontage* Loaded = Montage.Get())
+		{
+			return Loaded;
+		}
+		if (Montage.IsNull())
+		{
+			return nullptr;
+		}
+
+		UE_LOG(LogEscapeIT, Warning, TEXT("NPC: montage %s was not preloaded, loading synchronously"), *Montage.ToString());
+		return Montage.LoadSynchronous();
+	}
+}
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Navigation/CrowdFollowingComponent.h"
+
+ANPC::ANPC(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UNPCSkeletalMeshComponent>(ACharacter::MeshComponentName))
 {
 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
 	bReplicates = true;
 	SetReplicateMovement(true);
+
+	FNPCSpeedProfileSettings& Investigate = SpeedProfiles[static_cast<int32>(ENPCSpeedProfile::Investigate)];
+	Investigate.MaxWalkSpeed = 300.0f;
+
+	FNPCSpeedProfileSettings& Search = SpeedProfiles[static_cast<int32>(ENPCSpeedProfile::Search)];
+	Search.MaxWalkSpeed = 350.0f;
+	Search.CrowdSeparationWeight = 1.5f;
+
+	FNPCSpeedProfileSettings& Chase = SpeedProfiles[static_cast<int32>(ENPCSpeedProfile::Chase)];
+	Chase.MaxWalkSpeed = 600.0f;
+	Chase.CrowdSeparationWeight = 0.5f;
 }
 
 // Called when the game starts or when spawned
@@ -23,6 +64,156 @@ void ANPC::BeginPlay()
 {
 	Super::BeginPlay();
 
+	if (!bIsPooled)
+	{
+		RegisterWithAISubsystems();
+	}
+}
+
+void ANPC::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterFromAISubsystems();
+	ReleaseAnimations();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ANPC::RegisterWithAISubsystems()
+{
+	// Khoảng cách/hướng tới player được tính theo batch cho mọi NPC
+	if (UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(this))
+	{
+		WorldState->RegisterNPC(this);
+	}
+
+	if (UAISignificanceSubsystem* Significance = UAISignificanceSubsystem::Get(this))
+	{
+		Significance->RegisterNPC(this);
+	}
+}
+
+void ANPC::UnregisterFromAISubsystems()
+{
+	if (UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(this))
+	{
+		WorldState->UnregisterNPC(this);
+	}
+
+	if (UAISignificanceSubsystem* Significance = UAISignificanceSubsystem::Get(this))
+	{
+		Significance->UnregisterNPC(this);
+	}
+}
+
+// ============================================
+// DORMANCY
+// ============================================
+
+void ANPC::SetDormant(bool bDormant)
+{
+	if (bIsDormant == bDormant)
+	{
+		return;
+	}
+	bIsDormant = bDormant;
+
+	if (ANPC_AIController* AIController = GetController<ANPC_AIController>())
+	{
+		AIController->SetDormant(bDormant);
+	}
+
+	SetActorTickEnabled(!bDormant);
+
+	if (UCharacterMovementComponent* Movement = GetCharacterMovement())
+	{
+		if (bDormant)
+		{
+			Movement->StopMovementImmediately();
+		}
+		Movement->SetComponentTickEnabled(!bDormant);
+	}
+
+	// Capsule vẫn query để player không đi xuyên qua; mesh không cần collision khi đứng yên
+	UCapsuleComponent* Capsule = GetCapsuleComponent();
+	USkeletalMeshComponent* MeshComponent = GetMesh();
+	if (bDormant)
+	{
+		AwakeCapsuleCollision = Capsule->GetCollisionEnabled();
+		Capsule->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+
+		if (MeshComponent)
+		{
+			AwakeMeshCollision = MeshComponent->GetCollisionEnabled();
+			MeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		}
+	}
+	else
+	{
+		Capsule->SetCollisionEnabled(AwakeCapsuleCollision);
+
+		if (MeshComponent)
+		{
+			MeshComponent->SetCollisionEnabled(AwakeMeshCollision);
+		}
+	}
+
+	if (MeshComponent)
+	{
+		MeshComponent->SetComponentTickEnabled(!bDormant);
+	}
+
+	// Montage được preload lại khi NPC lên mức significance cao
+	if (bDormant)
+	{
+		ReleaseAnimations();
+	}
+}
+
+// ============================================
+// POOL
+// ============================================
+
+void ANPC::DeactivateToPool()
+{
+	if (bIsPooled)
+	{
+		return;
+	}
+	bIsPooled = true;
+
+	UnregisterFromAISubsystems();
+	SetDormant(true);
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+}
+
+void ANPC::ActivateFromPool(const FTransform& SpawnTransform, APaTrolPath* InPatrolPath)
+{
+	if (!bIsPooled)
+	{
+		return;
+	}
+	bIsPooled = false;
+
+	if (InPatrolPath)
+	{
+		PatrolPath = InPatrolPath;
+	}
+
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	SetDormant(false);
+	SetSpeedProfile(ENPCSpeedProfile::Patrol);
+
+	if (ANPC_AIController* AIController = GetController<ANPC_AIController>())
+	{
+		AIController->ResetForReuse();
+	}
+
+	RegisterWithAISubsystems();
 }
 
 
@@ -52,5 +243,63 @@ APaTrolPath* ANPC::GetPatrolPath() const
 
 UAnimMontage* ANPC::GetMontage() const
 {
-	return Montage;
+	return NPCAnimation::Resolve(Montage);
+}
+
+UAnimMontage* ANPC::GetAttackMontage(int32 Index) const
+{
+	return AttackMontages.IsValidIndex(Index) ? NPCAnimation::Resolve(AttackMontages[Index]) : nullptr;
+}
+
+void ANPC::PreloadAnimations()
+{
+	if (AnimationLoadHandle.IsValid())
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> Paths;
+	if (!Montage.IsNull())
+	{
+		Paths.Add(Montage.ToSoftObjectPath());
+	}
+	for (const TSoftObjectPtr<UAnimMontage>& Attack : AttackMontages)
+	{
+		if (!Attack.IsNull())
+		{
+			Paths.AddUnique(Attack.ToSoftObjectPath());
+		}
+	}
+
+	if (Paths.Num() > 0)
+	{
+		AnimationLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(Paths), FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+	}
+}
+
+void ANPC::ReleaseAnimations()
+{
+	if (AnimationLoadHandle.IsValid())
+	{
+		AnimationLoadHandle->ReleaseHandle();
+		AnimationLoadHandle.Reset();
+	}
+}
+
+void ANPC::SetSpeedProfile(ENPCSpeedProfile Profile)
+{
+	SpeedProfile = Profile;
+	const FNPCSpeedProfileSettings& Settings = SpeedProfiles[static_cast<int32>(Profile)];
+
+	if (UCharacterMovementComponent* Movement = GetCharacterMovement())
+	{
+		Movement->MaxWalkSpeed = Settings.MaxWalkSpeed;
+		Movement->MaxAcceleration = Settings.MaxAcceleration;
+	}
+
+	const AAIController* AIController = GetController<AAIController>();
+	if (UCrowdFollowingComponent* CrowdFollowing = AIController ? Cast<UCrowdFollowingComponent>(AIController->GetPathFollowingComponent()) : nullptr)
+	{
+		CrowdFollowing->SetCrowdSeparationWeight(Settings.CrowdSeparationWeight);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,289 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NPCAnimationBudgetSubsystem.h"
+#include "EscapeIT.h"
+#include "AI/NPCSkeletalMeshComponent.h"
+#include "AI/AISignificanceSubsystem.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "GameFramework/Character.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("NPCAnimationBudget Allocate"), STAT_NPCAnimationBudgetAllocate, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("NPC Anim Budgeted Meshes"), STAT_NPCAnimationBudgetMeshes, STATGROUP_EscapeIT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("NPC Anim Measured (ms)"), STAT_NPCAnimationBudgetMeasured, STATGROUP_EscapeIT);
+
+namespace NPCAnimationBudget
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("ai.AnimBudget.Enabled"),
+		bEnabled,
+		TEXT("0 = mesh NPC tick animation full rate (so sánh chi phí với/không có budget)"));
+
+	static float BudgetMs = 1.0f;
+	static FAutoConsoleVariableRef CVarBudgetMs(
+		TEXT("ai.AnimBudget.BudgetMs"),
+		BudgetMs,
+		TEXT("Thời gian game thread (ms/frame) dành cho animation của mọi NPC"));
+}
+
+UNPCAnimationBudgetSubsystem* UNPCAnimationBudgetSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UNPCAnimationBudgetSubsystem>() : nullptr;
+}
+
+bool UNPCAnimationBudgetSubsystem::IsEnabled()
+{
+	return NPCAnimationBudget::bEnabled;
+}
+
+float UNPCAnimationBudgetSubsystem::GetBudgetMs()
+{
+	return FMath::Max(NPCAnimationBudget::BudgetMs, 0.0f);
+}
+
+void UNPCAnimationBudgetSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	SortedIndices.Empty();
+	SET_DWORD_STAT(STAT_NPCAnimationBudgetMeshes, 0);
+
+	Super::Deinitialize();
+}
+
+TStatId UNPCAnimationBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNPCAnimationBudgetSubsystem, STATGROUP_Tickables);
+}
+
+// ============================================
+// COMPONENTS
+// ============================================
+
+void UNPCAnimationBudgetSubsystem::RegisterComponent(UNPCSkeletalMeshComponent* Component)
+{
+	if (!Component || Entries.ContainsByPredicate([Component](const FBudgetEntry& Entry) { return Entry.Component.Get() == Component; }))
+	{
+		return;
+	}
+
+	FBudgetEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Component = Component;
+	Entry.FrameOffset = NextFrameOffset++;
+
+	if (NPCAnimationBudget::bEnabled)
+	{
+		TakeControl(*Component);
+	}
+
+	SET_DWORD_STAT(STAT_NPCAnimationBudgetMeshes, Entries.Num());
+}
+
+void UNPCAnimationBudgetSubsystem::UnregisterComponent(UNPCSkeletalMeshComponent* Component)
+{
+	const int32 Index = Entries.IndexOfByPredicate([Component](const FBudgetEntry& Entry) { return Entry.Component.Get() == Component; });
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (Component)
+	{
+		ReleaseControl(*Component);
+	}
+	Entries.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	SET_DWORD_STAT(STAT_NPCAnimationBudgetMeshes, Entries.Num());
+}
+
+void UNPCAnimationBudgetSubsystem::TakeControl(UNPCSkeletalMeshComponent& Component) const
+{
+	Component.EnableExternalTickRateControl(true);
+	Component.SetExternalTickRate(1);
+	Component.SetBudgetedUpdate(true);
+}
+
+void UNPCAnimationBudgetSubsystem::ReleaseControl(UNPCSkeletalMeshComponent& Component) const
+{
+	Component.EnableExternalTickRateControl(false);
+	Component.EnableExternalInterpolation(false);
+	Component.EnableExternalEvaluationRateLimiting(false);
+	Component.SetBudgetedUpdate(true);
+	Component.SetForcedLOD(0);
+}
+
+// ============================================
+// ALLOCATE
+// ============================================
+
+void UNPCAnimationBudgetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const bool bEnabled = NPCAnimationBudget::bEnabled;
+	if (bEnabled != bWasEnabled)
+	{
+		bWasEnabled = bEnabled;
+		for (FBudgetEntry& Entry : Entries)
+		{
+			UNPCSkeletalMeshComponent* Component = Entry.Component.Get();
+			if (Component && bEnabled)
+			{
+				TakeControl(*Component);
+			}
+			else if (Component)
+			{
+				ReleaseControl(*Component);
+			}
+			Entry.TickRate = 1;
+			Entry.bForcedLOD = false;
+			Entry.AccumulatedDeltaTime = 0.0f;
+		}
+	}
+
+	if (!bEnabled || Entries.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_NPCAnimationBudgetAllocate);
+
+	const float MinimumCostMs = Allocate();
+	RecordStats(MinimumCostMs);
+
+	for (FBudgetEntry& Entry : Entries)
+	{
+		if (Entry.bActive)
+		{
+			Apply(Entry, DeltaTime);
+		}
+	}
+}
+
+float UNPCAnimationBudgetSubsystem::Allocate()
+{
+	UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(this);
+	const UAISignificanceSubsystem* Significance = UAISignificanceSubsystem::Get(this);
+
+	Entries.RemoveAllSwap([](const FBudgetEntry& Entry) { return !Entry.Component.IsValid(); }, EAllowShrinking::No);
+
+	// ---- Ưu tiên: render + Critical + gần player ----
+	SortedIndices.Reset();
+	float TotalWeight = 0.0f;
+	float MinimumCostMs = 0.0f;
+
+	for (int32 i = 0; i < Entries.Num(); ++i)
+	{
+		FBudgetEntry& Entry = Entries[i];
+		const UNPCSkeletalMeshComponent* Component = Entry.Component.Get();
+
+		// NPC ngủ đông / trong pool: mesh không tick, không tốn budget
+		Entry.bActive = Component->IsComponentTickEnabled();
+		if (!Entry.bActive)
+		{
+			continue;
+		}
+
+		const ACharacter* Owner = Cast<ACharacter>(Component->GetOwner());
+		const float Distance = WorldState && Owner ? WorldState->GetDistanceToPlayer(Owner) : 0.0f;
+
+		Entry.bRendered = Component->WasRecentlyRendered(RenderedTolerance);
+		Entry.bCritical = Significance && Owner && Significance->GetSignificance(Owner) == EAISignificance::Critical;
+		Entry.Cost = Component->GetEstimatedUpdateCostMs();
+		Entry.Weight = (Entry.bRendered ? VisibleWeight : 1.0f) * (Entry.bCritical ? CriticalWeight : 1.0f)
+			/ (1.0f + FMath::Min(Distance, 1.0e6f) / DistanceFalloff);
+
+		TotalWeight += Entry.Weight;
+		MinimumCostMs += Entry.Cost / (Entry.bCritical ? MaxCriticalTickRate : MaxTickRate);
+		SortedIndices.Add(i);
+	}
+
+	SortedIndices.Sort([this](int32 A, int32 B) { return Entries[A].Weight > Entries[B].Weight; });
+
+	// ---- Chia budget theo trọng số; mesh ưu tiên cao lấy phần của mình trước ----
+	float RemainingBudget = GetBudgetMs();
+	float RemainingWeight = TotalWeight;
+
+	for (const int32 Index : SortedIndices)
+	{
+		FBudgetEntry& Entry = Entries[Index];
+		const int32 MaxRate = Entry.bCritical ? FMath::Min(MaxCriticalTickRate, MaxTickRate) : MaxTickRate;
+
+		const float Share = RemainingWeight > 0.0f ? RemainingBudget * Entry.Weight / RemainingWeight : 0.0f;
+		const int32 Rate = Share > 0.0f ? FMath::CeilToInt(Entry.Cost / Share) : MaxRate;
+		Entry.TickRate = static_cast<uint8>(FMath::Clamp(Rate, 1, MaxRate));
+
+		// Phần dư của mesh rẻ được chia lại cho các mesh sau
+		RemainingBudget = FMath::Max(0.0f, RemainingBudget - Entry.Cost / Entry.TickRate);
+		RemainingWeight -= Entry.Weight;
+	}
+
+	return MinimumCostMs;
+}
+
+void UNPCAnimationBudgetSubsystem::Apply(FBudgetEntry& Entry, float DeltaTime) const
+{
+	UNPCSkeletalMeshComponent* Component = Entry.Component.Get();
+	const int32 Rate = Entry.TickRate;
+
+	// Quyết định cho frame tới (subsystem tick sau mesh trong frame hiện tại)
+	const uint64 Phase = (GFrameCounter + 1 + Entry.FrameOffset) % Rate;
+	const bool bUpdate = Phase == 0;
+
+	Entry.AccumulatedDeltaTime += DeltaTime;
+	if (bUpdate)
+	{
+		Component->SetExternalDeltaTime(Entry.AccumulatedDeltaTime);
+		Entry.AccumulatedDeltaTime = 0.0f;
+	}
+
+	Component->SetExternalTickRate(Entry.TickRate);
+	Component->SetBudgetedUpdate(bUpdate);
+
+	// ---- Nội suy giữa hai lần update (chỉ đáng tiền khi có người nhìn) ----
+	const bool bInterpolate = Rate > 1 && Entry.bRendered && Rate <= MaxInterpolatedTickRate;
+	Component->EnableExternalInterpolation(bInterpolate);
+	Component->EnableExternalEvaluationRateLimiting(Rate > 1);
+	if (bInterpolate)
+	{
+		Component->SetExternalInterpolationAlpha(static_cast<float>(Phase) / Rate);
+	}
+
+	// ---- LOD evaluate: mesh khuất dùng LOD thấp nhất (ít bone) ----
+	const bool bForceLOD = bForceLowestLODOffscreen && !Entry.bRendered && !Entry.bCritical;
+	if (bForceLOD != Entry.bForcedLOD)
+	{
+		Entry.bForcedLOD = bForceLOD;
+		Component->SetForcedLOD(bForceLOD ? Component->GetNumLODs() : 0);
+	}
+}
+
+void UNPCAnimationBudgetSubsystem::RecordStats(float MinimumCostMs)
+{
+	// Chi phí thật của các mesh đã tick trong frame này
+	double MeasuredMs = 0.0;
+	for (const FBudgetEntry& Entry : Entries)
+	{
+		const UNPCSkeletalMeshComponent* Component = Entry.Component.Get();
+		if (Component && Component->GetLastTickFrame() == GFrameCounter)
+		{
+			MeasuredMs += Component->GetLastTickCostMs();
+		}
+	}
+
+	const float BudgetMs = GetBudgetMs();
+	const bool bSaturated = MinimumCostMs > BudgetMs;
+
+	++Stats.NumFrames;
+	Stats.NumFramesOverBudget += MeasuredMs > BudgetMs ? 1 : 0;
+	Stats.NumSaturatedFrames += bSaturated ? 1 : 0;
+	Stats.TotalMeasuredMs += MeasuredMs;
+	Stats.MaxMeasuredMs = FMath::Max(Stats.MaxMeasuredMs, MeasuredMs);
+	if (!bSaturated)
+	{
+		Stats.TotalUnsaturatedMs += MeasuredMs;
+	}
+
+	SET_FLOAT_STAT(STAT_NPCAnimationBudgetMeasured, MeasuredMs);
+}
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NPCBehaviorTreeComponent.h"
+#include "AI/AIDecisionTrace.h"
+
+void UNPCBehaviorTreeComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	if (MinTickInterval > 0.0f)
+	{
+		PendingDeltaTime += DeltaTime;
+		if (PendingDeltaTime < MinTickInterval)
+		{
+			return;
+		}
+
+		// Tree nhận đủ thời gian đã bỏ qua để timer của task/service vẫn đúng
+		DeltaTime = PendingDeltaTime;
+		PendingDeltaTime = 0.0f;
+	}
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (UAIDecisionTraceSubsystem::IsEnabled())
+	{
+		const UBTNode* ActiveNode = GetActiveNode();
+		if (ActiveNode != LastTracedNode)
+		{
+			LastTracedNode = ActiveNode;
+			if (UAIDecisionTraceSubsystem* Trace = UAIDecisionTraceSubsystem::Get(this))
+			{
+				Trace->RecordNodeActivated(GetOwner(), ActiveNode);
+			}
+		}
+	}
+}
+
+void UNPCBehaviorTreeComponent::SetMinTickInterval(float Interval)
+{
+	MinTickInterval = FMath::Max(0.0f, Interval);
+	if (MinTickInterval <= 0.0f)
+	{
+		PendingDeltaTime = 0.0f;
+	}
+}
@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NPCBlackboardSchema.h"
+#include "UObject/ObjectKey.h"
+
+namespace NPCBlackboardSchemaPrivate
+{
+	// Cache theo asset; value là TUniquePtr để tham chiếu trả ra không bị rehash làm hỏng
+	TMap<TObjectKey<UBlackboardData>, TUniquePtr<FNPCBlackboardKeys>>& GetKeyCache()
+	{
+		static TMap<TObjectKey<UBlackboardData>, TUniquePtr<FNPCBlackboardKeys>> Cache;
+		return Cache;
+	}
+}
+
+// ============================================
+// SCHEMA
+// ============================================
+
+TConstArrayView<FNPCBlackboardKeyDesc> NPCBlackboard::GetSchema()
+{
+	// Tạo lười: UClass của key type chưa có lúc static init
+	static const TArray<FNPCBlackboardKeyDesc> Schema = []()
+	{
+		TSubclassOf<UBlackboardKeyType> BoolType = UBlackboardKeyType_Bool::StaticClass();
+		TSubclassOf<UBlackboardKeyType> VectorType = UBlackboardKeyType_Vector::StaticClass();
+
+		TArray<FNPCBlackboardKeyDesc> Keys;
+		Keys.Add({ ENPCBlackboardKey::CanSeePlayer,        TEXT("CanSeePlayer"),        BoolType });
+		Keys.Add({ ENPCBlackboardKey::IsPlayerBeingChased, TEXT("IsPlayerBeingChased"), BoolType });
+		Keys.Add({ ENPCBlackboardKey::LastHeardLocation,   TEXT("LastHeardLocation"),   VectorType });
+		Keys.Add({ ENPCBlackboardKey::HasHeardSound,       TEXT("HasHeardSound"),       BoolType });
+		Keys.Add({ ENPCBlackboardKey::IsInvestigating,     TEXT("IsInvestigating"),     BoolType });
+		Keys.Add({ ENPCBlackboardKey::CanJumpScare,        TEXT("bCanJumpScare"),       BoolType });
+
+		check(Keys.Num() == static_cast<int32>(ENPCBlackboardKey::Count));
+		return Keys;
+	}();
+
+	return Schema;
+}
+
+const FNPCBlackboardKeyDesc& NPCBlackboard::GetKeyDesc(ENPCBlackboardKey Key)
+{
+	return GetSchema()[static_cast<int32>(Key)];
+}
+
+bool NPCBlackboard::ValidateBlackboardAsset(const UBlackboardData& Asset, TArray<FString>& OutErrors)
+{
+	const int32 NumErrorsBefore = OutErrors.Num();
+
+	for (const FNPCBlackboardKeyDesc& Desc : GetSchema())
+	{
+		const FBlackboard::FKey KeyId = Asset.GetKeyID(Desc.Name);
+		if (KeyId == FBlackboard::InvalidKey)
+		{
+			OutErrors.Add(FString::Printf(TEXT("%s: missing key '%s' (%s)"),
+				*Asset.GetPathName(), *Desc.Name.ToString(), *GetNameSafe(Desc.KeyType)));
+			continue;
+		}
+
+		const TSubclassOf<UBlackboardKeyType> ActualType = Asset.GetKeyType(KeyId);
+		if (ActualType != Desc.KeyType)
+		{
+			OutErrors.Add(FString::Printf(TEXT("%s: key '%s' is %s, expected %s"),
+				*Asset.GetPathName(), *Desc.Name.ToString(), *GetNameSafe(ActualType), *GetNameSafe(Desc.KeyType)));
+		}
+	}
+
+	return OutErrors.Num() == NumErrorsBefore;
+}
+
+// ============================================
+// RESOLVED KEYS
+// ============================================
+
+FNPCBlackboardKeys::FNPCBlackboardKeys()
+{
+	for (FBlackboard::FKey& KeyId : KeyIds)
+	{
+		KeyId = FBlackboard::InvalidKey;
+	}
+}
+
+const FNPCBlackboardKeys& FNPCBlackboardKeys::Get(const UBlackboardData* Asset)
+{
+	static const FNPCBlackboardKeys InvalidKeys;
+	if (!Asset)
+	{
+		return InvalidKeys;
+	}
+
+	auto& Cache = NPCBlackboardSchemaPrivate::GetKeyCache();
+
+#if WITH_EDITOR
+	// Sửa key trong editor -> resolve lại tại chỗ (giữ nguyên địa chỉ đã trả ra)
+	static const FDelegateHandle UpdateKeysHandle = UBlackboardData::OnUpdateKeys.AddLambda([](UBlackboardData* UpdatedAsset)
+	{
+		if (TUniquePtr<FNPCBlackboardKeys>* Entry = NPCBlackboardSchemaPrivate::GetKeyCache().Find(UpdatedAsset))
+		{
+			(*Entry)->Resolve(UpdatedAsset);
+		}
+	});
+#endif
+
+	if (const TUniquePtr<FNPCBlackboardKeys>* Existing = Cache.Find(Asset))
+	{
+		return **Existing;
+	}
+
+	TUniquePtr<FNPCBlackboardKeys>& NewEntry = Cache.Add(Asset, MakeUnique<FNPCBlackboardKeys>());
+	NewEntry->Resolve(Asset);
+	return *NewEntry;
+}
+
+void FNPCBlackboardKeys::Resolve(const UBlackboardData* Asset)
+{
+	TArray<FString> Errors;
+	if (!NPCBlackboard::ValidateBlackboardAsset(*Asset, Errors))
+	{
+		// Key sai tên/kiểu không còn âm thầm fail: báo một lần cho mỗi asset
+		for (const FString& Error : Errors)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("NPCBlackboard: %s"), *Error);
+		}
+	}
+
+	for (const FNPCBlackboardKeyDesc& Desc : NPCBlackboard::GetSchema())
+	{
+		const FBlackboard::FKey KeyId = Asset->GetKeyID(Desc.Name);
+		const bool bTypeMatches = KeyId != FBlackboard::InvalidKey && Asset->GetKeyType(KeyId) == Desc.KeyType;
+		KeyIds[static_cast<int32>(Desc.Key)] = bTypeMatches ? KeyId : FBlackboard::InvalidKey;
+	}
+}
+
+// ============================================
+// TYPED ACCESSOR
+// ============================================
+
+FNPCBlackboard::FNPCBlackboard(UBlackboardComponent* InComponent)
+	: Component(InComponent)
+	, Keys(FNPCBlackboardKeys::Get(InComponent ? InComponent->GetBlackboardAsset() : nullptr))
+{
+}
+
+bool FNPCBlackboard::GetBool(ENPCBlackboardKey Key) const
+{
+	return Component ? Component->GetValue<UBlackboardKeyType_Bool>(Keys[Key]) : NPCBlackboard::GetKeyDesc(Key).bDefaultBool;
+}
+
+void FNPCBlackboard::SetBool(ENPCBlackboardKey Key, bool bValue) const
+{
+	if (Component)
+	{
+		Component->SetValue<UBlackboardKeyType_Bool>(Keys[Key], bValue);
+	}
+}
+
+FVector FNPCBlackboard::GetVector(ENPCBlackboardKey Key) const
+{
+	return Component ? Component->GetValue<UBlackboardKeyType_Vector>(Keys[Key]) : NPCBlackboard::GetKeyDesc(Key).DefaultVector;
+}
+
+void FNPCBlackboard::SetVector(ENPCBlackboardKey Key, const FVector& Value) const
+{
+	if (Component)
+	{
+		Component->SetValue<UBlackboardKeyType_Vector>(Keys[Key], Value);
+	}
+}
+
+void FNPCBlackboard::ResetToDefaults() const
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	for (const FNPCBlackboardKeyDesc& Desc : NPCBlackboard::GetSchema())
+	{
+		if (Desc.KeyType == UBlackboardKeyType_Bool::StaticClass())
+		{
+			SetBool(Desc.Key, Desc.bDefaultBool);
+		}
+		else if (Desc.KeyType == UBlackboardKeyType_Vector::StaticClass())
+		{
+			SetVector(Desc.Key, Desc.DefaultVector);
+		}
+	}
+}
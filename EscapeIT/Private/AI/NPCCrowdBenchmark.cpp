@@ -0,0 +1,1232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NPCCrowdBenchmark.h"
+#include "AI/NPC.h"
+#include "AI/NPCSightSubsystem.h"
+#include "AI/ChaseMovementSubsystem.h"
+#include "AI/AIDecisionTrace.h"
+#include "AI/NPCAnimationBudgetSubsystem.h"
+#include "AI/PaTrolPath.h"
+#include "AI/BlackBoardTask/BTTask_IncrementPathIndex.h"
+#include "AI/BlackBoardTask/BTTask_LookAround.h"
+#include "EscapeIT.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BehaviorTreeManager.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BTCompositeNode.h"
+#include "BehaviorTree/BTDecorator.h"
+#include "BehaviorTree/BTService.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "Navigation/CrowdFollowingComponent.h"
+#include "NavigationSystem.h"
+#include "NavMesh/NavMeshBoundsVolume.h"
+#include "NavMesh/RecastNavMesh.h"
+#include "Components/BrushComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "UObject/EnumProperty.h"
+#include "Engine/World.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "HAL/IConsoleManager.h"
+#include "RenderCore.h"
+
+namespace NPCCrowdBenchmark
+{
+	// Lỗi soak in ra log tối đa chừng này dòng, phần còn lại chỉ đếm
+	constexpr int32 MaxLoggedSoakViolations = 20;
+
+	// Map test: tường cao chừng này, navmesh build lâu hơn chừng này thì bỏ
+	constexpr float TestMapWallHeight = 300.0f;
+	constexpr float TestMapWallThickness = 50.0f;
+	constexpr float MaxNavMeshWaitSeconds = 60.0f;
+
+	// Map rỗng (vd. /Engine/Maps/Entry): spawn benchmark ở gốc toạ độ, map test được dựng bằng code
+	static FAutoConsoleCommandWithWorldAndArgs SpawnCommand(
+		TEXT("ai.CrowdBenchmark.Spawn"),
+		TEXT("Spawn ANPCCrowdBenchmark với map test dựng bằng code; mode lấy từ command line (-CrowdBenchmarkSoak, -CrowdBenchmarkLOD...)"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (!World || !World->IsGameWorld())
+			{
+				return;
+			}
+
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.bDeferConstruction = true;
+			if (ANPCCrowdBenchmark* Benchmark = World->SpawnActor<ANPCCrowdBenchmark>(FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams))
+			{
+				Benchmark->bGenerateTestMap = true;
+				Benchmark->FinishSpawning(FTransform::Identity);
+
+				// Không có -CrowdBenchmark thì BeginPlay không tự chạy
+				Benchmark->StartBenchmark();
+			}
+		}));
+
+	static void CollectNodes(const UBTCompositeNode* Composite, TArray<const UBTNode*>& OutNodes)
+	{
+		if (!Composite)
+		{
+			return;
+		}
+
+		OutNodes.Add(Composite);
+		for (const UBTService* Service : Composite->Services)
+		{
+			OutNodes.Add(Service);
+		}
+
+		for (const FBTCompositeChild& Child : Composite->Children)
+		{
+			for (const UBTDecorator* Decorator : Child.Decorators)
+			{
+				OutNodes.Add(Decorator);
+			}
+
+			if (const UBTTaskNode* Task = Child.ChildTask)
+			{
+				OutNodes.Add(Task);
+				for (const UBTService* Service : Task->Services)
+				{
+					OutNodes.Add(Service);
+				}
+			}
+
+			CollectNodes(Child.ChildComposite, OutNodes);
+		}
+	}
+
+	/** Class node gốc của engine; mọi thứ class của game thêm vào nằm sau phần của class này */
+	static const UClass* FindEngineNodeBase(const UClass* Class)
+	{
+		for (; Class; Class = Class->GetSuperClass())
+		{
+			if (Class == UBTTaskNode::StaticClass() || Class == UBTService::StaticClass()
+				|| Class == UBTDecorator::StaticClass() || Class == UBTCompositeNode::StaticClass()
+				|| Class == UBTNode::StaticClass())
+			{
+				return Class;
+			}
+		}
+		return nullptr;
+	}
+
+	/**
+	 * Byte thô mà class của node thêm vào trên base của engine ([Base size, Class size)).
+	 * So byte thay vì property phản chiếu: state bị lẫn thường là member C++ thường (vd. timer, chiều đi) không phải UPROPERTY
+	 */
+	static TArray<uint8> SnapshotNodeBytes(const UBTNode* Node)
+	{
+		const UClass* Class = Node->GetClass();
+		const UClass* Base = FindEngineNodeBase(Class);
+		const int32 Begin = Base ? Base->GetStructureSize() : 0;
+		const int32 End = Class->GetStructureSize();
+
+		TArray<uint8> Bytes;
+		if (End > Begin)
+		{
+			Bytes.Append(reinterpret_cast<const uint8*>(Node) + Begin, End - Begin);
+		}
+		return Bytes;
+	}
+
+	/** Offset (tính từ đầu object) của byte đầu tiên khác, INDEX_NONE nếu giống */
+	static int32 FindChangedOffset(const UBTNode* Node, TConstArrayView<uint8> Before)
+	{
+		const TArray<uint8> After = SnapshotNodeBytes(Node);
+		if (After.Num() != Before.Num())
+		{
+			return 0;
+		}
+
+		const UClass* Base = FindEngineNodeBase(Node->GetClass());
+		const int32 Begin = Base ? Base->GetStructureSize() : 0;
+		for (int32 i = 0; i < After.Num(); ++i)
+		{
+			if (After[i] != Before[i])
+			{
+				return Begin + i;
+			}
+		}
+		return INDEX_NONE;
+	}
+}
+
+ANPCCrowdBenchmark::ANPCCrowdBenchmark()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	NPCClass = ANPC::StaticClass();
+}
+
+void ANPCCrowdBenchmark::BeginPlay()
+{
+	Super::BeginPlay();
+
+	bQuitWhenDone = FParse::Param(FCommandLine::Get(), TEXT("CrowdBenchmark"));
+	FParse::Value(FCommandLine::Get(), TEXT("CrowdBenchmarkAgents="), NumAgents);
+	bRunBehaviorTree |= FParse::Param(FCommandLine::Get(), TEXT("CrowdBenchmarkBT"));
+	bChaseBenchmark |= FParse::Param(FCommandLine::Get(), TEXT("CrowdBenchmarkChase"));
+	bSoakBenchmark |= FParse::Param(FCommandLine::Get(), TEXT("CrowdBenchmarkSoak"));
+	bCompareSignificanceLOD |= FParse::Param(FCommandLine::Get(), TEXT("CrowdBenchmarkLOD"));
+	FParse::Value(FCommandLine::Get(), TEXT("CrowdBenchmarkDuration="), Duration);
+	bGenerateTestMap |= FParse::Param(FCommandLine::Get(), TEXT("CrowdBenchmarkGenerateMap"));
+
+	FString NPCClassPath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("CrowdBenchmarkNPC="), NPCClassPath))
+	{
+		if (UClass* LoadedClass = LoadClass<ANPC>(nullptr, *NPCClassPath))
+		{
+			NPCClass = LoadedClass;
+		}
+		else
+		{
+			UE_LOG(LogEscapeIT, Error, TEXT("CrowdBenchmark: %s is not an ANPC class"), *NPCClassPath);
+		}
+	}
+
+	if (bQuitWhenDone)
+	{
+		StartBenchmark();
+	}
+}
+
+void ANPCCrowdBenchmark::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bRunning && bSoakBenchmark)
+	{
+		EndSoak();
+	}
+	bRunning = false;
+	Agents.Empty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// ============================================
+// RUN
+// ============================================
+
+void ANPCCrowdBenchmark::StartBenchmark()
+{
+	UWorld* World = GetWorld();
+	if (bRunning || bWaitingForNavMesh || !World || !World->IsGameWorld())
+	{
+		return;
+	}
+
+	// Không có điểm đặt sẵn -> dựng map test, chờ navmesh build xong (Tick) rồi mới spawn agent
+	if ((bGenerateTestMap || SpawnPoints.Num() == 0 || GoalPoints.Num() == 0) && !bTestMapGenerated)
+	{
+		if (GenerateTestMap())
+		{
+			bWaitingForNavMesh = true;
+			NavMeshWaitTime = 0.0f;
+			SetActorTickEnabled(true);
+			return;
+		}
+	}
+
+	if (!NPCClass || SpawnPoints.Num() == 0 || GoalPoints.Num() == 0)
+	{
+		UE_LOG(LogEscapeIT, Error, TEXT("CrowdBenchmark: %s needs NPCClass, SpawnPoints and GoalPoints"), *GetName());
+		if (bQuitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false, TEXT("CrowdBenchmark"));
+		}
+		return;
+	}
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	const FTransform& Transform = GetActorTransform();
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	Agents.Reset(NumAgents);
+	for (int32 i = 0; i < NumAgents; ++i)
+	{
+		const FVector Base = Transform.TransformPosition(SpawnPoints[i % SpawnPoints.Num()]);
+		FVector Location = Base + FVector(FMath::RandPointInCircle(SpawnRadius), 0.0f);
+
+		FNavLocation Projected;
+		if (NavSys && NavSys->ProjectPointToNavigation(Location, Projected))
+		{
+			Location = Projected.Location;
+		}
+
+		ANPC* NPC = World->SpawnActor<ANPC>(NPCClass, Location + FVector(0.0f, 0.0f, 100.0f), FRotator::ZeroRotator, SpawnParams);
+		if (!NPC)
+		{
+			continue;
+		}
+
+		if (!NPC->GetController())
+		{
+			NPC->SpawnDefaultController();
+		}
+
+		FAgent& Agent = Agents.AddDefaulted_GetRef();
+		Agent.NPC = NPC;
+
+		if ((bRunBehaviorTree || bCompareSignificanceLOD) && !bChaseBenchmark && !bSoakBenchmark)
+		{
+			continue;
+		}
+
+		// Benchmark tự điều khiển move, BT không được chen vào
+		if (AAIController* AICon = NPC->GetController<AAIController>())
+		{
+			if (UBrainComponent* Brain = AICon->GetBrainComponent())
+			{
+				Brain->StopLogic(TEXT("CrowdBenchmark"));
+			}
+		}
+
+		if (bSoakBenchmark)
+		{
+			// BT được bật lại lệch nhau trong TickSoak
+			Agent.StartDelay = FMath::FRandRange(0.0f, SoakStartStagger);
+			Agent.bLogicStarted = false;
+			if (SoakPatrolPath)
+			{
+				NPC->SetPatrolPath(SoakPatrolPath);
+			}
+		}
+		else if (!bChaseBenchmark)
+		{
+			IssueMove(Agent);
+		}
+	}
+
+	ElapsedTime = 0.0f;
+	NumFrames = 0;
+	TotalGameThreadMs = 0.0;
+	MaxGameThreadMs = 0.0;
+	NumStuckEvents = 0;
+	TotalDeviation = 0.0;
+	NumDeviationSamples = 0;
+	NumArrivals = 0;
+
+	if (UNPCSightSubsystem* Sight = UNPCSightSubsystem::Get(this))
+	{
+		Sight->ResetLatencyStats();
+	}
+
+	if (bChaseBenchmark)
+	{
+		for (FChasePhaseStats& PhaseStats : ChasePhaseStats)
+		{
+			PhaseStats = FChasePhaseStats();
+		}
+		ChaseTargetPhase = 0.0f;
+		ChaseTargetLocation = Transform.TransformPosition(SpawnPoints[0]);
+		BeginChasePhase(EChasePhase::PerFrameMoveTo);
+	}
+
+	if (bSoakBenchmark)
+	{
+		BeginSoak();
+	}
+
+	if (bCompareSignificanceLOD)
+	{
+		for (FSignificancePhaseStats& PhaseStats : SignificancePhaseStats)
+		{
+			PhaseStats = FSignificancePhaseStats();
+		}
+
+		// Nửa đầu full rate
+		if (const IConsoleVariable* Significance = IConsoleManager::Get().FindConsoleVariable(TEXT("ai.Significance.Enabled")))
+		{
+			bSignificanceWasEnabled = Significance->GetBool();
+		}
+		SetSignificanceLOD(false);
+	}
+
+	// Dưới -nullrhi không NPC nào được render -> agent xa player sẽ ngủ đông và đứng yên giữa benchmark
+	if (IConsoleVariable* Dormancy = IConsoleManager::Get().FindConsoleVariable(TEXT("ai.Significance.Dormancy")))
+	{
+		bDormancyWasEnabled = Dormancy->GetBool();
+		Dormancy->Set(false, ECVF_SetByCode);
+	}
+
+	if (UAIDecisionTraceSubsystem* Trace = UAIDecisionTraceSubsystem::Get(this))
+	{
+		Trace->ResetStats();
+	}
+
+	if (UNPCAnimationBudgetSubsystem* AnimationBudget = UNPCAnimationBudgetSubsystem::Get(this))
+	{
+		AnimationBudget->ResetStats();
+	}
+
+	bRunning = true;
+	SetActorTickEnabled(true);
+
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: spawned %d/%d agent(s), running for %.0f s"), Agents.Num(), NumAgents, Duration);
+}
+
+void ANPCCrowdBenchmark::StopBenchmark()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	bRunning = false;
+	SetActorTickEnabled(false);
+
+	if (IConsoleVariable* Dormancy = IConsoleManager::Get().FindConsoleVariable(TEXT("ai.Significance.Dormancy")))
+	{
+		Dormancy->Set(bDormancyWasEnabled, ECVF_SetByCode);
+	}
+
+	if (bSoakBenchmark)
+	{
+		EndSoak();
+	}
+
+	if (bCompareSignificanceLOD)
+	{
+		SetSignificanceLOD(bSignificanceWasEnabled);
+	}
+
+	const bool bPassed = ReportResults();
+
+	FString TracePath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("AITraceFile="), TracePath))
+	{
+		if (UAIDecisionTraceSubsystem* Trace = UAIDecisionTraceSubsystem::Get(this))
+		{
+			Trace->Flush(TracePath);
+		}
+	}
+
+	UChaseMovementSubsystem* ChaseMovement = bChaseBenchmark ? UChaseMovementSubsystem::Get(this) : nullptr;
+	for (const FAgent& Agent : Agents)
+	{
+		if (ANPC* NPC = Agent.NPC.Get())
+		{
+			if (AController* Controller = NPC->GetController())
+			{
+				if (ChaseMovement)
+				{
+					ChaseMovement->StopChase(Cast<AAIController>(Controller));
+				}
+				Controller->Destroy();
+			}
+			NPC->Destroy();
+		}
+	}
+	Agents.Reset();
+
+	if (bQuitWhenDone)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, bPassed ? 0 : 1, TEXT("CrowdBenchmark"));
+	}
+}
+
+// ============================================
+// TEST MAP
+// ============================================
+
+AActor* ANPCCrowdBenchmark::SpawnTestBlock(UStaticMesh* Mesh, const FVector& LocalCenter, const FVector& Size)
+{
+	// Cube của engine cạnh 100 cm, tâm ở giữa
+	const FTransform BlockTransform(FRotator::ZeroRotator, GetActorTransform().TransformPosition(LocalCenter), Size / 100.0f);
+
+	AStaticMeshActor* Block = GetWorld()->SpawnActorDeferred<AStaticMeshActor>(AStaticMeshActor::StaticClass(), BlockTransform, this);
+	if (!Block)
+	{
+		return nullptr;
+	}
+
+	Block->GetStaticMeshComponent()->SetStaticMesh(Mesh);
+	Block->GetStaticMeshComponent()->SetCanEverAffectNavigation(true);
+	Block->SetFlags(RF_Transient);
+	Block->FinishSpawning(BlockTransform);
+	return Block;
+}
+
+bool ANPCCrowdBenchmark::GenerateTestMap()
+{
+	UWorld* World = GetWorld();
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!NavSys || !Cube)
+	{
+		UE_LOG(LogEscapeIT, Error, TEXT("CrowdBenchmark: cannot generate the test map (%s)"), NavSys ? TEXT("missing /Engine/BasicShapes/Cube") : TEXT("no navigation system"));
+		return false;
+	}
+
+	const float HalfX = TestMapSize.X * 0.5f;
+	const float HalfY = TestMapSize.Y * 0.5f;
+	const float Height = NPCCrowdBenchmark::TestMapWallHeight;
+	const float Thickness = NPCCrowdBenchmark::TestMapWallThickness;
+
+	// ---- Navmesh: dynamic để build được lúc runtime, trước geometry để octree gom được mọi block ----
+	if (!NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate))
+	{
+		FActorSpawnParameters NavParams;
+		NavParams.bDeferConstruction = true;
+		NavParams.ObjectFlags |= RF_Transient;
+		if (ARecastNavMesh* NavMesh = World->SpawnActor<ARecastNavMesh>(NavParams))
+		{
+			// RuntimeGeneration không có setter public ngoài editor
+			if (const FEnumProperty* RuntimeGeneration = FindFProperty<FEnumProperty>(ANavigationData::StaticClass(), TEXT("RuntimeGeneration")))
+			{
+				RuntimeGeneration->GetUnderlyingProperty()->SetIntPropertyValue(
+					RuntimeGeneration->ContainerPtrToValuePtr<void>(NavMesh), static_cast<int64>(ERuntimeGenerationType::Dynamic));
+			}
+			NavMesh->FinishSpawning(FTransform::Identity);
+		}
+	}
+
+	// ---- Sàn + tường bao ----
+	SpawnTestBlock(Cube, FVector(0.0f, 0.0f, -50.0f), FVector(TestMapSize.X, TestMapSize.Y, 100.0f));
+	SpawnTestBlock(Cube, FVector(0.0f, HalfY, Height * 0.5f), FVector(TestMapSize.X, Thickness, Height));
+	SpawnTestBlock(Cube, FVector(0.0f, -HalfY, Height * 0.5f), FVector(TestMapSize.X, Thickness, Height));
+	SpawnTestBlock(Cube, FVector(HalfX, 0.0f, Height * 0.5f), FVector(Thickness, TestMapSize.Y, Height));
+	SpawnTestBlock(Cube, FVector(-HalfX, 0.0f, Height * 0.5f), FVector(Thickness, TestMapSize.Y, Height));
+
+	// ---- Tường ngăn ở X = 0, hở hai chỗ hẹp ở Y = ±HalfY/2 ----
+	const float Chokepoint = FMath::Min(TestMapChokepointWidth, HalfY * 0.5f);
+	const float GapY = HalfY * 0.5f;
+	const float OuterLength = HalfY - GapY - Chokepoint * 0.5f;
+	const float InnerLength = 2.0f * (GapY - Chokepoint * 0.5f);
+	SpawnTestBlock(Cube, FVector(0.0f, HalfY - OuterLength * 0.5f, Height * 0.5f), FVector(Thickness, OuterLength, Height));
+	SpawnTestBlock(Cube, FVector(0.0f, -HalfY + OuterLength * 0.5f, Height * 0.5f), FVector(Thickness, OuterLength, Height));
+	SpawnTestBlock(Cube, FVector(0.0f, 0.0f, Height * 0.5f), FVector(Thickness, InnerLength, Height));
+
+	// ---- Bounds volume: brush lấy bounds từ BodySetup dựng bằng code (không có BSP ngoài editor) ----
+	const FVector BoundsExtent(HalfX + 200.0f, HalfY + 200.0f, Height + 200.0f);
+	FActorSpawnParameters BoundsParams;
+	BoundsParams.bDeferConstruction = true;
+	BoundsParams.ObjectFlags |= RF_Transient;
+	ANavMeshBoundsVolume* Bounds = World->SpawnActor<ANavMeshBoundsVolume>(GetActorLocation(), GetActorRotation(), BoundsParams);
+	if (!Bounds)
+	{
+		UE_LOG(LogEscapeIT, Error, TEXT("CrowdBenchmark: cannot spawn the test map navmesh bounds"));
+		return false;
+	}
+
+	UBrushComponent* BrushComponent = Bounds->GetBrushComponent();
+	UBodySetup* BodySetup = NewObject<UBodySetup>(BrushComponent);
+	BodySetup->AggGeom.BoxElems.Add(FKBoxElem(BoundsExtent.X * 2.0f, BoundsExtent.Y * 2.0f, BoundsExtent.Z * 2.0f));
+	BrushComponent->BrushBodySetup = BodySetup;
+	Bounds->FinishSpawning(GetActorTransform());
+	BrushComponent->UpdateBounds();
+	NavSys->OnNavigationBoundsUpdated(Bounds);
+	NavSys->Build();
+
+	// ---- Điểm spawn/goal ở hai phòng, patrol path vòng qua cả hai chỗ hẹp ----
+	const float RoomX = HalfX * 0.6f;
+	SpawnPoints = { FVector(-RoomX, -GapY, 0.0f), FVector(-RoomX, 0.0f, 0.0f), FVector(-RoomX, GapY, 0.0f) };
+	GoalPoints = { FVector(RoomX, -GapY, 0.0f), FVector(RoomX, 0.0f, 0.0f), FVector(RoomX, GapY, 0.0f) };
+	SpawnRadius = FMath::Min(SpawnRadius, GapY * 0.8f);
+
+	if (!SoakPatrolPath)
+	{
+		FActorSpawnParameters PathParams;
+		PathParams.ObjectFlags |= RF_Transient;
+		if (APaTrolPath* PatrolPath = World->SpawnActor<APaTrolPath>(GetActorLocation(), GetActorRotation(), PathParams))
+		{
+			PatrolPath->SetPatrolPoints({
+				FVector(-RoomX, -GapY, 0.0f), FVector(0.0f, -GapY, 0.0f), FVector(RoomX, -GapY, 0.0f),
+				FVector(RoomX, GapY, 0.0f), FVector(0.0f, GapY, 0.0f), FVector(-RoomX, GapY, 0.0f) });
+			SoakPatrolPath = PatrolPath;
+		}
+	}
+
+	bTestMapGenerated = true;
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: generated %.0fx%.0f cm test map with two %.0f cm chokepoints, building navmesh"),
+		TestMapSize.X, TestMapSize.Y, Chokepoint);
+	return true;
+}
+
+bool ANPCCrowdBenchmark::IsTestNavMeshReady() const
+{
+	const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!NavSys || NavSys->IsNavigationBuildInProgress())
+	{
+		return false;
+	}
+
+	// Build xong nhưng chưa có tile ở chỗ spawn -> chưa xong thật
+	FNavLocation Projected;
+	return NavSys->ProjectPointToNavigation(GetActorTransform().TransformPosition(SpawnPoints[0]), Projected);
+}
+
+void ANPCCrowdBenchmark::IssueMove(FAgent& Agent) const
+{
+	ANPC* NPC = Agent.NPC.Get();
+	AAIController* AICon = NPC ? NPC->GetController<AAIController>() : nullptr;
+	if (!AICon)
+	{
+		return;
+	}
+
+	const TArray<FVector>& Targets = Agent.bHeadingToGoal ? GoalPoints : SpawnPoints;
+	const FVector Target = GetActorTransform().TransformPosition(Targets[FMath::RandHelper(Targets.Num())]);
+
+	FAIMoveRequest MoveRequest(Target);
+	MoveRequest.SetAcceptanceRadius(SpawnRadius * 0.5f);
+	AICon->MoveTo(MoveRequest);
+}
+
+void ANPCCrowdBenchmark::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bWaitingForNavMesh)
+	{
+		NavMeshWaitTime += DeltaSeconds;
+		if (IsTestNavMeshReady() || NavMeshWaitTime >= NPCCrowdBenchmark::MaxNavMeshWaitSeconds)
+		{
+			if (!IsTestNavMeshReady())
+			{
+				UE_LOG(LogEscapeIT, Warning, TEXT("CrowdBenchmark: test map navmesh still building after %.0f s, starting anyway"), NavMeshWaitTime);
+			}
+			bWaitingForNavMesh = false;
+			SetActorTickEnabled(false);
+			StartBenchmark();
+		}
+		return;
+	}
+
+	if (!bRunning)
+	{
+		return;
+	}
+
+	ElapsedTime += DeltaSeconds;
+
+	// Thời gian game thread của frame trước (gồm cả crowd manager, movement, BT của mọi NPC)
+	const double GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	TotalGameThreadMs += GameThreadMs;
+	MaxGameThreadMs = FMath::Max(MaxGameThreadMs, GameThreadMs);
+	++NumFrames;
+
+	if (bChaseBenchmark)
+	{
+		TickChase(DeltaSeconds, GameThreadMs);
+		if (ElapsedTime >= Duration)
+		{
+			StopBenchmark();
+		}
+		return;
+	}
+
+	if (bSoakBenchmark)
+	{
+		TickSoak(DeltaSeconds);
+		if (ElapsedTime >= Duration)
+		{
+			StopBenchmark();
+		}
+		return;
+	}
+
+	if (bCompareSignificanceLOD)
+	{
+		TickSignificanceComparison(GameThreadMs);
+		if (ElapsedTime >= Duration)
+		{
+			StopBenchmark();
+		}
+		return;
+	}
+
+	// BT tự điều khiển NPC -> chỉ đo chi phí frame
+	if (bRunBehaviorTree)
+	{
+		if (ElapsedTime >= Duration)
+		{
+			StopBenchmark();
+		}
+		return;
+	}
+
+	for (FAgent& Agent : Agents)
+	{
+		const ANPC* NPC = Agent.NPC.Get();
+		const AAIController* AICon = NPC ? NPC->GetController<AAIController>() : nullptr;
+		const UPathFollowingComponent* PathFollowing = AICon ? AICon->GetPathFollowingComponent() : nullptr;
+		if (!PathFollowing)
+		{
+			continue;
+		}
+
+		// Move xong (tới nơi hoặc fail) -> quay đầu
+		if (PathFollowing->GetStatus() == EPathFollowingStatus::Idle)
+		{
+			NumArrivals += PathFollowing->DidMoveReachGoal() ? 1 : 0;
+			Agent.bHeadingToGoal = !Agent.bHeadingToGoal;
+			Agent.SlowTime = 0.0f;
+			IssueMove(Agent);
+			continue;
+		}
+
+		// ---- Độ lệch khỏi đoạn path đang đi ----
+		const FNavPathSharedPtr Path = PathFollowing->GetPath();
+		const int32 NextIndex = PathFollowing->GetNextPathIndex();
+		if (Path.IsValid() && NextIndex > 0 && NextIndex < Path->GetPathPoints().Num())
+		{
+			const TArray<FNavPathPoint>& PathPoints = Path->GetPathPoints();
+			TotalDeviation += FMath::PointDistToSegment(NPC->GetNavAgentLocation(), PathPoints[NextIndex - 1].Location, PathPoints[NextIndex].Location);
+			++NumDeviationSamples;
+		}
+
+		// ---- Kẹt: có move mà gần như đứng yên ----
+		if (NPC->GetVelocity().Size2D() < StuckSpeed)
+		{
+			Agent.SlowTime += DeltaSeconds;
+			if (Agent.SlowTime >= StuckTime && !Agent.bCountedStuck)
+			{
+				Agent.bCountedStuck = true;
+				Agent.bEverStuck = true;
+				++NumStuckEvents;
+			}
+		}
+		else
+		{
+			Agent.SlowTime = 0.0f;
+			Agent.bCountedStuck = false;
+		}
+	}
+
+	if (ElapsedTime >= Duration)
+	{
+		StopBenchmark();
+	}
+}
+
+// ============================================
+// CHASE
+// ============================================
+
+void ANPCCrowdBenchmark::BeginChasePhase(EChasePhase Phase)
+{
+	ChasePhase = Phase;
+
+	UChaseMovementSubsystem* ChaseMovement = UChaseMovementSubsystem::Get(this);
+	if (Phase != EChasePhase::Throttled || !ChaseMovement)
+	{
+		return;
+	}
+
+	// Số liệu subsystem chỉ tính từ đầu nửa sau
+	ChaseMovement->ResetStats();
+
+	const FChaseRepathSettings Settings;
+	for (const FAgent& Agent : Agents)
+	{
+		const ANPC* NPC = Agent.NPC.Get();
+		if (AAIController* AICon = NPC ? NPC->GetController<AAIController>() : nullptr)
+		{
+			ChaseMovement->StartChase(AICon, Settings);
+			ChaseMovement->SetChaseTarget(AICon, nullptr, ChaseTargetLocation);
+		}
+	}
+}
+
+void ANPCCrowdBenchmark::TickChase(float DeltaSeconds, double GameThreadMs)
+{
+	const EChasePhase Phase = ElapsedTime < Duration * 0.5f ? EChasePhase::PerFrameMoveTo : EChasePhase::Throttled;
+	if (Phase != ChasePhase)
+	{
+		BeginChasePhase(Phase);
+	}
+
+	FChasePhaseStats& PhaseStats = ChasePhaseStats[(int32)ChasePhase];
+	++PhaseStats.NumFrames;
+	PhaseStats.Seconds += DeltaSeconds;
+	PhaseStats.TotalGameThreadMs += GameThreadMs;
+	PhaseStats.MaxGameThreadMs = FMath::Max(PhaseStats.MaxGameThreadMs, GameThreadMs);
+
+	// Target chạy qua lại giữa spawn và goal như player bị đuổi qua chỗ hẹp
+	const FTransform& Transform = GetActorTransform();
+	const FVector From = Transform.TransformPosition(SpawnPoints[0]);
+	const FVector To = Transform.TransformPosition(GoalPoints[0]);
+	const float Length = FMath::Max(FVector::Dist(From, To), 1.0f);
+	ChaseTargetPhase = FMath::Fmod(ChaseTargetPhase + DeltaSeconds * ChaseTargetSpeed / Length, 2.0f);
+	ChaseTargetLocation = FMath::Lerp(From, To, ChaseTargetPhase <= 1.0f ? ChaseTargetPhase : 2.0f - ChaseTargetPhase);
+
+	UChaseMovementSubsystem* ChaseMovement = UChaseMovementSubsystem::Get(this);
+	const float AcceptanceRadius = FChaseRepathSettings().AcceptanceRadius;
+
+	for (const FAgent& Agent : Agents)
+	{
+		const ANPC* NPC = Agent.NPC.Get();
+		AAIController* AICon = NPC ? NPC->GetController<AAIController>() : nullptr;
+		if (!AICon)
+		{
+			continue;
+		}
+
+		if (ChasePhase == EChasePhase::Throttled)
+		{
+			if (ChaseMovement)
+			{
+				ChaseMovement->SetChaseTarget(AICon, nullptr, ChaseTargetLocation);
+			}
+			continue;
+		}
+
+		// Như BTTask_ChasePlayer cũ: MoveToLocation có pathfinding mỗi frame
+		FAIMoveRequest MoveRequest(ChaseTargetLocation);
+		MoveRequest.SetAcceptanceRadius(AcceptanceRadius);
+		MoveRequest.SetProjectGoalLocation(false);
+		MoveRequest.SetAllowPartialPath(true);
+		if (AICon->MoveTo(MoveRequest).Code == EPathFollowingRequestResult::RequestSuccessful)
+		{
+			++PhaseStats.PathSearches;
+		}
+	}
+
+	if (ChasePhase == EChasePhase::Throttled && ChaseMovement)
+	{
+		const FChaseMovementStats ChaseStats = ChaseMovement->GetStats();
+		PhaseStats.PathSearches = ChaseStats.PathSearches;
+		PhaseStats.DirectMoves = ChaseStats.DirectMoves;
+		PhaseStats.CorridorReuses = ChaseStats.CorridorReuses;
+		PhaseStats.Deferred = ChaseStats.Deferred;
+	}
+}
+
+void ANPCCrowdBenchmark::ReportChaseResults() const
+{
+	static const TCHAR* PhaseNames[] = { TEXT("per-frame MoveTo"), TEXT("chase subsystem") };
+	static_assert(UE_ARRAY_COUNT(PhaseNames) == (int32)EChasePhase::Num, "Missing chase phase name");
+
+	double SearchesPerSecond[(int32)EChasePhase::Num] = {};
+	for (int32 i = 0; i < (int32)EChasePhase::Num; ++i)
+	{
+		const FChasePhaseStats& PhaseStats = ChasePhaseStats[i];
+		const float Seconds = FMath::Max(PhaseStats.Seconds, KINDA_SMALL_NUMBER);
+		SearchesPerSecond[i] = PhaseStats.PathSearches / Seconds;
+
+		UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: chase %s, %.1f s: %.1f path search(es)/s, %.1f direct move(s)/s, %.1f corridor reuse(s)/s, %d deferred, game thread avg %.2f ms, max %.2f ms"),
+			PhaseNames[i], PhaseStats.Seconds, SearchesPerSecond[i], PhaseStats.DirectMoves / Seconds, PhaseStats.CorridorReuses / Seconds, PhaseStats.Deferred,
+			PhaseStats.TotalGameThreadMs / FMath::Max(PhaseStats.NumFrames, 1), PhaseStats.MaxGameThreadMs);
+	}
+
+	const double Throttled = SearchesPerSecond[(int32)EChasePhase::Throttled];
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: chase subsystem issues %.1fx fewer path searches"),
+		Throttled > 0.0 ? SearchesPerSecond[(int32)EChasePhase::PerFrameMoveTo] / Throttled : 0.0);
+}
+
+// ============================================
+// SIGNIFICANCE LOD
+// ============================================
+
+void ANPCCrowdBenchmark::SetSignificanceLOD(bool bEnabled)
+{
+	if (IConsoleVariable* Significance = IConsoleManager::Get().FindConsoleVariable(TEXT("ai.Significance.Enabled")))
+	{
+		Significance->Set(bEnabled, ECVF_SetByCode);
+	}
+	bSignificanceLODActive = bEnabled;
+	SignificancePhaseStartTime = ElapsedTime;
+}
+
+void ANPCCrowdBenchmark::TickSignificanceComparison(double GameThreadMs)
+{
+	const bool bLODPhase = ElapsedTime >= Duration * 0.5f;
+	if (bLODPhase != bSignificanceLODActive)
+	{
+		SetSignificanceLOD(bLODPhase);
+	}
+
+	if (ElapsedTime - SignificancePhaseStartTime < WarmupSeconds)
+	{
+		return;
+	}
+
+	FSignificancePhaseStats& PhaseStats = SignificancePhaseStats[bLODPhase ? 1 : 0];
+	++PhaseStats.NumFrames;
+	PhaseStats.TotalGameThreadMs += GameThreadMs;
+	PhaseStats.MaxGameThreadMs = FMath::Max(PhaseStats.MaxGameThreadMs, GameThreadMs);
+
+	if (const UAISignificanceSubsystem* Significance = UAISignificanceSubsystem::Get(this))
+	{
+		for (int32 i = 0; i < static_cast<int32>(EAISignificance::Count); ++i)
+		{
+			PhaseStats.LevelSamples[i] += Significance->GetNumInLevel(static_cast<EAISignificance>(i));
+		}
+	}
+}
+
+void ANPCCrowdBenchmark::ReportSignificanceResults() const
+{
+	const int32 SafeAgents = FMath::Max(Agents.Num(), 1);
+	double AverageMs[2] = {};
+
+	for (int32 Phase = 0; Phase < 2; ++Phase)
+	{
+		const FSignificancePhaseStats& PhaseStats = SignificancePhaseStats[Phase];
+		const int32 SafeFrames = FMath::Max(PhaseStats.NumFrames, 1);
+		AverageMs[Phase] = PhaseStats.TotalGameThreadMs / SafeFrames;
+
+		const auto AverageInLevel = [&PhaseStats, SafeFrames](EAISignificance Level)
+		{
+			return static_cast<double>(PhaseStats.LevelSamples[static_cast<int32>(Level)]) / SafeFrames;
+		};
+
+		UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: significance LOD %s, %d frame(s): game thread avg %.2f ms (%.4f ms per agent), max %.2f ms; agents per level critical %.1f, high %.1f, medium %.1f, low %.1f, dormant %.1f"),
+			Phase == 0 ? TEXT("off") : TEXT("on"), PhaseStats.NumFrames, AverageMs[Phase], AverageMs[Phase] / SafeAgents, PhaseStats.MaxGameThreadMs,
+			AverageInLevel(EAISignificance::Critical), AverageInLevel(EAISignificance::High), AverageInLevel(EAISignificance::Medium),
+			AverageInLevel(EAISignificance::Low), AverageInLevel(EAISignificance::Dormant));
+	}
+
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: significance LOD saves %.2f ms per frame (%.1f%%)"),
+		AverageMs[0] - AverageMs[1], AverageMs[0] > 0.0 ? 100.0 * (AverageMs[0] - AverageMs[1]) / AverageMs[0] : 0.0);
+}
+
+// ============================================
+// SOAK
+// ============================================
+
+void ANPCCrowdBenchmark::BeginSoak()
+{
+	NumLookAroundSamples = 0;
+	NumPathIndexSteps = 0;
+	NumCrowdPathSamples = 0;
+	NumSoakViolations = 0;
+	SoakNodeSnapshots.Reset();
+	SoakPathIndexTask.Reset();
+	SoakPathIndexKey = NAME_None;
+
+	// Mọi agent cùng một tick cố định -> so được timer trong NodeMemory với thời gian mô phỏng
+	bSoakFixedStepWasEnabled = FApp::UseFixedTimeStep();
+	SoakSavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(SoakStepSeconds);
+
+	const ANPC* FirstNPC = Agents.Num() > 0 ? Agents[0].NPC.Get() : nullptr;
+	const UBehaviorTree* Tree = FirstNPC ? FirstNPC->GetBehaviorTree() : nullptr;
+	if (!Tree)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("CrowdBenchmark: soak has no behavior tree to check"));
+		return;
+	}
+
+	// Load tree trước khi chụp: InitializeFromAsset/InitializeMemory của node chạy ở đây, không phải lúc soak
+	UBTCompositeNode* Root = Tree->RootNode;
+	if (UBehaviorTreeManager* BTManager = UBehaviorTreeManager::GetCurrent(GetWorld()))
+	{
+		uint16 InstanceMemorySize = 0;
+		BTManager->LoadTree(*const_cast<UBehaviorTree*>(Tree), Root, InstanceMemorySize);
+	}
+
+	TArray<const UBTNode*> Nodes;
+	NPCCrowdBenchmark::CollectNodes(Root, Nodes);
+
+	for (const UBTNode* Node : Nodes)
+	{
+		// Node instanced có object riêng cho từng agent
+		if (!Node->IsInstanced())
+		{
+			SoakNodeSnapshots.Add({ Node, NPCCrowdBenchmark::SnapshotNodeBytes(Node) });
+		}
+
+		const UBTTask_IncrementPathIndex* PathIndexTask = Cast<UBTTask_IncrementPathIndex>(Node);
+		if (PathIndexTask && !SoakPathIndexTask.IsValid())
+		{
+			SoakPathIndexTask = PathIndexTask;
+			SoakPathIndexKey = PathIndexTask->GetSelectedBlackboardKey();
+		}
+	}
+
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: soak %s, %d shared node(s), step %.4f s, start stagger %.1f s"),
+		*Tree->GetName(), SoakNodeSnapshots.Num(), SoakStepSeconds, SoakStartStagger);
+}
+
+void ANPCCrowdBenchmark::EndSoak()
+{
+	FApp::SetUseFixedTimeStep(bSoakFixedStepWasEnabled);
+	FApp::SetFixedDeltaTime(SoakSavedFixedDeltaTime);
+
+	for (const FSoakNodeSnapshot& Snapshot : SoakNodeSnapshots)
+	{
+		const UBTNode* Node = Snapshot.Node.Get();
+		const int32 ChangedOffset = Node ? NPCCrowdBenchmark::FindChangedOffset(Node, Snapshot.Bytes) : INDEX_NONE;
+		if (ChangedOffset != INDEX_NONE)
+		{
+			++NumSoakViolations;
+			UE_LOG(LogEscapeIT, Error, TEXT("CrowdBenchmark: shared node %s (%s) changed its members during the soak (first at byte %d); per-agent state belongs in NodeMemory"),
+				*Node->GetNodeName(), *Node->GetClass()->GetName(), ChangedOffset);
+		}
+	}
+	SoakNodeSnapshots.Reset();
+}
+
+void ANPCCrowdBenchmark::TickSoak(float DeltaSeconds)
+{
+	for (FAgent& Agent : Agents)
+	{
+		ANPC* NPC = Agent.NPC.Get();
+		AAIController* AICon = NPC ? NPC->GetController<AAIController>() : nullptr;
+		UBehaviorTreeComponent* BTComp = AICon ? Cast<UBehaviorTreeComponent>(AICon->GetBrainComponent()) : nullptr;
+		if (!BTComp)
+		{
+			continue;
+		}
+
+		if (!Agent.bLogicStarted)
+		{
+			if (ElapsedTime >= Agent.StartDelay)
+			{
+				StartSoakAgent(Agent, *NPC, *BTComp);
+			}
+			continue;
+		}
+
+		if (BTComp->IsRunning())
+		{
+			CheckSoakAgent(Agent, *NPC, *BTComp, DeltaSeconds);
+		}
+	}
+}
+
+void ANPCCrowdBenchmark::StartSoakAgent(FAgent& Agent, ANPC& NPC, UBehaviorTreeComponent& BTComp)
+{
+	Agent.bLogicStarted = true;
+
+	// Mỗi agent bắt đầu patrol ở một điểm khác nhau
+	const APaTrolPath* PatrolPath = NPC.GetPatrolPath();
+	UBlackboardComponent* BB = BTComp.GetBlackboardComponent();
+	if (BB && PatrolPath && PatrolPath->Num() > 0 && !SoakPathIndexKey.IsNone())
+	{
+		BB->SetValueAsInt(SoakPathIndexKey, FMath::RandHelper(PatrolPath->Num()));
+	}
+
+	if (UBehaviorTree* Tree = NPC.GetBehaviorTree())
+	{
+		BTComp.StartTree(*Tree, EBTExecutionMode::Looped);
+	}
+}
+
+void ANPCCrowdBenchmark::CheckSoakAgent(FAgent& Agent, const ANPC& NPC, UBehaviorTreeComponent& BTComp, float DeltaSeconds)
+{
+	// ---- LookAround: timer của agent không thể chạy nhanh hơn thời gian mô phỏng ----
+	if (const UBTTask_LookAround* LookAround = Cast<UBTTask_LookAround>(BTComp.GetActiveNode()))
+	{
+		const FBTLookAroundMemory* Memory = reinterpret_cast<const FBTLookAroundMemory*>(
+			BTComp.GetNodeMemory(const_cast<UBTTask_LookAround*>(LookAround), BTComp.GetActiveInstanceIdx()));
+		const float Elapsed = Memory->ElapsedTime;
+
+		if (Agent.LookAroundBaseElapsed < 0.0f || Elapsed < Agent.LastLookAroundElapsed)
+		{
+			// Vừa vào (hoặc vào lại) LookAround
+			Agent.LookAroundBaseElapsed = Elapsed;
+			Agent.LookAroundObservedTime = 0.0f;
+		}
+		else
+		{
+			Agent.LookAroundObservedTime += DeltaSeconds;
+			++NumLookAroundSamples;
+
+			// Timer dùng chung cộng delta của mọi agent đang LookAround; cho lệch một frame vì thứ tự tick
+			const float Advanced = Elapsed - Agent.LookAroundBaseElapsed;
+			if (Advanced > Agent.LookAroundObservedTime + DeltaSeconds + 0.01f)
+			{
+				AddSoakViolation(Agent, FString::Printf(TEXT("LookAround timer advanced %.2f s in %.2f s"), Advanced, Agent.LookAroundObservedTime));
+				Agent.LookAroundBaseElapsed = Elapsed;
+				Agent.LookAroundObservedTime = 0.0f;
+			}
+		}
+		Agent.LastLookAroundElapsed = Elapsed;
+	}
+	else
+	{
+		Agent.LookAroundBaseElapsed = -1.0f;
+	}
+
+	// ---- Crowd simulation: path đang đi phải có corridor navmesh (segment bake chỉ có điểm) ----
+	const AAIController* AICon = Cast<AAIController>(NPC.GetController());
+	const UCrowdFollowingComponent* CrowdFollowing = AICon ? Cast<UCrowdFollowingComponent>(AICon->GetPathFollowingComponent()) : nullptr;
+	if (CrowdFollowing && CrowdFollowing->IsCrowdSimulationEnabled() && CrowdFollowing->GetStatus() == EPathFollowingStatus::Moving)
+	{
+		const FNavPathSharedPtr& Path = CrowdFollowing->GetPath();
+		++NumCrowdPathSamples;
+
+		if (!Path.IsValid() || !Path->CastPath<FNavMeshPath>())
+		{
+			AddSoakViolation(Agent, TEXT("crowd-simulated move is following a path without a navmesh corridor"));
+		}
+	}
+
+	// ---- IncrementPathIndex: bước ±1, chỉ đổi chiều ở hai đầu, khớp chiều trong NodeMemory của agent ----
+	const UBTTask_IncrementPathIndex* PathIndexTask = SoakPathIndexTask.Get();
+	const APaTrolPath* PatrolPath = NPC.GetPatrolPath();
+	const UBlackboardComponent* BB = BTComp.GetBlackboardComponent();
+	const int32 NumPoints = PatrolPath ? PatrolPath->Num() : 0;
+	if (!PathIndexTask || !BB || NumPoints < 2)
+	{
+		return;
+	}
+
+	const int32 Index = BB->GetValueAsInt(SoakPathIndexKey);
+	if (Index < 0 || Index >= NumPoints)
+	{
+		AddSoakViolation(Agent, FString::Printf(TEXT("patrol index %d out of range [0, %d)"), Index, NumPoints));
+	}
+
+	if (Agent.LastPathIndex != INDEX_NONE && Index != Agent.LastPathIndex)
+	{
+		const bool bBiDirectional = PathIndexTask->IsBiDirectional();
+		int32 Step = Index - Agent.LastPathIndex;
+		if (!bBiDirectional && Step == -(NumPoints - 1))
+		{
+			// Vòng lại từ điểm cuối về điểm đầu
+			Step = 1;
+		}
+		++NumPathIndexSteps;
+
+		if (FMath::Abs(Step) != 1 || (!bBiDirectional && Step != 1))
+		{
+			AddSoakViolation(Agent, FString::Printf(TEXT("patrol index jumped %d -> %d"), Agent.LastPathIndex, Index));
+		}
+		else if (bBiDirectional)
+		{
+			const bool bAtEnd = Agent.LastPathIndex == 0 || Agent.LastPathIndex == NumPoints - 1;
+			if (Agent.LastPathStep != 0 && Step != Agent.LastPathStep && !bAtEnd)
+			{
+				AddSoakViolation(Agent, FString::Printf(TEXT("patrol direction reversed mid-path at index %d"), Agent.LastPathIndex));
+			}
+
+			// Instance 0 là tree gốc của NPC
+			const FBTIncrementPathIndexMemory* Memory = reinterpret_cast<const FBTIncrementPathIndexMemory*>(
+				BTComp.GetNodeMemory(const_cast<UBTTask_IncrementPathIndex*>(PathIndexTask), 0));
+			if (Memory && Memory->bReverse != (Step < 0))
+			{
+				AddSoakViolation(Agent, FString::Printf(TEXT("patrol direction in NodeMemory (%s) disagrees with step %d"),
+					Memory->bReverse ? TEXT("reverse") : TEXT("forward"), Step));
+			}
+		}
+
+		Agent.LastPathStep = Step;
+	}
+	Agent.LastPathIndex = Index;
+}
+
+void ANPCCrowdBenchmark::AddSoakViolation(const FAgent& Agent, const FString& Description)
+{
+	if (NumSoakViolations++ < NPCCrowdBenchmark::MaxLoggedSoakViolations)
+	{
+		UE_LOG(LogEscapeIT, Error, TEXT("CrowdBenchmark: soak %s at %.2f s: %s"),
+			Agent.NPC.IsValid() ? *Agent.NPC->GetName() : TEXT("<destroyed>"), ElapsedTime, *Description);
+	}
+}
+
+bool ANPCCrowdBenchmark::ReportSoakResults() const
+{
+	const int32 SafeFrames = FMath::Max(NumFrames, 1);
+	const int32 SafeAgents = FMath::Max(Agents.Num(), 1);
+
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: soak %.4f ms per agent per frame (game thread avg %.2f ms, %d agent(s), step %.4f s)"),
+		TotalGameThreadMs / SafeFrames / SafeAgents, TotalGameThreadMs / SafeFrames, Agents.Num(), SoakStepSeconds);
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: soak checked %d LookAround sample(s), %d patrol index step(s), %d crowd path sample(s), %d violation(s)"),
+		NumLookAroundSamples, NumPathIndexSteps, NumCrowdPathSamples, NumSoakViolations);
+
+	if (NumLookAroundSamples == 0 && NumPathIndexSteps == 0)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("CrowdBenchmark: soak never observed LookAround or IncrementPathIndex; check the map and SoakPatrolPath"));
+	}
+
+	return NumSoakViolations == 0;
+}
+
+bool ANPCCrowdBenchmark::ReportResults() const
+{
+	int32 NumStuckAgents = 0;
+	for (const FAgent& Agent : Agents)
+	{
+		NumStuckAgents += Agent.bEverStuck ? 1 : 0;
+	}
+
+	const int32 SafeFrames = FMath::Max(NumFrames, 1);
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: %d agent(s), %.1f s, %d frame(s)"), Agents.Num(), ElapsedTime, NumFrames);
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: game thread avg %.2f ms, max %.2f ms"), TotalGameThreadMs / SafeFrames, MaxGameThreadMs);
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: %d stuck event(s), %d/%d agent(s) stuck at least once, %d arrival(s)"),
+		NumStuckEvents, NumStuckAgents, Agents.Num(), NumArrivals);
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: average path deviation %.1f cm"),
+		NumDeviationSamples > 0 ? TotalDeviation / NumDeviationSamples : 0.0);
+
+	if (bChaseBenchmark)
+	{
+		ReportChaseResults();
+	}
+
+	if (bCompareSignificanceLOD)
+	{
+		ReportSignificanceResults();
+	}
+
+	if (const UAIDecisionTraceSubsystem* Trace = UAIDecisionTraceSubsystem::IsEnabled() ? UAIDecisionTraceSubsystem::Get(this) : nullptr)
+	{
+		const FAIDecisionTraceStats& TraceStats = Trace->GetStats();
+		const double TraceMs = TraceStats.RecordSeconds * 1000.0;
+		UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: decision trace %lld record(s), %.3f ms/frame (%.2f%% of game thread), %.0f ns/record"),
+			TraceStats.NumRecords, TraceMs / SafeFrames, TotalGameThreadMs > 0.0 ? 100.0 * TraceMs / TotalGameThreadMs : 0.0,
+			TraceStats.NumRecords > 0 ? TraceStats.RecordSeconds * 1.0e9 / TraceStats.NumRecords : 0.0);
+	}
+
+	const bool bSoakPassed = !bSoakBenchmark || ReportSoakResults();
+	const bool bAnimationPassed = ReportAnimationBudget();
+
+	const UNPCSightSubsystem* Sight = UNPCSightSubsystem::Get(this);
+	if (!Sight)
+	{
+		return bSoakPassed && bAnimationPassed;
+	}
+
+	const FNPCSightLatencyStats SightStats = Sight->GetLatencyStats();
+	const bool bSightPassed = SightStats.MaxLatency <= MaxSightLatency;
+
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: sight %d observer(s), %d detection(s), latency avg %.3f s, max %.3f s (limit %.3f s), %d over budget"),
+		Sight->GetNumObservers(), SightStats.NumDetections, SightStats.AverageLatency, SightStats.MaxLatency, MaxSightLatency, SightStats.NumOverBudget);
+
+	if (!bSightPassed)
+	{
+		UE_LOG(LogEscapeIT, Error, TEXT("CrowdBenchmark: sight detection latency %.3f s exceeds %.3f s"), SightStats.MaxLatency, MaxSightLatency);
+	}
+
+	return bSightPassed && bSoakPassed && bAnimationPassed;
+}
+
+bool ANPCCrowdBenchmark::ReportAnimationBudget() const
+{
+	const UNPCAnimationBudgetSubsystem* AnimationBudget = UNPCAnimationBudgetSubsystem::IsEnabled() ? UNPCAnimationBudgetSubsystem::Get(this) : nullptr;
+	if (!AnimationBudget || AnimationBudget->GetStats().NumFrames == 0)
+	{
+		return true;
+	}
+
+	const FNPCAnimationBudgetStats& Stats = AnimationBudget->GetStats();
+	const float BudgetMs = UNPCAnimationBudgetSubsystem::GetBudgetMs();
+	const int32 NumUnsaturated = Stats.NumFrames - Stats.NumSaturatedFrames;
+	const double AverageUnsaturatedMs = NumUnsaturated > 0 ? Stats.TotalUnsaturatedMs / NumUnsaturated : 0.0;
+
+	UE_LOG(LogEscapeIT, Display, TEXT("CrowdBenchmark: animation %d mesh(es), avg %.3f ms, max %.3f ms (budget %.3f ms), %d/%d frame(s) over budget, %d saturated"),
+		AnimationBudget->GetNumComponents(), Stats.TotalMeasuredMs / Stats.NumFrames, Stats.MaxMeasuredMs, BudgetMs,
+		Stats.NumFramesOverBudget, Stats.NumFrames, Stats.NumSaturatedFrames);
+
+	const bool bPassed = AverageUnsaturatedMs <= BudgetMs * (1.0f + MaxAnimationBudgetOverrun);
+	if (!bPassed)
+	{
+		UE_LOG(LogEscapeIT, Error, TEXT("CrowdBenchmark: animation cost %.3f ms exceeds budget %.3f ms"), AverageUnsaturatedMs, BudgetMs);
+	}
+	return bPassed;
+}
@@ -0,0 +1,326 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NPCSightSubsystem.h"
+#include "AI/NPC_AIController.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "Data/NPCPerceptionProfile.h"
+#include "EscapeIT.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+
+DECLARE_CYCLE_STAT(TEXT("NPCSight Tick"), STAT_NPCSightTick, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("NPC Sight Observers"), STAT_NPCSightObservers, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPC Sight Traces"), STAT_NPCSightTraces, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("NPC Sight Traces Deferred"), STAT_NPCSightDeferred, STATGROUP_EscapeIT);
+
+namespace NPCSight
+{
+	// Kết quả async trace chỉ được giữ một frame; quá hạn thì bỏ handle và trace lại
+	constexpr uint64 MaxTraceFrameAge = 2;
+}
+
+UNPCSightSubsystem* UNPCSightSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UNPCSightSubsystem>() : nullptr;
+}
+
+TStatId UNPCSightSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNPCSightSubsystem, STATGROUP_Tickables);
+}
+
+void UNPCSightSubsystem::Deinitialize()
+{
+	Observers.Empty();
+	ObserverIndices.Empty();
+	Candidates.Empty();
+	SET_DWORD_STAT(STAT_NPCSightObservers, 0);
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// OBSERVERS
+// ============================================
+
+void UNPCSightSubsystem::RegisterObserver(ANPC_AIController* Controller, const FNPCPerceptionSettings& Settings)
+{
+	if (!Controller)
+	{
+		return;
+	}
+
+	FObserver* Observer = nullptr;
+	if (const int32* Index = ObserverIndices.Find(Controller))
+	{
+		Observer = &Observers[*Index];
+	}
+	else
+	{
+		ObserverIndices.Add(Controller, Observers.Num());
+		Observer = &Observers.AddDefaulted_GetRef();
+		Observer->Controller = Controller;
+		Observer->Key = Controller;
+	}
+
+	Observer->SightRadius = Settings.SightRadius;
+	Observer->LoseSightRadius = FMath::Max(Settings.LoseSightRadius, Settings.SightRadius);
+	Observer->CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(Settings.PeripheralVisionAngleDegrees));
+	Observer->AutoSuccessRangeSq = FMath::Square(Settings.AutoSuccessRangeFromLastSeenLocation);
+	Observer->MaxAge = Settings.SightMaxAge;
+
+	SET_DWORD_STAT(STAT_NPCSightObservers, Observers.Num());
+}
+
+void UNPCSightSubsystem::UnregisterObserver(ANPC_AIController* Controller)
+{
+	if (const int32* Index = ObserverIndices.Find(Controller))
+	{
+		RemoveObserverAt(*Index);
+	}
+}
+
+void UNPCSightSubsystem::RemoveObserverAt(int32 Index)
+{
+	// Dùng key: controller đã bị destroy vẫn gỡ được khỏi map
+	ObserverIndices.Remove(Observers[Index].Key);
+	Observers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	if (Observers.IsValidIndex(Index))
+	{
+		ObserverIndices.Add(Observers[Index].Key, Index);
+	}
+
+	SET_DWORD_STAT(STAT_NPCSightObservers, Observers.Num());
+}
+
+void UNPCSightSubsystem::SetObserverEnabled(ANPC_AIController* Controller, bool bEnabled)
+{
+	const int32* Index = ObserverIndices.Find(Controller);
+	if (!Index)
+	{
+		return;
+	}
+
+	FObserver& Observer = Observers[*Index];
+	Observer.bEnabled = bEnabled;
+
+	if (!bEnabled)
+	{
+		Observer.PendingTrace = FTraceHandle();
+		Observer.CandidateSince = -1.0;
+
+		if (Observer.bSeen)
+		{
+			const UWorld* World = GetWorld();
+			SetSeen(Observer, nullptr, false, Observer.LastSeenLocation, World ? World->GetTimeSeconds() : 0.0);
+		}
+	}
+}
+
+void UNPCSightSubsystem::SetSeen(FObserver& Observer, AActor* Target, bool bSeen, const FVector& Location, double Now)
+{
+	if (bSeen)
+	{
+		Observer.LastSeenLocation = Location;
+		Observer.LastSeenTime = Now;
+	}
+
+	if (Observer.bSeen == bSeen)
+	{
+		return;
+	}
+	Observer.bSeen = bSeen;
+
+	if (bSeen && Observer.CandidateSince >= 0.0)
+	{
+		const float Latency = static_cast<float>(Now - Observer.CandidateSince);
+		++NumDetections;
+		TotalLatency += Latency;
+		MaxLatency = FMath::Max(MaxLatency, Latency);
+		NumOverBudget += Latency > MaxDetectionLatency ? 1 : 0;
+	}
+	Observer.CandidateSince = -1.0;
+
+	if (ANPC_AIController* Controller = Observer.Controller.Get())
+	{
+		// Mất dấu khi player đã bị huỷ: controller vẫn cần biết để xoá trạng thái thấy
+		Controller->NotifySightChanged(Target ? Target : Controller->GetPlayerMemory().Actor.Get(), bSeen, Location);
+	}
+}
+
+// ============================================
+// TICK
+// ============================================
+
+void UNPCSightSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_NPCSightTick);
+
+	UWorld* World = GetWorld();
+	if (!World || Observers.Num() == 0)
+	{
+		return;
+	}
+
+	const double Now = World->GetTimeSeconds();
+
+	UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(World);
+	ACharacter* Player = WorldState ? WorldState->GetPlayer() : nullptr;
+
+	// ---- Gỡ controller đã bị huỷ trước, để index trong Candidates ổn định ----
+	for (int32 i = Observers.Num() - 1; i >= 0; --i)
+	{
+		if (!Observers[i].Controller.IsValid())
+		{
+			RemoveObserverAt(i);
+		}
+	}
+
+	const FVector TargetLocation = Player ? Player->GetActorLocation() : FVector::ZeroVector;
+
+	Candidates.Reset();
+	for (int32 i = 0; i < Observers.Num(); ++i)
+	{
+		FObserver& Observer = Observers[i];
+		ANPC_AIController* Controller = Observer.Controller.Get();
+		const APawn* Pawn = Controller->GetPawn();
+
+		// ---- Kết quả async trace đã gửi ở frame trước ----
+		if (Observer.PendingTrace.IsValid())
+		{
+			FTraceDatum TraceData;
+			if (World->QueryTraceData(Observer.PendingTrace, TraceData))
+			{
+				Observer.PendingTrace = FTraceHandle();
+
+				if (Player && Observer.bEnabled)
+				{
+					const bool bBlocked = TraceData.OutHits.ContainsByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+					if (bBlocked)
+					{
+						// Bị che: đếm lại độ trễ từ lần player vào tầm nhìn tiếp theo
+						Observer.CandidateSince = -1.0;
+						SetSeen(Observer, Player, false, Observer.LastSeenLocation, Now);
+					}
+					else
+					{
+						SetSeen(Observer, Player, true, TraceData.End, Now);
+					}
+				}
+			}
+			else if (GFrameCounter > Observer.PendingTraceFrame + NPCSight::MaxTraceFrameAge)
+			{
+				Observer.PendingTrace = FTraceHandle();
+			}
+		}
+
+		if (!Player || !Pawn || !Observer.bEnabled)
+		{
+			if (Observer.bSeen)
+			{
+				SetSeen(Observer, Player, false, Observer.LastSeenLocation, Now);
+			}
+			continue;
+		}
+
+		// ---- Bán kính + góc nhìn ----
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		Controller->GetActorEyesViewPoint(ViewLocation, ViewRotation);
+
+		const FVector ToTarget = TargetLocation - ViewLocation;
+		const float Distance = static_cast<float>(ToTarget.Size());
+		const float Radius = Observer.bSeen ? Observer.LoseSightRadius : Observer.SightRadius;
+
+		const bool bInRange = Distance <= Radius;
+		const bool bInCone = Distance <= KINDA_SMALL_NUMBER
+			|| (ViewRotation.Vector() | (ToTarget / Distance)) >= Observer.CosHalfAngle;
+
+		if (!bInRange || !bInCone)
+		{
+			Observer.CandidateSince = -1.0;
+			if (Observer.bSeen)
+			{
+				SetSeen(Observer, Player, false, Observer.LastSeenLocation, Now);
+			}
+			continue;
+		}
+
+		// Đã thấy và player còn quanh vị trí thấy cuối -> vẫn thấy, không tốn trace
+		if (Observer.bSeen && FVector::DistSquared(TargetLocation, Observer.LastSeenLocation) <= Observer.AutoSuccessRangeSq)
+		{
+			continue;
+		}
+
+		if (Observer.PendingTrace.IsValid())
+		{
+			continue;
+		}
+
+		if (!Observer.bSeen && Observer.CandidateSince < 0.0)
+		{
+			Observer.CandidateSince = Now;
+		}
+
+		// ---- Ưu tiên: chờ lâu, gần player, vừa thấy player gần đây ----
+		const float TimeSinceCheck = Observer.LastCheckTime < 0.0 ? 1.0f : static_cast<float>(Now - Observer.LastCheckTime);
+		const bool bRecentlySeen = Observer.LastSeenTime >= 0.0 && Now - Observer.LastSeenTime <= Observer.MaxAge;
+
+		float Priority = (TimeSinceCheck + KINDA_SMALL_NUMBER) * (2.0f - Distance / FMath::Max(Radius, 1.0f));
+		if (bRecentlySeen)
+		{
+			Priority *= RecentlySeenPriorityScale;
+		}
+
+		Candidates.Add({ Priority, i });
+	}
+
+	// ---- Gửi async trace trong budget ----
+	Candidates.Sort();
+
+	const int32 NumTraces = FMath::Min(Candidates.Num(), MaxTracesPerFrame);
+	for (int32 c = 0; c < NumTraces; ++c)
+	{
+		FObserver& Observer = Observers[Candidates[c].Index];
+		ANPC_AIController* Controller = Observer.Controller.Get();
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		Controller->GetActorEyesViewPoint(ViewLocation, ViewRotation);
+
+		FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(NPCSight), true);
+		TraceParams.AddIgnoredActor(Controller->GetPawn());
+		TraceParams.AddIgnoredActor(Player);
+
+		Observer.PendingTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, ViewLocation, TargetLocation, ECC_Visibility, TraceParams);
+		Observer.PendingTraceFrame = GFrameCounter;
+		Observer.LastCheckTime = Now;
+	}
+
+	INC_DWORD_STAT_BY(STAT_NPCSightTraces, NumTraces);
+	INC_DWORD_STAT_BY(STAT_NPCSightDeferred, Candidates.Num() - NumTraces);
+}
+
+// ============================================
+// STATS
+// ============================================
+
+FNPCSightLatencyStats UNPCSightSubsystem::GetLatencyStats() const
+{
+	FNPCSightLatencyStats Stats;
+	Stats.NumDetections = NumDetections;
+	Stats.AverageLatency = NumDetections > 0 ? static_cast<float>(TotalLatency / NumDetections) : 0.0f;
+	Stats.MaxLatency = MaxLatency;
+	Stats.NumOverBudget = NumOverBudget;
+	return Stats;
+}
+
+void UNPCSightSubsystem::ResetLatencyStats()
+{
+	NumDetections = 0;
+	TotalLatency = 0.0;
+	MaxLatency = 0.0f;
+	NumOverBudget = 0;
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NPCSkeletalMeshComponent.h"
+#include "AI/NPCAnimationBudgetSubsystem.h"
+
+namespace NPCSkeletalMesh
+{
+	// Trọng số của lần đo mới trong ước lượng chi phí
+	constexpr float CostSmoothing = 0.1f;
+}
+
+UNPCSkeletalMeshComponent::UNPCSkeletalMeshComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// External tick rate control chỉ có tác dụng khi bật URO
+	bEnableUpdateRateOptimizations = true;
+}
+
+void UNPCSkeletalMeshComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UNPCAnimationBudgetSubsystem* Budget = UNPCAnimationBudgetSubsystem::Get(this))
+	{
+		Budget->RegisterComponent(this);
+	}
+}
+
+void UNPCSkeletalMeshComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UNPCAnimationBudgetSubsystem* Budget = UNPCAnimationBudgetSubsystem::Get(this))
+	{
+		Budget->UnregisterComponent(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UNPCSkeletalMeshComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	LastTickCostMs = static_cast<float>(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+	LastTickFrame = GFrameCounter;
+
+	// Frame bị bỏ qua gần như không tốn gì, tính vào thì ước lượng bị kéo xuống theo tick rate
+	if (bBudgetedUpdate)
+	{
+		EstimatedUpdateCostMs = FMath::Lerp(EstimatedUpdateCostMs, LastTickCostMs, NPCSkeletalMesh::CostSmoothing);
+	}
+}
+
+void UNPCSkeletalMeshComponent::SetBudgetedUpdate(bool bUpdate)
+{
+	bBudgetedUpdate = bUpdate;
+	EnableExternalUpdate(bUpdate);
+}
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NPCSpawnPoint.h"
+#include "AI/NPC.h"
+#include "AI/NPCSpawnPoolSubsystem.h"
+#include "Components/SceneComponent.h"
+
+ANPCSpawnPoint::ANPCSpawnPoint()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void ANPCSpawnPoint::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UNPCSpawnPoolSubsystem* Pool = UNPCSpawnPoolSubsystem::Get(this))
+	{
+		Pool->RegisterSpawnPoint(this);
+	}
+}
+
+void ANPCSpawnPoint::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UNPCSpawnPoolSubsystem* Pool = UNPCSpawnPoolSubsystem::Get(this))
+	{
+		Pool->UnregisterSpawnPoint(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,254 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NPCSpawnPoolSubsystem.h"
+#include "EscapeIT.h"
+#include "AI/NPC.h"
+#include "AI/NPCSpawnPoint.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "AI/AISignificanceSubsystem.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("NPCSpawnPool Evaluate"), STAT_NPCSpawnPoolEvaluate, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("NPC Pool Active"), STAT_NPCSpawnPoolActive, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("NPC Pool Free"), STAT_NPCSpawnPoolFree, STATGROUP_EscapeIT);
+
+UNPCSpawnPoolSubsystem* UNPCSpawnPoolSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UNPCSpawnPoolSubsystem>() : nullptr;
+}
+
+void UNPCSpawnPoolSubsystem::Deinitialize()
+{
+	Slots.Empty();
+	FreeNPCs.Empty();
+	SET_DWORD_STAT(STAT_NPCSpawnPoolActive, 0);
+	SET_DWORD_STAT(STAT_NPCSpawnPoolFree, 0);
+
+	Super::Deinitialize();
+}
+
+TStatId UNPCSpawnPoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNPCSpawnPoolSubsystem, STATGROUP_Tickables);
+}
+
+// ============================================
+// SPAWN POINTS
+// ============================================
+
+void UNPCSpawnPoolSubsystem::RegisterSpawnPoint(ANPCSpawnPoint* Point)
+{
+	if (!Point || Slots.ContainsByPredicate([Point](const FSpawnSlot& Slot) { return Slot.Point.Get() == Point; }))
+	{
+		return;
+	}
+
+	FSpawnSlot& Slot = Slots.AddDefaulted_GetRef();
+	Slot.Point = Point;
+
+	if (Point->ShouldPrewarm() && Point->GetNPCClass())
+	{
+		Prewarm(Point->GetNPCClass(), 1, Point->GetActorTransform());
+	}
+
+	// Kiểm tra ngay ở tick tới
+	TimeSinceEvaluation = EvaluationInterval;
+}
+
+void UNPCSpawnPoolSubsystem::UnregisterSpawnPoint(ANPCSpawnPoint* Point)
+{
+	const int32 Index = Slots.IndexOfByPredicate([Point](const FSpawnSlot& Slot) { return Slot.Point.Get() == Point; });
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Level stream ra: NPC của point về pool cho point khác dùng
+	ANPC* NPC = Slots[Index].NPC.Get();
+	if (NPC && !GetWorld()->bIsTearingDown)
+	{
+		ReleaseNPC(NPC);
+	}
+	Slots.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+// ============================================
+// POOL
+// ============================================
+
+ANPC* UNPCSpawnPoolSubsystem::AcquireNPC(TSubclassOf<ANPC> NPCClass, const FTransform& SpawnTransform, APaTrolPath* PatrolPath)
+{
+	if (!NPCClass)
+	{
+		return nullptr;
+	}
+
+	ANPC* NPC = nullptr;
+	if (TArray<TWeakObjectPtr<ANPC>>* Free = FreeNPCs.Find(NPCClass.Get()))
+	{
+		while (!NPC && Free->Num() > 0)
+		{
+			NPC = Free->Pop(EAllowShrinking::No).Get();
+		}
+	}
+
+	if (NPC)
+	{
+		NPC->ActivateFromPool(SpawnTransform, PatrolPath);
+	}
+	else
+	{
+		NPC = SpawnNPC(NPCClass, SpawnTransform, PatrolPath);
+	}
+
+	UpdateStats();
+	return NPC;
+}
+
+void UNPCSpawnPoolSubsystem::ReleaseNPC(ANPC* NPC)
+{
+	if (!NPC || NPC->IsPooled())
+	{
+		return;
+	}
+
+	NPC->DeactivateToPool();
+	FreeNPCs.FindOrAdd(NPC->GetClass()).Add(NPC);
+	UpdateStats();
+}
+
+void UNPCSpawnPoolSubsystem::Prewarm(TSubclassOf<ANPC> NPCClass, int32 Count, const FTransform& ParkTransform)
+{
+	for (int32 i = 0; i < Count; ++i)
+	{
+		if (ANPC* NPC = SpawnNPC(NPCClass, ParkTransform, nullptr))
+		{
+			ReleaseNPC(NPC);
+		}
+	}
+}
+
+ANPC* UNPCSpawnPoolSubsystem::SpawnNPC(TSubclassOf<ANPC> NPCClass, const FTransform& SpawnTransform, APaTrolPath* PatrolPath)
+{
+	UWorld* World = GetWorld();
+	if (!World || !NPCClass)
+	{
+		return nullptr;
+	}
+
+	ANPC* NPC = World->SpawnActorDeferred<ANPC>(NPCClass, SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+	if (!NPC)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("NPCSpawnPool: failed to spawn %s"), *NPCClass->GetName());
+		return nullptr;
+	}
+
+	// BT đọc patrol path ngay khi controller possess
+	NPC->SetPatrolPath(PatrolPath);
+	NPC->AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+	NPC->FinishSpawning(SpawnTransform);
+
+	if (!NPC->GetController())
+	{
+		NPC->SpawnDefaultController();
+	}
+	return NPC;
+}
+
+int32 UNPCSpawnPoolSubsystem::GetNumActive() const
+{
+	int32 NumActive = 0;
+	for (const FSpawnSlot& Slot : Slots)
+	{
+		NumActive += Slot.NPC.IsValid() ? 1 : 0;
+	}
+	return NumActive;
+}
+
+int32 UNPCSpawnPoolSubsystem::GetNumPooled() const
+{
+	int32 NumPooled = 0;
+	for (const TPair<TObjectKey<UClass>, TArray<TWeakObjectPtr<ANPC>>>& Pair : FreeNPCs)
+	{
+		NumPooled += Pair.Value.Num();
+	}
+	return NumPooled;
+}
+
+void UNPCSpawnPoolSubsystem::UpdateStats() const
+{
+	SET_DWORD_STAT(STAT_NPCSpawnPoolActive, GetNumActive());
+	SET_DWORD_STAT(STAT_NPCSpawnPoolFree, GetNumPooled());
+}
+
+// ============================================
+// EVALUATE
+// ============================================
+
+void UNPCSpawnPoolSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TimeSinceEvaluation += DeltaTime;
+	if (TimeSinceEvaluation < EvaluationInterval || Slots.Num() == 0)
+	{
+		return;
+	}
+	TimeSinceEvaluation = 0.0f;
+
+	SCOPE_CYCLE_COUNTER(STAT_NPCSpawnPoolEvaluate);
+
+	UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(this);
+	if (!WorldState || !WorldState->GetPlayerSnapshot().bValid)
+	{
+		return;
+	}
+
+	const FVector PlayerLocation = WorldState->GetPlayerSnapshot().Location;
+	const UAISignificanceSubsystem* Significance = UAISignificanceSubsystem::Get(this);
+	int32 NumActive = GetNumActive();
+
+	for (int32 i = Slots.Num() - 1; i >= 0; --i)
+	{
+		FSpawnSlot& Slot = Slots[i];
+		const ANPCSpawnPoint* Point = Slot.Point.Get();
+		if (!Point)
+		{
+			if (ANPC* Orphan = Slot.NPC.Get())
+			{
+				ReleaseNPC(Orphan);
+			}
+			Slots.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		if (ANPC* NPC = Slot.NPC.Get())
+		{
+			// ---- Cất: NPC đã ở xa, không có việc gì quan trọng và không ai nhìn thấy ----
+			const bool bBusy = Significance && Significance->GetSignificance(NPC) == EAISignificance::Critical;
+			if (!bBusy && WorldState->GetDistanceToPlayer(NPC) > Point->GetDeactivationDistance() && !NPC->WasRecentlyRendered(RenderedTolerance))
+			{
+				ReleaseNPC(NPC);
+				Slot.NPC.Reset();
+				Slot.bSpent = Point->IsSpawnOnce();
+				--NumActive;
+			}
+			continue;
+		}
+
+		// ---- Spawn: player tới gần point ----
+		if (Slot.bSpent || !Point->IsSpawnEnabled() || NumActive >= MaxActiveNPCs)
+		{
+			continue;
+		}
+
+		if (FVector::Dist(Point->GetActorLocation(), PlayerLocation) <= Point->GetActivationDistance())
+		{
+			Slot.NPC = AcquireNPC(Point->GetNPCClass(), Point->GetActorTransform(), Point->GetPatrolPath());
+			NumActive += Slot.NPC.IsValid() ? 1 : 0;
+		}
+	}
+
+	UpdateStats();
+}
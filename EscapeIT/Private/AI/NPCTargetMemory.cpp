@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NPCTargetMemory.h"
+
+// ============================================
+// TARGET MEMORY
+// ============================================
+
+void FNPCTargetMemory::Sense(const FVector& Location, double Time, FAISenseID Sense, float InStrength, const FVector* KnownVelocity)
+{
+	if (KnownVelocity)
+	{
+		Velocity = *KnownVelocity;
+	}
+	else if (LastSensedTime >= 0.0 && Time > LastSensedTime)
+	{
+		// Làm mượt để vài stimulus lệch không làm vận tốc nhảy lung tung
+		const FVector Measured = (Location - LastKnownLocation) / static_cast<float>(Time - LastSensedTime);
+		Velocity = FMath::Lerp(Velocity, Measured, 0.5f);
+	}
+
+	LastKnownLocation = Location;
+	LastSensedTime = Time;
+	SourceSense = Sense;
+	Strength = InStrength;
+	Confidence = 1.0f;
+	bCurrentlySensed = true;
+}
+
+void FNPCTargetMemory::Decay(float DeltaSeconds, float DecayPerSecond)
+{
+	if (bCurrentlySensed || Confidence <= 0.0f)
+	{
+		return;
+	}
+
+	Confidence = FMath::Max(0.0f, Confidence - DecayPerSecond * DeltaSeconds);
+	if (Confidence <= 0.0f)
+	{
+		Reset();
+	}
+}
+
+// ============================================
+// STIMULUS ROUTER
+// ============================================
+
+void FNPCStimulusRouter::Register(FAISenseID Sense, FHandler Handler)
+{
+	if (!Sense.IsValid())
+	{
+		return;
+	}
+
+	const int32 Index = Sense.Index;
+	if (!Handlers.IsValidIndex(Index))
+	{
+		Handlers.SetNum(Index + 1);
+	}
+	Handlers[Index] = MoveTemp(Handler);
+}
+
+bool FNPCStimulusRouter::Dispatch(AActor* Actor, const FAIStimulus& Stimulus) const
+{
+	const FAISenseID Sense = Stimulus.Type;
+	if (!Sense.IsValid() || !Handlers.IsValidIndex(Sense.Index) || !Handlers[Sense.Index])
+	{
+		return false;
+	}
+
+	Handlers[Sense.Index](Actor, Stimulus);
+	return true;
+}
@@ -3,19 +3,248 @@
 #include "AI/NPC_AIController.h"
 #include "AI/NPC.h"
 #include "Perception/AIPerceptionComponent.h"
-#include "Perception/AISenseConfig_Sight.h"
 #include "EscapeITCharacter.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "Perception/AISenseConfig_Hearing.h"
+#include "AI/NPCBlackboardSchema.h"
+#include "AI/NPCBehaviorTreeComponent.h"
+#include "Perception/AISense_Sight.h"
+#include "Perception/AISense_Hearing.h"
+#include "AI/NoiseFieldSubsystem.h"
+#include "AI/NPCSightSubsystem.h"
+#include "AI/AIDirectorSubsystem.h"
+#include "AI/AIDecisionTrace.h"
+#include "Data/NPCPerceptionProfile.h"
+#include "Settings/Core/SettingsSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+#include "DrawDebugHelpers.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogNPCPerception, Log, All);
+
+namespace NPCPerception
+{
+	// 0 = tắt, 1 = vẽ target memory mỗi lần sync
+	static int32 DebugDraw = 0;
+	static FAutoConsoleVariableRef CVarDebugDraw(
+		TEXT("ai.NPC.PerceptionDebug"),
+		DebugDraw,
+		TEXT("Vẽ vị trí player/noise mà NPC đang nhớ (0 = tắt)"));
+}
+
+namespace NPCCrowd
+{
+	static bool bAvoidanceEnabled = true;
+	static FAutoConsoleVariableRef CVarAvoidance(
+		TEXT("ai.NPC.CrowdAvoidance"),
+		bAvoidanceEnabled,
+		TEXT("0 = tắt crowd simulation của NPC (so sánh chi phí/độ kẹt), áp ở lần đổi significance tiếp theo"));
+}
 
 ANPC_AIController::ANPC_AIController(FObjectInitializer const& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdFollowingComponent>(TEXT("PathFollowingComponent")))
 {
+	// RunBehaviorTree dùng lại BrainComponent có sẵn -> tick BT giảm được theo significance
+	BrainComponent = CreateDefaultSubobject<UNPCBehaviorTreeComponent>(TEXT("BehaviorTree Component"));
+
 	SetupPerceptionSystem();
 }
 
+void ANPC_AIController::SetUpdateRates(float BehaviorTreeTickInterval, bool bSightEnabled)
+{
+	if (UNPCBehaviorTreeComponent* BehaviorTreeComponent = Cast<UNPCBehaviorTreeComponent>(BrainComponent))
+	{
+		BehaviorTreeComponent->SetMinTickInterval(BehaviorTreeTickInterval);
+	}
+
+	bSightUpdatesEnabled = bSightEnabled;
+	if (UNPCSightSubsystem* Sight = UNPCSightSubsystem::Get(this))
+	{
+		Sight->SetObserverEnabled(this, bSightEnabled);
+	}
+}
+
+void ANPC_AIController::SetCrowdAvoidance(ECrowdAvoidanceQuality::Type Quality, bool bSimulationEnabled)
+{
+	UCrowdFollowingComponent* CrowdFollowing = Cast<UCrowdFollowingComponent>(GetPathFollowingComponent());
+	if (!CrowdFollowing)
+	{
+		return;
+	}
+
+	CrowdFollowing->SetCrowdAvoidanceQuality(Quality);
+
+	const ECrowdSimulationState State = !NPCCrowd::bAvoidanceEnabled ? ECrowdSimulationState::Disabled
+		: bSimulationEnabled ? ECrowdSimulationState::Enabled
+		: ECrowdSimulationState::ObstacleOnly;
+	if (CrowdFollowing->GetStatus() == EPathFollowingStatus::Idle)
+	{
+		CrowdFollowing->SetCrowdSimulationState(State);
+		PendingCrowdSimulationState.Reset();
+	}
+	else
+	{
+		PendingCrowdSimulationState = State;
+	}
+}
+
+void ANPC_AIController::SetDormant(bool bDormant)
+{
+	if (bIsDormant == bDormant)
+	{
+		return;
+	}
+	bIsDormant = bDormant;
+
+	UPathFollowingComponent* PathFollowing = GetPathFollowingComponent();
+	UAIPerceptionComponent* Perception = GetPerceptionComponent();
+
+	if (bDormant)
+	{
+		// Pause chứ không stop: task move đang chạy không bị abort, thức dậy đi tiếp
+		if (BrainComponent)
+		{
+			BrainComponent->PauseLogic(TEXT("Dormant"));
+		}
+		if (PathFollowing && PathFollowing->GetStatus() == EPathFollowingStatus::Moving)
+		{
+			PathFollowing->PauseMove();
+		}
+
+		GetWorldTimerManager().PauseTimer(BlackboardSyncTimer);
+
+		if (UNPCSightSubsystem* Sight = UNPCSightSubsystem::Get(this))
+		{
+			Sight->UnregisterObserver(this);
+		}
+		if (Perception)
+		{
+			Perception->SetSenseEnabled(UAISense_Hearing::StaticClass(), false);
+			Perception->SetComponentTickEnabled(false);
+		}
+
+		if (UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(this))
+		{
+			Director->ReleaseAllTokens(this);
+		}
+	}
+	else
+	{
+		if (Perception)
+		{
+			Perception->SetComponentTickEnabled(true);
+			Perception->SetSenseEnabled(UAISense_Hearing::StaticClass(), true);
+		}
+
+		// Đăng ký lại theo độ khó hiện tại (có thể đã đổi trong lúc ngủ)
+		ApplyPerceptionProfile();
+		if (UNPCSightSubsystem* Sight = UNPCSightSubsystem::Get(this))
+		{
+			Sight->SetObserverEnabled(this, bSightUpdatesEnabled);
+		}
+
+		GetWorldTimerManager().UnPauseTimer(BlackboardSyncTimer);
+
+		if (PathFollowing && PathFollowing->GetStatus() == EPathFollowingStatus::Paused)
+		{
+			PathFollowing->ResumeMove();
+		}
+		if (BrainComponent)
+		{
+			BrainComponent->ResumeLogic(TEXT("Dormant"));
+		}
+	}
+
+	SetActorTickEnabled(!bDormant);
+}
+
+void ANPC_AIController::ResetForReuse()
+{
+	StopMovement();
+	ClearFocus(EAIFocusPriority::Gameplay);
+
+	PlayerMemory.Reset();
+	NoiseMemory.Reset();
+	bNoiseMemoryDirty = false;
+	LastSyncTime = GetWorld()->GetTimeSeconds();
+
+	FNPCBlackboard(GetBlackboardComponent()).ResetToDefaults();
+
+	if (BrainComponent)
+	{
+		BrainComponent->RestartLogic();
+	}
+}
+
+void ANPC_AIController::OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result)
+{
+	// Áp trước khi báo cho BT: task tiếp theo có thể bắt đầu move mới ngay trong Super
+	if (PendingCrowdSimulationState.IsSet())
+	{
+		if (UCrowdFollowingComponent* CrowdFollowing = Cast<UCrowdFollowingComponent>(GetPathFollowingComponent()))
+		{
+			CrowdFollowing->SetCrowdSimulationState(PendingCrowdSimulationState.GetValue());
+		}
+		PendingCrowdSimulationState.Reset();
+	}
+
+	Super::OnMoveCompleted(RequestID, Result);
+}
+
+void ANPC_AIController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Giữ khoảng cách giữa các NPC trong hành lang hẹp (trọng số theo speed profile của ANPC)
+	if (UCrowdFollowingComponent* CrowdFollowing = Cast<UCrowdFollowingComponent>(GetPathFollowingComponent()))
+	{
+		CrowdFollowing->SetCrowdSeparation(true);
+	}
+
+	RegisterStimulusHandlers();
+
+	// Đổi độ khó giữa chừng -> áp lại perception profile
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		if (USettingsSubsystem* Settings = GameInstance->GetSubsystem<USettingsSubsystem>())
+		{
+			Settings->OnGameplaySettingsChanged.AddUniqueDynamic(this, &ANPC_AIController::HandleGameplaySettingsChanged);
+		}
+	}
+}
+
+void ANPC_AIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		if (USettingsSubsystem* Settings = GameInstance->GetSubsystem<USettingsSubsystem>())
+		{
+			Settings->OnGameplaySettingsChanged.RemoveDynamic(this, &ANPC_AIController::HandleGameplaySettingsChanged);
+		}
+	}
+
+	if (UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(this))
+	{
+		Director->ReleaseAllTokens(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ANPC_AIController::OnPossess(APawn* InPawn)
 {
 	Super::OnPossess(InPawn);
+
+	PlayerMemory.Reset();
+	NoiseMemory.Reset();
+	bNoiseMemoryDirty = false;
+	LastSyncTime = GetWorld()->GetTimeSeconds();
+	GetWorldTimerManager().SetTimer(BlackboardSyncTimer, this, &ANPC_AIController::SyncBlackboardFromMemory, BlackboardSyncInterval, true);
+
+	ApplyPerceptionProfile();
+
 	if (ANPC* const npc = Cast<ANPC>(InPawn))
 	{
 		if (UBehaviorTree* const tree = npc->GetBehaviorTree())
@@ -24,36 +253,48 @@ void ANPC_AIController::OnPossess(APawn* InPawn)
 			UseBlackboard(tree->BlackboardAsset, b);
 			Blackboard = b;
 			RunBehaviorTree(tree);
+			StartDecisionTrace();
 		}
 	}
 }
 
-void ANPC_AIController::SetupPerceptionSystem()
+void ANPC_AIController::OnUnPossess()
 {
-	// Chỉ tạo một lần PerceptionComponent
-	SetPerceptionComponent(*CreateDefaultSubobject<UAIPerceptionComponent>(TEXT("Perception Component")));
+	// Không để BT/perception bị pause lại cho pawn possess sau
+	SetDormant(false);
 
-	// Thiết lập SightConfig
-	SightConfig = CreateDefaultSubobject<UAISenseConfig_Sight>(TEXT("Sight Config"));
-	if (SightConfig)
+	GetWorldTimerManager().ClearTimer(BlackboardSyncTimer);
+
+	if (UNPCSightSubsystem* Sight = UNPCSightSubsystem::Get(this))
 	{
-		SightConfig->SightRadius = 1000.f;
-		SightConfig->LoseSightRadius = SightConfig->SightRadius + 25.f;
-		SightConfig->PeripheralVisionAngleDegrees = 90.f;
-		SightConfig->SetMaxAge(5.f);
-		SightConfig->AutoSuccessRangeFromLastSeenLocation = 520.f;
-		SightConfig->DetectionByAffiliation.bDetectEnemies = true;
-		SightConfig->DetectionByAffiliation.bDetectFriendlies = true;
-		SightConfig->DetectionByAffiliation.bDetectNeutrals = true;
+		Sight->UnregisterObserver(this);
+	}
 
-		GetPerceptionComponent()->ConfigureSense(*SightConfig);
+	if (UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(this))
+	{
+		Director->ReleaseAllTokens(this);
 	}
 
+	if (Blackboard)
+	{
+		Blackboard->UnregisterObserversFrom(this);
+	}
+
+	Super::OnUnPossess();
+}
+
+void ANPC_AIController::SetupPerceptionSystem()
+{
+	// Chỉ tạo một lần PerceptionComponent
+	SetPerceptionComponent(*CreateDefaultSubobject<UAIPerceptionComponent>(TEXT("Perception Component")));
+
+	// Sight không dùng UAISense_Sight: UNPCSightSubsystem làm line-of-sight bằng async trace có budget
+
 	// Thiết lập HearConfig
 	HearConfig = CreateDefaultSubobject<UAISenseConfig_Hearing>(TEXT("Hear Config"));
 	if (HearConfig)
 	{
-		HearConfig->HearingRange = 3000.f;
+		HearConfig->HearingRange = FNPCPerceptionSettings().HearingRange;
 		HearConfig->DetectionByAffiliation.bDetectEnemies = true;
 		HearConfig->DetectionByAffiliation.bDetectFriendlies = true;
 		HearConfig->DetectionByAffiliation.bDetectNeutrals = true;
@@ -61,54 +302,259 @@ void ANPC_AIController::SetupPerceptionSystem()
 		GetPerceptionComponent()->ConfigureSense(*HearConfig);
 	}
 
-	// Đặt giác quan chính (dominant sense)
-	GetPerceptionComponent()->SetDominantSense(*SightConfig->GetSenseImplementation());
-
 	// ===== QUAN TRỌNG: CHỈ BIND 1 LẦN! =====
 	GetPerceptionComponent()->OnTargetPerceptionUpdated.AddDynamic(this, &ANPC_AIController::OnTargetDetected);
 }
 
+void ANPC_AIController::ApplyPerceptionProfile()
+{
+	const ANPC* NPC = Cast<ANPC>(GetPawn());
+	if (!NPC)
+	{
+		return;
+	}
+
+	const FNPCPerceptionSettings Settings = UNPCPerceptionProfile::ResolveSettings(NPC->GetPerceptionProfile(), GetCurrentDifficulty());
+
+	if (UNPCSightSubsystem* Sight = UNPCSightSubsystem::Get(this))
+	{
+		Sight->RegisterObserver(this, Settings);
+	}
+
+	if (HearConfig && HearConfig->HearingRange != Settings.HearingRange)
+	{
+		HearConfig->HearingRange = Settings.HearingRange;
+		GetPerceptionComponent()->ConfigureSense(*HearConfig);
+	}
+}
+
+EE_DifficultyLevel ANPC_AIController::GetCurrentDifficulty() const
+{
+	const UGameInstance* GameInstance = GetGameInstance();
+	const USettingsSubsystem* Settings = GameInstance ? GameInstance->GetSubsystem<USettingsSubsystem>() : nullptr;
+	return Settings ? Settings->GetGameplaySettings().DifficultyLevel : EE_DifficultyLevel::Normal;
+}
+
+void ANPC_AIController::HandleGameplaySettingsChanged(const FS_GameplaySettings& NewSettings)
+{
+	// NPC đang ngủ đông áp profile lúc thức dậy
+	if (GetPawn() && !bIsDormant)
+	{
+		ApplyPerceptionProfile();
+	}
+}
+
+void ANPC_AIController::NotifySightChanged(AActor* Target, bool bSeen, const FVector& Location)
+{
+	const APawn* ControlledPawn = GetPawn();
+	const FAIStimulus Stimulus(*GetDefault<UAISense_Sight>(), 1.0f, Location,
+		ControlledPawn ? ControlledPawn->GetActorLocation() : Location,
+		bSeen ? FAIStimulus::SensingSucceeded : FAIStimulus::SensingFailed);
+
+	OnTargetDetected(Target, Stimulus);
+}
+
+void ANPC_AIController::NotifyNoiseHeard(AActor* Instigator, const FVector& Location, float Loudness)
+{
+	const APawn* ControlledPawn = GetPawn();
+	const FAIStimulus Stimulus(*GetDefault<UAISense_Hearing>(), Loudness, Location,
+		ControlledPawn ? ControlledPawn->GetActorLocation() : Location,
+		FAIStimulus::SensingSucceeded, FName("SoundPortal"));
+
+	OnTargetDetected(Instigator, Stimulus);
+}
+
+float ANPC_AIController::GetHearingRange() const
+{
+	return HearConfig ? HearConfig->HearingRange : 0.0f;
+}
+
 void ANPC_AIController::OnTargetDetected(AActor* Actor, FAIStimulus const Stimulus)
 {
-	UE_LOG(LogTemp, Warning, TEXT("OnTargetDetected called for: %s"), *Actor->GetName());
-    
-	if (auto* const ch = Cast<AEscapeITCharacter>(Actor))
+	if (UAIDecisionTraceSubsystem::IsEnabled())
+	{
+		if (UAIDecisionTraceSubsystem* Trace = UAIDecisionTraceSubsystem::Get(this))
+		{
+			Trace->RecordStimulus(this, Stimulus.Type.Name, Stimulus.WasSuccessfullySensed(), Stimulus.StimulusLocation);
+		}
+	}
+
+	if (!StimulusRouter.Dispatch(Actor, Stimulus))
+	{
+		UE_LOG(LogNPCPerception, Verbose, TEXT("%s: no handler for sense %s"), *GetName(), *Stimulus.Type.Name.ToString());
+	}
+}
+
+// ============================================
+// STIMULUS HANDLERS
+// ============================================
+
+void ANPC_AIController::RegisterStimulusHandlers()
+{
+	StimulusRouter.Register<UAISense_Sight>([this](AActor* Actor, const FAIStimulus& Stimulus)
+	{
+		HandleSightStimulus(Actor, Stimulus);
+	});
+
+	StimulusRouter.Register<UAISense_Hearing>([this](AActor* Actor, const FAIStimulus& Stimulus)
+	{
+		HandleHearingStimulus(Actor, Stimulus);
+	});
+}
+
+void ANPC_AIController::HandleSightStimulus(AActor* Actor, const FAIStimulus& Stimulus)
+{
+	if (!Cast<AEscapeITCharacter>(Actor))
 	{
-		if (!GetBlackboardComponent())
+		return;
+	}
+
+	if (Stimulus.WasSuccessfullySensed())
+	{
+		const FVector Velocity = Actor->GetVelocity();
+		PlayerMemory.Actor = Actor;
+		PlayerMemory.Sense(Stimulus.StimulusLocation, GetWorld()->GetTimeSeconds(), Stimulus.Type, Stimulus.Strength, &Velocity);
+	}
+	else
+	{
+		PlayerMemory.Lose();
+	}
+
+	UE_LOG(LogNPCPerception, Verbose, TEXT("%s: sight %s -> %s"),
+		*GetName(), *GetNameSafe(Actor), Stimulus.WasSuccessfullySensed() ? TEXT("seen") : TEXT("lost"));
+}
+
+void ANPC_AIController::HandleHearingStimulus(AActor* Actor, const FAIStimulus& Stimulus)
+{
+	// Noise từ cửa, đồ rơi, jumpscare... không có instigator là player nhưng NPC vẫn phải nghe
+	if (!Stimulus.WasSuccessfullySensed())
+	{
+		return;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// Đang có noise chưa xử lý -> chỉ đổi sang noise to hơn (so với loudness cũ đã decay)
+	const FNPCBlackboard BB(GetBlackboardComponent());
+	if (bNoiseMemoryDirty || BB.GetHasHeardSound())
+	{
+		const UNoiseFieldSubsystem* NoiseField = UNoiseFieldSubsystem::Get(this);
+		const float Elapsed = static_cast<float>(Now - NoiseMemory.LastSensedTime);
+		const float CurrentLoudness = NoiseField ? NoiseField->GetDecayedLoudness(NoiseMemory.Strength, Elapsed) : 0.0f;
+		if (Stimulus.Strength < CurrentLoudness)
 		{
-			UE_LOG(LogTemp, Error, TEXT("Blackboard Component is NULL!"));
 			return;
 		}
-       
-		if (Stimulus.Type.Name == "Default__AISense_Sight")
+	}
+
+	NoiseMemory.Actor = Actor;
+	NoiseMemory.Sense(Stimulus.StimulusLocation, Now, Stimulus.Type, Stimulus.Strength);
+
+	// Noise là sự kiện tức thời: confidence bắt đầu giảm ngay
+	NoiseMemory.Lose();
+	bNoiseMemoryDirty = true;
+
+	UE_LOG(LogNPCPerception, Verbose, TEXT("%s: heard %s at %s (loudness %.2f)"),
+		*GetName(), *GetNameSafe(Actor), *Stimulus.StimulusLocation.ToString(), Stimulus.Strength);
+}
+
+// ============================================
+// BLACKBOARD SYNC
+// ============================================
+
+void ANPC_AIController::SyncBlackboardFromMemory()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float DeltaSeconds = static_cast<float>(Now - LastSyncTime);
+	LastSyncTime = Now;
+
+	// ---- Memory ----
+	if (PlayerMemory.bCurrentlySensed)
+	{
+		// Sight chỉ báo khi thấy/mất dấu; trong lúc vẫn thấy thì đọc thẳng vị trí player
+		if (const AActor* Player = PlayerMemory.Actor.Get())
 		{
-			bool bWasSensed = Stimulus.WasSuccessfullySensed();
-			GetBlackboardComponent()->SetValueAsBool("CanSeePlayer", bWasSensed);
-            
-			UE_LOG(LogTemp, Warning, TEXT("👁 SIGHT: CanSeePlayer = %s"), 
-				bWasSensed ? TEXT("TRUE") : TEXT("FALSE"));
+			const FVector Velocity = Player->GetVelocity();
+			PlayerMemory.Sense(Player->GetActorLocation(), Now, PlayerMemory.SourceSense, PlayerMemory.Strength, &Velocity);
 		}
+		else
+		{
+			PlayerMemory.Lose();
+		}
+	}
+
+	PlayerMemory.Decay(DeltaSeconds, PlayerConfidenceDecayPerSecond);
+	NoiseMemory.Decay(DeltaSeconds, NoiseConfidenceDecayPerSecond);
 
-		if (Stimulus.Type.Name == "Default__AISense_Hearing")
+	// ---- Blackboard ----
+	const FNPCBlackboard BB(GetBlackboardComponent());
+	if (!BB.IsValid())
+	{
+		return;
+	}
+
+	BB.SetCanSeePlayer(PlayerMemory.bCurrentlySensed);
+
+	if (bNoiseMemoryDirty)
+	{
+		BB.SetLastHeardLocation(NoiseMemory.LastKnownLocation);
+		BB.SetHasHeardSound(true);
+		bNoiseMemoryDirty = false;
+	}
+
+#if ENABLE_DRAW_DEBUG
+	if (NPCPerception::DebugDraw > 0)
+	{
+		if (PlayerMemory.IsValid())
+		{
+			const FColor Color = PlayerMemory.bCurrentlySensed ? FColor::Red : FColor::Orange;
+			DrawDebugSphere(GetWorld(), PlayerMemory.LastKnownLocation, 50.0f * PlayerMemory.Confidence + 10.0f, 12, Color, false, BlackboardSyncInterval);
+			DrawDebugLine(GetWorld(), PlayerMemory.LastKnownLocation, PlayerMemory.PredictLocation(1.0f), Color, false, BlackboardSyncInterval);
+		}
+
+		if (NoiseMemory.IsValid())
 		{
-			GetBlackboardComponent()->SetValueAsVector("LastHeardLocation", Stimulus.StimulusLocation);
+			DrawDebugSphere(GetWorld(), NoiseMemory.LastKnownLocation, 100.0f * NoiseMemory.Confidence + 10.0f, 12, FColor::Yellow, false, BlackboardSyncInterval);
+		}
+	}
+#endif
+}
 
-			GetBlackboardComponent()->SetValueAsBool("HasHeardSound", true);
-            
-			UE_LOG(LogTemp, Warning, TEXT("👂 HEARING: Sound at location %s"), 
-				*Stimulus.StimulusLocation.ToString());
+// ============================================
+// DECISION TRACE
+// ============================================
 
-			#if WITH_EDITOR
-			DrawDebugSphere(
-				GetWorld(),
-				Stimulus.StimulusLocation,
-				100.f,
-				12,
-				FColor::Yellow,
-				false,
-				3.0f
-			);
-			#endif
+void ANPC_AIController::StartDecisionTrace()
+{
+	if (!UAIDecisionTraceSubsystem::IsEnabled() || !Blackboard)
+	{
+		return;
+	}
+
+	const FNPCBlackboardKeys& Keys = FNPCBlackboardKeys::Get(Blackboard->GetBlackboardAsset());
+	for (const FNPCBlackboardKeyDesc& Desc : NPCBlackboard::GetSchema())
+	{
+		if (Keys[Desc.Key] != FBlackboard::InvalidKey)
+		{
+			Blackboard->RegisterObserver(Keys[Desc.Key], this,
+				FOnBlackboardChangeNotification::CreateUObject(this, &ANPC_AIController::OnTracedBlackboardKeyChanged));
 		}
 	}
-}
\ No newline at end of file
+}
+
+EBlackboardNotificationResult ANPC_AIController::OnTracedBlackboardKeyChanged(const UBlackboardComponent& BlackboardComp, FBlackboard::FKey ChangedKeyID)
+{
+	UAIDecisionTraceSubsystem* Trace = UAIDecisionTraceSubsystem::IsEnabled() ? UAIDecisionTraceSubsystem::Get(this) : nullptr;
+	if (!Trace)
+	{
+		// Trace đã tắt -> không cần theo dõi nữa
+		return EBlackboardNotificationResult::RemoveObserver;
+	}
+
+	const TSubclassOf<UBlackboardKeyType> KeyType = BlackboardComp.GetKeyType(ChangedKeyID);
+	const bool bValue = KeyType == UBlackboardKeyType_Bool::StaticClass() && BlackboardComp.GetValue<UBlackboardKeyType_Bool>(ChangedKeyID);
+	const FVector Value = KeyType == UBlackboardKeyType_Vector::StaticClass() ? BlackboardComp.GetValue<UBlackboardKeyType_Vector>(ChangedKeyID) : FVector::ZeroVector;
+
+	Trace->RecordBlackboardChange(this, BlackboardComp.GetKeyName(ChangedKeyID), bValue, Value);
+	return EBlackboardNotificationResult::ContinueObserving;
+}
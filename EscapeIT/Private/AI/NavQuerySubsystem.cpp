@@ -0,0 +1,421 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NavQuerySubsystem.h"
+#include "EscapeIT.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("NavQuery GameThread"), STAT_NavQueryGameThread, STATGROUP_EscapeIT);
+DECLARE_CYCLE_STAT(TEXT("NavQuery Worker"), STAT_NavQueryWorker, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Nav Queries Completed"), STAT_NavQueriesCompleted, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Nav Queries Pending"), STAT_NavQueriesPending, STATGROUP_EscapeIT);
+
+namespace NavQuery
+{
+	// Bắn N query ngẫu nhiên quanh player, đo chi phí game thread mỗi frame tới khi batch xong
+	static FAutoConsoleCommandWithWorldAndArgs StressCommand(
+		TEXT("ai.NavQuery.Stress"),
+		TEXT("ai.NavQuery.Stress <N=1000> <MaxGameThreadMs=1.0>: gửi N query (đủ 4 loại) quanh player qua UNavQuerySubsystem, FAILED nếu có frame vượt MaxGameThreadMs"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UNavQuerySubsystem* NavQuery = UNavQuerySubsystem::Get(World))
+			{
+				NavQuery->RunStressTest(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000, Args.Num() > 1 ? FCString::Atof(*Args[1]) : 1.0f);
+			}
+		}));
+}
+
+UNavQuerySubsystem* UNavQuerySubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UNavQuerySubsystem>() : nullptr;
+}
+
+void UNavQuerySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Navmesh chỉ bị sửa (nav tick, streaming) trong UWorld::Tick và bị huỷ khi GC -> worker phải xong trước đó
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UNavQuerySubsystem::HandleWorldTickStart);
+	PreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &UNavQuerySubsystem::CollectWorkerResults);
+}
+
+void UNavQuerySubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGarbageCollectHandle);
+
+	WorkerTask.Wait();
+	InFlight.Empty();
+	Batches.Empty();
+	NumPendingQueries = 0;
+	SET_DWORD_STAT(STAT_NavQueriesPending, 0);
+
+	Super::Deinitialize();
+}
+
+TStatId UNavQuerySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNavQuerySubsystem, STATGROUP_Tickables);
+}
+
+void UNavQuerySubsystem::HandleWorldTickStart(UWorld* TickedWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (TickedWorld == GetWorld())
+	{
+		// Frame mới: Wait() ở đây cũng tính vào chi phí game thread của subsystem
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		CollectWorkerResults();
+		FrameGameThreadMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+	}
+}
+
+// ============================================
+// BATCH
+// ============================================
+
+uint32 UNavQuerySubsystem::SubmitBatch(TArray<FNavQuery> Queries, FOnNavQueryBatchComplete OnComplete)
+{
+	if (Queries.Num() == 0)
+	{
+		return 0;
+	}
+
+	TSharedPtr<FBatch> Batch = MakeShared<FBatch>();
+	Batch->Id = NextBatchId++;
+	if (NextBatchId == 0)
+	{
+		NextBatchId = 1;
+	}
+
+	Batch->Results.SetNum(Queries.Num());
+	Batch->Queries = MoveTemp(Queries);
+	Batch->OnComplete = MoveTemp(OnComplete);
+
+	NumPendingQueries += Batch->Queries.Num();
+	SET_DWORD_STAT(STAT_NavQueriesPending, NumPendingQueries);
+
+	Batches.Add(Batch);
+	return Batch->Id;
+}
+
+void UNavQuerySubsystem::CancelBatch(uint32 BatchId)
+{
+	for (int32 i = 0; i < Batches.Num(); ++i)
+	{
+		if (Batches[i]->Id != BatchId)
+		{
+			continue;
+		}
+
+		// Worker có thể đang ghi vào batch -> chỉ đánh dấu, bỏ khi task xong
+		Batches[i]->bCancelled = true;
+		Batches[i]->OnComplete.Unbind();
+		return;
+	}
+}
+
+// ============================================
+// EXECUTION
+// ============================================
+
+void UNavQuerySubsystem::ExecuteQuery(const ANavigationData& NavData, const FNavQuery& Query, FNavQueryResult& OutResult)
+{
+	FSharedConstNavQueryFilter Filter = NavData.GetDefaultQueryFilter();
+
+	switch (Query.Type)
+	{
+	case ENavQueryType::RandomReachablePoint:
+	{
+		FNavLocation Location;
+		OutResult.bSuccess = NavData.GetRandomReachablePointInRadius(Query.Start, Query.Radius, Location, Filter);
+		OutResult.Location = Location.Location;
+		break;
+	}
+
+	case ENavQueryType::Project:
+	{
+		FNavLocation Location;
+		OutResult.bSuccess = NavData.ProjectPoint(Query.Start, Location, Query.Extent, Filter);
+		OutResult.Location = Location.Location;
+		break;
+	}
+
+	case ENavQueryType::PathLength:
+	{
+		FVector::FReal Length = 0.0;
+		OutResult.bSuccess = NavData.CalcPathLength(Query.Start, Query.End, Length, Filter) == ENavigationQueryResult::Success;
+		OutResult.PathLength = static_cast<float>(Length);
+		break;
+	}
+
+	case ENavQueryType::Raycast:
+	{
+		FVector HitLocation = Query.End;
+		OutResult.bHit = NavData.Raycast(Query.Start, Query.End, HitLocation, Filter);
+		OutResult.Location = OutResult.bHit ? HitLocation : Query.End;
+		OutResult.bSuccess = true;
+		break;
+	}
+	}
+}
+
+const ANavigationData* UNavQuerySubsystem::GetNavData() const
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	return NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+}
+
+bool UNavQuerySubsystem::CanUseWorkerThreads(const ANavigationData& NavData) const
+{
+	if (!bUseWorkerThreads || !FApp::ShouldUseThreadingForPerformance())
+	{
+		return false;
+	}
+
+	// Navmesh build lúc runtime có thể đổi tile giữa frame -> chỉ đọc trên game thread
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	return NavData.GetRuntimeGenerationMode() == ERuntimeGenerationType::Static
+		&& NavSys && !NavSys->IsNavigationBuildInProgress();
+}
+
+void UNavQuerySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_NavQueryGameThread);
+
+		TickQueries();
+	}
+
+	LastFrameGameThreadMs = FrameGameThreadMs + FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+	FrameGameThreadMs = 0.0;
+
+	if (Stress.BatchId != 0)
+	{
+		UpdateStressTest();
+	}
+}
+
+void UNavQuerySubsystem::TickQueries()
+{
+	const double EndTime = FPlatformTime::Seconds() + GameThreadBudgetMs / 1000.0;
+
+	CollectWorkerResults();
+
+	const ANavigationData* NavData = GetNavData();
+	if (NavData && NumPendingQueries > 0)
+	{
+		if (CanUseWorkerThreads(*NavData))
+		{
+			DispatchToWorkers(*NavData);
+		}
+		else
+		{
+			RunOnGameThread(*NavData, EndTime);
+		}
+	}
+
+	DeliverCompletedBatches(EndTime);
+}
+
+void UNavQuerySubsystem::CollectWorkerResults()
+{
+	if (InFlight.Num() == 0)
+	{
+		return;
+	}
+
+	// Thường đã xong từ frame trước; nếu chưa thì phải đợi trước khi navmesh có thể bị sửa
+	WorkerTask.Wait();
+
+	for (const FWorkItem& Item : InFlight)
+	{
+		Item.Batch->NumCompleted += Item.Count;
+	}
+	InFlight.Reset();
+}
+
+void UNavQuerySubsystem::DispatchToWorkers(const ANavigationData& NavData)
+{
+	check(InFlight.Num() == 0);
+
+	int32 Budget = MaxWorkerQueriesPerFrame;
+	for (const TSharedPtr<FBatch>& Batch : Batches)
+	{
+		if (Budget <= 0)
+		{
+			break;
+		}
+
+		const int32 Remaining = Batch->Queries.Num() - Batch->NextQuery;
+		if (Batch->bCancelled || Remaining <= 0)
+		{
+			continue;
+		}
+
+		FWorkItem& Item = InFlight.AddDefaulted_GetRef();
+		Item.Batch = Batch;
+		Item.First = Batch->NextQuery;
+		Item.Count = FMath::Min(Remaining, Budget);
+
+		Batch->NextQuery += Item.Count;
+		Budget -= Item.Count;
+	}
+
+	if (InFlight.Num() == 0)
+	{
+		return;
+	}
+
+	// Task chỉ đọc Queries và ghi vào vùng Results riêng của mình; game thread không đụng tới cho tới CollectWorkerResults.
+	// NavData giữ bằng con trỏ thường: task luôn được đợi xong trước GC và trước khi navmesh có thể bị sửa
+	const ANavigationData* NavDataPtr = &NavData;
+	WorkerTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Items = InFlight, NavDataPtr]()
+	{
+		SCOPE_CYCLE_COUNTER(STAT_NavQueryWorker);
+
+		for (const FWorkItem& Item : Items)
+		{
+			for (int32 i = Item.First; i < Item.First + Item.Count; ++i)
+			{
+				ExecuteQuery(*NavDataPtr, Item.Batch->Queries[i], Item.Batch->Results[i]);
+			}
+		}
+	});
+}
+
+void UNavQuerySubsystem::RunOnGameThread(const ANavigationData& NavData, double EndTime)
+{
+	for (const TSharedPtr<FBatch>& Batch : Batches)
+	{
+		while (!Batch->bCancelled && Batch->NextQuery < Batch->Queries.Num())
+		{
+			if (FPlatformTime::Seconds() >= EndTime)
+			{
+				return;
+			}
+
+			const int32 Index = Batch->NextQuery++;
+			ExecuteQuery(NavData, Batch->Queries[Index], Batch->Results[Index]);
+			++Batch->NumCompleted;
+		}
+	}
+}
+
+void UNavQuerySubsystem::DeliverCompletedBatches(double EndTime)
+{
+	for (int32 i = 0; i < Batches.Num(); )
+	{
+		// Batch còn phần đang chạy trên worker thì chưa được bỏ
+		const TSharedPtr<FBatch> Batch = Batches[i];
+		const bool bInFlight = InFlight.ContainsByPredicate([&Batch](const FWorkItem& Item) { return Item.Batch == Batch; });
+
+		const bool bDone = Batch->NumCompleted >= Batch->Queries.Num();
+		const bool bCancelledAndIdle = Batch->bCancelled && !bInFlight;
+		if (!bDone && !bCancelledAndIdle)
+		{
+			++i;
+			continue;
+		}
+
+		if (!Batch->bCancelled && FPlatformTime::Seconds() >= EndTime)
+		{
+			// Hết budget: callback để frame sau
+			break;
+		}
+
+		NumPendingQueries -= Batch->Queries.Num();
+		INC_DWORD_STAT_BY(STAT_NavQueriesCompleted, Batch->NumCompleted);
+
+		// Bỏ khỏi danh sách trước khi gọi callback: callback có thể submit batch mới
+		Batches.RemoveAt(i, 1, EAllowShrinking::No);
+		Batch->OnComplete.ExecuteIfBound(Batch->Results);
+	}
+
+	SET_DWORD_STAT(STAT_NavQueriesPending, NumPendingQueries);
+}
+
+// ============================================
+// STRESS
+// ============================================
+
+void UNavQuerySubsystem::RunStressTest(int32 NumQueries, float MaxGameThreadMs)
+{
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
+	if (!Player || NumQueries <= 0)
+	{
+		return;
+	}
+
+	if (Stress.BatchId != 0)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("NavQuery stress: batch %u is still running"), Stress.BatchId);
+		return;
+	}
+
+	const FVector Origin = Player->GetActorLocation();
+
+	TArray<FNavQuery> Queries;
+	Queries.Reserve(NumQueries);
+	for (int32 i = 0; i < NumQueries; ++i)
+	{
+		const FVector Offset = FVector(FMath::FRandRange(-2000.0f, 2000.0f), FMath::FRandRange(-2000.0f, 2000.0f), 0.0f);
+		switch (i % 4)
+		{
+		case 0: Queries.Add(FNavQuery::RandomReachablePoint(Origin, 1500.0f)); break;
+		case 1: Queries.Add(FNavQuery::Project(Origin + Offset)); break;
+		case 2: Queries.Add(FNavQuery::PathLength(Origin, Origin + Offset)); break;
+		default: Queries.Add(FNavQuery::Raycast(Origin, Origin + Offset)); break;
+		}
+	}
+
+	Stress = FStressRun();
+	Stress.NumQueries = NumQueries;
+	Stress.MaxGameThreadMs = MaxGameThreadMs;
+	Stress.StartTime = FPlatformTime::Seconds();
+
+	// Callback chạy giữa Tick -> chỉ ghi lại, report sau khi chi phí của frame đó đã được đo
+	Stress.BatchId = SubmitBatch(MoveTemp(Queries), FOnNavQueryBatchComplete::CreateWeakLambda(this, [this](TConstArrayView<FNavQueryResult> Results)
+	{
+		Stress.NumSucceeded = 0;
+		for (const FNavQueryResult& Result : Results)
+		{
+			Stress.NumSucceeded += Result.bSuccess ? 1 : 0;
+		}
+	}));
+}
+
+void UNavQuerySubsystem::UpdateStressTest()
+{
+	++Stress.NumFrames;
+	Stress.TotalGameThreadMs += LastFrameGameThreadMs;
+	Stress.PeakGameThreadMs = FMath::Max(Stress.PeakGameThreadMs, LastFrameGameThreadMs);
+
+	if (Stress.NumSucceeded == INDEX_NONE)
+	{
+		return;
+	}
+
+	const bool bPassed = Stress.PeakGameThreadMs <= Stress.MaxGameThreadMs;
+	UE_LOG(LogEscapeIT, Display, TEXT("NavQuery stress: %d/%d succeeded, %.1f ms wall time over %d frame(s); game thread avg %.3f ms, max %.3f ms (limit %.3f ms)"),
+		Stress.NumSucceeded, Stress.NumQueries, (FPlatformTime::Seconds() - Stress.StartTime) * 1000.0, Stress.NumFrames,
+		Stress.TotalGameThreadMs / Stress.NumFrames, Stress.PeakGameThreadMs, Stress.MaxGameThreadMs);
+
+	if (bPassed)
+	{
+		UE_LOG(LogEscapeIT, Display, TEXT("NavQuery stress: passed"));
+	}
+	else
+	{
+		UE_LOG(LogEscapeIT, Error, TEXT("NavQuery stress: FAILED, worst frame %.3f ms exceeds %.3f ms"), Stress.PeakGameThreadMs, Stress.MaxGameThreadMs);
+	}
+
+	Stress = FStressRun();
+}
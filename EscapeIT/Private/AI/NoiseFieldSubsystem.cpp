@@ -0,0 +1,368 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/NoiseFieldSubsystem.h"
+#include "EscapeIT.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "AI/SoundPropagationSubsystem.h"
+#include "Perception/AISense_Hearing.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+
+DECLARE_CYCLE_STAT(TEXT("NoiseField Tick"), STAT_NoiseFieldTick, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noise Events"), STAT_NoiseEvents, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noise Reports"), STAT_NoiseReports, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Noise Clusters"), STAT_NoiseClusters, STATGROUP_EscapeIT);
+
+namespace NoiseField
+{
+	static FAutoConsoleCommandWithWorldAndArgs ValidateCommand(
+		TEXT("ai.NoiseField.Validate"),
+		TEXT("Kiểm tra gộp cluster, decay và report dồn lượt của noise field"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UNoiseFieldSubsystem* NoiseField = UNoiseFieldSubsystem::Get(World))
+			{
+				NoiseField->RunValidation();
+			}
+		}));
+}
+
+UNoiseFieldSubsystem::UNoiseFieldSubsystem()
+{
+	// Cùng mapping với UFootstepComponent::GetFootstepSoundForSurface
+	SurfaceLoudness.Add(SurfaceType1, 1.2f);   // Wood
+	SurfaceLoudness.Add(SurfaceType2, 1.5f);   // Metal
+	SurfaceLoudness.Add(SurfaceType3, 1.0f);   // Concrete
+	SurfaceLoudness.Add(SurfaceType4, 0.6f);   // Grass
+	SurfaceLoudness.Add(SurfaceType5, 1.3f);   // Water
+	SurfaceLoudness.Add(SurfaceType6, 0.4f);   // Carpet
+}
+
+UNoiseFieldSubsystem* UNoiseFieldSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UNoiseFieldSubsystem>() : nullptr;
+}
+
+void UNoiseFieldSubsystem::Deinitialize()
+{
+	Clusters.Empty();
+	PendingReports.Empty();
+	SET_DWORD_STAT(STAT_NoiseClusters, 0);
+
+	Super::Deinitialize();
+}
+
+TStatId UNoiseFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UNoiseFieldSubsystem, STATGROUP_Tickables);
+}
+
+// ============================================
+// NOISE
+// ============================================
+
+float UNoiseFieldSubsystem::GetSurfaceMultiplier(EPhysicalSurface Surface) const
+{
+	const float* Multiplier = SurfaceLoudness.Find(Surface);
+	return Multiplier ? *Multiplier : 1.0f;
+}
+
+void UNoiseFieldSubsystem::ReportNoise(const FVector& Location, float Loudness, AActor* Instigator, ENoiseSource Source, EPhysicalSurface Surface)
+{
+	Loudness *= GetSurfaceMultiplier(Surface);
+	if (Loudness <= 0.0f || Loudness < MinLoudness)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_NoiseEvents);
+
+	// Player ồn -> snapshot cho service/task đọc
+	const APawn* InstigatorPawn = Cast<APawn>(Instigator);
+	if (InstigatorPawn && InstigatorPawn->IsPlayerControlled())
+	{
+		if (UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(this))
+		{
+			WorldState->NotifyPlayerNoise(Loudness);
+		}
+	}
+
+	// ---- Tìm cluster gần nhất trong ClusterRadius ----
+	FNoiseCluster* Target = nullptr;
+	float BestDistSq = FMath::Square(ClusterRadius);
+	for (FNoiseCluster& Cluster : Clusters)
+	{
+		const float DistSq = FVector::DistSquared(Cluster.Location, Location);
+		if (DistSq <= BestDistSq)
+		{
+			BestDistSq = DistSq;
+			Target = &Cluster;
+		}
+	}
+
+	if (!Target)
+	{
+		if (Clusters.Num() < MaxClusters)
+		{
+			Target = &Clusters.AddDefaulted_GetRef();
+		}
+		else
+		{
+			// Hết chỗ: thay cluster nhỏ nhất nếu event mới to hơn
+			FNoiseCluster* Quietest = &Clusters[0];
+			for (FNoiseCluster& Cluster : Clusters)
+			{
+				if (Cluster.Loudness < Quietest->Loudness)
+				{
+					Quietest = &Cluster;
+				}
+			}
+
+			if (Quietest->Loudness >= Loudness)
+			{
+				return;
+			}
+
+			*Quietest = FNoiseCluster();
+			Target = Quietest;
+		}
+
+		Target->Location = Location;
+	}
+
+	// ---- Gộp: dời tâm theo trọng số, giữ loudness/nguồn của event to nhất ----
+	Target->Weight += Loudness;
+	Target->Location = FMath::Lerp(Target->Location, Location, Loudness / Target->Weight);
+	if (Loudness >= Target->Loudness)
+	{
+		Target->Loudness = Loudness;
+		Target->Source = Source;
+		Target->Instigator = Instigator;
+	}
+	++Target->NumEvents;
+	Target->bPendingReport = true;
+
+	SET_DWORD_STAT(STAT_NoiseClusters, Clusters.Num());
+}
+
+// ============================================
+// UPDATE
+// ============================================
+
+void UNoiseFieldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_NoiseFieldTick);
+
+	DecayClusters(DeltaTime);
+
+	TimeSinceReport += DeltaTime;
+	if (TimeSinceReport >= ReportInterval)
+	{
+		TimeSinceReport = 0.0f;
+		ReportPendingClusters();
+	}
+}
+
+void UNoiseFieldSubsystem::DecayClusters(float DeltaTime)
+{
+	for (int32 i = Clusters.Num() - 1; i >= 0; --i)
+	{
+		FNoiseCluster& Cluster = Clusters[i];
+		Cluster.Loudness = GetDecayedLoudness(Cluster.Loudness, DeltaTime);
+
+		if (Cluster.Loudness < MinLoudness)
+		{
+			Clusters.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_NoiseClusters, Clusters.Num());
+}
+
+void UNoiseFieldSubsystem::CollectPendingReports(TArray<FNoiseCluster, TInlineAllocator<4>>& OutReports)
+{
+	OutReports.Reset();
+	PendingReports.Reset();
+	for (int32 i = 0; i < Clusters.Num(); ++i)
+	{
+		if (Clusters[i].bPendingReport)
+		{
+			PendingReports.Add(i);
+		}
+	}
+
+	if (PendingReports.Num() == 0)
+	{
+		return;
+	}
+
+	PendingReports.Sort([this](int32 A, int32 B) { return Clusters[A].Loudness > Clusters[B].Loudness; });
+
+	// Cluster nhỏ hơn vẫn pending và được xét lại ở lần report sau (nếu chưa decay hết)
+	const int32 NumToReport = FMath::Min(PendingReports.Num(), MaxReportsPerInterval);
+	for (int32 i = 0; i < NumToReport; ++i)
+	{
+		FNoiseCluster& Cluster = Clusters[PendingReports[i]];
+		OutReports.Add(Cluster);
+		Cluster.bPendingReport = false;
+
+		// Tâm chỉ bị kéo bởi event từ sau lần report này
+		Cluster.Weight = Cluster.Loudness;
+	}
+}
+
+void UNoiseFieldSubsystem::ReportPendingClusters()
+{
+	// Copy trước khi report: listener có thể gọi ngược vào ReportNoise và làm thay đổi Clusters
+	TArray<FNoiseCluster, TInlineAllocator<4>> ToReport;
+	CollectPendingReports(ToReport);
+	if (ToReport.Num() == 0)
+	{
+		return;
+	}
+
+	// Level đã bake sound portal graph: tiếng đi theo phòng/cửa, không xuyên tường
+	USoundPropagationSubsystem* SoundPropagation = USoundPropagationSubsystem::Get(this);
+
+	for (const FNoiseCluster& Cluster : ToReport)
+	{
+		INC_DWORD_STAT(STAT_NoiseReports);
+
+		if (SoundPropagation && SoundPropagation->BroadcastNoise(Cluster.Location, Cluster.Loudness, Cluster.Instigator.Get()))
+		{
+			continue;
+		}
+
+		UAISense_Hearing::ReportNoiseEvent(
+			GetWorld(),
+			Cluster.Location,
+			Cluster.Loudness,
+			Cluster.Instigator.Get(),
+			0.0f,
+			FName("NoiseCluster"));
+	}
+}
+
+// ============================================
+// VALIDATION
+// ============================================
+
+bool UNoiseFieldSubsystem::RunValidation(FAutomationTestBase* Test)
+{
+	int32 NumFailed = 0;
+	auto Check = [&NumFailed, Test](bool bCondition, const TCHAR* Description)
+	{
+		if (!bCondition)
+		{
+			++NumFailed;
+			if (Test)
+			{
+				Test->AddError(Description);
+			}
+		}
+		UE_LOG(LogEscapeIT, Display, TEXT("NoiseField: [%s] %s"), bCondition ? TEXT("PASS") : TEXT("FAIL"), Description);
+	};
+
+	// Không có instigator -> ReportNoise không chạm tới world state; không gọi Tick nên không noise nào được gửi
+	const TArray<FNoiseCluster> SavedClusters = Clusters;
+	const float SavedClusterRadius = ClusterRadius;
+	const int32 SavedMaxClusters = MaxClusters;
+	const float SavedDecayPerSecond = DecayPerSecond;
+	const float SavedMinLoudness = MinLoudness;
+	const int32 SavedMaxReports = MaxReportsPerInterval;
+
+	ClusterRadius = 400.0f;
+	MaxClusters = 3;
+	DecayPerSecond = 0.5f;
+	MinLoudness = 0.05f;
+	MaxReportsPerInterval = 2;
+
+	TArray<FNoiseCluster, TInlineAllocator<4>> Reports;
+
+	// ---- Clustering ----
+	Clusters.Reset();
+	ReportNoise(FVector::ZeroVector, 1.0f, nullptr, ENoiseSource::Footstep);
+	ReportNoise(FVector(300.0f, 0.0f, 0.0f), 0.5f, nullptr, ENoiseSource::Door);
+	Check(Clusters.Num() == 1 && Clusters[0].NumEvents == 2, TEXT("events within ClusterRadius merge"));
+	Check(Clusters.Num() == 1 && FMath::IsNearlyEqual(Clusters[0].Loudness, 1.0f) && Clusters[0].Source == ENoiseSource::Footstep,
+		TEXT("merged cluster keeps the loudest event"));
+	Check(Clusters.Num() == 1 && FMath::IsNearlyEqual(Clusters[0].Location.X, 100.0f, 0.1f), TEXT("merged centre is loudness-weighted"));
+
+	ReportNoise(FVector(1000.0f, 0.0f, 0.0f), 0.3f, nullptr, ENoiseSource::DroppedItem);
+	Check(Clusters.Num() == 2, TEXT("event beyond ClusterRadius starts a new cluster"));
+
+	ReportNoise(FVector(2000.0f, 0.0f, 0.0f), 1.0f, nullptr, ENoiseSource::Other, SurfaceType2);
+	Check(Clusters.Num() == 3 && FMath::IsNearlyEqual(Clusters[2].Loudness, GetSurfaceMultiplier(SurfaceType2)),
+		TEXT("surface multiplier scales loudness"));
+
+	ReportNoise(FVector(3000.0f, 0.0f, 0.0f), 0.2f, nullptr, ENoiseSource::Other);
+	Check(Clusters.Num() == 3 && !Clusters.ContainsByPredicate([](const FNoiseCluster& Cluster) { return Cluster.Location.X > 2500.0f; }),
+		TEXT("full field drops an event quieter than every cluster"));
+
+	ReportNoise(FVector(3000.0f, 0.0f, 0.0f), 0.8f, nullptr, ENoiseSource::Jump);
+	Check(Clusters.Num() == 3
+		&& Clusters.ContainsByPredicate([](const FNoiseCluster& Cluster) { return Cluster.Source == ENoiseSource::Jump && Cluster.NumEvents == 1; })
+		&& !Clusters.ContainsByPredicate([](const FNoiseCluster& Cluster) { return Cluster.Source == ENoiseSource::DroppedItem; }),
+		TEXT("full field replaces the quietest cluster with a louder event"));
+
+	// ---- Report dồn lượt ----
+	CollectPendingReports(Reports);
+	Check(Reports.Num() == 2 && Reports[0].Loudness >= Reports[1].Loudness && Reports[1].Loudness >= 1.0f,
+		TEXT("report picks the loudest MaxReportsPerInterval clusters"));
+	Check(Clusters.FilterByPredicate([](const FNoiseCluster& Cluster) { return Cluster.bPendingReport; }).Num() == 1,
+		TEXT("unreported cluster stays pending"));
+
+	CollectPendingReports(Reports);
+	Check(Reports.Num() == 1 && Reports[0].Source == ENoiseSource::Jump, TEXT("unreported cluster is reported next interval"));
+
+	CollectPendingReports(Reports);
+	Check(Reports.Num() == 0, TEXT("nothing is reported twice without new events"));
+
+	// ---- Decay ----
+	Clusters.Reset();
+	ReportNoise(FVector::ZeroVector, 1.0f, nullptr, ENoiseSource::Footstep);
+	DecayClusters(1.0f);
+	Check(Clusters.Num() == 1 && FMath::IsNearlyEqual(Clusters[0].Loudness, 1.0f - DecayPerSecond), TEXT("loudness decays by DecayPerSecond"));
+	Check(FMath::IsNearlyEqual(GetDecayedLoudness(1.0f, 10.0f), 0.0f), TEXT("decayed loudness never goes below zero"));
+
+	DecayClusters(0.95f);
+	Check(Clusters.Num() == 0, TEXT("cluster below MinLoudness is removed"));
+
+	ReportNoise(FVector::ZeroVector, MinLoudness * 0.5f, nullptr, ENoiseSource::Footstep);
+	Check(Clusters.Num() == 0, TEXT("event below MinLoudness is ignored"));
+
+	Clusters = SavedClusters;
+	ClusterRadius = SavedClusterRadius;
+	MaxClusters = SavedMaxClusters;
+	DecayPerSecond = SavedDecayPerSecond;
+	MinLoudness = SavedMinLoudness;
+	MaxReportsPerInterval = SavedMaxReports;
+	SET_DWORD_STAT(STAT_NoiseClusters, Clusters.Num());
+
+	UE_LOG(LogEscapeIT, Display, TEXT("NoiseField: validation %s (%d failed)"), NumFailed == 0 ? TEXT("passed") : TEXT("FAILED"), NumFailed);
+	return NumFailed == 0;
+}
+
+// ============================================
+// AUTOMATION
+// ============================================
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNoiseFieldValidationTest, "EscapeIT.AI.NoiseField.Validate",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FNoiseFieldValidationTest::RunTest(const FString& Parameters)
+{
+	// Validation không cần world: chạy trên instance tạm với settings mặc định
+	UNoiseFieldSubsystem* NoiseField = NewObject<UNoiseFieldSubsystem>(GetTransientPackage());
+	return NoiseField->RunValidation(this);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/PatrolRouteSubsystem.h"
+#include "EscapeIT.h"
+#include "AI/PaTrolPath.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("PatrolRoute Bake"), STAT_PatrolRouteBake, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Patrol Nav Queries Saved"), STAT_PatrolQueriesSaved, STATGROUP_EscapeIT);
+
+// ============================================
+// ROUTE
+// ============================================
+
+const FBakedPatrolSegment* FBakedPatrolRoute::FindSegment(int32 FromIndex, int32 ToIndex, bool& bOutReversed) const
+{
+	const int32 NumPoints = WorldPoints.Num();
+	if (!IsValidIndex(FromIndex) || !IsValidIndex(ToIndex) || FromIndex == ToIndex || Segments.Num() != NumPoints)
+	{
+		return nullptr;
+	}
+
+	// Segment i nối i -> (i + 1) % Num; đi ngược thì dùng lại segment của chiều xuôi
+	if ((FromIndex + 1) % NumPoints == ToIndex)
+	{
+		bOutReversed = false;
+		return &Segments[FromIndex];
+	}
+
+	if ((ToIndex + 1) % NumPoints == FromIndex)
+	{
+		bOutReversed = true;
+		return &Segments[ToIndex];
+	}
+
+	return nullptr;
+}
+
+// ============================================
+// SUBSYSTEM
+// ============================================
+
+UPatrolRouteSubsystem* UPatrolRouteSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UPatrolRouteSubsystem>() : nullptr;
+}
+
+void UPatrolRouteSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &UPatrolRouteSubsystem::HandleNavigationGenerationFinished);
+	}
+}
+
+void UPatrolRouteSubsystem::Deinitialize()
+{
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.RemoveDynamic(this, &UPatrolRouteSubsystem::HandleNavigationGenerationFinished);
+	}
+
+	Routes.Empty();
+
+	Super::Deinitialize();
+}
+
+void UPatrolRouteSubsystem::HandleNavigationGenerationFinished(ANavigationData* NavData)
+{
+	Routes.Empty();
+}
+
+const FBakedPatrolRoute* UPatrolRouteSubsystem::GetRoute(const APaTrolPath* PatrolPath)
+{
+	if (!PatrolPath)
+	{
+		return nullptr;
+	}
+
+	if (const TUniquePtr<FBakedPatrolRoute>* Existing = Routes.Find(PatrolPath))
+	{
+		return Existing->Get();
+	}
+
+	TUniquePtr<FBakedPatrolRoute> Route = MakeUnique<FBakedPatrolRoute>();
+	if (!BakeRoute(GetWorld(), *PatrolPath, *Route))
+	{
+		// Chưa có navmesh -> không cache, thử lại lần sau
+		return nullptr;
+	}
+
+	if (Route->NumUnreachableSegments > 0 || Route->NumOffNavmeshPoints > 0)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("PatrolRoute: %s has %d off-navmesh point(s), %d unreachable segment(s)"),
+			*PatrolPath->GetName(), Route->NumOffNavmeshPoints, Route->NumUnreachableSegments);
+	}
+
+	return Routes.Add(PatrolPath, MoveTemp(Route)).Get();
+}
+
+bool UPatrolRouteSubsystem::BakeRoute(UWorld* World, const APaTrolPath& PatrolPath, FBakedPatrolRoute& OutRoute)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PatrolRouteBake);
+
+	OutRoute = FBakedPatrolRoute();
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	const ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	if (!NavData)
+	{
+		return false;
+	}
+
+	// ---- Point: local -> world, chiếu lên navmesh ----
+	const FTransform& Transform = PatrolPath.GetActorTransform();
+	const int32 NumPoints = PatrolPath.Num();
+
+	OutRoute.WorldPoints.Reserve(NumPoints);
+	OutRoute.bPointOnNavmesh.Reserve(NumPoints);
+
+	for (int32 i = 0; i < NumPoints; ++i)
+	{
+		const FVector WorldPoint = Transform.TransformPosition(PatrolPath.GetPatrolPoint(i));
+
+		FNavLocation Projected;
+		const bool bOnNavmesh = NavSys->ProjectPointToNavigation(WorldPoint, Projected, INVALID_NAVEXTENT, NavData);
+
+		OutRoute.WorldPoints.Add(bOnNavmesh ? Projected.Location : WorldPoint);
+		OutRoute.bPointOnNavmesh.Add(bOnNavmesh);
+		OutRoute.NumOffNavmeshPoints += bOnNavmesh ? 0 : 1;
+	}
+
+	if (NumPoints < 2)
+	{
+		return true;
+	}
+
+	// ---- Segment i -> (i + 1) % Num ----
+	OutRoute.Segments.SetNum(NumPoints);
+
+	for (int32 i = 0; i < NumPoints; ++i)
+	{
+		const int32 Next = (i + 1) % NumPoints;
+		FBakedPatrolSegment& Segment = OutRoute.Segments[i];
+
+		if (!OutRoute.bPointOnNavmesh[i] || !OutRoute.bPointOnNavmesh[Next])
+		{
+			++OutRoute.NumUnreachableSegments;
+			continue;
+		}
+
+		FPathFindingQuery Query(&PatrolPath, *NavData, OutRoute.WorldPoints[i], OutRoute.WorldPoints[Next]);
+		const FPathFindingResult Result = NavSys->FindPathSync(Query);
+
+		if (!Result.IsSuccessful() || Result.IsPartial() || !Result.Path.IsValid())
+		{
+			++OutRoute.NumUnreachableSegments;
+			continue;
+		}
+
+		const TArray<FNavPathPoint>& PathPoints = Result.Path->GetPathPoints();
+		Segment.PathPoints.Reserve(PathPoints.Num());
+		for (const FNavPathPoint& PathPoint : PathPoints)
+		{
+			Segment.PathPoints.Add(PathPoint.Location);
+		}
+
+		Segment.Length = Result.Path->GetLength();
+		Segment.Cost = Result.Path->GetCost();
+		Segment.bReachable = true;
+
+		OutRoute.TotalLength += Segment.Length;
+	}
+
+	return true;
+}
+
+void UPatrolRouteSubsystem::NotifyBakedSegmentUsed()
+{
+	++NumQueriesSaved;
+	INC_DWORD_STAT(STAT_PatrolQueriesSaved);
+}
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/SoundPortalGraph.h"
+#include "AI/SoundPropagationSubsystem.h"
+#include "Actor/Door/Door.h"
+#include "Components/SceneComponent.h"
+
+// ============================================
+// GRAPH
+// ============================================
+
+int32 FSoundPortalGraph::FindRoom(const FVector& Location) const
+{
+	// Mỗi level vài chục phòng -> quét tuyến tính, đã sắp theo priority
+	const int32 NumRoomsToTest = NumRooms();
+	for (int32 i = 0; i < NumRoomsToTest; ++i)
+	{
+		if (RoomBounds[i].IsInsideOrOn(RoomTransforms[i].InverseTransformPosition(Location)))
+		{
+			return i;
+		}
+	}
+
+	return GetOutsideRoom();
+}
+
+int32 FSoundPortalGraph::AddRoom(FName Name, const FTransform& Transform, const FBox& LocalBounds)
+{
+	RoomNames.Add(Name);
+	RoomBounds.Add(LocalBounds);
+	return RoomTransforms.Add(Transform);
+}
+
+int32 FSoundPortalGraph::AddPortal(const FVector& Location, int32 RoomA, int32 RoomB, const TSoftObjectPtr<ADoor>& Door, float BasePenalty)
+{
+	check(RoomA != RoomB);
+
+	PortalRoomA.Add(RoomA);
+	PortalRoomB.Add(RoomB);
+	PortalDoors.Add(Door);
+	PortalBasePenalties.Add(BasePenalty);
+	return PortalLocations.Add(Location);
+}
+
+void FSoundPortalGraph::BuildRoomPortals()
+{
+	// Phòng bên ngoài ở index NumRooms() -> NumRooms() + 1 phòng, NumRooms() + 2 offset
+	const int32 NumRoomSlots = NumRooms() + 1;
+
+	RoomPortalOffsets.Reset(NumRoomSlots + 1);
+	RoomPortalOffsets.AddZeroed(NumRoomSlots + 1);
+
+	for (int32 Portal = 0; Portal < NumPortals(); ++Portal)
+	{
+		++RoomPortalOffsets[PortalRoomA[Portal] + 1];
+		++RoomPortalOffsets[PortalRoomB[Portal] + 1];
+	}
+
+	for (int32 Room = 0; Room < NumRoomSlots; ++Room)
+	{
+		RoomPortalOffsets[Room + 1] += RoomPortalOffsets[Room];
+	}
+
+	RoomPortals.Reset(RoomPortalOffsets[NumRoomSlots]);
+	RoomPortals.AddUninitialized(RoomPortalOffsets[NumRoomSlots]);
+
+	TArray<int32> Cursor(RoomPortalOffsets.GetData(), NumRoomSlots);
+	for (int32 Portal = 0; Portal < NumPortals(); ++Portal)
+	{
+		RoomPortals[Cursor[PortalRoomA[Portal]]++] = Portal;
+		RoomPortals[Cursor[PortalRoomB[Portal]]++] = Portal;
+	}
+}
+
+// ============================================
+// ACTOR
+// ============================================
+
+ASoundPortalGraphActor::ASoundPortalGraphActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+#if WITH_EDITORONLY_DATA
+	// Graph dùng cho cả level, không được stream theo cell của World Partition
+	bIsSpatiallyLoaded = false;
+#endif
+}
+
+void ASoundPortalGraphActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (USoundPropagationSubsystem* SoundPropagation = USoundPropagationSubsystem::Get(this))
+	{
+		SoundPropagation->RegisterGraph(this);
+	}
+}
+
+void ASoundPortalGraphActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USoundPropagationSubsystem* SoundPropagation = USoundPropagationSubsystem::Get(this))
+	{
+		SoundPropagation->UnregisterGraph(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
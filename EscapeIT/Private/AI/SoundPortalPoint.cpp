@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/SoundPortalPoint.h"
+#include "Components/SceneComponent.h"
+
+ASoundPortalPoint::ASoundPortalPoint()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	// Dữ liệu đã bake vào ASoundPortalGraphActor, runtime không cần marker
+	bIsEditorOnlyActor = true;
+}
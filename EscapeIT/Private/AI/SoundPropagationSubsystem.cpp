@@ -0,0 +1,630 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/SoundPropagationSubsystem.h"
+#include "AI/SoundRoomVolume.h"
+#include "AI/SoundPortalPoint.h"
+#include "AI/AIWorldStateSubsystem.h"
+#include "AI/NPC_AIController.h"
+#include "Actor/Door/Door.h"
+#include "Actor/Door/DoorActor.h"
+#include "EscapeIT.h"
+#include "Components/BrushComponent.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("SoundPropagation Query"), STAT_SoundPropagationQuery, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sound Propagation Queries"), STAT_SoundPropagationQueries, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sound Propagation Rows Built"), STAT_SoundPropagationRows, STATGROUP_EscapeIT);
+
+namespace SoundPropagation
+{
+	/** Dò hai phòng ở hai bên một cửa/lối đi, theo trục X rồi trục Y của actor */
+	static bool FindPortalRooms(const FSoundPortalGraph& Graph, const FTransform& Transform, const FSoundPortalBakeSettings& Settings,
+		FVector& OutLocation, int32& OutRoomA, int32& OutRoomB)
+	{
+		OutLocation = Transform.GetLocation() + FVector::UpVector * Settings.ProbeHeight;
+
+		for (const EAxis::Type Axis : { EAxis::X, EAxis::Y })
+		{
+			const FVector Offset = Transform.GetUnitAxis(Axis) * Settings.ProbeDistance;
+			OutRoomA = Graph.FindRoom(OutLocation + Offset);
+			OutRoomB = Graph.FindRoom(OutLocation - Offset);
+			if (OutRoomA != OutRoomB)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/** Ba phòng 1000 x 1000 nối tiếp theo trục X, cửa ở X = 1000 và X = 2000 */
+	static FSoundPortalGraph MakeValidationGraph()
+	{
+		const FBox RoomBox(FVector(0.0f, 0.0f, 0.0f), FVector(1000.0f, 1000.0f, 300.0f));
+
+		FSoundPortalGraph Graph;
+		Graph.AddRoom(TEXT("RoomA"), FTransform(FVector(0.0f, 0.0f, 0.0f)), RoomBox);
+		Graph.AddRoom(TEXT("RoomB"), FTransform(FVector(1000.0f, 0.0f, 0.0f)), RoomBox);
+		Graph.AddRoom(TEXT("RoomC"), FTransform(FVector(2000.0f, 0.0f, 0.0f)), RoomBox);
+		Graph.AddPortal(FVector(1000.0f, 500.0f, 100.0f), 0, 1, nullptr, 0.0f);
+		Graph.AddPortal(FVector(2000.0f, 500.0f, 100.0f), 1, 2, nullptr, 0.0f);
+		Graph.BuildRoomPortals();
+		return Graph;
+	}
+
+	/** Chạy các kịch bản lan truyền trên graph dựng tay, không cần level */
+	static bool RunValidation()
+	{
+		int32 NumFailed = 0;
+		auto Check = [&NumFailed](bool bCondition, const TCHAR* Description)
+		{
+			if (!bCondition)
+			{
+				++NumFailed;
+			}
+			UE_LOG(LogEscapeIT, Display, TEXT("SoundPropagation: [%s] %s"), bCondition ? TEXT("PASS") : TEXT("FAIL"), Description);
+		};
+
+		const FSoundPortalGraph Graph = MakeValidationGraph();
+		FSoundPropagationSolver Solver;
+		Solver.Initialize(Graph);
+
+		constexpr float HearingRange = 3000.0f;
+		constexpr float ClosedPenalty = 1500.0f;
+		const FVector InA(500.0f, 500.0f, 100.0f);
+		const FVector InB(1500.0f, 500.0f, 100.0f);
+		const FVector InC(2500.0f, 500.0f, 100.0f);
+		FSoundPropagationResult Result;
+
+		// ---- Rooms ----
+		Check(Graph.IsValid() && Graph.FindRoom(InA) == 0 && Graph.FindRoom(InC) == 2, TEXT("points resolve to their room"));
+		Check(Graph.FindRoom(FVector(500.0f, -500.0f, 100.0f)) == Graph.GetOutsideRoom(), TEXT("point outside every volume is outside"));
+
+		// ---- Paths ----
+		Check(Solver.Propagate(Graph, InA, FVector(800.0f, 500.0f, 100.0f), 1.0f, HearingRange, Result)
+			&& FMath::IsNearlyEqual(Result.EffectiveDistance, 300.0f) && Result.ArrivalPortal == INDEX_NONE && Result.PerceivedLocation == InA,
+			TEXT("same room hears the source directly"));
+
+		Check(Solver.Propagate(Graph, InA, InB, 1.0f, HearingRange, Result)
+			&& FMath::IsNearlyEqual(Result.EffectiveDistance, 1000.0f, 1.0f) && Result.ArrivalPortal == 0 && Result.PerceivedLocation == Graph.PortalLocations[0],
+			TEXT("open door: sound arrives through the door"));
+
+		Check(Solver.Propagate(Graph, InA, InC, 1.0f, HearingRange, Result)
+			&& FMath::IsNearlyEqual(Result.EffectiveDistance, 2000.0f, 1.0f) && Result.ArrivalPortal == 1,
+			TEXT("two rooms away arrives through the last door"));
+
+		Check(!Solver.Propagate(Graph, InA, FVector(500.0f, -500.0f, 100.0f), 1.0f, HearingRange, Result) && Result.EffectiveDistance == MAX_flt,
+			TEXT("no portal to the outside: not heard"));
+
+		// ---- Doors ----
+		Solver.SetPortalPenalty(0, ClosedPenalty);
+		Check(Solver.Propagate(Graph, InA, InB, 1.0f, HearingRange, Result)
+			&& FMath::IsNearlyEqual(Result.EffectiveDistance, 1000.0f + ClosedPenalty, 1.0f) && Result.Loudness < 1.0f,
+			TEXT("closed door adds its penalty and muffles the sound"));
+
+		Check(!Solver.Propagate(Graph, InA, InC, 1.0f, HearingRange, Result),
+			TEXT("closed door puts a room out of hearing range"));
+
+		Check(FMath::IsNearlyEqual(Solver.GetPortalDistance(0, 1), Solver.GetPortalDistance(1, 0), 1.0f)
+			&& FMath::IsNearlyEqual(Solver.GetPortalDistance(0, 1), 1000.0f + ClosedPenalty * 0.5f, 1.0f),
+			TEXT("portal distances are symmetric and include half the end penalties"));
+
+		Solver.SetPortalPenalty(0, 0.0f);
+		Check(Solver.Propagate(Graph, InA, InC, 1.0f, HearingRange, Result) && FMath::IsNearlyEqual(Result.EffectiveDistance, 2000.0f, 1.0f),
+			TEXT("reopening the door invalidates cached distances"));
+
+		Check(!Solver.Propagate(Graph, InA, InC, 0.5f, HearingRange, Result),
+			TEXT("quiet sound does not carry as far"));
+
+		// ---- Cost ----
+		constexpr int32 NumQueries = 100000;
+		const int32 RowsBefore = Solver.GetNumRowsBuilt();
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			Solver.Propagate(Graph, InA, (i & 1) ? InB : InC, 1.0f, HearingRange, Result);
+		}
+		const double MicrosecondsPerQuery = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0 / NumQueries;
+
+		Check(Solver.GetNumRowsBuilt() == RowsBefore, TEXT("repeated queries reuse cached rows"));
+		UE_LOG(LogEscapeIT, Display, TEXT("SoundPropagation: %d quer%s, avg %.3f us"), NumQueries, NumQueries == 1 ? TEXT("y") : TEXT("ies"), MicrosecondsPerQuery);
+
+		UE_LOG(LogEscapeIT, Display, TEXT("SoundPropagation: validation %s (%d failed)"), NumFailed == 0 ? TEXT("passed") : TEXT("FAILED"), NumFailed);
+		return NumFailed == 0;
+	}
+
+	static FAutoConsoleCommand ValidateCommand(
+		TEXT("ai.SoundPropagation.Validate"),
+		TEXT("Kiểm tra lan truyền âm thanh qua phòng/cửa trên graph dựng sẵn"),
+		FConsoleCommandDelegate::CreateStatic([]() { RunValidation(); }));
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("ai.SoundPropagation.Benchmark"),
+		TEXT("ai.SoundPropagation.Benchmark <N>: tính N đường âm thanh trên graph của level, in thời gian mỗi lần"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (USoundPropagationSubsystem* SoundPropagation = USoundPropagationSubsystem::Get(World))
+			{
+				SoundPropagation->RunBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000);
+			}
+		}));
+}
+
+// ============================================
+// SOLVER
+// ============================================
+
+void FSoundPropagationSolver::Initialize(const FSoundPortalGraph& Graph)
+{
+	Reset();
+
+	const int32 Num = Graph.NumPortals();
+	Penalties = Graph.PortalBasePenalties;
+
+	// Hai portal kề nhau khi chung một phòng; cạnh = đường thẳng trong phòng đó
+	LinkOffsets.Reserve(Num + 1);
+	for (int32 Portal = 0; Portal < Num; ++Portal)
+	{
+		LinkOffsets.Add(LinkTargets.Num());
+
+		for (const int32 Room : { Graph.PortalRoomA[Portal], Graph.PortalRoomB[Portal] })
+		{
+			for (const int32 Other : Graph.GetRoomPortals(Room))
+			{
+				if (Other != Portal)
+				{
+					LinkTargets.Add(Other);
+					LinkDistances.Add(FVector::Dist(Graph.PortalLocations[Portal], Graph.PortalLocations[Other]));
+				}
+			}
+		}
+	}
+	LinkOffsets.Add(LinkTargets.Num());
+
+	Distances.SetNumUninitialized(Num * Num);
+	ValidRows.Init(false, Num);
+}
+
+void FSoundPropagationSolver::Reset()
+{
+	Penalties.Reset();
+	LinkOffsets.Reset();
+	LinkTargets.Reset();
+	LinkDistances.Reset();
+	Distances.Reset();
+	ValidRows.Reset();
+	NumRowsBuilt = 0;
+}
+
+void FSoundPropagationSolver::SetPortalPenalty(int32 Portal, float Penalty)
+{
+	if (Penalties[Portal] == Penalty)
+	{
+		return;
+	}
+
+	Penalties[Portal] = Penalty;
+
+	// Một cửa đổi trạng thái có thể đổi đường đi giữa mọi cặp portal
+	ValidRows.SetRange(0, ValidRows.Num(), false);
+}
+
+float FSoundPropagationSolver::GetPortalDistance(int32 From, int32 To)
+{
+	if (!ValidRows[From])
+	{
+		BuildRow(From);
+	}
+
+	return Distances[From * NumPortals() + To];
+}
+
+void FSoundPropagationSolver::BuildRow(int32 From)
+{
+	INC_DWORD_STAT(STAT_SoundPropagationRows);
+
+	const int32 Num = NumPortals();
+	float* Row = Distances.GetData() + From * Num;
+	for (int32 i = 0; i < Num; ++i)
+	{
+		Row[i] = MAX_flt;
+	}
+	Row[From] = 0.0f;
+
+	OpenList.Reset();
+	OpenList.HeapPush({ 0.0f, From });
+
+	while (OpenList.Num() > 0)
+	{
+		FOpenPortal Open;
+		OpenList.HeapPop(Open, EAllowShrinking::No);
+
+		if (Open.Cost > Row[Open.Portal])
+		{
+			continue;
+		}
+
+		const float HalfPenalty = Penalties[Open.Portal] * 0.5f;
+		for (int32 Link = LinkOffsets[Open.Portal]; Link < LinkOffsets[Open.Portal + 1]; ++Link)
+		{
+			const int32 Target = LinkTargets[Link];
+			const float NewCost = Open.Cost + LinkDistances[Link] + HalfPenalty + Penalties[Target] * 0.5f;
+			if (NewCost < Row[Target])
+			{
+				Row[Target] = NewCost;
+				OpenList.HeapPush({ NewCost, Target });
+			}
+		}
+	}
+
+	ValidRows[From] = true;
+	++NumRowsBuilt;
+}
+
+bool FSoundPropagationSolver::Propagate(const FSoundPortalGraph& Graph, const FVector& Source, const FVector& Listener, float Loudness, float HearingRange,
+	FSoundPropagationResult& OutResult)
+{
+	OutResult = FSoundPropagationResult();
+	OutResult.SourceRoom = Graph.FindRoom(Source);
+	OutResult.ListenerRoom = Graph.FindRoom(Listener);
+
+	// Đường qua portal không bao giờ ngắn hơn đường thẳng
+	const float MaxDistance = HearingRange * Loudness;
+	const float Direct = FVector::Dist(Source, Listener);
+	if (Direct > MaxDistance)
+	{
+		return false;
+	}
+
+	if (OutResult.SourceRoom == OutResult.ListenerRoom)
+	{
+		OutResult.EffectiveDistance = Direct;
+		OutResult.PerceivedLocation = Source;
+	}
+	else
+	{
+		// Nửa penalty còn lại của portal đầu/cuối (GetPortalDistance chỉ tính một nửa mỗi đầu)
+		const TConstArrayView<int32> ListenerPortals = Graph.GetRoomPortals(OutResult.ListenerRoom);
+		TArray<float, TInlineAllocator<16>> FromListenerPortal;
+		for (const int32 Portal : ListenerPortals)
+		{
+			FromListenerPortal.Add(FVector::Dist(Graph.PortalLocations[Portal], Listener) + Penalties[Portal] * 0.5f);
+		}
+
+		float Best = MAX_flt;
+		for (const int32 SourcePortal : Graph.GetRoomPortals(OutResult.SourceRoom))
+		{
+			const float ToSourcePortal = FVector::Dist(Source, Graph.PortalLocations[SourcePortal]) + Penalties[SourcePortal] * 0.5f;
+			if (ToSourcePortal > FMath::Min(Best, MaxDistance))
+			{
+				continue;
+			}
+
+			for (int32 i = 0; i < ListenerPortals.Num(); ++i)
+			{
+				const float Partial = ToSourcePortal + FromListenerPortal[i];
+				if (Partial > FMath::Min(Best, MaxDistance))
+				{
+					continue;
+				}
+
+				const float Total = Partial + GetPortalDistance(SourcePortal, ListenerPortals[i]);
+				if (Total < Best)
+				{
+					Best = Total;
+					OutResult.ArrivalPortal = ListenerPortals[i];
+				}
+			}
+		}
+
+		if (OutResult.ArrivalPortal == INDEX_NONE)
+		{
+			return false;
+		}
+
+		OutResult.EffectiveDistance = Best;
+		OutResult.PerceivedLocation = Graph.PortalLocations[OutResult.ArrivalPortal];
+	}
+
+	if (OutResult.EffectiveDistance > MaxDistance)
+	{
+		return false;
+	}
+
+	OutResult.Loudness = OutResult.EffectiveDistance > KINDA_SMALL_NUMBER
+		? Loudness * FMath::Min(1.0f, Direct / OutResult.EffectiveDistance)
+		: Loudness;
+	return true;
+}
+
+// ============================================
+// SUBSYSTEM
+// ============================================
+
+USoundPropagationSubsystem* USoundPropagationSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<USoundPropagationSubsystem>() : nullptr;
+}
+
+void USoundPropagationSubsystem::Deinitialize()
+{
+	GraphActor.Reset();
+	PortalDoors.Empty();
+	Solver.Reset();
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// GRAPH
+// ============================================
+
+void USoundPropagationSubsystem::RegisterGraph(const ASoundPortalGraphActor* InGraphActor)
+{
+	if (!InGraphActor)
+	{
+		return;
+	}
+
+	const FSoundPortalGraph& Graph = InGraphActor->GetGraph();
+	if (!Graph.IsValid())
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("SoundPropagation: %s has no baked graph, run the SoundPortalBake commandlet"), *InGraphActor->GetName());
+		return;
+	}
+
+	if (GraphActor.IsValid() && GraphActor.Get() != InGraphActor)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("SoundPropagation: %s replaces %s, only one graph per world is used"),
+			*InGraphActor->GetName(), *GraphActor->GetName());
+	}
+
+	GraphActor = InGraphActor;
+	Solver.Initialize(Graph);
+
+	PortalDoors.Reset(Graph.NumPortals());
+	for (const TSoftObjectPtr<ADoor>& Door : Graph.PortalDoors)
+	{
+		PortalDoors.Add(Door.Get());
+	}
+
+	RefreshedFrame = MAX_uint64;
+}
+
+void USoundPropagationSubsystem::UnregisterGraph(const ASoundPortalGraphActor* InGraphActor)
+{
+	if (GraphActor.Get() == InGraphActor)
+	{
+		GraphActor.Reset();
+		PortalDoors.Reset();
+		Solver.Reset();
+	}
+}
+
+const FSoundPortalGraph* USoundPropagationSubsystem::GetGraph() const
+{
+	const ASoundPortalGraphActor* Actor = GraphActor.Get();
+	return Actor ? &Actor->GetGraph() : nullptr;
+}
+
+bool USoundPropagationSubsystem::BakeGraph(TConstArrayView<const ASoundRoomVolume*> Rooms, TConstArrayView<const ADoor*> Doors,
+	TConstArrayView<const ASoundPortalPoint*> Openings, const FSoundPortalBakeSettings& Settings,
+	FSoundPortalGraph& OutGraph, FSoundPortalBakeReport& OutReport)
+{
+	OutGraph.Reset();
+	OutReport = FSoundPortalBakeReport();
+
+	// ---- Phòng: priority cao trước, giữ thứ tự của caller khi bằng nhau ----
+	TArray<const ASoundRoomVolume*> SortedRooms(Rooms);
+	SortedRooms.StableSort([](const ASoundRoomVolume& A, const ASoundRoomVolume& B) { return A.GetPriority() > B.GetPriority(); });
+
+	for (const ASoundRoomVolume* Room : SortedRooms)
+	{
+		const FBox LocalBounds = Room->GetBrushComponent()->CalcBounds(FTransform::Identity).GetBox();
+		if (LocalBounds.IsValid)
+		{
+			OutGraph.AddRoom(Room->GetFName(), Room->GetActorTransform(), LocalBounds);
+		}
+	}
+
+	OutReport.NumRooms = OutGraph.NumRooms();
+	if (OutGraph.NumRooms() == 0)
+	{
+		return false;
+	}
+
+	// ---- Portal ----
+	FVector Location;
+	int32 RoomA = INDEX_NONE;
+	int32 RoomB = INDEX_NONE;
+
+	for (int32 i = 0; i < Doors.Num(); ++i)
+	{
+		if (SoundPropagation::FindPortalRooms(OutGraph, Doors[i]->GetActorTransform(), Settings, Location, RoomA, RoomB))
+		{
+			OutGraph.AddPortal(Location, RoomA, RoomB, TSoftObjectPtr<ADoor>(FSoftObjectPath(Doors[i])), 0.0f);
+			++OutReport.NumDoorPortals;
+		}
+		else
+		{
+			OutReport.UnlinkedDoors.Add(i);
+		}
+	}
+
+	for (int32 i = 0; i < Openings.Num(); ++i)
+	{
+		if (SoundPropagation::FindPortalRooms(OutGraph, Openings[i]->GetActorTransform(), Settings, Location, RoomA, RoomB))
+		{
+			OutGraph.AddPortal(Location, RoomA, RoomB, nullptr, Openings[i]->GetPenalty());
+			++OutReport.NumOpenPortals;
+		}
+		else
+		{
+			OutReport.UnlinkedOpenings.Add(i);
+		}
+	}
+
+	OutGraph.BuildRoomPortals();
+
+	for (int32 Room = 0; Room < OutGraph.NumRooms(); ++Room)
+	{
+		if (OutGraph.GetRoomPortals(Room).Num() == 0)
+		{
+			OutReport.IsolatedRooms.Add(Room);
+		}
+	}
+
+	return true;
+}
+
+// ============================================
+// PROPAGATION
+// ============================================
+
+float USoundPropagationSubsystem::GetDoorPenalty(const ADoor* Door) const
+{
+	if (!Door)
+	{
+		return ClosedDoorPenalty;
+	}
+
+	if (Door->IsOpen())
+	{
+		return OpenDoorPenalty;
+	}
+
+	const ADoorActor* DoorActor = Cast<ADoorActor>(Door);
+	return DoorActor && DoorActor->bIsLocked ? LockedDoorPenalty : ClosedDoorPenalty;
+}
+
+void USoundPropagationSubsystem::RefreshPortalPenalties()
+{
+	if (RefreshedFrame == GFrameCounter)
+	{
+		return;
+	}
+	RefreshedFrame = GFrameCounter;
+
+	const FSoundPortalGraph* Graph = GetGraph();
+	for (int32 Portal = 0; Portal < PortalDoors.Num(); ++Portal)
+	{
+		// Lối đi hở: penalty cố định từ lúc bake
+		if (Graph->PortalDoors[Portal].IsNull())
+		{
+			continue;
+		}
+
+		ADoor* Door = PortalDoors[Portal].Get();
+		if (!Door)
+		{
+			// Cửa trong cell World Partition có thể được stream vào sau khi graph đăng ký
+			Door = Graph->PortalDoors[Portal].Get();
+			PortalDoors[Portal] = Door;
+		}
+
+		Solver.SetPortalPenalty(Portal, GetDoorPenalty(Door));
+	}
+}
+
+bool USoundPropagationSubsystem::Propagate(const FVector& Source, const FVector& Listener, float Loudness, float HearingRange, FSoundPropagationResult& OutResult)
+{
+	const FSoundPortalGraph* Graph = GetGraph();
+	if (!Graph)
+	{
+		OutResult = FSoundPropagationResult();
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_SoundPropagationQuery);
+	INC_DWORD_STAT(STAT_SoundPropagationQueries);
+
+	RefreshPortalPenalties();
+	return Solver.Propagate(*Graph, Source, Listener, Loudness, HearingRange, OutResult);
+}
+
+bool USoundPropagationSubsystem::BroadcastNoise(const FVector& Location, float Loudness, AActor* Instigator)
+{
+	if (!GetGraph())
+	{
+		return false;
+	}
+
+	UAIWorldStateSubsystem* WorldState = UAIWorldStateSubsystem::Get(this);
+	if (!WorldState)
+	{
+		return true;
+	}
+
+	FSoundPropagationResult Result;
+	for (const TWeakObjectPtr<APawn>& NPCPtr : WorldState->GetNPCs())
+	{
+		APawn* NPC = NPCPtr.Get();
+		if (!NPC || NPC == Instigator)
+		{
+			continue;
+		}
+
+		ANPC_AIController* Controller = Cast<ANPC_AIController>(NPC->GetController());
+		if (!Controller || Controller->IsDormant())
+		{
+			continue;
+		}
+
+		if (Propagate(Location, NPC->GetActorLocation(), Loudness, Controller->GetHearingRange(), Result))
+		{
+			Controller->NotifyNoiseHeard(Instigator, Result.PerceivedLocation, Result.Loudness);
+		}
+	}
+
+	return true;
+}
+
+void USoundPropagationSubsystem::RunBenchmark(int32 NumQueries)
+{
+	const FSoundPortalGraph* Graph = GetGraph();
+	if (!Graph || NumQueries <= 0)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("SoundPropagation benchmark: no baked graph registered"));
+		return;
+	}
+
+	FRandomStream Random(NumQueries);
+	auto RandomPointInRoom = [Graph, &Random]()
+	{
+		const int32 Room = Random.RandHelper(Graph->NumRooms());
+		const FBox& Bounds = Graph->RoomBounds[Room];
+		const FVector Local(Random.FRandRange(Bounds.Min.X, Bounds.Max.X), Random.FRandRange(Bounds.Min.Y, Bounds.Max.Y), Random.FRandRange(Bounds.Min.Z, Bounds.Max.Z));
+		return Graph->RoomTransforms[Room].TransformPosition(Local);
+	};
+
+	// Tầm nghe rất lớn để không bị cắt sớm: đo trường hợp phải tìm đường qua portal
+	constexpr float BenchmarkHearingRange = 1.0e6f;
+
+	uint64 TotalCycles = 0;
+	uint64 MaxCycles = 0;
+	int32 NumHeard = 0;
+	const int32 RowsBefore = Solver.GetNumRowsBuilt();
+
+	FSoundPropagationResult Result;
+	for (int32 i = 0; i < NumQueries; ++i)
+	{
+		const FVector Source = RandomPointInRoom();
+		const FVector Listener = RandomPointInRoom();
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		NumHeard += Propagate(Source, Listener, 1.0f, BenchmarkHearingRange, Result) ? 1 : 0;
+		const uint64 Cycles = FPlatformTime::Cycles64() - StartCycles;
+
+		TotalCycles += Cycles;
+		MaxCycles = FMath::Max(MaxCycles, Cycles);
+	}
+
+	UE_LOG(LogEscapeIT, Display, TEXT("SoundPropagation benchmark: %d room(s), %d portal(s), %d quer%s, avg %.2f us, max %.2f us, %d heard, %d row(s) built"),
+		Graph->NumRooms(), Graph->NumPortals(), NumQueries, NumQueries == 1 ? TEXT("y") : TEXT("ies"),
+		FPlatformTime::ToMilliseconds64(TotalCycles) * 1000.0 / NumQueries,
+		FPlatformTime::ToMilliseconds64(MaxCycles) * 1000.0,
+		NumHeard, Solver.GetNumRowsBuilt() - RowsBefore);
+}
@@ -0,0 +1,13 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/SoundRoomVolume.h"
+#include "Components/BrushComponent.h"
+#include "Engine/CollisionProfile.h"
+
+ASoundRoomVolume::ASoundRoomVolume()
+{
+	GetBrushComponent()->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+
+	// Dữ liệu đã bake vào ASoundPortalGraphActor, runtime không cần volume
+	bIsEditorOnlyActor = true;
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/TacticalSearchGraph.h"
+#include "AI/TacticalSearchSubsystem.h"
+#include "Components/SceneComponent.h"
+
+// ============================================
+// GRAPH
+// ============================================
+
+int32 FTacticalSearchGraph::FindNearestNode(const FVector& Location, float MaxDistance) const
+{
+	// Graph mỗi level chỉ vài trăm node -> quét tuyến tính trên mảng liền nhau là đủ nhanh
+	int32 BestNode = INDEX_NONE;
+	double BestDistSq = FMath::Square(static_cast<double>(MaxDistance));
+
+	const int32 NumNodes = NodeLocations.Num();
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		const double DistSq = FVector::DistSquared(Location, NodeLocations[i]);
+		if (DistSq <= BestDistSq)
+		{
+			BestDistSq = DistSq;
+			BestNode = i;
+		}
+	}
+
+	return BestNode;
+}
+
+// ============================================
+// ACTOR
+// ============================================
+
+ATacticalSearchGraphActor::ATacticalSearchGraphActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+#if WITH_EDITORONLY_DATA
+	// Graph dùng cho cả level, không được stream theo cell của World Partition
+	bIsSpatiallyLoaded = false;
+#endif
+}
+
+void ATacticalSearchGraphActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UTacticalSearchSubsystem* TacticalSearch = UTacticalSearchSubsystem::Get(this))
+	{
+		TacticalSearch->RegisterGraph(this);
+	}
+}
+
+void ATacticalSearchGraphActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UTacticalSearchSubsystem* TacticalSearch = UTacticalSearchSubsystem::Get(this))
+	{
+		TacticalSearch->UnregisterGraph(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
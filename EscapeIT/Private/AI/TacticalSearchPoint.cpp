@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/TacticalSearchPoint.h"
+#include "Components/SceneComponent.h"
+
+ATacticalSearchPoint::ATacticalSearchPoint()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	// Dữ liệu đã bake vào ATacticalSearchGraphActor, runtime không cần marker
+	bIsEditorOnlyActor = true;
+}
@@ -0,0 +1,401 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/TacticalSearchSubsystem.h"
+#include "AI/TacticalSearchPoint.h"
+#include "EscapeIT.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("TacticalSearch Plan"), STAT_TacticalSearchPlan, STATGROUP_EscapeIT);
+DECLARE_CYCLE_STAT(TEXT("TacticalSearch Bake"), STAT_TacticalSearchBake, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tactical Search Plans"), STAT_TacticalSearchPlans, STATGROUP_EscapeIT);
+
+namespace TacticalSearch
+{
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("ai.TacticalSearch.Benchmark"),
+		TEXT("ai.TacticalSearch.Benchmark <N>: lập N kế hoạch lục soát trên graph của level, in thời gian mỗi lần"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UTacticalSearchSubsystem* TacticalSearch = UTacticalSearchSubsystem::Get(World))
+			{
+				TacticalSearch->RunBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000);
+			}
+		}));
+
+	// Số điểm tối đa mỗi kế hoạch khi benchmark (bằng với BT task)
+	constexpr int32 BenchmarkPlanPoints = 8;
+}
+
+UTacticalSearchSubsystem* UTacticalSearchSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UTacticalSearchSubsystem>() : nullptr;
+}
+
+void UTacticalSearchSubsystem::Deinitialize()
+{
+	GraphActor.Reset();
+
+	Costs.Empty();
+	Scores.Empty();
+	Reached.Empty();
+	OpenList.Empty();
+	Cleared.Empty();
+
+	Super::Deinitialize();
+}
+
+// ============================================
+// GRAPH
+// ============================================
+
+void UTacticalSearchSubsystem::RegisterGraph(const ATacticalSearchGraphActor* InGraphActor)
+{
+	if (!InGraphActor)
+	{
+		return;
+	}
+
+	if (!InGraphActor->GetGraph().IsValid())
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("TacticalSearch: %s has no baked graph, run the TacticalSearchBake commandlet"), *InGraphActor->GetName());
+		return;
+	}
+
+	if (GraphActor.IsValid() && GraphActor.Get() != InGraphActor)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("TacticalSearch: %s replaces %s, only one graph per world is used"),
+			*InGraphActor->GetName(), *GraphActor->GetName());
+	}
+
+	GraphActor = InGraphActor;
+}
+
+void UTacticalSearchSubsystem::UnregisterGraph(const ATacticalSearchGraphActor* InGraphActor)
+{
+	if (GraphActor.Get() == InGraphActor)
+	{
+		GraphActor.Reset();
+	}
+}
+
+const FTacticalSearchGraph* UTacticalSearchSubsystem::GetGraph() const
+{
+	const ATacticalSearchGraphActor* Actor = GraphActor.Get();
+	return Actor ? &Actor->GetGraph() : nullptr;
+}
+
+// ============================================
+// BAKE
+// ============================================
+
+bool UTacticalSearchSubsystem::BakeGraph(UWorld* World, TConstArrayView<const ATacticalSearchPoint*> Points, const FTacticalSearchBakeSettings& Settings,
+	FTacticalSearchGraph& OutGraph, FTacticalSearchBakeReport& OutReport)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TacticalSearchBake);
+
+	OutGraph.Reset();
+	OutReport = FTacticalSearchBakeReport();
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+	const ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+	if (!NavData)
+	{
+		return false;
+	}
+
+	const int32 NumNodes = Points.Num();
+	OutReport.NumNodes = NumNodes;
+
+	// ---- Node: chiếu lên navmesh ----
+	OutGraph.NodeLocations.Reserve(NumNodes);
+	OutGraph.NodeTypes.Reserve(NumNodes);
+	OutGraph.NodeWeights.Reserve(NumNodes);
+
+	TBitArray<> OnNavmesh(false, NumNodes);
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		const FVector Location = Points[i]->GetActorLocation();
+
+		FNavLocation Projected;
+		const bool bOnNavmesh = NavSys->ProjectPointToNavigation(Location, Projected, INVALID_NAVEXTENT, NavData);
+
+		OutGraph.NodeLocations.Add(bOnNavmesh ? Projected.Location : Location);
+		OutGraph.NodeTypes.Add(Points[i]->GetNodeType());
+		OutGraph.NodeWeights.Add(Points[i]->GetSearchWeight());
+
+		OnNavmesh[i] = bOnNavmesh;
+		if (!bOnNavmesh)
+		{
+			OutReport.OffNavmeshNodes.Add(i);
+		}
+	}
+
+	// ---- Cạnh: path navmesh đầy đủ, không đi vòng quá MaxDetourFactor ----
+	TArray<TArray<TPair<int32, float>>> Links;
+	Links.SetNum(NumNodes);
+
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		for (int32 j = i + 1; j < NumNodes; ++j)
+		{
+			if (!OnNavmesh[i] || !OnNavmesh[j])
+			{
+				continue;
+			}
+
+			const FVector& From = OutGraph.NodeLocations[i];
+			const FVector& To = OutGraph.NodeLocations[j];
+			const double StraightDistance = FVector::Dist(From, To);
+			if (StraightDistance > Settings.MaxLinkDistance)
+			{
+				continue;
+			}
+
+			FPathFindingQuery Query(Points[i], *NavData, From, To);
+			const FPathFindingResult Result = NavSys->FindPathSync(Query);
+			++OutReport.NumNavQueries;
+
+			if (!Result.IsSuccessful() || Result.IsPartial() || !Result.Path.IsValid())
+			{
+				continue;
+			}
+
+			const float Length = Result.Path->GetLength();
+			if (Length > FMath::Max(StraightDistance, 1.0) * Settings.MaxDetourFactor)
+			{
+				continue;
+			}
+
+			Links[i].Add({ j, Length });
+			Links[j].Add({ i, Length });
+		}
+	}
+
+	// ---- Sight line: trace ở độ cao mắt ----
+	TArray<TArray<int32>> SightLines;
+	SightLines.SetNum(NumNodes);
+
+	const FVector EyeOffset(0.0f, 0.0f, Settings.EyeHeight);
+	const FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(TacticalSearchBake), false);
+
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		for (int32 j = i + 1; j < NumNodes; ++j)
+		{
+			const FVector From = OutGraph.NodeLocations[i] + EyeOffset;
+			const FVector To = OutGraph.NodeLocations[j] + EyeOffset;
+			if (FVector::Dist(From, To) > Settings.MaxSightDistance)
+			{
+				continue;
+			}
+
+			if (!World->LineTraceTestByChannel(From, To, ECC_Visibility, TraceParams))
+			{
+				SightLines[i].Add(j);
+				SightLines[j].Add(i);
+			}
+		}
+	}
+
+	// ---- Flatten sang CSR ----
+	OutGraph.EdgeOffsets.Reserve(NumNodes + 1);
+	OutGraph.SightOffsets.Reserve(NumNodes + 1);
+
+	for (int32 i = 0; i < NumNodes; ++i)
+	{
+		OutGraph.EdgeOffsets.Add(OutGraph.EdgeTargets.Num());
+		for (const TPair<int32, float>& Link : Links[i])
+		{
+			OutGraph.EdgeTargets.Add(Link.Key);
+			OutGraph.EdgeCosts.Add(Link.Value);
+		}
+
+		OutGraph.SightOffsets.Add(OutGraph.SightTargets.Num());
+		OutGraph.SightTargets.Append(SightLines[i]);
+
+		if (OnNavmesh[i] && NumNodes > 1 && Links[i].Num() == 0)
+		{
+			OutReport.IsolatedNodes.Add(i);
+		}
+	}
+	OutGraph.EdgeOffsets.Add(OutGraph.EdgeTargets.Num());
+	OutGraph.SightOffsets.Add(OutGraph.SightTargets.Num());
+
+	// Mỗi cạnh lưu hai chiều
+	OutReport.NumEdges = OutGraph.EdgeTargets.Num() / 2;
+	OutReport.NumSightLines = OutGraph.SightTargets.Num() / 2;
+
+	return true;
+}
+
+// ============================================
+// PLANNING
+// ============================================
+
+float UTacticalSearchSubsystem::GetTypeWeight(ETacticalNodeType Type) const
+{
+	switch (Type)
+	{
+	case ETacticalNodeType::Room:       return RoomWeight;
+	case ETacticalNodeType::Doorway:    return DoorwayWeight;
+	case ETacticalNodeType::HidingSpot: return HidingSpotWeight;
+	default:                            return 0.0f;
+	}
+}
+
+int32 UTacticalSearchSubsystem::PlanSearch(const FVector& LastKnownLocation, const FVector& LastKnownVelocity, TArrayView<FVector> OutPoints)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TacticalSearchPlan);
+
+	const FTacticalSearchGraph* Graph = GetGraph();
+	if (!Graph || OutPoints.Num() == 0)
+	{
+		return 0;
+	}
+
+	const int32 StartNode = Graph->FindNearestNode(LastKnownLocation, MaxStartDistance);
+	if (StartNode == INDEX_NONE)
+	{
+		return 0;
+	}
+
+	INC_DWORD_STAT(STAT_TacticalSearchPlans);
+
+	const int32 NumNodes = Graph->Num();
+
+	// ---- Dijkstra từ node bắt đầu, dừng ở MaxSearchCost ----
+	Costs.Init(MAX_flt, NumNodes);
+	Reached.Reset();
+	OpenList.Reset();
+
+	Costs[StartNode] = 0.0f;
+	OpenList.HeapPush({ 0.0f, StartNode });
+
+	while (OpenList.Num() > 0)
+	{
+		FOpenNode Open;
+		OpenList.HeapPop(Open, EAllowShrinking::No);
+
+		// Entry cũ (node đã được mở với cost thấp hơn)
+		if (Open.Cost > Costs[Open.Node])
+		{
+			continue;
+		}
+		Reached.Add(Open.Node);
+
+		const TConstArrayView<int32> Neighbors = Graph->GetNeighbors(Open.Node);
+		const TConstArrayView<float> NeighborCosts = Graph->GetNeighborCosts(Open.Node);
+		for (int32 i = 0; i < Neighbors.Num(); ++i)
+		{
+			const float NewCost = Open.Cost + NeighborCosts[i];
+			if (NewCost < Costs[Neighbors[i]] && NewCost <= MaxSearchCost)
+			{
+				Costs[Neighbors[i]] = NewCost;
+				OpenList.HeapPush({ NewCost, Neighbors[i] });
+			}
+		}
+	}
+
+	// ---- Điểm cơ bản: loại node x khoảng cách x hướng player chạy ----
+	const FVector Heading = LastKnownVelocity.GetSafeNormal2D();
+
+	Scores.SetNumUninitialized(NumNodes, EAllowShrinking::No);
+	for (const int32 Node : Reached)
+	{
+		float Score = GetTypeWeight(Graph->NodeTypes[Node]) * Graph->NodeWeights[Node] / (1.0f + Costs[Node] / CostFalloff);
+
+		if (!Heading.IsZero())
+		{
+			const FVector ToNode = (Graph->NodeLocations[Node] - LastKnownLocation).GetSafeNormal2D();
+			Score *= 1.0f + HeadingBias * FMath::Max(0.0f, static_cast<float>(ToNode | Heading));
+		}
+
+		Scores[Node] = Score;
+	}
+
+	// ---- Chọn tham lam; node nhìn thấy từ điểm đã chọn coi như đã lục soát ----
+	Cleared.Init(false, NumNodes);
+
+	int32 NumPoints = 0;
+	FVector Previous = LastKnownLocation;
+
+	while (NumPoints < OutPoints.Num())
+	{
+		int32 BestNode = INDEX_NONE;
+		float BestScore = 0.0f;
+
+		for (const int32 Node : Reached)
+		{
+			if (Cleared[Node])
+			{
+				continue;
+			}
+
+			// Ưu tiên node gần điểm vừa lục soát để NPC không chạy qua chạy lại
+			const float Travel = static_cast<float>(FVector::Dist(Previous, Graph->NodeLocations[Node]));
+			const float Score = Scores[Node] / (1.0f + Travel / CostFalloff);
+			if (Score > BestScore)
+			{
+				BestScore = Score;
+				BestNode = Node;
+			}
+		}
+
+		if (BestNode == INDEX_NONE)
+		{
+			break;
+		}
+
+		Previous = Graph->NodeLocations[BestNode];
+		OutPoints[NumPoints++] = Previous;
+
+		Cleared[BestNode] = true;
+		for (const int32 Visible : Graph->GetVisibleNodes(BestNode))
+		{
+			Cleared[Visible] = true;
+		}
+	}
+
+	return NumPoints;
+}
+
+void UTacticalSearchSubsystem::RunBenchmark(int32 NumPlans)
+{
+	const FTacticalSearchGraph* Graph = GetGraph();
+	if (!Graph || NumPlans <= 0)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("TacticalSearch benchmark: no baked graph registered"));
+		return;
+	}
+
+	FRandomStream Random(NumPlans);
+	FVector PlanPoints[TacticalSearch::BenchmarkPlanPoints];
+
+	uint64 TotalCycles = 0;
+	uint64 MaxCycles = 0;
+	int64 TotalPoints = 0;
+
+	for (int32 i = 0; i < NumPlans; ++i)
+	{
+		const FVector Offset(Random.FRandRange(-300.0f, 300.0f), Random.FRandRange(-300.0f, 300.0f), 0.0f);
+		const FVector Start = Graph->NodeLocations[Random.RandHelper(Graph->Num())] + Offset;
+		const FVector Velocity = Random.GetUnitVector().GetSafeNormal2D() * 400.0f;
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		TotalPoints += PlanSearch(Start, Velocity, PlanPoints);
+		const uint64 Cycles = FPlatformTime::Cycles64() - StartCycles;
+
+		TotalCycles += Cycles;
+		MaxCycles = FMath::Max(MaxCycles, Cycles);
+	}
+
+	UE_LOG(LogEscapeIT, Display, TEXT("TacticalSearch benchmark: %d node(s), %d plan(s), avg %.2f us, max %.2f us, %.1f point(s) per plan"),
+		Graph->Num(), NumPlans,
+		FPlatformTime::ToMilliseconds64(TotalCycles) * 1000.0 / NumPlans,
+		FPlatformTime::ToMilliseconds64(MaxCycles) * 1000.0,
+		static_cast<double>(TotalPoints) / NumPlans);
+}
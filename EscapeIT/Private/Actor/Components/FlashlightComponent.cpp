@@ -7,6 +7,8 @@
 #include "TimerManager.h"
 #include "Actor/Components/InventoryComponent.h"
 #include "Components/TextBlock.h"
+#include "GameSystem/FlashlightIlluminationSubsystem.h"
+#include "GameInstance/BatterySubsystem.h"
 
 UFlashlightComponent::UFlashlightComponent()
 {
@@ -30,12 +32,45 @@ UFlashlightComponent::UFlashlightComponent()
 void UFlashlightComponent::BeginPlay()
 {
     Super::BeginPlay();
-    
+
+    // Ngưỡng lấy từ profile để UI/beep khớp với event của UBatterySubsystem
+    if (BatteryProfile)
+    {
+        LowBatteryThreshold = BatteryProfile->LowThreshold * 100.0f;
+        CriticalBatteryThreshold = BatteryProfile->CriticalThreshold * 100.0f;
+    }
+
+    if (UBatterySubsystem* Batteries = UBatterySubsystem::Get(this))
+    {
+        Batteries->OnBatteryChargeChanged.AddDynamic(this, &UFlashlightComponent::HandleBatteryChargeChanged);
+        Batteries->OnBatteryLevelChanged.AddDynamic(this, &UFlashlightComponent::HandleBatteryLevelChanged);
+    }
+
+    InstallNewBattery(GetBatteryPercentage() / 100.0f);
     LastBatteryPercentage = GetBatteryPercentage();
     
     UE_LOG(LogTemp, Log, TEXT("FlashlightComponent: Initialized (Battery: %.1f%%)"), LastBatteryPercentage);
 }
 
+void UFlashlightComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UBatterySubsystem* Batteries = UBatterySubsystem::Get(this))
+    {
+        Batteries->OnBatteryChargeChanged.RemoveDynamic(this, &UFlashlightComponent::HandleBatteryChargeChanged);
+        Batteries->OnBatteryLevelChanged.RemoveDynamic(this, &UFlashlightComponent::HandleBatteryLevelChanged);
+        Batteries->RemoveBattery(InstalledBatteryId);
+    }
+    InstalledBatteryId.Invalidate();
+
+    // Owner bị destroy / level unload khi đèn vẫn bật -> không để beam cũ tiếp tục được publish
+    if (UFlashlightIlluminationSubsystem* Illumination = UFlashlightIlluminationSubsystem::Get(this))
+    {
+        Illumination->ClearBeam();
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
 void UFlashlightComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
     Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
@@ -46,12 +81,6 @@ void UFlashlightComponent::TickComponent(float DeltaTime, ELevelTick TickType, F
         return;
     }
 
-    // Update battery drain
-    if (bIsLightOn && !IsBatteryDepleted())
-    {
-        UpdateBattery(DeltaTime);
-    }
-
     // Update light intensity (smooth transitions + flicker)
     UpdateLightIntensity(DeltaTime);
 }
@@ -172,6 +201,12 @@ bool UFlashlightComponent::SetLightEnabled(bool bEnabled)
     // Change state
     bIsLightOn = bEnabled;
 
+    // Pin chỉ xả khi đèn bật; tắt đèn thì subsystem chuyển sang hồi (recovery bounce)
+    if (UBatterySubsystem* Batteries = UBatterySubsystem::Get(this))
+    {
+        Batteries->SetBatteryLoad(InstalledBatteryId, bIsLightOn);
+    }
+
     // Set target intensity for smooth fade
     if (bIsLightOn)
     {
@@ -363,21 +398,17 @@ void UFlashlightComponent::AddBatteryCharge(float ChargePercent)
     }
 
     float OldPercent = GetBatteryPercentage();
-    
-    // Convert percentage to seconds
-    float ChargeSeconds = (ChargePercent / 100.0f) * ItemData.BatteryDuration;
-    CurrentBattery = FMath::Clamp(CurrentBattery + ChargeSeconds, 0.0f, ItemData.BatteryDuration);
-
-    float NewPercent = GetBatteryPercentage();
-    float AddedPercent = NewPercent - OldPercent;
 
-    // Reset low battery warning if charged above threshold
-    if (OldPercent <= LowBatteryThreshold && NewPercent > LowBatteryThreshold)
+    // Subsystem broadcast charge/level -> CurrentBattery và cảnh báo pin yếu được cập nhật qua handler
+    if (UBatterySubsystem* Batteries = UBatterySubsystem::Get(this))
     {
-        bLowBatterySoundPlayed = false;
-        StopLowBatteryBeep();
+        Batteries->AddCharge(InstalledBatteryId, ChargePercent / 100.0f);
+        CurrentBattery = Batteries->GetCharge(InstalledBatteryId) * ItemData.BatteryDuration;
     }
 
+    float NewPercent = GetBatteryPercentage();
+    float AddedPercent = NewPercent - OldPercent;
+
     // Update light intensity if currently on
     if (bIsLightOn)
     {
@@ -394,54 +425,159 @@ void UFlashlightComponent::AddBatteryCharge(float ChargePercent)
         AddedPercent, OldPercent, NewPercent);
 }
 
-void UFlashlightComponent::ReplaceBattery()
+FGuid UFlashlightComponent::ReplaceBattery(float FreshCharge)
 {
-    CurrentBattery = ItemData.BatteryDuration;
-    LastBatteryPercentage = 100.0f;
+    // Pin mới = instance mới (ID mới); pin cũ được trả cho caller, không bị xoá
+    const FGuid EjectedBatteryId = EjectBattery();
+    InstallNewBattery(FreshCharge);
+    OnBatteryInstalled();
+    return EjectedBatteryId;
+}
+
+FGuid UFlashlightComponent::SwapBattery(FGuid NewBatteryId)
+{
+    const UBatterySubsystem* Batteries = UBatterySubsystem::Get(this);
+    FBatteryState NewState;
+    if (!Batteries || !Batteries->GetBatteryState(NewBatteryId, NewState))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Battery: %s not found, installing a fresh battery"), *NewBatteryId.ToString());
+        return ReplaceBattery(1.0f);
+    }
+
+    const FGuid EjectedBatteryId = EjectBattery();
+    InstallBattery(NewBatteryId);
+    OnBatteryInstalled();
+    return EjectedBatteryId;
+}
+
+FGuid UFlashlightComponent::EjectBattery()
+{
+    FGuid EjectedBatteryId = InstalledBatteryId;
+    InstalledBatteryId.Invalidate();
+
+    UBatterySubsystem* Batteries = UBatterySubsystem::Get(this);
+    if (!Batteries || !EjectedBatteryId.IsValid())
+    {
+        return FGuid();
+    }
+
+    // Pin tháo ra giữ charge/tuổi (và tiếp tục hồi bounce); pin cạn thì bỏ luôn
+    Batteries->SetBatteryLoad(EjectedBatteryId, false);
+    if (Batteries->GetCharge(EjectedBatteryId) <= KINDA_SMALL_NUMBER)
+    {
+        Batteries->RemoveBattery(EjectedBatteryId);
+        EjectedBatteryId.Invalidate();
+    }
+
+    return EjectedBatteryId;
+}
+
+void UFlashlightComponent::InstallBattery(FGuid BatteryId)
+{
+    InstalledBatteryId = BatteryId;
+
+    if (UBatterySubsystem* Batteries = UBatterySubsystem::Get(this))
+    {
+        CurrentBattery = Batteries->GetCharge(BatteryId) * ItemData.BatteryDuration;
+        Batteries->SetBatteryLoad(BatteryId, bIsLightOn);
+    }
+}
+
+void UFlashlightComponent::OnBatteryInstalled()
+{
+    LastBatteryPercentage = GetBatteryPercentage();
     bLowBatterySoundPlayed = false;
 
     StopLowBatteryBeep();
     
     if (bIsLightOn)
     {
-        TargetLightIntensity = NormalIntensity;
+        TargetLightIntensity = CalculateTargetIntensity();
+    }
+
+    // Pin lắp vào đã yếu -> cảnh báo ngay, không chờ lần đổi level tiếp theo
+    if (const UBatterySubsystem* Batteries = UBatterySubsystem::Get(this))
+    {
+        FBatteryState State;
+        if (Batteries->GetBatteryState(InstalledBatteryId, State) && State.Level != EBatteryLevel::Normal)
+        {
+            HandleBatteryLevelChanged(InstalledBatteryId, State.Level);
+        }
     }
 
     PlaySound(BatteryReplaceSound);
     OnBatteryChanged.Broadcast(CurrentBattery, ItemData.BatteryDuration);
 
-    UE_LOG(LogTemp, Log, TEXT("Battery: Replaced (100%%)"));
+    UE_LOG(LogTemp, Log, TEXT("Battery: Replaced (%.1f%%)"), LastBatteryPercentage);
 }
 
-void UFlashlightComponent::UpdateBattery(float DeltaTime)
+void UFlashlightComponent::InstallNewBattery(float InitialCharge)
 {
-    if (CurrentBattery <= 0.0f)
+    CurrentBattery = FMath::Clamp(InitialCharge, 0.0f, 1.0f) * ItemData.BatteryDuration;
+
+    UBatterySubsystem* Batteries = UBatterySubsystem::Get(this);
+    if (!Batteries)
     {
         return;
     }
 
-    // Drain battery
-    float DrainAmount = ItemData.BatteryDrainRate * DeltaTime;
-    CurrentBattery = FMath::Max(CurrentBattery - DrainAmount, 0.0f);
+    if (InstalledBatteryId.IsValid())
+    {
+        Batteries->RemoveBattery(InstalledBatteryId);
+    }
 
-    float CurrentPercentage = GetBatteryPercentage();
+    // Không có profile -> giữ đúng thời lượng cũ của ItemData (Duration / DrainRate)
+    const float ItemRuntime = ItemData.BatteryDrainRate > 0.0f
+        ? ItemData.BatteryDuration / ItemData.BatteryDrainRate
+        : ItemData.BatteryDuration;
 
-    // Broadcast battery change
-    OnBatteryChanged.Broadcast(CurrentBattery, ItemData.BatteryDuration);
+    InstalledBatteryId = Batteries->CreateBattery(BatteryProfile, InitialCharge, BatteryProfile ? 0.0f : ItemRuntime);
+    Batteries->SetBatteryLoad(InstalledBatteryId, bIsLightOn);
+}
 
-    // Check for low battery warning
-    if (!bLowBatterySoundPlayed && CurrentPercentage <= LowBatteryThreshold && LastBatteryPercentage > LowBatteryThreshold)
+void UFlashlightComponent::HandleBatteryChargeChanged(FGuid BatteryId, float Charge)
+{
+    if (BatteryId != InstalledBatteryId)
     {
-        HandleBatteryLow();
+        return;
     }
 
-    // Check for battery depletion
-    if (IsBatteryDepleted())
+    CurrentBattery = Charge * ItemData.BatteryDuration;
+    LastBatteryPercentage = GetBatteryPercentage();
+
+    OnBatteryChanged.Broadcast(CurrentBattery, ItemData.BatteryDuration);
+}
+
+void UFlashlightComponent::HandleBatteryLevelChanged(FGuid BatteryId, EBatteryLevel NewLevel)
+{
+    if (BatteryId != InstalledBatteryId)
     {
-        HandleBatteryDepleted();
+        return;
     }
 
-    LastBatteryPercentage = CurrentPercentage;
+    switch (NewLevel)
+    {
+    case EBatteryLevel::Normal:
+        // Sạc lại trên ngưỡng -> reset cảnh báo
+        bLowBatterySoundPlayed = false;
+        StopLowBatteryBeep();
+        break;
+
+    case EBatteryLevel::Low:
+    case EBatteryLevel::Critical:
+        if (bIsLightOn && !bLowBatterySoundPlayed)
+        {
+            HandleBatteryLow();
+        }
+        break;
+
+    case EBatteryLevel::Depleted:
+        if (bIsLightOn)
+        {
+            HandleBatteryDepleted();
+        }
+        break;
+    }
 }
 
 void UFlashlightComponent::HandleBatteryDepleted()
@@ -581,6 +717,13 @@ void UFlashlightComponent::UpdateLightIntensity(float DeltaTime)
     }
 
     SpotLight->SetIntensity(FinalIntensity);
+
+    // Publish beam cho gameplay (ghost/NPC) - một lần mỗi frame
+    if (UFlashlightIlluminationSubsystem* Illumination = UFlashlightIlluminationSubsystem::Get(this))
+    {
+        const bool bBeamVisible = bIsLightOn && SpotLight->IsVisible() && NormalIntensity > 0.0f;
+        Illumination->PublishBeam(SpotLight, bBeamVisible ? FinalIntensity / NormalIntensity : 0.0f, GetOwner());
+    }
 }
 
 void UFlashlightComponent::ApplyFlickerEffect(float DeltaTime)
@@ -714,12 +857,21 @@ void UFlashlightComponent::CleanupFlashlight()
         GetWorld()->GetTimerManager().ClearTimer(UnequipAnimationTimer);
     }
 
+    if (UFlashlightIlluminationSubsystem* Illumination = UFlashlightIlluminationSubsystem::Get(this))
+    {
+        Illumination->ClearBeam();
+    }
+
     // Clear references
     SpotLight = nullptr;
     CurrentFlashlightActor = nullptr;
     
     // Reset state
     bIsLightOn = false;
+    if (UBatterySubsystem* Batteries = UBatterySubsystem::Get(this))
+    {
+        Batteries->SetBatteryLoad(InstalledBatteryId, false);
+    }
     CurrentLightIntensity = 0.0f;
     TargetLightIntensity = 0.0f;
     bIsFadingLight = false;
@@ -6,6 +6,7 @@
 #include "Sound/SoundBase.h"
 #include "PhysicalMaterials/PhysicalMaterial.h"
 #include "DrawDebugHelpers.h"
+#include "AI/NoiseFieldSubsystem.h"
 
 UFootstepComponent::UFootstepComponent()
 {
@@ -71,6 +72,8 @@ void UFootstepComponent::PlayFootstepSound()
 		return; // No surface detected
 	}
 
+	ReportFootstepNoise(HitResult);
+
 	// Get appropriate sound
 	USoundBase* FootstepSound = GetFootstepSoundForSurface(HitResult);
 	if (!FootstepSound)
@@ -170,6 +173,7 @@ bool UFootstepComponent::TraceSurface(FHitResult& OutHitResult) const
 
 	FCollisionQueryParams QueryParams;
 	QueryParams.AddIgnoredActor(OwnerCharacter);
+	QueryParams.bReturnPhysicalMaterial = true; // Cần cho GetFootstepSoundForSurface và noise theo bề mặt
 
 	bool bHit = GetWorld()->LineTraceSingleByChannel(
 		OutHitResult,
@@ -210,6 +214,28 @@ bool UFootstepComponent::TraceSurface(FHitResult& OutHitResult) const
 	return bHit;
 }
 
+void UFootstepComponent::ReportFootstepNoise(const FHitResult& HitResult) const
+{
+	const float CurrentSpeed = OwnerCharacter->GetVelocity().Size2D();
+	if (CurrentSpeed < MinNoiseSpeed)
+	{
+		return;
+	}
+
+	UNoiseFieldSubsystem* NoiseField = UNoiseFieldSubsystem::Get(this);
+	if (!NoiseField)
+	{
+		return;
+	}
+
+	const float Loudness = CurrentSpeed > 400.0f ? FootstepNoiseLoudness * SprintNoiseMultiplier : FootstepNoiseLoudness;
+	const EPhysicalSurface Surface = HitResult.PhysMaterial.IsValid()
+		? UPhysicalMaterial::DetermineSurfaceType(HitResult.PhysMaterial.Get())
+		: SurfaceType_Default;
+
+	NoiseField->ReportNoise(HitResult.ImpactPoint, Loudness, OwnerCharacter, ENoiseSource::Footstep, Surface);
+}
+
 USoundBase* UFootstepComponent::GetFootstepSoundForSurface(const FHitResult& HitResult) const
 {
 	// Try to get physical material from hit result
@@ -9,6 +9,8 @@
 #include "Actor/Components/FlashlightComponent.h"
 #include "Actor/Item/Flashlight.h"
 #include "TimerManager.h"
+#include "AI/NoiseFieldSubsystem.h"
+#include "GameInstance/BatterySubsystem.h"
 
 UInventoryComponent::UInventoryComponent()
 {
@@ -180,6 +182,17 @@ bool UInventoryComponent::RemoveItem(FName ItemID, int32 Quantity)
             InventorySlots[i].Quantity -= AmountToRemove;
             RemainingToRemove -= AmountToRemove;
 
+            // Pin mới trong stack bị bỏ trước; pin đã dùng vượt quá số lượng còn lại thì rời game
+            TArray<FGuid>& BatteryIds = InventorySlots[i].BatteryIds;
+            while (BatteryIds.Num() > FMath::Max(InventorySlots[i].Quantity, 0))
+            {
+                if (UBatterySubsystem* Batteries = UBatterySubsystem::Get(this))
+                {
+                    Batteries->RemoveBattery(BatteryIds.Last());
+                }
+                BatteryIds.Pop();
+            }
+
             if (InventorySlots[i].Quantity <= 0)
             {
                 SlotsToRemove.Add(i);
@@ -260,6 +273,119 @@ void UInventoryComponent::RemoveSlotAndUpdateReferences(int32 SlotIndexToRemove)
     UE_LOG(LogTemp, Log, TEXT("  → Removed inventory slot[%d]"), SlotIndexToRemove);
 }
 
+// ============================================================================
+// BATTERY ITEMS - mỗi viên pin đã dùng giữ ID trong UBatterySubsystem
+// ============================================================================
+
+bool UInventoryComponent::AddBatteryItem(FName ItemID, FGuid BatteryId)
+{
+    UBatterySubsystem* Batteries = UBatterySubsystem::Get(this);
+
+    if (!AddItem(ItemID, 1))
+    {
+        // Không còn chỗ -> viên pin rời game
+        if (Batteries)
+        {
+            Batteries->RemoveBattery(BatteryId);
+        }
+        return false;
+    }
+
+    if (!BatteryId.IsValid())
+    {
+        return true;
+    }
+
+    // Đơn vị vừa thêm chưa có ID -> gắn vào slot đầu tiên còn đơn vị không có ID
+    for (FInventorySlot& Slot : InventorySlots)
+    {
+        if (Slot.ItemID == ItemID && Slot.BatteryIds.Num() < Slot.Quantity)
+        {
+            Slot.BatteryIds.Add(BatteryId);
+            break;
+        }
+    }
+
+    return true;
+}
+
+FGuid UInventoryComponent::RemoveBatteryUnit(FName ItemID)
+{
+    // RemoveItem bớt ở slot cuối cùng có ItemID -> dồn viên được chọn về slot đó trước khi bớt
+    int32 LastSlotIndex = INDEX_NONE;
+    int32 FreshSlotIndex = INDEX_NONE;
+    for (int32 i = 0; i < InventorySlots.Num(); ++i)
+    {
+        const FInventorySlot& Slot = InventorySlots[i];
+        if (Slot.ItemID != ItemID || Slot.Quantity <= 0)
+        {
+            continue;
+        }
+
+        LastSlotIndex = i;
+        if (Slot.Quantity > Slot.BatteryIds.Num())
+        {
+            FreshSlotIndex = i;
+        }
+    }
+
+    if (LastSlotIndex == INDEX_NONE)
+    {
+        return FGuid();
+    }
+
+    FInventorySlot& LastSlot = InventorySlots[LastSlotIndex];
+    FGuid TakenBatteryId;
+
+    if (FreshSlotIndex != INDEX_NONE)
+    {
+        // Còn pin mới: slot cuối phải có một đơn vị không ID để bớt
+        if (FreshSlotIndex != LastSlotIndex)
+        {
+            InventorySlots[FreshSlotIndex].BatteryIds.Add(LastSlot.BatteryIds.Pop());
+        }
+    }
+    else
+    {
+        // Chỉ còn pin đã dùng: lấy viên còn nhiều charge nhất
+        const UBatterySubsystem* Batteries = UBatterySubsystem::Get(this);
+        int32 BestSlotIndex = LastSlotIndex;
+        int32 BestBatteryIndex = 0;
+        float BestCharge = -1.0f;
+
+        for (int32 i = 0; i < InventorySlots.Num(); ++i)
+        {
+            const FInventorySlot& Slot = InventorySlots[i];
+            if (Slot.ItemID != ItemID)
+            {
+                continue;
+            }
+
+            for (int32 j = 0; j < Slot.BatteryIds.Num(); ++j)
+            {
+                const float Charge = Batteries ? Batteries->GetCharge(Slot.BatteryIds[j]) : 0.0f;
+                if (Charge > BestCharge)
+                {
+                    BestCharge = Charge;
+                    BestSlotIndex = i;
+                    BestBatteryIndex = j;
+                }
+            }
+        }
+
+        FInventorySlot& BestSlot = InventorySlots[BestSlotIndex];
+        TakenBatteryId = BestSlot.BatteryIds[BestBatteryIndex];
+        BestSlot.BatteryIds.RemoveAtSwap(BestBatteryIndex);
+        if (BestSlotIndex != LastSlotIndex)
+        {
+            BestSlot.BatteryIds.Add(LastSlot.BatteryIds.Pop());
+        }
+    }
+
+    RemoveItem(ItemID, 1);
+    return TakenBatteryId;
+}
+
 // ============================================================================
 // USE ITEMS - IMPROVED VALIDATION
 // ============================================================================
@@ -316,21 +442,29 @@ bool UInventoryComponent::UseItem(FName ItemID)
             return false;
         }
 
-        float CurrentBattery = FlashlightComp->GetCurrentBattery();
-        if (CurrentBattery >= 100.0f)
+        if (FlashlightComp->GetBatteryPercentage() >= 100.0f)
         {
             UE_LOG(LogTemp, Warning, TEXT("UseItem: Battery is already full!"));
             OnItemUsed.Broadcast(ItemID, false);
             return false;
         }
 
-        FlashlightComp->AddBatteryCharge(ItemData.BatteryChargePercent);
-        RemoveItem(ItemID, 1);
+        // Đổi pin: viên lấy ra từ inventory được lắp vào, viên trong đèn (nếu còn charge) quay lại inventory
+        const FGuid StoredBatteryId = RemoveBatteryUnit(ItemID);
+        const FGuid EjectedBatteryId = StoredBatteryId.IsValid()
+            ? FlashlightComp->SwapBattery(StoredBatteryId)
+            : FlashlightComp->ReplaceBattery(ItemData.BatteryChargePercent / 100.0f);
+
+        if (EjectedBatteryId.IsValid())
+        {
+            AddBatteryItem(ItemID, EjectedBatteryId);
+        }
+
         PlayItemSound(ItemData.UseSound);
         OnItemUsed.Broadcast(ItemID, true);
         OnInventoryUpdated.Broadcast();
 
-        UE_LOG(LogTemp, Log, TEXT("Battery replaced (+%.0f%%)"), ItemData.BatteryChargePercent);
+        UE_LOG(LogTemp, Log, TEXT("Battery replaced (%.0f%%)"), FlashlightComp->GetBatteryPercentage());
         return true;
     }
 
@@ -815,6 +949,8 @@ bool UInventoryComponent::DropItem(FName ItemID, int32 Quantity)
     FActorSpawnParameters SpawnParams;
     SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 
+    const bool bIsBattery = ItemData.ItemType == EItemType::Consumable && ItemData.ConsumableType == EConsumableType::Battery;
+
     // Spawn pickup actors
     for (int32 i = 0; i < Quantity; ++i)
     {
@@ -832,6 +968,20 @@ bool UInventoryComponent::DropItem(FName ItemID, int32 Quantity)
             SpawnParams
         );
 
+        // Pin được bỏ từng viên; pin đã dùng mang ID theo pickup để nhặt lại vẫn giữ charge
+        if (bIsBattery)
+        {
+            const FGuid DroppedBatteryId = RemoveBatteryUnit(ItemID);
+            if (Dropped)
+            {
+                Dropped->BatteryId = DroppedBatteryId;
+            }
+            else if (UBatterySubsystem* Batteries = UBatterySubsystem::Get(this))
+            {
+                Batteries->RemoveBattery(DroppedBatteryId);
+            }
+        }
+
         if (Dropped)
         {
             Dropped->ItemID = ItemID;
@@ -850,10 +1000,18 @@ bool UInventoryComponent::DropItem(FName ItemID, int32 Quantity)
         }
     }
 
-    // Remove from inventory
-    RemoveItem(ItemID, Quantity);
+    // Remove from inventory (pin đã được bỏ từng viên ở trên)
+    if (!bIsBattery)
+    {
+        RemoveItem(ItemID, Quantity);
+    }
     PlayItemSound(ItemData.UseSound);
 
+    if (UNoiseFieldSubsystem* NoiseField = UNoiseFieldSubsystem::Get(Owner))
+    {
+        NoiseField->ReportNoise(BaseLocation, DropNoiseLoudness, Owner, ENoiseSource::DroppedItem);
+    }
+
     UE_LOG(LogTemp, Log, TEXT("Dropped %d x %s"), Quantity, *ItemData.ItemName.ToString());
     return true;
 }
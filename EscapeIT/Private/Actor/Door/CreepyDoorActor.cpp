@@ -7,6 +7,9 @@
 #include "Components/TimelineComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "TimerManager.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "GameSystem/MaterialParameterAnimator.h"
+#include "AI/AIDirectorSubsystem.h"
 
 ACreepyDoorActor::ACreepyDoorActor()
 {
@@ -90,6 +93,13 @@ void ACreepyDoorActor::BeginPlay()
 		&ACreepyDoorActor::OpenDoorWithCreepyEffects, 3.0f, false);
 }
 
+void ACreepyDoorActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ReleaseBreachToken();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ACreepyDoorActor::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
@@ -105,6 +115,14 @@ void ACreepyDoorActor::Tick(float DeltaTime)
 	{
 		UpdateShadowMovement(DeltaTime);
 	}
+
+	// Chuỗi mở cửa đã xong (không còn chạy, pause hay đóng-mở ngẫu nhiên) -> trả token cho cửa khác
+	if (bHoldsBreachToken && DoorTimeline && !DoorTimeline->IsPlaying()
+		&& !GetWorldTimerManager().IsTimerActive(PauseTimerHandle)
+		&& !GetWorldTimerManager().IsTimerActive(RandomCloseTimerHandle))
+	{
+		ReleaseBreachToken();
+	}
 }
 
 // ============================================================================
@@ -117,6 +135,14 @@ void ACreepyDoorActor::OpenDoorWithCreepyEffects()
 		return;
 	}
 
+	// Director chưa cho breach (cửa khác đang mở, vừa có scare, sanity thấp) -> thử lại sau
+	if (!AcquireBreachToken())
+	{
+		GetWorldTimerManager().SetTimer(BreachRetryTimerHandle, this,
+			&ACreepyDoorActor::OpenDoorWithCreepyEffects, BreachRetryInterval, false);
+		return;
+	}
+
 	// FIX: Clear tất cả timer cũ trước khi bắt đầu
 	ClearAllTimers();
 
@@ -380,6 +406,23 @@ void ACreepyDoorActor::ShowShadowFigure()
 	ShadowMoveProgress = 0.0f;
 
 	// FIX: Không cần timer riêng, dùng Tick để update
+	// Opacity do MaterialParameterAnimator chạy cùng lượt với các fade khác
+	if (ShadowDynamicMaterial)
+	{
+		if (UMaterialParameterAnimator* Animator = UMaterialParameterAnimator::Get(this))
+		{
+			Animator->CancelTrack(ShadowOpacityTrackId);
+
+			FMaterialParameterTrackDesc OpacityTrack;
+			OpacityTrack.Material = ShadowDynamicMaterial;
+			OpacityTrack.ParameterName = FName("Opacity");
+			OpacityTrack.From = 1.0f;
+			OpacityTrack.To = 0.0f;
+			OpacityTrack.Duration = ShadowMoveDuration;
+			OpacityTrack.Owner = this;
+			ShadowOpacityTrackId = Animator->AddTrack(MoveTemp(OpacityTrack));
+		}
+	}
 }
 
 // FIX: Thêm DeltaTime parameter
@@ -403,13 +446,6 @@ void ACreepyDoorActor::UpdateShadowMovement(float DeltaTime)
 	FVector CurrentLocation = FMath::Lerp(
 		ShadowStartLocation, ShadowEndLocation, ShadowMoveProgress);
 	ShadowFigure->SetRelativeLocation(CurrentLocation);
-
-	// FIX: Dùng material đã tạo sẵn, không tạo mới mỗi frame
-	if (ShadowDynamicMaterial)
-	{
-		float Opacity = 1.0f - ShadowMoveProgress;
-		ShadowDynamicMaterial->SetScalarParameterValue(FName("Opacity"), Opacity);
-	}
 }
 
 void ACreepyDoorActor::HideShadowFigure()
@@ -420,6 +456,12 @@ void ACreepyDoorActor::HideShadowFigure()
 	}
 
 	ShadowMoveProgress = 0.0f;
+
+	if (UMaterialParameterAnimator* Animator = UMaterialParameterAnimator::Get(this))
+	{
+		Animator->CancelTrack(ShadowOpacityTrackId);
+	}
+	ShadowOpacityTrackId = INDEX_NONE;
 }
 
 void ACreepyDoorActor::UpdateDoorRotation_Implementation(float Value)
@@ -458,6 +500,37 @@ void ACreepyDoorActor::CloseDoor_Implementation()
 
 	// FIX: Clear tất cả timers
 	ClearAllTimers();
+
+	ReleaseBreachToken();
+}
+
+// ============================================================================
+// AI DIRECTOR: token DoorBreach
+// ============================================================================
+bool ACreepyDoorActor::AcquireBreachToken()
+{
+	UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(this);
+	if (!Director)
+	{
+		return true;
+	}
+
+	bHoldsBreachToken = Director->TryAcquireToken(EAIDirectorToken::DoorBreach, this);
+	return bHoldsBreachToken;
+}
+
+void ACreepyDoorActor::ReleaseBreachToken()
+{
+	if (!bHoldsBreachToken)
+	{
+		return;
+	}
+
+	bHoldsBreachToken = false;
+	if (UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(this))
+	{
+		Director->ReleaseToken(EAIDirectorToken::DoorBreach, this);
+	}
 }
 
 // FIX: Thêm helper function để clear tất cả timers
@@ -467,6 +540,7 @@ void ACreepyDoorActor::ClearAllTimers()
 	GetWorldTimerManager().ClearTimer(ShakeTimerHandle);
 	GetWorldTimerManager().ClearTimer(PauseTimerHandle);
 	GetWorldTimerManager().ClearTimer(RandomCloseTimerHandle);
+	GetWorldTimerManager().ClearTimer(BreachRetryTimerHandle);
 	
 	// Reset flags
 	bIsShaking = false;
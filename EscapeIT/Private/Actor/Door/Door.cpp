@@ -5,6 +5,7 @@
 #include "Curves/CurveFloat.h"
 #include "GameSystem/AudioManager.h"
 #include "Components/WidgetComponent.h"
+#include "AI/NoiseFieldSubsystem.h"
 
 ADoor::ADoor()
 {
@@ -117,6 +118,11 @@ void ADoor::OpenDoor_Implementation()
     {
         AudioManager->PlayOpenDoorSound();
     }
+
+    if (UNoiseFieldSubsystem* NoiseField = UNoiseFieldSubsystem::Get(this))
+    {
+        NoiseField->ReportNoise(GetActorLocation(), DoorNoiseLoudness, this, ENoiseSource::Door);
+    }
 }
 
 void ADoor::CloseDoor_Implementation()
@@ -125,4 +131,9 @@ void ADoor::CloseDoor_Implementation()
     {
         AudioManager->PlayCloseDoorSound();
     }
+
+    if (UNoiseFieldSubsystem* NoiseField = UNoiseFieldSubsystem::Get(this))
+    {
+        NoiseField->ReportNoise(GetActorLocation(), DoorNoiseLoudness, this, ENoiseSource::Door);
+    }
 }
\ No newline at end of file
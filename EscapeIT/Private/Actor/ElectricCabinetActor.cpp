@@ -4,6 +4,7 @@
 #include "GameInstance/PowerSystemManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
 #include "UI/NotificationWidget.h"
 #include "UI/HUD/WidgetManager.h"
 
@@ -26,6 +27,73 @@ void AElectricCabinetActor::Tick(float DeltaTime)
     Super::Tick(DeltaTime);
 }
 
+void AElectricCabinetActor::OnInteractionBeginOverlap_Implementation(
+    UPrimitiveComponent* OverlappedComponent,
+    AActor* OtherActor,
+    UPrimitiveComponent* OtherComp,
+    int32 OtherBodyIndex,
+    bool bFromSweep,
+    const FHitResult& SweepResult)
+{
+    Super::OnInteractionBeginOverlap_Implementation(
+        OverlappedComponent, OtherActor, OtherComp, OtherBodyIndex, bFromSweep, SweepResult);
+    
+    APawn* Pawn = Cast<APawn>(OtherActor);
+    if (!Pawn || !Pawn->IsPlayerControlled())
+    {
+        return;
+    }
+    
+    // Start generating while the player walks up and opens the door
+    PrewarmPuzzle(Cast<APlayerController>(Pawn->GetController()));
+}
+
+void AElectricCabinetActor::OnInteractionEndOverlap_Implementation(
+    UPrimitiveComponent* OverlappedComponent,
+    AActor* OtherActor,
+    UPrimitiveComponent* OtherComp,
+    int32 OtherBodyIndex)
+{
+    Super::OnInteractionEndOverlap_Implementation(
+        OverlappedComponent, OtherActor, OtherComp, OtherBodyIndex);
+    
+    APawn* Pawn = Cast<APawn>(OtherActor);
+    if (!Pawn || !Pawn->IsPlayerControlled())
+    {
+        return;
+    }
+    
+    // Player walked away without opening the cabinet
+    if (!bIsOpen && ElectricCabinetWidget)
+    {
+        ElectricCabinetWidget->CancelPuzzlePrewarm();
+    }
+}
+
+bool AElectricCabinetActor::NeedsRepair() const
+{
+    if (!bCanInteract || bIsRepaired)
+    {
+        return false;
+    }
+    
+    const UPowerSystemManager* PowerSystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<UPowerSystemManager>() : nullptr;
+    return PowerSystem && !PowerSystem->IsPowerOn();
+}
+
+void AElectricCabinetActor::PrewarmPuzzle(APlayerController* PlayerController)
+{
+    if (!PlayerController || !NeedsRepair())
+    {
+        return;
+    }
+    
+    if (EnsurePuzzleWidget(PlayerController))
+    {
+        ElectricCabinetWidget->PrewarmPuzzle();
+    }
+}
+
 void AElectricCabinetActor::CalculateDoorOpenDirection_Implementation(AActor* Interactor)
 {
     Super::CalculateDoorOpenDirection_Implementation(Interactor);
@@ -68,6 +136,9 @@ void AElectricCabinetActor::Interact_Implementation(AActor* Interactor)
         OpenDoor_Implementation();
         bIsOpen = true; 
         
+        // No-op if the overlap already started it; otherwise the door animation covers generation
+        PrewarmPuzzle(CachedPlayerController);
+        
         UE_LOG(LogTemp, Log, TEXT("Opening cabinet door..."));
         
         if (WidgetShowTimerHandle.IsValid())
@@ -123,27 +194,36 @@ void AElectricCabinetActor::OnDoorOpenFinished()
     CachedPlayerController = nullptr;
 }
 
-void AElectricCabinetActor::ShowPuzzleWidget(APlayerController* PlayerController)
+bool AElectricCabinetActor::EnsurePuzzleWidget(APlayerController* PlayerController)
 {
+    if (ElectricCabinetWidget)
+    {
+        return true;
+    }
+    
     if (!ElectricCabinetWidgetClass)
     {
         UE_LOG(LogTemp, Error, TEXT("ElectricCabinetWidgetClass not set!"));
-        return;
+        return false;
     }
     
+    ElectricCabinetWidget = CreateWidget<UElectricCabinetWidget>(PlayerController, ElectricCabinetWidgetClass);
     if (!ElectricCabinetWidget)
     {
-        ElectricCabinetWidget = CreateWidget<UElectricCabinetWidget>(PlayerController, ElectricCabinetWidgetClass);
-        if (ElectricCabinetWidget)
-        {
-            ElectricCabinetWidget->OnPuzzleCompleted.AddDynamic(this, &AElectricCabinetActor::OnPuzzleCompleted);
-            UE_LOG(LogTemp, Log, TEXT("ElectricCabinetWidget created successfully"));
-        }
-        else
-        {
-            UE_LOG(LogTemp, Error, TEXT("Failed to create ElectricCabinetWidget"));
-            return;
-        }
+        UE_LOG(LogTemp, Error, TEXT("Failed to create ElectricCabinetWidget"));
+        return false;
+    }
+    
+    ElectricCabinetWidget->OnPuzzleCompleted.AddDynamic(this, &AElectricCabinetActor::OnPuzzleCompleted);
+    UE_LOG(LogTemp, Log, TEXT("ElectricCabinetWidget created successfully"));
+    return true;
+}
+
+void AElectricCabinetActor::ShowPuzzleWidget(APlayerController* PlayerController)
+{
+    if (!EnsurePuzzleWidget(PlayerController))
+    {
+        return;
     }
     
     if (ElectricCabinetWidget->IsInViewport())
@@ -4,6 +4,7 @@
 #include "Components/PointLightComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/AudioComponent.h"
+#include "Particles/ParticleSystem.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Camera/CameraShakeBase.h"
@@ -11,6 +12,7 @@
 #include "Engine/World.h"
 #include "Sound/SoundBase.h"
 #include "Pawn/LobbyCamera.h"
+#include "GameSystem/EffectPoolSubsystem.h"
 
 AFlickLightActor::AFlickLightActor()
 {
@@ -36,6 +38,22 @@ void AFlickLightActor::BeginPlay()
 	PointLight->SetIntensity(NormalLightIntensity);
 	PointLight->SetLightColor(NormalLightColor);
 
+	// Tạo sẵn particle trong pool để lần chớp đầu không phải tạo component.
+	// Tia lửa là effect môi trường -> cull mặc định; ghost appear là effect scare -> không cull
+	if (UEffectPoolSubsystem* EffectPool = UEffectPoolSubsystem::Get(this))
+	{
+		if (ElectricalSparkParticle)
+		{
+			EffectPool->Prewarm(ElectricalSparkParticle);
+		}
+
+		if (GhostAppearParticle)
+		{
+			EffectPool->ConfigureEffect(GhostAppearParticle, FEffectPoolSettings::AlwaysRelevant());
+			EffectPool->Prewarm(GhostAppearParticle);
+		}
+	}
+
 	// Auto start flicker sequence
 	GetWorldTimerManager().SetTimer(DelayTimerHandle, this, &AFlickLightActor::StartFlickerSequence, DelayBeforeFlicker, false);
 }
@@ -87,7 +105,10 @@ void AFlickLightActor::UpdateFlicker(float DeltaTime)
 		// Spawn electrical sparks occasionally
 		if (ElectricalSparkParticle && FMath::RandRange(0.0f, 1.0f) > 0.7f)
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ElectricalSparkParticle, GetActorLocation());
+			if (UEffectPoolSubsystem* EffectPool = UEffectPoolSubsystem::Get(this))
+			{
+				EffectPool->SpawnEffectAtLocation(ElectricalSparkParticle, GetActorLocation());
+			}
 		}
 	}
 
@@ -208,7 +229,10 @@ void AFlickLightActor::SpawnGhost()
 		// Spawn ghost appearance particle effect
 		if (GhostAppearParticle)
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(World, GhostAppearParticle, SpawnLocation);
+			if (UEffectPoolSubsystem* EffectPool = UEffectPoolSubsystem::Get(this))
+			{
+				EffectPool->SpawnEffectAtLocation(GhostAppearParticle, SpawnLocation);
+			}
 		}
 	}
 }
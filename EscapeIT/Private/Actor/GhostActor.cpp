@@ -5,6 +5,8 @@
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerController.h"
+#include "GameSystem/MaterialParameterAnimator.h"
+#include "GameSystem/FlashlightIlluminationSubsystem.h"
 
 AGhostActor::AGhostActor()
 {
@@ -27,7 +29,9 @@ void AGhostActor::BeginPlay()
 	FloatOffset = FMath::RandRange(0.0f, PI * 2.0f); // Random start phase
 
 	CreateDynamicMaterials();
-	UpdateMaterialOpacity(0.0f); // Start invisible
+
+	// Start invisible, fade in qua MaterialParameterAnimator
+	StartMaterialFade(0.0f, 1.0f, FadeInDuration, EEasingFunc::EaseIn, [this]() { OnFadeInFinished(); });
 
 	// Schedule disappearance if set
 	if (DisappearAfterTime > 0.0f)
@@ -35,9 +39,32 @@ void AGhostActor::BeginPlay()
 		GetWorldTimerManager().SetTimer(DisappearTimerHandle, this, &AGhostActor::StartFadeOut, DisappearAfterTime, false);
 	}
 
+	if (UFlashlightIlluminationSubsystem* Illumination = UFlashlightIlluminationSubsystem::Get(this))
+	{
+		Illumination->RegisterTarget(this, FlashlightTargetRadius);
+		Illumination->OnIlluminationChanged.AddDynamic(this, &AGhostActor::HandleIlluminationChanged);
+	}
+
 	UE_LOG(LogTemp, Warning, TEXT("👻 Ghost actor initialized"));
 }
 
+void AGhostActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UMaterialParameterAnimator* Animator = UMaterialParameterAnimator::Get(this))
+	{
+		Animator->CancelTracksForOwner(this);
+		Animator->SetOwnerPaused(this, false);
+	}
+
+	if (UFlashlightIlluminationSubsystem* Illumination = UFlashlightIlluminationSubsystem::Get(this))
+	{
+		Illumination->UnregisterTarget(this);
+		Illumination->OnIlluminationChanged.RemoveDynamic(this, &AGhostActor::HandleIlluminationChanged);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AGhostActor::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
@@ -47,10 +74,10 @@ void AGhostActor::Tick(float DeltaTime)
 
 	LifetimeTimer += DeltaTime;
 
-	// Update fade in/out
+	// Material được animator cập nhật, ở đây chỉ đọc lại tiến độ fade
 	if (bIsFadingIn || bIsFadingOut)
 	{
-		UpdateFade(DeltaTime);
+		UpdateFade();
 	}
 
 	// Update rotation to face player
@@ -109,37 +136,91 @@ void AGhostActor::CreateDynamicMaterials()
 	}
 }
 
-void AGhostActor::UpdateFade(float DeltaTime)
+void AGhostActor::UpdateFade()
 {
-	if (bIsFadingIn)
+	const UMaterialParameterAnimator* Animator = UMaterialParameterAnimator::Get(this);
+	const float Alpha = Animator ? Animator->GetTrackAlpha(FadeTrackId) : -1.0f;
+	if (Alpha >= 0.0f)
 	{
-		FadeTimer += DeltaTime;
-		CurrentFadeValue = FMath::Clamp(FadeTimer / FadeInDuration, 0.0f, 1.0f);
-
-		// Ease-in curve for smoother fade
-		float EasedValue = FMath::InterpEaseIn(0.0f, 1.0f, CurrentFadeValue, 2.0f);
-		UpdateMaterialOpacity(EasedValue);
+		CurrentFadeValue = FMath::Lerp(FadeFromValue, FadeToValue, Alpha);
+	}
+}
 
-		if (CurrentFadeValue >= 1.0f)
-		{
-			bIsFadingIn = false;
-			UE_LOG(LogTemp, Warning, TEXT("👻 Ghost fully materialized"));
-		}
+void AGhostActor::StartMaterialFade(float FromValue, float ToValue, float Duration, EEasingFunc::Type EasingFunc, TFunction<void()>&& OnFinished)
+{
+	UMaterialParameterAnimator* Animator = UMaterialParameterAnimator::Get(this);
+	if (Animator)
+	{
+		Animator->CancelTracksForOwner(this);
 	}
-	else if (bIsFadingOut)
+
+	FadeFromValue = FromValue;
+	FadeToValue = ToValue;
+	CurrentFadeValue = FromValue;
+	FadeTrackId = INDEX_NONE;
+
+	if (!Animator || DynamicMaterials.Num() == 0)
 	{
-		FadeTimer -= DeltaTime;
-		CurrentFadeValue = FMath::Clamp(FadeTimer / FadeInDuration, 0.0f, 1.0f);
+		CurrentFadeValue = ToValue;
+		OnFinished();
+		return;
+	}
 
-		float EasedValue = FMath::InterpEaseOut(0.0f, 1.0f, CurrentFadeValue, 2.0f);
-		UpdateMaterialOpacity(EasedValue);
+	// Opacity và emissive (= opacity * 2) chạy cùng duration nên kết thúc cùng một lượt tick,
+	// completion chỉ gắn vào track đầu tiên
+	for (UMaterialInstanceDynamic* DynMat : DynamicMaterials)
+	{
+		if (!DynMat)
+		{
+			continue;
+		}
 
-		if (CurrentFadeValue <= 0.0f)
+		FMaterialParameterTrackDesc OpacityTrack;
+		OpacityTrack.Material = DynMat;
+		OpacityTrack.ParameterName = OpacityParameterName;
+		OpacityTrack.From = FromValue;
+		OpacityTrack.To = ToValue;
+		OpacityTrack.Duration = Duration;
+		OpacityTrack.EasingFunc = EasingFunc;
+		OpacityTrack.Owner = this;
+
+		FMaterialParameterTrackDesc EmissiveTrack = OpacityTrack;
+		EmissiveTrack.ParameterName = EmissiveStrengthParameterName;
+		EmissiveTrack.From = FromValue * 2.0f;
+		EmissiveTrack.To = ToValue * 2.0f;
+
+		if (FadeTrackId == INDEX_NONE)
+		{
+			OpacityTrack.OnCompleted = OnFinished;
+			FadeTrackId = Animator->AddTrack(MoveTemp(OpacityTrack));
+		}
+		else
 		{
-			UE_LOG(LogTemp, Warning, TEXT("👻 Ghost disappeared"));
-			Destroy();
+			Animator->AddTrack(MoveTemp(OpacityTrack));
 		}
+		Animator->AddTrack(MoveTemp(EmissiveTrack));
 	}
+
+	// Material không có parameter opacity -> kết thúc fade ngay
+	if (FadeTrackId == INDEX_NONE)
+	{
+		CurrentFadeValue = ToValue;
+		OnFinished();
+	}
+}
+
+void AGhostActor::OnFadeInFinished()
+{
+	bIsFadingIn = false;
+	CurrentFadeValue = 1.0f;
+	UE_LOG(LogTemp, Warning, TEXT("👻 Ghost fully materialized"));
+}
+
+void AGhostActor::OnFadeOutFinished()
+{
+	CurrentFadeValue = 0.0f;
+	UE_LOG(LogTemp, Warning, TEXT("👻 Ghost disappeared"));
+	Destroy();
 }
 
 void AGhostActor::UpdateRotation(float DeltaTime)
@@ -163,27 +244,14 @@ void AGhostActor::UpdateRotation(float DeltaTime)
 	SetActorRotation(NewRotation);
 }
 
-void AGhostActor::UpdateMaterialOpacity(float Opacity)
-{
-	for (UMaterialInstanceDynamic* DynMat : DynamicMaterials)
-	{
-		if (DynMat)
-		{
-			// Set opacity parameter
-			DynMat->SetScalarParameterValue(OpacityParameterName, Opacity);
-
-			// Optionally increase emissive strength as it fades in
-			float EmissiveValue = Opacity * 2.0f;
-			DynMat->SetScalarParameterValue(EmissiveStrengthParameterName, EmissiveValue);
-		}
-	}
-}
-
 void AGhostActor::StartFadeOut()
 {
 	bIsFadingOut = true;
 	bIsFadingIn = false;
-	FadeTimer = FadeInDuration * CurrentFadeValue; // Start from current opacity
+
+	// Start from current opacity
+	StartMaterialFade(CurrentFadeValue, 0.0f, FadeInDuration * CurrentFadeValue, EEasingFunc::EaseOut,
+		[this]() { OnFadeOutFinished(); });
 
 	UE_LOG(LogTemp, Warning, TEXT("👻 Ghost starting to fade out..."));
 }
@@ -248,6 +316,14 @@ void AGhostActor::TriggerJumpscare()
 	// StartFadeOut();
 }
 
+void AGhostActor::HandleIlluminationChanged(AActor* Target, bool bIsLit)
+{
+	if (Target == this)
+	{
+		OnFlashlightBeamChanged(bIsLit);
+	}
+}
+
 void AGhostActor::ForceDisappear()
 {
 	UE_LOG(LogTemp, Warning, TEXT("👻 Ghost force disappeared"));
@@ -270,11 +346,19 @@ void AGhostActor::StartFadeOutNow()
 void AGhostActor::PauseAllEffects()
 {
 	bIsPaused = true;
+	if (UMaterialParameterAnimator* Animator = UMaterialParameterAnimator::Get(this))
+	{
+		Animator->SetOwnerPaused(this, true);
+	}
 	UE_LOG(LogTemp, Warning, TEXT("👻 Ghost effects paused"));
 }
 
 void AGhostActor::ResumeAllEffects()
 {
 	bIsPaused = false;
+	if (UMaterialParameterAnimator* Animator = UMaterialParameterAnimator::Get(this))
+	{
+		Animator->SetOwnerPaused(this, false);
+	}
 	UE_LOG(LogTemp, Warning, TEXT("👻 Ghost effects resumed"));
 }
\ No newline at end of file
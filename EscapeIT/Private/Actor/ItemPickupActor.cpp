@@ -112,7 +112,11 @@ void AItemPickupActor::PickupItem(AActor* Collector)
         return;
     }
 
-    if (Inventory->AddItem(ItemID, Quantity))
+    const bool bAdded = BatteryId.IsValid()
+        ? Inventory->AddBatteryItem(ItemID, BatteryId)
+        : Inventory->AddItem(ItemID, Quantity);
+
+    if (bAdded)
     {
         PlayPickupEffects(ItemData);
         
@@ -20,6 +20,9 @@
 #include "UI/SanityWidget.h"
 #include "UI/HUD/WidgetManager.h"
 #include "Actor/Components/SanityComponent.h"
+#include "GameSystem/EffectPoolSubsystem.h"
+#include "AI/NoiseFieldSubsystem.h"
+#include "AI/AIDirectorSubsystem.h"
 
 AWindowJumpscareActor::AWindowJumpscareActor()
 {
@@ -122,6 +125,21 @@ void AWindowJumpscareActor::BeginPlay()
 	{
 		FlickerLight->SetLightColor(FlickerColor);
 	}
+
+	// Jumpscare effect luôn phải hiện -> không cull theo khoảng cách/góc nhìn
+	if (UEffectPoolSubsystem* EffectPool = UEffectPoolSubsystem::Get(this))
+	{
+		const FEffectPoolSettings JumpscareEffectSettings = FEffectPoolSettings::AlwaysRelevant();
+
+		for (UParticleSystem* Effect : { GhostAppearEffect.Get(), WindowBurstEffect.Get() })
+		{
+			if (Effect)
+			{
+				EffectPool->ConfigureEffect(Effect, JumpscareEffectSettings);
+				EffectPool->Prewarm(Effect);
+			}
+		}
+	}
 }
 
 void AWindowJumpscareActor::Tick(float DeltaTime)
@@ -248,6 +266,17 @@ void AWindowJumpscareActor::TriggerJumpscare()
 	DisableInput(PlayerCon);
 	OriginalViewTarget = PlayerCon->GetViewTarget();
 
+	if (UNoiseFieldSubsystem* NoiseField = UNoiseFieldSubsystem::Get(this))
+	{
+		NoiseField->ReportNoise(GetActorLocation(), JumpscareNoiseLoudness, this, ENoiseSource::JumpScare);
+	}
+
+	// Scare của level cũng tính vào nhịp độ: NPC tạm bớt đuổi/jumpscare
+	if (UAIDirectorSubsystem* Director = UAIDirectorSubsystem::Get(this))
+	{
+		Director->NotifyScare();
+	}
+
 	// Select random ghost if enabled
 	if (bUseRandomGhost && GhostMeshVariations.Num() > 0)
 	{
@@ -397,36 +426,24 @@ void AWindowJumpscareActor::RestoreTimeScale()
 
 void AWindowJumpscareActor::SpawnParticleEffects()
 {
+	UEffectPoolSubsystem* EffectPool = UEffectPoolSubsystem::Get(this);
+	if (!EffectPool)
+	{
+		return;
+	}
+
 	if (GhostAppearEffect)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(
-			GetWorld(),
-			GhostAppearEffect,
-			GhostMesh->GetComponentLocation(),
-			FRotator::ZeroRotator,
-			true
-		);
+		EffectPool->SpawnEffectAtLocation(GhostAppearEffect, GhostMesh->GetComponentLocation());
 	}
 
 	if (WindowBurstEffect)
 	{
 		// Spawn at left window
-		UGameplayStatics::SpawnEmitterAtLocation(
-			GetWorld(),
-			WindowBurstEffect,
-			LeftWindowMesh->GetComponentLocation(),
-			FRotator::ZeroRotator,
-			true
-		);
+		EffectPool->SpawnEffectAtLocation(WindowBurstEffect, LeftWindowMesh->GetComponentLocation());
 
 		// Spawn at right window
-		UGameplayStatics::SpawnEmitterAtLocation(
-			GetWorld(),
-			WindowBurstEffect,
-			RightWindowMesh->GetComponentLocation(),
-			FRotator::ZeroRotator,
-			true
-		);
+		EffectPool->SpawnEffectAtLocation(WindowBurstEffect, RightWindowMesh->GetComponentLocation());
 	}
 }
 
@@ -0,0 +1,215 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/AITraceDiffCommandlet.h"
+#include "AI/AIDecisionTrace.h"
+#include "EscapeIT.h"
+
+namespace AITraceDiff
+{
+	struct FDivergence
+	{
+		FString AgentName;
+		int32 AgentA = INDEX_NONE;
+		int32 AgentB = INDEX_NONE;
+		// Vị trí bản ghi lệch trong Records của từng file (INDEX_NONE = file đó không có)
+		int32 RecordA = INDEX_NONE;
+		int32 RecordB = INDEX_NONE;
+		uint32 Frame = 0;
+	};
+
+	static bool RecordsMatch(const FAIDecisionTraceFile& A, const FAITraceRecord& RecordA,
+		const FAIDecisionTraceFile& B, const FAITraceRecord& RecordB, bool bCompareFrames, float Tolerance)
+	{
+		if (RecordA.Type != RecordB.Type || RecordA.Code != RecordB.Code)
+		{
+			return false;
+		}
+
+		if (bCompareFrames && RecordA.Frame != RecordB.Frame)
+		{
+			return false;
+		}
+
+		// Id là index bảng chuỗi riêng của từng file -> so chuỗi
+		if (A.GetString(RecordA.Id) != B.GetString(RecordB.Id))
+		{
+			return false;
+		}
+
+		return RecordA.Value.Equals(RecordB.Value, Tolerance);
+	}
+
+	/** Tìm chỗ lệch đầu tiên của một agent. Ring buffer có thể đã ghi đè -> ghép theo số thứ tự tuyệt đối */
+	static bool FindDivergence(const FAIDecisionTraceFile& A, const FAIDecisionTraceFile::FAgent& AgentA,
+		const FAIDecisionTraceFile& B, const FAIDecisionTraceFile::FAgent& AgentB,
+		bool bCompareFrames, float Tolerance, FDivergence& OutDivergence)
+	{
+		const uint64 FirstA = AgentA.TotalRecorded - AgentA.Records.Num();
+		const uint64 FirstB = AgentB.TotalRecorded - AgentB.Records.Num();
+		const uint64 First = FMath::Max(FirstA, FirstB);
+		const uint64 End = FMath::Min(AgentA.TotalRecorded, AgentB.TotalRecorded);
+
+		if (FirstA != FirstB)
+		{
+			UE_LOG(LogEscapeIT, Warning, TEXT("AITraceDiff: %s: ring buffers start at different records (%llu vs %llu), comparing from %llu"),
+				*AgentA.Name, FirstA, FirstB, First);
+		}
+
+		for (uint64 Sequence = First; Sequence < End; ++Sequence)
+		{
+			const int32 IndexA = static_cast<int32>(Sequence - FirstA);
+			const int32 IndexB = static_cast<int32>(Sequence - FirstB);
+			const FAITraceRecord& RecordA = AgentA.Records[IndexA];
+			const FAITraceRecord& RecordB = AgentB.Records[IndexB];
+
+			if (!RecordsMatch(A, RecordA, B, RecordB, bCompareFrames, Tolerance))
+			{
+				OutDivergence.RecordA = IndexA;
+				OutDivergence.RecordB = IndexB;
+				OutDivergence.Frame = FMath::Min(RecordA.Frame, RecordB.Frame);
+				return true;
+			}
+		}
+
+		// Một bên có thêm bản ghi ở cuối
+		if (AgentA.TotalRecorded != AgentB.TotalRecorded)
+		{
+			const bool bALonger = AgentA.TotalRecorded > AgentB.TotalRecorded;
+			const FAIDecisionTraceFile::FAgent& Longer = bALonger ? AgentA : AgentB;
+			const int32 ExtraIndex = static_cast<int32>(End - (bALonger ? FirstA : FirstB));
+
+			OutDivergence.RecordA = bALonger ? ExtraIndex : INDEX_NONE;
+			OutDivergence.RecordB = bALonger ? INDEX_NONE : ExtraIndex;
+			OutDivergence.Frame = Longer.Records.IsValidIndex(ExtraIndex) ? Longer.Records[ExtraIndex].Frame : 0;
+			return true;
+		}
+
+		return false;
+	}
+
+	static void LogContext(const TCHAR* Label, const FAIDecisionTraceFile& File, int32 AgentIndex, int32 RecordIndex, int32 Context)
+	{
+		if (!File.Agents.IsValidIndex(AgentIndex))
+		{
+			UE_LOG(LogEscapeIT, Display, TEXT("  %s: <agent missing>"), Label);
+			return;
+		}
+
+		const TArray<FAITraceRecord>& Records = File.Agents[AgentIndex].Records;
+		const int32 Last = RecordIndex == INDEX_NONE ? Records.Num() - 1 : RecordIndex;
+
+		for (int32 i = FMath::Max(0, Last - Context); i <= Last && i < Records.Num(); ++i)
+		{
+			UE_LOG(LogEscapeIT, Display, TEXT("  %s %s %s"), Label, i == RecordIndex ? TEXT(">>") : TEXT("  "), *File.DescribeRecord(Records[i]));
+		}
+
+		if (RecordIndex == INDEX_NONE)
+		{
+			UE_LOG(LogEscapeIT, Display, TEXT("  %s >> <end of trace>"), Label);
+		}
+	}
+}
+
+UAITraceDiffCommandlet::UAITraceDiffCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UAITraceDiffCommandlet::Main(const FString& Params)
+{
+	using namespace AITraceDiff;
+
+	FString PathA;
+	FString PathB;
+	if (!FParse::Value(*Params, TEXT("A="), PathA) || !FParse::Value(*Params, TEXT("B="), PathB))
+	{
+		UE_LOG(LogEscapeIT, Error, TEXT("AITraceDiff: usage -A=<trace> -B=<trace> [-Context=5] [-CompareFrames] [-Tolerance=1.0]"));
+		return 2;
+	}
+
+	int32 Context = 5;
+	float Tolerance = 1.0f;
+	FParse::Value(*Params, TEXT("Context="), Context);
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+	const bool bCompareFrames = FParse::Param(*Params, TEXT("CompareFrames"));
+
+	FAIDecisionTraceFile A;
+	FAIDecisionTraceFile B;
+	if (!A.Load(PathA) || !B.Load(PathB))
+	{
+		UE_LOG(LogEscapeIT, Error, TEXT("AITraceDiff: failed to read '%s' or '%s'"), *PathA, *PathB);
+		return 2;
+	}
+
+	if (A.Seed != B.Seed || A.MapName != B.MapName)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("AITraceDiff: traces come from different runs (seed %u on %s vs seed %u on %s)"),
+			A.Seed, *A.MapName, B.Seed, *B.MapName);
+	}
+
+	TMap<FString, int32> AgentsB;
+	for (int32 i = 0; i < B.Agents.Num(); ++i)
+	{
+		AgentsB.Add(B.Agents[i].Name, i);
+	}
+
+	TArray<FDivergence> Divergences;
+	for (int32 i = 0; i < A.Agents.Num(); ++i)
+	{
+		FDivergence Divergence;
+		Divergence.AgentName = A.Agents[i].Name;
+		Divergence.AgentA = i;
+
+		const int32* IndexB = AgentsB.Find(A.Agents[i].Name);
+		if (!IndexB)
+		{
+			Divergence.RecordA = 0;
+			Divergence.Frame = A.Agents[i].Records.Num() > 0 ? A.Agents[i].Records[0].Frame : 0;
+			Divergences.Add(Divergence);
+			continue;
+		}
+
+		Divergence.AgentB = *IndexB;
+		AgentsB.Remove(A.Agents[i].Name);
+
+		if (FindDivergence(A, A.Agents[i], B, B.Agents[*IndexB], bCompareFrames, Tolerance, Divergence))
+		{
+			Divergences.Add(Divergence);
+		}
+	}
+
+	// Agent chỉ có trong B
+	for (const TPair<FString, int32>& Remaining : AgentsB)
+	{
+		FDivergence Divergence;
+		Divergence.AgentName = Remaining.Key;
+		Divergence.AgentB = Remaining.Value;
+		Divergence.RecordB = 0;
+		Divergence.Frame = B.Agents[Remaining.Value].Records.Num() > 0 ? B.Agents[Remaining.Value].Records[0].Frame : 0;
+		Divergences.Add(Divergence);
+	}
+
+	if (Divergences.IsEmpty())
+	{
+		UE_LOG(LogEscapeIT, Display, TEXT("AITraceDiff: %d agent(s), traces are identical"), A.Agents.Num());
+		return 0;
+	}
+
+	Divergences.Sort([](const FDivergence& L, const FDivergence& R) { return L.Frame < R.Frame; });
+
+	const FDivergence& First = Divergences[0];
+	UE_LOG(LogEscapeIT, Display, TEXT("AITraceDiff: %d of %d agent(s) diverge; first divergence at frame %u in %s"),
+		Divergences.Num(), FMath::Max(A.Agents.Num(), B.Agents.Num()), First.Frame, *First.AgentName);
+	LogContext(TEXT("A"), A, First.AgentA, First.RecordA, Context);
+	LogContext(TEXT("B"), B, First.AgentB, First.RecordB, Context);
+
+	for (int32 i = 1; i < Divergences.Num(); ++i)
+	{
+		UE_LOG(LogEscapeIT, Display, TEXT("AITraceDiff: also diverges: %s at frame %u"), *Divergences[i].AgentName, Divergences[i].Frame);
+	}
+
+	return 1;
+}
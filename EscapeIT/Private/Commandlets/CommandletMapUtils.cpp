@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/CommandletMapUtils.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/World.h"
+#include "NavigationSystem.h"
+#include "UObject/Package.h"
+
+void EscapeITCommandlet::GatherMapPaths(const FString& Params, TArray<FString>& OutMapPaths)
+{
+	FString MapParam;
+	if (FParse::Value(*Params, TEXT("Map="), MapParam))
+	{
+		MapParam.ParseIntoArray(OutMapPaths, TEXT("+"));
+		return;
+	}
+
+	FString RootPath = TEXT("/Game");
+	FParse::Value(*Params, TEXT("Path="), RootPath);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UWorld::StaticClass()->GetClassPathName());
+	Filter.PackagePaths.Add(FName(*RootPath));
+	Filter.bRecursivePaths = true;
+
+	TArray<FAssetData> MapAssets;
+	AssetRegistry.GetAssets(Filter, MapAssets);
+	for (const FAssetData& MapAsset : MapAssets)
+	{
+		OutMapPaths.Add(MapAsset.PackageName.ToString());
+	}
+}
+
+UWorld* EscapeITCommandlet::LoadWorld(const FString& MapPath)
+{
+	UPackage* Package = LoadPackage(nullptr, *MapPath, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(true)
+			.CreateNavigation(true)
+			.CreateAISystem(false)
+			.AllowAudioPlayback(false));
+	}
+	World->UpdateWorldComponents(true, false);
+
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World))
+	{
+		// Đợi navmesh load/build xong trước khi query
+		NavSys->Build();
+	}
+
+	return World;
+}
+
+void EscapeITCommandlet::ReleaseWorld(UWorld* World)
+{
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+	CollectGarbage(RF_NoFlags);
+}
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+namespace EscapeITCommandlet
+{
+	/** Danh sách map: -Map=A+B, không có thì lấy mọi map dưới -Path (mặc định /Game) */
+	void GatherMapPaths(const FString& Params, TArray<FString>& OutMapPaths);
+
+	/**
+	 * Load map và khởi tạo world ở chế độ editor để có navigation system, navmesh đã lưu và collision cho trace.
+	 * Gọi ReleaseWorld khi xong. Trả về null nếu load thất bại.
+	 */
+	UWorld* LoadWorld(const FString& MapPath);
+	void ReleaseWorld(UWorld* World);
+}
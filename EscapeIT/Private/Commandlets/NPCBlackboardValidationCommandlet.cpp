@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/NPCBlackboardValidationCommandlet.h"
+#include "AI/NPCBlackboardSchema.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "EscapeIT.h"
+
+UNPCBlackboardValidationCommandlet::UNPCBlackboardValidationCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UNPCBlackboardValidationCommandlet::Main(const FString& Params)
+{
+	FString RootPath = TEXT("/Game");
+	FParse::Value(*Params, TEXT("Path="), RootPath);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UBehaviorTree::StaticClass()->GetClassPathName());
+	Filter.PackagePaths.Add(FName(*RootPath));
+	Filter.bRecursivePaths = true;
+
+	TArray<FAssetData> TreeAssets;
+	AssetRegistry.GetAssets(Filter, TreeAssets);
+
+	// Nhiều tree có thể dùng chung một blackboard -> chỉ kiểm tra mỗi asset một lần
+	TSet<const UBlackboardData*> CheckedBlackboards;
+	TArray<FString> Errors;
+	int32 NumTreesWithoutBlackboard = 0;
+
+	for (const FAssetData& TreeAsset : TreeAssets)
+	{
+		const UBehaviorTree* Tree = Cast<UBehaviorTree>(TreeAsset.GetAsset());
+		if (!Tree)
+		{
+			Errors.Add(FString::Printf(TEXT("%s: failed to load"), *TreeAsset.GetObjectPathString()));
+			continue;
+		}
+
+		if (!Tree->BlackboardAsset)
+		{
+			++NumTreesWithoutBlackboard;
+			Errors.Add(FString::Printf(TEXT("%s: no blackboard asset"), *Tree->GetPathName()));
+			continue;
+		}
+
+		bool bAlreadyChecked = false;
+		CheckedBlackboards.Add(Tree->BlackboardAsset, &bAlreadyChecked);
+		if (!bAlreadyChecked)
+		{
+			NPCBlackboard::ValidateBlackboardAsset(*Tree->BlackboardAsset, Errors);
+		}
+	}
+
+	for (const FString& Error : Errors)
+	{
+		UE_LOG(LogEscapeIT, Error, TEXT("NPCBlackboardValidation: %s"), *Error);
+	}
+
+	UE_LOG(LogEscapeIT, Display, TEXT("NPCBlackboardValidation: %d behavior tree(s), %d blackboard(s), %d without blackboard, %d error(s)"),
+		TreeAssets.Num(), CheckedBlackboards.Num(), NumTreesWithoutBlackboard, Errors.Num());
+
+	return Errors.Num() > 0 ? 1 : 0;
+}
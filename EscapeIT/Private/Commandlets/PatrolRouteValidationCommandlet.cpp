@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/PatrolRouteValidationCommandlet.h"
+#include "AI/PaTrolPath.h"
+#include "AI/PatrolRouteSubsystem.h"
+#include "Commandlets/CommandletMapUtils.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "EscapeIT.h"
+
+UPatrolRouteValidationCommandlet::UPatrolRouteValidationCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPatrolRouteValidationCommandlet::Main(const FString& Params)
+{
+	TArray<FString> MapPaths;
+	EscapeITCommandlet::GatherMapPaths(Params, MapPaths);
+
+	int32 NumRoutes = 0;
+	int32 NumErrors = 0;
+	int32 TotalQueriesSaved = 0;
+
+	for (const FString& MapPath : MapPaths)
+	{
+		UWorld* World = EscapeITCommandlet::LoadWorld(MapPath);
+		if (!World)
+		{
+			UE_LOG(LogEscapeIT, Error, TEXT("PatrolRouteValidation: %s: failed to load map"), *MapPath);
+			++NumErrors;
+			continue;
+		}
+
+		for (TActorIterator<APaTrolPath> It(World); It; ++It)
+		{
+			const APaTrolPath* PatrolPath = *It;
+			++NumRoutes;
+
+			FBakedPatrolRoute Route;
+			if (!UPatrolRouteSubsystem::BakeRoute(World, *PatrolPath, Route))
+			{
+				UE_LOG(LogEscapeIT, Error, TEXT("PatrolRouteValidation: %s: %s: no navmesh"), *MapPath, *PatrolPath->GetName());
+				++NumErrors;
+				continue;
+			}
+
+			for (int32 i = 0; i < Route.WorldPoints.Num(); ++i)
+			{
+				if (!Route.bPointOnNavmesh[i])
+				{
+					UE_LOG(LogEscapeIT, Error, TEXT("PatrolRouteValidation: %s: %s: point %d %s is off the navmesh"),
+						*MapPath, *PatrolPath->GetName(), i, *Route.WorldPoints[i].ToString());
+					++NumErrors;
+				}
+			}
+
+			int32 NumReachable = 0;
+			for (int32 i = 0; i < Route.Segments.Num(); ++i)
+			{
+				if (Route.Segments[i].bReachable)
+				{
+					++NumReachable;
+					continue;
+				}
+
+				// Điểm off-navmesh đã báo ở trên; chỉ báo segment lỗi do không có đường đi
+				const int32 Next = (i + 1) % Route.WorldPoints.Num();
+				if (Route.bPointOnNavmesh[i] && Route.bPointOnNavmesh[Next])
+				{
+					UE_LOG(LogEscapeIT, Error, TEXT("PatrolRouteValidation: %s: %s: point %d -> %d is unreachable"),
+						*MapPath, *PatrolPath->GetName(), i, Next);
+					++NumErrors;
+				}
+			}
+
+			// Mỗi segment tới được là một lần search path NPC không phải làm mỗi vòng patrol
+			TotalQueriesSaved += NumReachable;
+
+			UE_LOG(LogEscapeIT, Display, TEXT("PatrolRouteValidation: %s: %s: %d point(s), loop length %.0f cm, %d/%d segment(s) baked, %d nav quer%s saved per loop"),
+				*MapPath, *PatrolPath->GetName(), Route.WorldPoints.Num(), Route.TotalLength,
+				NumReachable, Route.Segments.Num(), NumReachable, NumReachable == 1 ? TEXT("y") : TEXT("ies"));
+		}
+
+		EscapeITCommandlet::ReleaseWorld(World);
+	}
+
+	UE_LOG(LogEscapeIT, Display, TEXT("PatrolRouteValidation: %d map(s), %d route(s), %d nav queries saved per patrol loop, %d error(s)"),
+		MapPaths.Num(), NumRoutes, TotalQueriesSaved, NumErrors);
+
+	return NumErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/SoundPortalBakeCommandlet.h"
+#include "AI/SoundPortalGraph.h"
+#include "AI/SoundPortalPoint.h"
+#include "AI/SoundRoomVolume.h"
+#include "AI/SoundPropagationSubsystem.h"
+#include "Actor/Door/Door.h"
+#include "Commandlets/CommandletMapUtils.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "EscapeIT.h"
+
+namespace SoundPortalBake
+{
+	bool SavePackage(UPackage* Package, UObject* Asset, const FString& Extension)
+	{
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Standalone;
+		SaveArgs.SaveFlags = SAVE_NoError;
+
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), Extension);
+		return UPackage::SavePackage(Package, Asset, *Filename, SaveArgs);
+	}
+
+	/** Sắp theo tên để graph bake ra giống nhau giữa các lần chạy */
+	template <typename ActorType>
+	TArray<const ActorType*> GatherSorted(UWorld* World)
+	{
+		TArray<const ActorType*> Actors;
+		for (TActorIterator<ActorType> It(World); It; ++It)
+		{
+			Actors.Add(*It);
+		}
+		Actors.Sort([](const ActorType& A, const ActorType& B) { return A.GetFName().LexicalLess(B.GetFName()); });
+		return Actors;
+	}
+}
+
+USoundPortalBakeCommandlet::USoundPortalBakeCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USoundPortalBakeCommandlet::Main(const FString& Params)
+{
+	TArray<FString> MapPaths;
+	EscapeITCommandlet::GatherMapPaths(Params, MapPaths);
+
+	const bool bSave = !FParse::Param(*Params, TEXT("NoSave"));
+	int32 NumBenchmarkQueries = 0;
+	FParse::Value(*Params, TEXT("Benchmark="), NumBenchmarkQueries);
+
+	int32 NumBaked = 0;
+	int32 NumErrors = 0;
+
+	for (const FString& MapPath : MapPaths)
+	{
+		UWorld* World = EscapeITCommandlet::LoadWorld(MapPath);
+		if (!World)
+		{
+			UE_LOG(LogEscapeIT, Error, TEXT("SoundPortalBake: %s: failed to load map"), *MapPath);
+			++NumErrors;
+			continue;
+		}
+
+		const TArray<const ASoundRoomVolume*> Rooms = SoundPortalBake::GatherSorted<ASoundRoomVolume>(World);
+		const TArray<const ADoor*> Doors = SoundPortalBake::GatherSorted<ADoor>(World);
+		const TArray<const ASoundPortalPoint*> Openings = SoundPortalBake::GatherSorted<ASoundPortalPoint>(World);
+
+		TActorIterator<ASoundPortalGraphActor> GraphIt(World);
+		ASoundPortalGraphActor* GraphActor = GraphIt ? *GraphIt : nullptr;
+
+		// Level chưa chia phòng: giữ hearing theo đường thẳng
+		if (Rooms.Num() == 0)
+		{
+			if (GraphActor)
+			{
+				UE_LOG(LogEscapeIT, Warning, TEXT("SoundPortalBake: %s: %s has no room volumes to bake"), *MapPath, *GraphActor->GetName());
+			}
+			EscapeITCommandlet::ReleaseWorld(World);
+			continue;
+		}
+
+		if (!GraphActor)
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.OverrideLevel = World->PersistentLevel;
+			SpawnParams.Name = TEXT("SoundPortalGraph");
+			GraphActor = World->SpawnActor<ASoundPortalGraphActor>(SpawnParams);
+		}
+
+		FSoundPortalBakeReport Report;
+		if (!GraphActor || !USoundPropagationSubsystem::BakeGraph(Rooms, Doors, Openings, GraphActor->BakeSettings, GraphActor->Graph, Report))
+		{
+			UE_LOG(LogEscapeIT, Error, TEXT("SoundPortalBake: %s: no room volume has valid bounds"), *MapPath);
+			++NumErrors;
+			EscapeITCommandlet::ReleaseWorld(World);
+			continue;
+		}
+		++NumBaked;
+
+		for (const int32 Door : Report.UnlinkedDoors)
+		{
+			UE_LOG(LogEscapeIT, Error, TEXT("SoundPortalBake: %s: %s does not sit between two different rooms"), *MapPath, *Doors[Door]->GetName());
+			++NumErrors;
+		}
+
+		for (const int32 Opening : Report.UnlinkedOpenings)
+		{
+			UE_LOG(LogEscapeIT, Error, TEXT("SoundPortalBake: %s: %s does not sit between two different rooms"), *MapPath, *Openings[Opening]->GetName());
+			++NumErrors;
+		}
+
+		for (const int32 Room : Report.IsolatedRooms)
+		{
+			UE_LOG(LogEscapeIT, Warning, TEXT("SoundPortalBake: %s: %s has no door or opening, sound never leaves it"),
+				*MapPath, *GraphActor->Graph.RoomNames[Room].ToString());
+		}
+
+		UE_LOG(LogEscapeIT, Display, TEXT("SoundPortalBake: %s: %d room(s), %d door portal(s), %d open portal(s)"),
+			*MapPath, Report.NumRooms, Report.NumDoorPortals, Report.NumOpenPortals);
+
+		if (NumBenchmarkQueries > 0)
+		{
+			if (USoundPropagationSubsystem* SoundPropagation = USoundPropagationSubsystem::Get(World))
+			{
+				SoundPropagation->RegisterGraph(GraphActor);
+				SoundPropagation->RunBenchmark(NumBenchmarkQueries);
+				SoundPropagation->UnregisterGraph(GraphActor);
+			}
+		}
+
+		if (bSave)
+		{
+			// World Partition: actor nằm trong package riêng
+			bool bSaved = SoundPortalBake::SavePackage(World->GetPackage(), World, FPackageName::GetMapPackageExtension());
+			if (UPackage* ActorPackage = GraphActor->GetExternalPackage())
+			{
+				bSaved &= SoundPortalBake::SavePackage(ActorPackage, GraphActor, FPackageName::GetAssetPackageExtension());
+			}
+
+			if (!bSaved)
+			{
+				UE_LOG(LogEscapeIT, Error, TEXT("SoundPortalBake: %s: failed to save"), *MapPath);
+				++NumErrors;
+			}
+		}
+
+		EscapeITCommandlet::ReleaseWorld(World);
+	}
+
+	UE_LOG(LogEscapeIT, Display, TEXT("SoundPortalBake: %d map(s), %d graph(s) baked, %d error(s)"), MapPaths.Num(), NumBaked, NumErrors);
+
+	return NumErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/TacticalSearchBakeCommandlet.h"
+#include "AI/TacticalSearchGraph.h"
+#include "AI/TacticalSearchPoint.h"
+#include "AI/TacticalSearchSubsystem.h"
+#include "Commandlets/CommandletMapUtils.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "EscapeIT.h"
+
+namespace TacticalSearchBake
+{
+	bool SavePackage(UPackage* Package, UObject* Asset, const FString& Extension)
+	{
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Standalone;
+		SaveArgs.SaveFlags = SAVE_NoError;
+
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), Extension);
+		return UPackage::SavePackage(Package, Asset, *Filename, SaveArgs);
+	}
+}
+
+UTacticalSearchBakeCommandlet::UTacticalSearchBakeCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UTacticalSearchBakeCommandlet::Main(const FString& Params)
+{
+	TArray<FString> MapPaths;
+	EscapeITCommandlet::GatherMapPaths(Params, MapPaths);
+
+	const bool bSave = !FParse::Param(*Params, TEXT("NoSave"));
+	int32 NumBenchmarkPlans = 0;
+	FParse::Value(*Params, TEXT("Benchmark="), NumBenchmarkPlans);
+
+	int32 NumBaked = 0;
+	int32 NumErrors = 0;
+
+	for (const FString& MapPath : MapPaths)
+	{
+		UWorld* World = EscapeITCommandlet::LoadWorld(MapPath);
+		if (!World)
+		{
+			UE_LOG(LogEscapeIT, Error, TEXT("TacticalSearchBake: %s: failed to load map"), *MapPath);
+			++NumErrors;
+			continue;
+		}
+
+		// Sắp theo tên để graph bake ra giống nhau giữa các lần chạy
+		TArray<const ATacticalSearchPoint*> Points;
+		for (TActorIterator<ATacticalSearchPoint> It(World); It; ++It)
+		{
+			Points.Add(*It);
+		}
+		Points.Sort([](const ATacticalSearchPoint& A, const ATacticalSearchPoint& B) { return A.GetFName().LexicalLess(B.GetFName()); });
+
+		TActorIterator<ATacticalSearchGraphActor> GraphIt(World);
+		ATacticalSearchGraphActor* GraphActor = GraphIt ? *GraphIt : nullptr;
+
+		if (Points.Num() == 0)
+		{
+			if (GraphActor)
+			{
+				UE_LOG(LogEscapeIT, Warning, TEXT("TacticalSearchBake: %s: %s has no search points to bake"), *MapPath, *GraphActor->GetName());
+			}
+			EscapeITCommandlet::ReleaseWorld(World);
+			continue;
+		}
+
+		if (!GraphActor)
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.OverrideLevel = World->PersistentLevel;
+			SpawnParams.Name = TEXT("TacticalSearchGraph");
+			GraphActor = World->SpawnActor<ATacticalSearchGraphActor>(SpawnParams);
+		}
+
+		FTacticalSearchBakeReport Report;
+		if (!GraphActor || !UTacticalSearchSubsystem::BakeGraph(World, Points, GraphActor->BakeSettings, GraphActor->Graph, Report))
+		{
+			UE_LOG(LogEscapeIT, Error, TEXT("TacticalSearchBake: %s: no navmesh"), *MapPath);
+			++NumErrors;
+			EscapeITCommandlet::ReleaseWorld(World);
+			continue;
+		}
+		++NumBaked;
+
+		for (const int32 Node : Report.OffNavmeshNodes)
+		{
+			UE_LOG(LogEscapeIT, Error, TEXT("TacticalSearchBake: %s: %s is off the navmesh"), *MapPath, *Points[Node]->GetName());
+			++NumErrors;
+		}
+
+		for (const int32 Node : Report.IsolatedNodes)
+		{
+			UE_LOG(LogEscapeIT, Error, TEXT("TacticalSearchBake: %s: %s has no walkable link to another point"), *MapPath, *Points[Node]->GetName());
+			++NumErrors;
+		}
+
+		UE_LOG(LogEscapeIT, Display, TEXT("TacticalSearchBake: %s: %d node(s), %d link(s), %d sight line(s), %d nav quer%s"),
+			*MapPath, Report.NumNodes, Report.NumEdges, Report.NumSightLines, Report.NumNavQueries, Report.NumNavQueries == 1 ? TEXT("y") : TEXT("ies"));
+
+		if (NumBenchmarkPlans > 0)
+		{
+			if (UTacticalSearchSubsystem* TacticalSearch = UTacticalSearchSubsystem::Get(World))
+			{
+				TacticalSearch->RegisterGraph(GraphActor);
+				TacticalSearch->RunBenchmark(NumBenchmarkPlans);
+				TacticalSearch->UnregisterGraph(GraphActor);
+			}
+		}
+
+		if (bSave)
+		{
+			// World Partition: actor nằm trong package riêng
+			bool bSaved = TacticalSearchBake::SavePackage(World->GetPackage(), World, FPackageName::GetMapPackageExtension());
+			if (UPackage* ActorPackage = GraphActor->GetExternalPackage())
+			{
+				bSaved &= TacticalSearchBake::SavePackage(ActorPackage, GraphActor, FPackageName::GetAssetPackageExtension());
+			}
+
+			if (!bSaved)
+			{
+				UE_LOG(LogEscapeIT, Error, TEXT("TacticalSearchBake: %s: failed to save"), *MapPath);
+				++NumErrors;
+			}
+		}
+
+		EscapeITCommandlet::ReleaseWorld(World);
+	}
+
+	UE_LOG(LogEscapeIT, Display, TEXT("TacticalSearchBake: %d map(s), %d graph(s) baked, %d error(s)"), MapPaths.Num(), NumBaked, NumErrors);
+
+	return NumErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+#include "Data/BatteryProfile.h"
+#include "Curves/CurveFloat.h"
+
+float UBatteryProfile::GetDrainMultiplier(float Charge, float TemperatureCelsius, float OnTimeSeconds) const
+{
+    float Multiplier = DischargeCurve ? DischargeCurve->GetFloatValue(Charge) : 1.0f;
+
+    if (TemperatureCurve)
+    {
+        Multiplier *= TemperatureCurve->GetFloatValue(TemperatureCelsius);
+    }
+
+    if (AgeCapacityCurve)
+    {
+        // Dung lượng giảm -> cùng một lượng điện làm tụt charge nhanh hơn
+        const float Capacity = AgeCapacityCurve->GetFloatValue(OnTimeSeconds / 3600.0f);
+        Multiplier /= FMath::Max(Capacity, 0.05f);
+    }
+
+    return FMath::Max(Multiplier, KINDA_SMALL_NUMBER);
+}
+
+float UBatteryProfile::EstimateRuntimeSeconds(float TemperatureCelsius, float OnTimeSeconds) const
+{
+    // T = RatedRuntime * ∫(0..1) dC / Multiplier(C), trung điểm 256 đoạn
+    constexpr int32 NumSteps = 256;
+    constexpr float StepSize = 1.0f / NumSteps;
+
+    float Integral = 0.0f;
+    for (int32 i = 0; i < NumSteps; ++i)
+    {
+        const float Charge = (i + 0.5f) * StepSize;
+        Integral += StepSize / GetDrainMultiplier(Charge, TemperatureCelsius, OnTimeSeconds);
+    }
+
+    return RatedRuntimeSeconds * Integral;
+}
+
+EBatteryLevel UBatteryProfile::GetLevelForCharge(float Charge) const
+{
+    if (Charge <= 0.0f)
+    {
+        return EBatteryLevel::Depleted;
+    }
+    if (Charge <= CriticalThreshold)
+    {
+        return EBatteryLevel::Critical;
+    }
+    if (Charge <= LowThreshold)
+    {
+        return EBatteryLevel::Low;
+    }
+    return EBatteryLevel::Normal;
+}
@@ -0,0 +1,41 @@
+#include "Data/NPCPerceptionProfile.h"
+#include "Settings/Handlers/GameplaySettingsHandler.h"
+
+namespace NPCPerceptionProfile
+{
+    void ScaleByDifficulty(FNPCPerceptionSettings& Settings, EE_DifficultyLevel Difficulty)
+    {
+        const float Multiplier = FGameplaySettingsHandler::GetDifficultyMultipliers(Difficulty).AIDetectionMultiplier;
+
+        Settings.SightRadius *= Multiplier;
+        Settings.LoseSightRadius *= Multiplier;
+        Settings.HearingRange *= Multiplier;
+    }
+}
+
+FNPCPerceptionSettings UNPCPerceptionProfile::GetSettingsForDifficulty(EE_DifficultyLevel Difficulty) const
+{
+    if (const FNPCPerceptionSettings* Override = DifficultyOverrides.Find(Difficulty))
+    {
+        return *Override;
+    }
+
+    FNPCPerceptionSettings Result = Settings;
+    if (bScaleByDifficultyMultiplier)
+    {
+        NPCPerceptionProfile::ScaleByDifficulty(Result, Difficulty);
+    }
+    return Result;
+}
+
+FNPCPerceptionSettings UNPCPerceptionProfile::ResolveSettings(const UNPCPerceptionProfile* Profile, EE_DifficultyLevel Difficulty)
+{
+    if (Profile)
+    {
+        return Profile->GetSettingsForDifficulty(Difficulty);
+    }
+
+    FNPCPerceptionSettings Result;
+    NPCPerceptionProfile::ScaleByDifficulty(Result, Difficulty);
+    return Result;
+}
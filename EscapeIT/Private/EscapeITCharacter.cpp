@@ -20,7 +20,7 @@
 #include "PhysicalMaterials/PhysicalMaterial.h"
 #include "Sound/SoundBase.h"
 #include "Actor/Components/FlashlightComponent.h"
-#include "Perception/AISense_Hearing.h"
+#include "AI/NoiseFieldSubsystem.h"
 
 // ==================== CONSTRUCTOR ====================
 
@@ -100,21 +100,6 @@ void AEscapeITCharacter::BeginPlay()
 void AEscapeITCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-
-	if (GetVelocity().Size() > 0.0f)
-	{
-		TimeSinceLastFootstep += DeltaTime;
-
-		if (TimeSinceLastFootstep >= FootstepNoiseInterval)
-		{
-			MakeFootstepNoise();
-			TimeSinceLastFootstep = 0.0f;
-		}
-	}
-	else
-	{
-		TimeSinceLastFootstep = 0.0f;
-	}
 	
 	if (bIsSprinting && StaminaComponent)
 	{
@@ -308,7 +293,7 @@ void AEscapeITCharacter::DoJumpStart()
 
 	if (GetCharacterMovement()->IsFalling())
 	{
-		MakeNoise(JumpNoiseLoudness,GetActorLocation());
+		MakeNoise(JumpNoiseLoudness, GetActorLocation(), ENoiseSource::Jump);
 	}
 
 	Jump();
@@ -319,15 +304,13 @@ void AEscapeITCharacter::DoJumpEnd()
 	StopJumping();
 }
 
-void AEscapeITCharacter::MakeNoise(float Loudness, FVector NoiseLocation)
+void AEscapeITCharacter::MakeNoise(float Loudness, FVector NoiseLocation, ENoiseSource Source)
 {
-	UAISense_Hearing::ReportNoiseEvent(
-		GetWorld(),
-		NoiseLocation,
-		Loudness,
-		this,
-		0.0f,
-		FName("PlayerNoise"));
+	// Noise field gộp event rồi mới report tới hearing sense
+	if (UNoiseFieldSubsystem* NoiseField = UNoiseFieldSubsystem::Get(this))
+	{
+		NoiseField->ReportNoise(NoiseLocation, Loudness, this, Source);
+	}
 }
 
 // ==================== SPRINT ====================
@@ -517,23 +500,6 @@ void AEscapeITCharacter::PlayLandingSound(float FallSpeed, float ImpactStrength)
 	}
 }
 
-void AEscapeITCharacter::MakeFootstepNoise()
-{
-	float Speed = GetVelocity().Size();
-
-	if (Speed > 200.0f)
-	{
-		float Loudness = FootstepNoiseLoudness;
-
-		if (Speed > 400.0f)
-		{
-			Loudness *= 1.5f;
-		}
-		
-		MakeNoise(Loudness,GetActorLocation());
-	}
-}
-
 // ==================== GETTERS ====================
 
 float AEscapeITCharacter::GetCurrentSpeed() const
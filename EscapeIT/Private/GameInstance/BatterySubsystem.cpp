@@ -0,0 +1,405 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameInstance/BatterySubsystem.h"
+#include "EscapeIT.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+
+DECLARE_CYCLE_STAT(TEXT("BatterySubsystem Tick"), STAT_BatterySubsystemTick, STATGROUP_EscapeIT);
+
+namespace BatterySimulation
+{
+	// Bước tích phân tối đa - đủ mịn cho curve, và simulate nhiều giờ vẫn chỉ vài nghìn bước
+	constexpr float MaxStepSeconds = 0.5f;
+
+	static UCurveFloat* MakeCurve(std::initializer_list<TPair<float, float>> Keys)
+	{
+		UCurveFloat* Curve = NewObject<UCurveFloat>(GetTransientPackage());
+		for (const TPair<float, float>& Key : Keys)
+		{
+			Curve->FloatCurve.AddKey(Key.Key, Key.Value);
+		}
+		return Curve;
+	}
+
+	/** Bật tải liên tục từ đầy tới cạn với bước DeltaTime cố định, trả về số giây đã chạy */
+	static float SimulateRuntime(const UBatteryProfile& Profile, float TemperatureCelsius, float DeltaTime, float OnTimeSeconds = 0.0f)
+	{
+		FBatteryState State;
+		State.RatedRuntimeSeconds = Profile.RatedRuntimeSeconds;
+		State.OnTimeSeconds = OnTimeSeconds;
+		State.bUnderLoad = true;
+
+		const float TimeLimit = Profile.RatedRuntimeSeconds * 100.0f;
+		float Elapsed = 0.0f;
+		while (State.Charge > 0.0f && Elapsed < TimeLimit)
+		{
+			UBatterySubsystem::StepBattery(State, Profile, DeltaTime, TemperatureCelsius);
+			Elapsed += DeltaTime;
+		}
+		return Elapsed;
+	}
+
+	/**
+	 * Tích phân curve không cần world: so runtime mô phỏng với EstimateRuntimeSeconds và các tính chất của bounce.
+	 * Test != null thì mỗi check fail là một lỗi của test
+	 */
+	static bool RunValidation(FAutomationTestBase* Test = nullptr)
+	{
+		int32 NumFailed = 0;
+		auto Check = [&NumFailed, Test](bool bCondition, const TCHAR* Description)
+		{
+			if (!bCondition)
+			{
+				++NumFailed;
+				if (Test)
+				{
+					Test->AddError(Description);
+				}
+			}
+			UE_LOG(LogEscapeIT, Display, TEXT("Battery: [%s] %s"), bCondition ? TEXT("PASS") : TEXT("FAIL"), Description);
+		};
+
+		constexpr float FrameTime = 1.0f / 60.0f;
+
+		// ---- Linear ----
+		UBatteryProfile* Linear = NewObject<UBatteryProfile>(GetTransientPackage());
+		Linear->RecoveryFraction = 0.0f;
+		const float LinearRuntime = SimulateRuntime(*Linear, 20.0f, FrameTime);
+		Check(FMath::IsNearlyEqual(LinearRuntime, Linear->RatedRuntimeSeconds, 0.5f), TEXT("linear profile runs for RatedRuntime"));
+		Check(FMath::IsNearlyEqual(Linear->EstimateRuntimeSeconds(), Linear->RatedRuntimeSeconds, 0.01f), TEXT("linear estimate equals RatedRuntime"));
+
+		// ---- Discharge curve (chữ U) ----
+		UBatteryProfile* Worn = NewObject<UBatteryProfile>(GetTransientPackage());
+		Worn->RecoveryFraction = 0.0f;
+		Worn->DischargeCurve = MakeCurve({ { 0.0f, 2.5f }, { 0.2f, 1.0f }, { 0.8f, 0.8f }, { 1.0f, 2.0f } });
+		const float WornEstimate = Worn->EstimateRuntimeSeconds();
+		const float WornRuntime = SimulateRuntime(*Worn, 20.0f, FrameTime);
+		Check(FMath::Abs(WornRuntime - WornEstimate) <= WornEstimate * 0.01f, TEXT("U-shaped curve runtime matches the integrated estimate"));
+
+		// Bước lớn (frame hitch) không được làm lệch tích phân
+		const float CoarseRuntime = SimulateRuntime(*Worn, 20.0f, 0.25f);
+		const float HitchRuntime = SimulateRuntime(*Worn, 20.0f, 1.0f);
+		Check(FMath::Abs(CoarseRuntime - WornRuntime) <= WornRuntime * 0.01f, TEXT("runtime is invariant to frame step"));
+		Check(FMath::Abs(HitchRuntime - WornRuntime) <= WornRuntime * 0.02f, TEXT("long frames are sub-stepped"));
+
+		// ---- Temperature ----
+		UBatteryProfile* Cold = NewObject<UBatteryProfile>(GetTransientPackage());
+		Cold->RecoveryFraction = 0.0f;
+		Cold->TemperatureCurve = MakeCurve({ { -10.0f, 2.0f }, { 20.0f, 1.0f } });
+		const float WarmRuntime = SimulateRuntime(*Cold, 20.0f, FrameTime);
+		const float ColdRuntime = SimulateRuntime(*Cold, -10.0f, FrameTime);
+		Check(FMath::IsNearlyEqual(ColdRuntime * 2.0f, WarmRuntime, 1.0f), TEXT("cold halves runtime"));
+
+		// ---- Age: nhiều giờ chơi, mỗi chu kỳ sạc đầy rồi xả cạn ----
+		UBatteryProfile* Aging = NewObject<UBatteryProfile>(GetTransientPackage());
+		Aging->RecoveryFraction = 0.0f;
+		Aging->AgeCapacityCurve = MakeCurve({ { 0.0f, 1.0f }, { 10.0f, 0.5f } });
+
+		const uint64 AgeStartCycles = FPlatformTime::Cycles64();
+		FBatteryState AgingState;
+		AgingState.RatedRuntimeSeconds = Aging->RatedRuntimeSeconds;
+		AgingState.bUnderLoad = true;
+
+		constexpr float PlayHours = 10.0f;
+		int32 NumCycles = 0;
+		float FirstCycleRuntime = 0.0f;
+		float LastCycleRuntime = 0.0f;
+		float LastCycleEstimate = 0.0f;
+		while (AgingState.OnTimeSeconds < PlayHours * 3600.0f)
+		{
+			AgingState.Charge = 1.0f;
+			const float CycleStartOnTime = AgingState.OnTimeSeconds;
+			LastCycleEstimate = Aging->EstimateRuntimeSeconds(20.0f, CycleStartOnTime);
+			while (AgingState.Charge > 0.0f)
+			{
+				UBatterySubsystem::StepBattery(AgingState, *Aging, 1.0f, 20.0f);
+			}
+			LastCycleRuntime = AgingState.OnTimeSeconds - CycleStartOnTime;
+			FirstCycleRuntime = NumCycles == 0 ? LastCycleRuntime : FirstCycleRuntime;
+			++NumCycles;
+		}
+		const double AgeMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - AgeStartCycles);
+
+		Check(LastCycleRuntime < FirstCycleRuntime * 0.6f, TEXT("aged battery runs shorter per charge"));
+		Check(FMath::Abs(LastCycleRuntime - LastCycleEstimate) <= LastCycleEstimate * 0.02f, TEXT("aged runtime matches estimate at that age"));
+		UE_LOG(LogEscapeIT, Display, TEXT("Battery: simulated %.0fh of load (%d cycles) in %.2f ms"), PlayHours, NumCycles, AgeMs);
+
+		// ---- Recovery bounce ----
+		UBatteryProfile* Bouncy = NewObject<UBatteryProfile>(GetTransientPackage());
+		Bouncy->RecoveryFraction = 0.2f;
+		Bouncy->RecoveryTimeConstant = 4.0f;
+
+		FBatteryState BounceState;
+		BounceState.RatedRuntimeSeconds = Bouncy->RatedRuntimeSeconds;
+		BounceState.bUnderLoad = true;
+		UBatterySubsystem::StepBattery(BounceState, *Bouncy, 60.0f, 20.0f);
+
+		const float ChargeAtOff = BounceState.Charge;
+		const float DepressionAtOff = BounceState.Depression;
+		BounceState.bUnderLoad = false;
+		UBatterySubsystem::StepBattery(BounceState, *Bouncy, Bouncy->RecoveryTimeConstant * 10.0f, 20.0f);
+
+		const float Recovered = BounceState.Charge - ChargeAtOff;
+		Check(DepressionAtOff > 0.0f && Recovered > 0.0f, TEXT("charge bounces back after load is removed"));
+		Check(Recovered <= DepressionAtOff + KINDA_SMALL_NUMBER, TEXT("bounce never exceeds depressed charge"));
+		Check(BounceState.Charge < 1.0f - 0.5f * Bouncy->RecoveryFraction, TEXT("bounce cannot refill the drained charge"));
+		Check(BounceState.Depression <= KINDA_SMALL_NUMBER * 10.0f, TEXT("depression settles after ten time constants"));
+
+		UE_LOG(LogEscapeIT, Display, TEXT("Battery: validation %s (%d failed)"), NumFailed == 0 ? TEXT("passed") : TEXT("FAILED"), NumFailed);
+		return NumFailed == 0;
+	}
+
+	static FAutoConsoleCommand ValidateCommand(
+		TEXT("flashlight.Battery.Validate"),
+		TEXT("Kiểm tra tích phân curve xả pin (tuyến tính, chữ U, nhiệt độ, tuổi, recovery, bước frame)"),
+		FConsoleCommandDelegate::CreateStatic([]() { RunValidation(); }));
+}
+
+void UBatterySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	LinearProfile = NewObject<UBatteryProfile>(this, TEXT("LinearBatteryProfile"));
+}
+
+void UBatterySubsystem::Deinitialize()
+{
+	Batteries.Empty();
+	ActiveBatteryCount = 0;
+
+	Super::Deinitialize();
+}
+
+UWorld* UBatterySubsystem::GetTickableGameObjectWorld() const
+{
+	const UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetWorld() : nullptr;
+}
+
+TStatId UBatterySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBatterySubsystem, STATGROUP_Tickables);
+}
+
+UBatterySubsystem* UBatterySubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UBatterySubsystem>() : nullptr;
+}
+
+// ============================================
+// BATTERIES
+// ============================================
+
+FGuid UBatterySubsystem::CreateBattery(UBatteryProfile* Profile, float InitialCharge, float RatedRuntimeOverride)
+{
+	FBatteryState State;
+	State.BatteryId = FGuid::NewGuid();
+	State.Profile = Profile ? Profile : LinearProfile.Get();
+	State.Charge = FMath::Clamp(InitialCharge, 0.0f, 1.0f);
+	State.RatedRuntimeSeconds = RatedRuntimeOverride > 0.0f ? RatedRuntimeOverride : State.Profile->RatedRuntimeSeconds;
+	State.Level = State.Profile->GetLevelForCharge(State.Charge);
+	State.LastBroadcastPercent = FMath::CeilToInt(State.Charge * 100.0f);
+
+	Batteries.Add(State.BatteryId, State);
+
+	UE_LOG(LogEscapeIT, Log, TEXT("Battery: created %s (%.0f%%, runtime %.0fs)"),
+		*State.BatteryId.ToString(), State.Charge * 100.0f, State.RatedRuntimeSeconds);
+
+	return State.BatteryId;
+}
+
+void UBatterySubsystem::RemoveBattery(FGuid BatteryId)
+{
+	Batteries.Remove(BatteryId);
+	RefreshActiveCount();
+}
+
+void UBatterySubsystem::SetBatteryLoad(FGuid BatteryId, bool bUnderLoad)
+{
+	if (FBatteryState* State = Batteries.Find(BatteryId))
+	{
+		State->bUnderLoad = bUnderLoad;
+		RefreshActiveCount();
+	}
+}
+
+void UBatterySubsystem::AddCharge(FGuid BatteryId, float ChargeAmount)
+{
+	FBatteryState* State = Batteries.Find(BatteryId);
+	if (!State || ChargeAmount <= 0.0f)
+	{
+		return;
+	}
+
+	const EBatteryLevel OldLevel = State->Level;
+	State->Charge = FMath::Min(State->Charge + ChargeAmount, 1.0f);
+	State->Depression = FMath::Min(State->Depression, 1.0f - State->Charge);
+
+	FBatteryChangeEvent Event;
+	if (CollectChanges(*State, OldLevel, Event))
+	{
+		BroadcastChanges(Event);
+	}
+}
+
+bool UBatterySubsystem::GetBatteryState(FGuid BatteryId, FBatteryState& OutState) const
+{
+	if (const FBatteryState* State = Batteries.Find(BatteryId))
+	{
+		OutState = *State;
+		return true;
+	}
+	return false;
+}
+
+float UBatterySubsystem::GetCharge(FGuid BatteryId) const
+{
+	const FBatteryState* State = Batteries.Find(BatteryId);
+	return State ? State->Charge : 0.0f;
+}
+
+// ============================================
+// SIMULATION
+// ============================================
+
+void UBatterySubsystem::StepBattery(FBatteryState& State, const UBatteryProfile& Profile, float DeltaTime, float TemperatureCelsius)
+{
+	const float RatedRuntime = FMath::Max(State.RatedRuntimeSeconds, 1.0f);
+	float Remaining = DeltaTime;
+
+	while (Remaining > 0.0f)
+	{
+		const float Step = FMath::Min(Remaining, BatterySimulation::MaxStepSeconds);
+		Remaining -= Step;
+
+		if (State.bUnderLoad)
+		{
+			if (State.Charge <= 0.0f)
+			{
+				State.Charge = 0.0f;
+				break;
+			}
+
+			const float Multiplier = Profile.GetDrainMultiplier(State.Charge, TemperatureCelsius, State.OnTimeSeconds);
+			const float Drain = FMath::Min(Multiplier * Step / RatedRuntime, State.Charge);
+
+			State.Charge -= Drain;
+			State.Depression = FMath::Min(State.Depression + Drain * Profile.RecoveryFraction, 1.0f - State.Charge);
+			State.OnTimeSeconds += Step;
+		}
+		else if (State.Depression > KINDA_SMALL_NUMBER)
+		{
+			// Recovery bounce: phần bị nén hồi lại theo hàm mũ
+			const float Recovered = State.Depression * (1.0f - FMath::Exp(-Step / Profile.RecoveryTimeConstant));
+			State.Depression -= Recovered;
+			State.Charge = FMath::Min(State.Charge + Recovered, 1.0f);
+		}
+		else
+		{
+			State.Depression = 0.0f;
+			break;
+		}
+	}
+}
+
+void UBatterySubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BatterySubsystemTick);
+
+	bool bAnyBecameIdle = false;
+	TArray<FBatteryChangeEvent, TInlineAllocator<4>> Changes;
+
+	for (TPair<FGuid, FBatteryState>& Pair : Batteries)
+	{
+		FBatteryState& State = Pair.Value;
+		if (!State.bUnderLoad && State.Depression <= 0.0f)
+		{
+			continue;
+		}
+
+		const EBatteryLevel OldLevel = State.Level;
+		StepBattery(State, *State.Profile, DeltaTime, AmbientTemperature);
+
+		FBatteryChangeEvent Event;
+		if (CollectChanges(State, OldLevel, Event))
+		{
+			Changes.Add(Event);
+		}
+
+		bAnyBecameIdle |= !State.bUnderLoad && State.Depression <= 0.0f;
+	}
+
+	if (bAnyBecameIdle)
+	{
+		RefreshActiveCount();
+	}
+
+	// Listener (flashlight hết pin, UI) có thể thêm/xoá pin hoặc đổi tải -> chỉ broadcast khi đã duyệt xong Batteries
+	for (const FBatteryChangeEvent& Event : Changes)
+	{
+		BroadcastChanges(Event);
+	}
+}
+
+bool UBatterySubsystem::CollectChanges(FBatteryState& State, EBatteryLevel OldLevel, FBatteryChangeEvent& OutEvent)
+{
+	const int32 Percent = FMath::CeilToInt(State.Charge * 100.0f);
+	OutEvent.bChargeChanged = Percent != State.LastBroadcastPercent;
+	State.LastBroadcastPercent = Percent;
+
+	State.Level = State.Profile->GetLevelForCharge(State.Charge);
+	OutEvent.bLevelChanged = State.Level != OldLevel;
+
+	OutEvent.BatteryId = State.BatteryId;
+	OutEvent.Charge = State.Charge;
+	OutEvent.Level = State.Level;
+	return OutEvent.bChargeChanged || OutEvent.bLevelChanged;
+}
+
+void UBatterySubsystem::BroadcastChanges(const FBatteryChangeEvent& Event)
+{
+	if (Event.bChargeChanged)
+	{
+		OnBatteryChargeChanged.Broadcast(Event.BatteryId, Event.Charge);
+	}
+
+	if (Event.bLevelChanged)
+	{
+		OnBatteryLevelChanged.Broadcast(Event.BatteryId, Event.Level);
+	}
+}
+
+void UBatterySubsystem::RefreshActiveCount()
+{
+	ActiveBatteryCount = 0;
+	for (const TPair<FGuid, FBatteryState>& Pair : Batteries)
+	{
+		if (Pair.Value.bUnderLoad || Pair.Value.Depression > 0.0f)
+		{
+			++ActiveBatteryCount;
+		}
+	}
+}
+
+// ============================================
+// AUTOMATION
+// ============================================
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBatteryValidationTest, "EscapeIT.Flashlight.Battery.Validate",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FBatteryValidationTest::RunTest(const FString& Parameters)
+{
+	return BatterySimulation::RunValidation(this);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
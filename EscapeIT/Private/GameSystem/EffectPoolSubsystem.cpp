@@ -0,0 +1,357 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameSystem/EffectPoolSubsystem.h"
+#include "EscapeIT.h"
+#include "Engine/World.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "NiagaraSystem.h"
+#include "NiagaraComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "TimerManager.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Pool Live"), STAT_EffectPoolLive, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Pool Created"), STAT_EffectPoolCreated, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Pool Reused"), STAT_EffectPoolReused, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Pool Overflow"), STAT_EffectPoolOverflow, STATGROUP_EscapeIT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Pool Culled"), STAT_EffectPoolCulled, STATGROUP_EscapeIT);
+
+UEffectPoolSubsystem* UEffectPoolSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UEffectPoolSubsystem>() : nullptr;
+}
+
+void UEffectPoolSubsystem::Deinitialize()
+{
+	for (const TPair<TObjectKey<UFXSystemAsset>, FEffectPool>& Pair : Pools)
+	{
+		DEC_DWORD_STAT_BY(STAT_EffectPoolLive, Pair.Value.LiveComponents.Num());
+	}
+	Pools.Empty();
+
+	if (UWorld* World = GetWorld())
+	{
+		for (TPair<UFXSystemComponent*, FTimerHandle>& Pair : LoopingTimeouts)
+		{
+			World->GetTimerManager().ClearTimer(Pair.Value);
+		}
+	}
+	LoopingTimeouts.Empty();
+
+	for (UFXSystemComponent* Component : AllComponents)
+	{
+		if (IsValid(Component))
+		{
+			Component->DestroyComponent();
+		}
+	}
+
+	AllComponents.Empty();
+
+	Super::Deinitialize();
+}
+
+void UEffectPoolSubsystem::ConfigureEffect(UFXSystemAsset* Effect, const FEffectPoolSettings& Settings)
+{
+	if (Effect)
+	{
+		FindOrAddPool(Effect).Settings = Settings;
+	}
+}
+
+void UEffectPoolSubsystem::Prewarm(UFXSystemAsset* Effect)
+{
+	if (!Effect)
+	{
+		return;
+	}
+
+	FEffectPool& Pool = FindOrAddPool(Effect);
+	const int32 Target = FMath::Min(Pool.Settings.WarmInstances, Pool.Settings.MaxLiveInstances);
+	while (Pool.FreeComponents.Num() + Pool.LiveComponents.Num() < Target)
+	{
+		UFXSystemComponent* Component = CreatePooledComponent(Effect);
+		if (!Component)
+		{
+			break;
+		}
+		Pool.FreeComponents.Add(Component);
+	}
+}
+
+UFXSystemComponent* UEffectPoolSubsystem::SpawnEffectAtLocation(UFXSystemAsset* Effect, FVector Location, FRotator Rotation)
+{
+	if (!Effect || !GetWorld())
+	{
+		return nullptr;
+	}
+
+	FEffectPool& Pool = FindOrAddPool(Effect);
+
+	const bool bLooping = IsLoopingEffect(Effect);
+	if (bLooping && Pool.Settings.LoopingTimeout <= 0.0f)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("EffectPool: %s is looping and would never return to the pool; set LoopingTimeout to spawn it"), *GetNameSafe(Effect));
+		return nullptr;
+	}
+
+	if (!PassesRelevancy(Pool.Settings, Location))
+	{
+		Pool.Stats.Culled++;
+		INC_DWORD_STAT(STAT_EffectPoolCulled);
+		return nullptr;
+	}
+
+	if (Pool.LiveComponents.Num() >= Pool.Settings.MaxLiveInstances)
+	{
+		Pool.Stats.Overflowed++;
+		INC_DWORD_STAT(STAT_EffectPoolOverflow);
+		return nullptr;
+	}
+
+	UFXSystemComponent* Component = nullptr;
+	while (!Component && Pool.FreeComponents.Num() > 0)
+	{
+		Component = Pool.FreeComponents.Pop(EAllowShrinking::No);
+		if (!IsValid(Component))
+		{
+			Component = nullptr;
+		}
+	}
+
+	if (Component)
+	{
+		Pool.Stats.Reused++;
+		INC_DWORD_STAT(STAT_EffectPoolReused);
+	}
+	else
+	{
+		Component = CreatePooledComponent(Effect);
+		if (!Component)
+		{
+			return nullptr;
+		}
+	}
+
+	Component->SetWorldLocationAndRotation(Location, Rotation);
+	Component->SetVisibility(true);
+	Component->Activate(true);
+
+	Pool.LiveComponents.Add(Component);
+	Pool.Stats.Live = Pool.LiveComponents.Num();
+	INC_DWORD_STAT(STAT_EffectPoolLive);
+
+	// Effect loop không bắn OnSystemFinished -> tự tắt và trả về pool sau LoopingTimeout
+	if (bLooping)
+	{
+		TWeakObjectPtr<UFXSystemComponent> WeakComponent(Component);
+		FTimerHandle& TimerHandle = LoopingTimeouts.FindOrAdd(Component);
+		GetWorld()->GetTimerManager().SetTimer(TimerHandle, FTimerDelegate::CreateWeakLambda(this, [this, WeakComponent]()
+		{
+			if (UFXSystemComponent* LoopingComponent = WeakComponent.Get())
+			{
+				LoopingTimeouts.Remove(LoopingComponent);
+				LoopingComponent->DeactivateImmediate();
+				ReturnToPool(LoopingComponent);
+			}
+		}), Pool.Settings.LoopingTimeout, false);
+	}
+
+	return Component;
+}
+
+FEffectPoolStats UEffectPoolSubsystem::GetStats(UFXSystemAsset* Effect) const
+{
+	const FEffectPool* Pool = Pools.Find(Effect);
+	return Pool ? Pool->Stats : FEffectPoolStats();
+}
+
+FEffectPoolStats UEffectPoolSubsystem::GetTotalStats() const
+{
+	FEffectPoolStats Total;
+	for (const TPair<TObjectKey<UFXSystemAsset>, FEffectPool>& Pair : Pools)
+	{
+		Total.Spawned += Pair.Value.Stats.Spawned;
+		Total.Reused += Pair.Value.Stats.Reused;
+		Total.Overflowed += Pair.Value.Stats.Overflowed;
+		Total.Culled += Pair.Value.Stats.Culled;
+		Total.Live += Pair.Value.Stats.Live;
+	}
+	return Total;
+}
+
+void UEffectPoolSubsystem::ReleaseAll()
+{
+	for (TPair<TObjectKey<UFXSystemAsset>, FEffectPool>& Pair : Pools)
+	{
+		FEffectPool& Pool = Pair.Value;
+
+		// DeactivateImmediate có thể bắn OnSystemFinished -> tách danh sách ra trước khi lặp
+		TArray<TObjectPtr<UFXSystemComponent>> LiveComponents = MoveTemp(Pool.LiveComponents);
+		DEC_DWORD_STAT_BY(STAT_EffectPoolLive, LiveComponents.Num());
+		Pool.Stats.Live = 0;
+
+		for (UFXSystemComponent* Component : LiveComponents)
+		{
+			ClearLoopingTimeout(Component);
+			if (IsValid(Component))
+			{
+				Component->DeactivateImmediate();
+				Component->SetVisibility(false);
+				Pool.FreeComponents.Add(Component);
+			}
+		}
+	}
+}
+
+UEffectPoolSubsystem::FEffectPool& UEffectPoolSubsystem::FindOrAddPool(UFXSystemAsset* Effect)
+{
+	if (FEffectPool* Existing = Pools.Find(Effect))
+	{
+		return *Existing;
+	}
+
+	FEffectPool& Pool = Pools.Add(Effect);
+	Pool.Settings = DefaultSettings;
+	return Pool;
+}
+
+UFXSystemComponent* UEffectPoolSubsystem::CreatePooledComponent(UFXSystemAsset* Effect)
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	UFXSystemComponent* Component = nullptr;
+
+	if (UParticleSystem* CascadeSystem = Cast<UParticleSystem>(Effect))
+	{
+		UParticleSystemComponent* ParticleComponent = NewObject<UParticleSystemComponent>(World);
+		ParticleComponent->bAutoActivate = false;
+		ParticleComponent->bAutoDestroy = false;
+		ParticleComponent->SetTemplate(CascadeSystem);
+		ParticleComponent->OnSystemFinished.AddUniqueDynamic(this, &UEffectPoolSubsystem::OnCascadeFinished);
+		Component = ParticleComponent;
+	}
+	else if (UNiagaraSystem* NiagaraSystem = Cast<UNiagaraSystem>(Effect))
+	{
+		UNiagaraComponent* NiagaraComponent = NewObject<UNiagaraComponent>(World);
+		NiagaraComponent->SetAutoActivate(false);
+		NiagaraComponent->SetAutoDestroy(false);
+		NiagaraComponent->SetAsset(NiagaraSystem);
+		NiagaraComponent->OnSystemFinished.AddUniqueDynamic(this, &UEffectPoolSubsystem::OnNiagaraFinished);
+		Component = NiagaraComponent;
+	}
+	else
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("EffectPool: unsupported effect asset %s"), *GetNameSafe(Effect));
+		return nullptr;
+	}
+
+	Component->RegisterComponentWithWorld(World);
+	Component->SetVisibility(false);
+	AllComponents.Add(Component);
+
+	FEffectPool& Pool = FindOrAddPool(Effect);
+	Pool.Stats.Spawned++;
+	INC_DWORD_STAT(STAT_EffectPoolCreated);
+
+	return Component;
+}
+
+bool UEffectPoolSubsystem::PassesRelevancy(const FEffectPoolSettings& Settings, const FVector& Location) const
+{
+	const APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(GetWorld(), 0);
+	if (!CameraManager)
+	{
+		return true;
+	}
+
+	const FVector CameraLocation = CameraManager->GetCameraLocation();
+	const FVector ToEffect = Location - CameraLocation;
+	const float DistSq = ToEffect.SizeSquared();
+
+	if (DistSq <= FMath::Square(Settings.AlwaysRelevantRadius))
+	{
+		return true;
+	}
+
+	if (Settings.MaxSpawnDistance > 0.0f && DistSq > FMath::Square(Settings.MaxSpawnDistance))
+	{
+		return false;
+	}
+
+	if (Settings.bCullOutsideView)
+	{
+		// Nới thêm 10 độ để effect ở mép màn hình không bị mất
+		const float HalfFOVRad = FMath::DegreesToRadians(FMath::Min(CameraManager->GetFOVAngle() * 0.5f + 10.0f, 89.0f));
+		const FVector CameraForward = CameraManager->GetCameraRotation().Vector();
+		const float CosAngle = FVector::DotProduct(CameraForward, ToEffect.GetSafeNormal());
+		if (CosAngle < FMath::Cos(HalfFOVRad))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void UEffectPoolSubsystem::ReturnToPool(UFXSystemComponent* Component)
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	FEffectPool* Pool = Pools.Find(Component->GetFXSystemAsset());
+	if (!Pool || Pool->LiveComponents.RemoveSwap(Component, EAllowShrinking::No) == 0)
+	{
+		return;
+	}
+
+	ClearLoopingTimeout(Component);
+
+	Component->SetVisibility(false);
+	Pool->FreeComponents.Add(Component);
+	Pool->Stats.Live = Pool->LiveComponents.Num();
+	DEC_DWORD_STAT(STAT_EffectPoolLive);
+}
+
+void UEffectPoolSubsystem::ClearLoopingTimeout(UFXSystemComponent* Component)
+{
+	FTimerHandle TimerHandle;
+	if (LoopingTimeouts.RemoveAndCopyValue(Component, TimerHandle))
+	{
+		if (UWorld* World = GetWorld())
+		{
+			World->GetTimerManager().ClearTimer(TimerHandle);
+		}
+	}
+}
+
+bool UEffectPoolSubsystem::IsLoopingEffect(const UFXSystemAsset* Effect)
+{
+	if (const UParticleSystem* CascadeSystem = Cast<UParticleSystem>(Effect))
+	{
+		return CascadeSystem->IsLooping();
+	}
+	if (const UNiagaraSystem* NiagaraSystem = Cast<UNiagaraSystem>(Effect))
+	{
+		return NiagaraSystem->IsLooping();
+	}
+	return false;
+}
+
+void UEffectPoolSubsystem::OnCascadeFinished(UParticleSystemComponent* Component)
+{
+	ReturnToPool(Component);
+}
+
+void UEffectPoolSubsystem::OnNiagaraFinished(UNiagaraComponent* Component)
+{
+	ReturnToPool(Component);
+}
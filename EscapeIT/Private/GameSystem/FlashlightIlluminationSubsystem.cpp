@@ -0,0 +1,423 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameSystem/FlashlightIlluminationSubsystem.h"
+#include "EscapeIT.h"
+#include "Components/SpotLightComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Engine/TargetPoint.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("FlashlightIllumination Tick"), STAT_FlashlightIlluminationTick, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flashlight Occlusion Traces"), STAT_FlashlightOcclusionTraces, STATGROUP_EscapeIT);
+
+namespace FlashlightIllumination
+{
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("flashlight.Illumination.Benchmark"),
+		TEXT("flashlight.Illumination.Benchmark <NumTargets> <NumFrames>: đăng ký NumTargets target tạm, quét beam qua NumFrames frame, in thời gian Tick và batch query"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UFlashlightIlluminationSubsystem* Illumination = UFlashlightIlluminationSubsystem::Get(World))
+			{
+				Illumination->RunBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 500, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 600);
+			}
+		}));
+}
+
+UFlashlightIlluminationSubsystem* UFlashlightIlluminationSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UFlashlightIlluminationSubsystem>() : nullptr;
+}
+
+void UFlashlightIlluminationSubsystem::Deinitialize()
+{
+	Targets.Empty();
+	TargetRadii.Empty();
+	TargetRequiresLOS.Empty();
+	TargetHasLOS.Empty();
+	TargetLit.Empty();
+	TargetLocations.Empty();
+	TargetInCone.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UFlashlightIlluminationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFlashlightIlluminationSubsystem, STATGROUP_Tickables);
+}
+
+// ============================================
+// BEAM
+// ============================================
+
+void UFlashlightIlluminationSubsystem::PublishBeam(const USpotLightComponent* SpotLight, float EffectiveIntensity, const AActor* IgnoredActor)
+{
+	if (!SpotLight || EffectiveIntensity < MinEffectiveIntensity)
+	{
+		ClearBeam();
+		return;
+	}
+
+	SetBeamCone(SpotLight->GetComponentLocation(), SpotLight->GetForwardVector(), SpotLight->OuterConeAngle, SpotLight->AttenuationRadius, EffectiveIntensity);
+	BeamOwner = IgnoredActor;
+	BeamSource = SpotLight;
+}
+
+void UFlashlightIlluminationSubsystem::ClearBeam()
+{
+	Beam.bActive = false;
+	Beam.EffectiveIntensity = 0.0f;
+	BeamSource.Reset();
+}
+
+void UFlashlightIlluminationSubsystem::SetBeamCone(const FVector& Origin, const FVector& Direction, float HalfAngleDegrees, float Range, float EffectiveIntensity)
+{
+	Beam.bActive = true;
+	Beam.Origin = Origin;
+	Beam.Direction = Direction;
+	Beam.HalfAngleDegrees = HalfAngleDegrees;
+	Beam.Range = Range;
+	Beam.EffectiveIntensity = EffectiveIntensity;
+
+	FMath::SinCos(&SinHalfAngle, &CosHalfAngle, FMath::DegreesToRadians(Beam.HalfAngleDegrees));
+}
+
+// ============================================
+// QUERIES
+// ============================================
+
+bool UFlashlightIlluminationSubsystem::IsSphereInBeam(FVector Center, float Radius) const
+{
+	return Beam.bActive && IsSphereInBeamInternal(Center, Radius);
+}
+
+void UFlashlightIlluminationSubsystem::QuerySpheresInBeam(TConstArrayView<FVector> Centers, float Radius, TArray<bool>& OutInBeam) const
+{
+	OutInBeam.SetNumUninitialized(Centers.Num());
+
+	if (!Beam.bActive)
+	{
+		for (int32 i = 0; i < Centers.Num(); ++i)
+		{
+			OutInBeam[i] = false;
+		}
+		return;
+	}
+
+	for (int32 i = 0; i < Centers.Num(); ++i)
+	{
+		OutInBeam[i] = IsSphereInBeamInternal(Centers[i], Radius);
+	}
+}
+
+bool UFlashlightIlluminationSubsystem::IsTargetLit(const AActor* Target) const
+{
+	for (int32 i = 0; i < Targets.Num(); ++i)
+	{
+		if (Targets[i].Get() == Target)
+		{
+			return TargetLit[i];
+		}
+	}
+	return false;
+}
+
+bool UFlashlightIlluminationSubsystem::IsSphereInBeamInternal(const FVector& Center, float Radius) const
+{
+	const FVector ToCenter = Center - Beam.Origin;
+	const float DistSq = ToCenter.SizeSquared();
+
+	if (DistSq <= Radius * Radius)
+	{
+		return true;
+	}
+
+	if (DistSq > FMath::Square(Beam.Range + Radius))
+	{
+		return false;
+	}
+
+	// Mở rộng góc cone thêm asin(R/d): cos(a) >= cos(Half + b) = cosHalf*cosB - sinHalf*sinB
+	const float InvDist = FMath::InvSqrt(DistSq);
+	const float CosAngle = FVector::DotProduct(ToCenter, Beam.Direction) * InvDist;
+	const float SinB = FMath::Min(Radius * InvDist, 1.0f);
+	const float CosB = FMath::Sqrt(1.0f - SinB * SinB);
+
+	return CosAngle >= CosHalfAngle * CosB - SinHalfAngle * SinB;
+}
+
+bool UFlashlightIlluminationSubsystem::TraceLineOfSight(const AActor* Target, const FVector& TargetLocation) const
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return true;
+	}
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(FlashlightOcclusion), false);
+	Params.AddIgnoredActor(Target);
+	if (const AActor* Owner = BeamOwner.Get())
+	{
+		Params.AddIgnoredActor(Owner);
+	}
+
+	return !World->LineTraceTestByChannel(Beam.Origin, TargetLocation, OcclusionChannel, Params);
+}
+
+// ============================================
+// TARGETS
+// ============================================
+
+void UFlashlightIlluminationSubsystem::RegisterTarget(AActor* Target, float Radius, bool bRequireLineOfSight)
+{
+	if (!Target)
+	{
+		return;
+	}
+
+	const int32 Existing = Targets.IndexOfByKey(Target);
+	if (Existing != INDEX_NONE)
+	{
+		TargetRadii[Existing] = Radius;
+		TargetRequiresLOS[Existing] = bRequireLineOfSight;
+		return;
+	}
+
+	Targets.Add(Target);
+	TargetRadii.Add(Radius);
+	TargetRequiresLOS.Add(bRequireLineOfSight);
+	TargetHasLOS.Add(false);
+	TargetLit.Add(false);
+	TargetLocations.Add(Target->GetActorLocation());
+	TargetInCone.Add(false);
+}
+
+void UFlashlightIlluminationSubsystem::UnregisterTarget(AActor* Target)
+{
+	const int32 Index = Targets.IndexOfByKey(Target);
+	if (Index != INDEX_NONE)
+	{
+		RemoveTargetAt(Index);
+	}
+}
+
+void UFlashlightIlluminationSubsystem::RemoveTargetAt(int32 Index)
+{
+	Targets.RemoveAtSwap(Index);
+	TargetRadii.RemoveAtSwap(Index);
+	TargetRequiresLOS.RemoveAtSwap(Index);
+	TargetHasLOS.RemoveAtSwap(Index);
+	TargetLit.RemoveAtSwap(Index);
+	TargetLocations.RemoveAtSwap(Index);
+	TargetInCone.RemoveAtSwap(Index);
+}
+
+void UFlashlightIlluminationSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlashlightIlluminationTick);
+
+	if (Beam.bActive && !BeamSource.IsValid())
+	{
+		ClearBeam();
+	}
+
+	UpdateTargets();
+}
+
+void UFlashlightIlluminationSubsystem::UpdateTargets()
+{
+	const int32 NumTargets = Targets.Num();
+	if (NumTargets == 0)
+	{
+		return;
+	}
+
+	// Pass 1: lấy vị trí + test cone cho tất cả target
+	for (int32 i = NumTargets - 1; i >= 0; --i)
+	{
+		const AActor* Target = Targets[i].Get();
+		if (!Target)
+		{
+			RemoveTargetAt(i);
+			continue;
+		}
+
+		TargetLocations[i] = Target->GetActorLocation();
+		TargetInCone[i] = Beam.bActive && IsSphereInBeamInternal(TargetLocations[i], TargetRadii[i]);
+	}
+
+	// Pass 2: occlusion trace có budget, round-robin để target nào cũng được cập nhật sau vài frame
+	int32 TracesLeft = MaxOcclusionTracesPerFrame;
+	int32 TracesDone = 0;
+	const int32 Count = Targets.Num();
+	for (int32 Step = 0; Step < Count && TracesLeft > 0; ++Step)
+	{
+		const int32 i = (OcclusionCursor + Step) % Count;
+		if (!TargetInCone[i] || !TargetRequiresLOS[i])
+		{
+			continue;
+		}
+
+		TargetHasLOS[i] = TraceLineOfSight(Targets[i].Get(), TargetLocations[i]);
+		--TracesLeft;
+		++TracesDone;
+		OcclusionCursor = i + 1;
+	}
+	if (Count > 0)
+	{
+		OcclusionCursor %= Count;
+	}
+	SET_DWORD_STAT(STAT_FlashlightOcclusionTraces, TracesDone);
+
+	// Pass 3: cập nhật trạng thái + bắn event enter/exit.
+	// Target vừa vào cone nhưng chưa tới lượt trace thì chưa tính là sáng
+	TArray<TPair<TWeakObjectPtr<AActor>, bool>, TInlineAllocator<16>> Changes;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		bool bLit = TargetInCone[i] && (!TargetRequiresLOS[i] || TargetHasLOS[i]);
+		if (!TargetInCone[i])
+		{
+			TargetHasLOS[i] = false;
+		}
+
+		if (bLit != TargetLit[i])
+		{
+			TargetLit[i] = bLit;
+			Changes.Emplace(Targets[i], bLit);
+		}
+	}
+
+	// Broadcast sau cùng vì listener có thể register/unregister target
+	for (const TPair<TWeakObjectPtr<AActor>, bool>& Change : Changes)
+	{
+		if (AActor* Target = Change.Key.Get())
+		{
+			OnIlluminationChanged.Broadcast(Target, Change.Value);
+		}
+	}
+}
+
+// ============================================
+// BENCHMARK
+// ============================================
+
+void UFlashlightIlluminationSubsystem::RunBenchmark(int32 NumTargets, int32 NumFrames)
+{
+	UWorld* World = GetWorld();
+	if (!World || NumTargets <= 0 || NumFrames <= 0)
+	{
+		return;
+	}
+
+	// Cất target thật ra khỏi các mảng SoA trong lúc benchmark: UpdateTargets chỉ thấy target benchmark,
+	// target thật không bị beam giả làm enter/exit và giữ nguyên trạng thái lit
+	TArray<TWeakObjectPtr<AActor>> SavedTargets = MoveTemp(Targets);
+	TArray<float> SavedRadii = MoveTemp(TargetRadii);
+	TArray<bool> SavedRequiresLOS = MoveTemp(TargetRequiresLOS);
+	TArray<bool> SavedHasLOS = MoveTemp(TargetHasLOS);
+	TArray<bool> SavedLit = MoveTemp(TargetLit);
+	TArray<FVector> SavedLocations = MoveTemp(TargetLocations);
+	TArray<bool> SavedInCone = MoveTemp(TargetInCone);
+	const int32 SavedOcclusionCursor = OcclusionCursor;
+	OcclusionCursor = 0;
+
+	// Đặt xa level (trên cao) để trace không đụng geometry; một nửa target cần line of sight
+	const FVector Center(0.0f, 0.0f, 100000.0f);
+	constexpr float Range = 2500.0f;
+	constexpr float HalfAngle = 25.0f;
+
+	FRandomStream Random(NumTargets);
+	TArray<TObjectPtr<AActor>> BenchmarkActors;
+	BenchmarkActors.Reserve(NumTargets);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	for (int32 i = 0; i < NumTargets; ++i)
+	{
+		const FVector Location = Center + Random.GetUnitVector() * Random.FRandRange(100.0f, Range * 1.2f);
+		if (AActor* Actor = World->SpawnActor<ATargetPoint>(Location, FRotator::ZeroRotator, SpawnParams))
+		{
+			RegisterTarget(Actor, 50.0f, (i & 1) == 0);
+			BenchmarkActors.Add(Actor);
+		}
+	}
+
+	// Giữ beam thật để trả lại sau benchmark
+	const FFlashlightBeam SavedBeam = Beam;
+	const TWeakObjectPtr<const AActor> SavedOwner = BeamOwner;
+	const TWeakObjectPtr<const USpotLightComponent> SavedSource = BeamSource;
+
+	TArray<FVector> Centers;
+	TArray<bool> InBeam;
+	Centers.Reserve(BenchmarkActors.Num());
+	for (const AActor* Actor : BenchmarkActors)
+	{
+		Centers.Add(Actor->GetActorLocation());
+	}
+
+	uint64 TickCycles = 0;
+	uint64 MaxTickCycles = 0;
+	uint64 QueryCycles = 0;
+	int64 NumLit = 0;
+	int32 NumChanges = 0;
+	TArray<bool> PreviousLit;
+
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		// Beam quét một vòng quanh tâm trong NumFrames frame
+		const float Yaw = 360.0f * Frame / NumFrames;
+		SetBeamCone(Center, FRotator(-10.0f, Yaw, 0.0f).Vector(), HalfAngle, Range, 1.0f);
+		BeamOwner.Reset();
+		BeamSource.Reset();
+
+		PreviousLit = TargetLit;
+
+		// Beam giả không có spot light -> bỏ qua kiểm tra source của Tick
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		UpdateTargets();
+		const uint64 Cycles = FPlatformTime::Cycles64() - StartCycles;
+		TickCycles += Cycles;
+		MaxTickCycles = FMath::Max(MaxTickCycles, Cycles);
+
+		const uint64 QueryStart = FPlatformTime::Cycles64();
+		QuerySpheresInBeam(Centers, 50.0f, InBeam);
+		QueryCycles += FPlatformTime::Cycles64() - QueryStart;
+
+		for (int32 i = 0; i < TargetLit.Num(); ++i)
+		{
+			NumLit += TargetLit[i] ? 1 : 0;
+			NumChanges += PreviousLit.IsValidIndex(i) && PreviousLit[i] != TargetLit[i] ? 1 : 0;
+		}
+	}
+
+	for (AActor* Actor : BenchmarkActors)
+	{
+		Actor->Destroy();
+	}
+
+	Targets = MoveTemp(SavedTargets);
+	TargetRadii = MoveTemp(SavedRadii);
+	TargetRequiresLOS = MoveTemp(SavedRequiresLOS);
+	TargetHasLOS = MoveTemp(SavedHasLOS);
+	TargetLit = MoveTemp(SavedLit);
+	TargetLocations = MoveTemp(SavedLocations);
+	TargetInCone = MoveTemp(SavedInCone);
+	OcclusionCursor = SavedOcclusionCursor;
+
+	Beam = SavedBeam;
+	FMath::SinCos(&SinHalfAngle, &CosHalfAngle, FMath::DegreesToRadians(Beam.HalfAngleDegrees));
+	BeamOwner = SavedOwner;
+	BeamSource = SavedSource;
+
+	const double TickMs = FPlatformTime::ToMilliseconds64(TickCycles) / NumFrames;
+	UE_LOG(LogEscapeIT, Display, TEXT("FlashlightIllumination benchmark: %d target(s), %d frame(s), tick avg %.3f ms (%.3f us per target), max %.3f ms, batch query avg %.3f us, avg %.1f lit, %d enter/exit event(s), %d trace(s) per frame max"),
+		BenchmarkActors.Num(), NumFrames, TickMs, TickMs * 1000.0 / FMath::Max(1, BenchmarkActors.Num()),
+		FPlatformTime::ToMilliseconds64(MaxTickCycles),
+		FPlatformTime::ToMilliseconds64(QueryCycles) * 1000.0 / NumFrames,
+		static_cast<double>(NumLit) / NumFrames, NumChanges, MaxOcclusionTracesPerFrame);
+}
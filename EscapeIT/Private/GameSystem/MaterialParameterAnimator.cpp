@@ -0,0 +1,244 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameSystem/MaterialParameterAnimator.h"
+#include "EscapeIT.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("MaterialParameterAnimator Tick"), STAT_MaterialParameterAnimatorTick, STATGROUP_EscapeIT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Material Parameter Tracks"), STAT_MaterialParameterTracks, STATGROUP_EscapeIT);
+
+UMaterialParameterAnimator* UMaterialParameterAnimator::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UMaterialParameterAnimator>() : nullptr;
+}
+
+void UMaterialParameterAnimator::Deinitialize()
+{
+	Tracks.Empty();
+	TrackIdToIndex.Empty();
+	ParameterIndexCache.Empty();
+	PausedOwners.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UMaterialParameterAnimator::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UMaterialParameterAnimator, STATGROUP_Tickables);
+}
+
+int32 UMaterialParameterAnimator::AddTrack(FMaterialParameterTrackDesc&& Desc)
+{
+	UMaterialInstanceDynamic* Material = Desc.Material.Get();
+	if (!Material || Desc.ParameterName.IsNone())
+	{
+		return INDEX_NONE;
+	}
+
+	FActiveTrack Track;
+	Track.Id = NextTrackId++;
+	Track.Material = Material;
+	Track.From = Desc.From;
+	Track.To = Desc.To;
+	Track.InvDuration = Desc.Duration > KINDA_SMALL_NUMBER ? 1.0f / Desc.Duration : 0.0f;
+	Track.Curve = Desc.Curve;
+	Track.EasingFunc = Desc.EasingFunc;
+	Track.BlendExp = Desc.BlendExp;
+	Track.Owner = Desc.Owner;
+	Track.OnCompleted = MoveTemp(Desc.OnCompleted);
+	Track.bPaused = Desc.Owner.IsValid() && PausedOwners.Contains(Desc.Owner);
+
+	// Giá trị đầu được ghi ngay để không bị nháy một frame
+	Track.ParameterIndex = ResolveParameterIndex(Material, Desc.ParameterName, EvaluateTrack(Track));
+	if (Track.ParameterIndex == INDEX_NONE)
+	{
+		UE_LOG(LogEscapeIT, Warning, TEXT("MaterialParameterAnimator: parameter %s not found on %s"),
+			*Desc.ParameterName.ToString(), *Material->GetName());
+		return INDEX_NONE;
+	}
+
+	const int32 TrackId = Track.Id;
+	TrackIdToIndex.Add(TrackId, Tracks.Add(MoveTemp(Track)));
+	return TrackId;
+}
+
+void UMaterialParameterAnimator::CancelTrack(int32 TrackId)
+{
+	if (const int32* Index = TrackIdToIndex.Find(TrackId))
+	{
+		RemoveTrackAt(*Index);
+	}
+}
+
+void UMaterialParameterAnimator::CancelTracksForOwner(const UObject* Owner)
+{
+	for (int32 i = Tracks.Num() - 1; i >= 0; --i)
+	{
+		if (Tracks[i].Owner.Get() == Owner)
+		{
+			RemoveTrackAt(i);
+		}
+	}
+}
+
+void UMaterialParameterAnimator::SetOwnerPaused(const UObject* Owner, bool bPaused)
+{
+	if (!Owner)
+	{
+		return;
+	}
+
+	// Bỏ owner đã bị destroy mà chưa resume
+	for (auto It = PausedOwners.CreateIterator(); It; ++It)
+	{
+		if (!It->IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	const TWeakObjectPtr<UObject> WeakOwner(const_cast<UObject*>(Owner));
+	if (bPaused)
+	{
+		PausedOwners.Add(WeakOwner);
+	}
+	else
+	{
+		PausedOwners.Remove(WeakOwner);
+	}
+
+	for (FActiveTrack& Track : Tracks)
+	{
+		if (Track.Owner == WeakOwner)
+		{
+			Track.bPaused = bPaused;
+		}
+	}
+}
+
+bool UMaterialParameterAnimator::IsTrackActive(int32 TrackId) const
+{
+	return TrackIdToIndex.Contains(TrackId);
+}
+
+float UMaterialParameterAnimator::GetTrackAlpha(int32 TrackId) const
+{
+	const int32* Index = TrackIdToIndex.Find(TrackId);
+	return Index ? Tracks[*Index].Alpha : -1.0f;
+}
+
+void UMaterialParameterAnimator::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MaterialParameterAnimatorTick);
+	SET_DWORD_STAT(STAT_MaterialParameterTracks, Tracks.Num());
+
+	if (Tracks.Num() == 0)
+	{
+		return;
+	}
+
+	// Callback được gọi sau vòng lặp vì callback có thể destroy owner / đăng ký track mới
+	TArray<TFunction<void()>, TInlineAllocator<8>> Completed;
+	bool bHasStaleMaterial = false;
+
+	for (int32 i = Tracks.Num() - 1; i >= 0; --i)
+	{
+		FActiveTrack& Track = Tracks[i];
+		UMaterialInstanceDynamic* Material = Track.Material.Get();
+		if (!Material)
+		{
+			// Material bị GC: coi như track đã xong để owner vẫn kết thúc được (vd. ghost Destroy sau fade)
+			bHasStaleMaterial = true;
+			const bool bOwnerAlive = Track.Owner.IsExplicitlyNull() || Track.Owner.IsValid();
+			if (Track.OnCompleted && bOwnerAlive)
+			{
+				Completed.Add(MoveTemp(Track.OnCompleted));
+			}
+			RemoveTrackAt(i);
+			continue;
+		}
+
+		if (Track.bPaused)
+		{
+			continue;
+		}
+
+		Track.Alpha = Track.InvDuration > 0.0f ? FMath::Min(Track.Alpha + DeltaTime * Track.InvDuration, 1.0f) : 1.0f;
+		Material->SetScalarParameterByIndex(Track.ParameterIndex, EvaluateTrack(Track));
+
+		if (Track.Alpha >= 1.0f)
+		{
+			if (Track.OnCompleted)
+			{
+				Completed.Add(MoveTemp(Track.OnCompleted));
+			}
+			RemoveTrackAt(i);
+		}
+	}
+
+	if (bHasStaleMaterial)
+	{
+		for (auto It = ParameterIndexCache.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	for (TFunction<void()>& Callback : Completed)
+	{
+		Callback();
+	}
+}
+
+int32 UMaterialParameterAnimator::ResolveParameterIndex(UMaterialInstanceDynamic* Material, FName ParameterName, float InitialValue)
+{
+	const TMap<FName, int32>* MaterialCache = ParameterIndexCache.Find(Material);
+	if (const int32* CachedIndex = MaterialCache ? MaterialCache->Find(ParameterName) : nullptr)
+	{
+		Material->SetScalarParameterByIndex(*CachedIndex, InitialValue);
+		return *CachedIndex;
+	}
+
+	int32 ParameterIndex = INDEX_NONE;
+	if (!Material->InitializeScalarParameterAndGetIndex(ParameterName, InitialValue, ParameterIndex))
+	{
+		return INDEX_NONE;
+	}
+
+	// Chỉ thêm vào cache khi tìm được parameter: miss không để lại entry rỗng cho material
+	ParameterIndexCache.FindOrAdd(Material).Add(ParameterName, ParameterIndex);
+	return ParameterIndex;
+}
+
+float UMaterialParameterAnimator::EvaluateTrack(const FActiveTrack& Track) const
+{
+	float Shaped = Track.Alpha;
+	if (const UCurveFloat* Curve = Track.Curve.Get())
+	{
+		Shaped = Curve->GetFloatValue(Track.Alpha);
+	}
+	else if (Track.EasingFunc != EEasingFunc::Linear)
+	{
+		Shaped = UKismetMathLibrary::Ease(0.0f, 1.0f, Track.Alpha, Track.EasingFunc, Track.BlendExp);
+	}
+
+	return FMath::Lerp(Track.From, Track.To, Shaped);
+}
+
+void UMaterialParameterAnimator::RemoveTrackAt(int32 Index)
+{
+	TrackIdToIndex.Remove(Tracks[Index].Id);
+	Tracks.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	// Track cuối đã được swap vào Index
+	if (Tracks.IsValidIndex(Index))
+	{
+		TrackIdToIndex.Add(Tracks[Index].Id, Index);
+	}
+}
@@ -0,0 +1,1111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Puzzle/FlowPuzzle.h"
+#include "Puzzle/FlowPuzzleBitboard.h"
+#include "Puzzle/FlowPuzzleAsyncGenerator.h"
+#include "EscapeIT.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+
+namespace FlowPuzzle
+{
+	static const EWireColor WireColors[] = { EWireColor::Red, EWireColor::Blue, EWireColor::Yellow, EWireColor::Green, EWireColor::Orange };
+
+	// Cùng thứ tự với hướng của FFlowPuzzleBitGrid: phải, trái, xuống, lên
+	static const FIntPoint Directions[] = { FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1) };
+	static_assert(UE_ARRAY_COUNT(Directions) == FFlowPuzzleBitGrid::NumDirections, "Hai engine phải có cùng số hướng");
+
+	static bool IsAdjacent(FIntPoint A, FIntPoint B)
+	{
+		return FMath::Abs(A.X - B.X) + FMath::Abs(A.Y - B.Y) == 1;
+	}
+
+	static bool IsEndpoint(const FGridCell& Cell)
+	{
+		return Cell.CellType == ECellType::StartPoint || Cell.CellType == ECellType::EndPoint;
+	}
+
+	/**
+	 * Chọn ngẫu nhiên một hướng trong các hướng đi được (bCanMove, theo thứ tự Directions), hướng tiến gần End
+	 * theo X/Y được ưu tiên gấp 4 lần. INDEX_NONE nếu không còn hướng nào (ngõ cụt).
+	 * Dùng chung cho cả hai engine để cùng seed cho cùng đường.
+	 */
+	static int32 ChooseDirection(FRandomStream& Random, FIntPoint Current, FIntPoint End, const bool (&bCanMove)[UE_ARRAY_COUNT(Directions)])
+	{
+		const int32 DeltaX = End.X - Current.X;
+		const int32 DeltaY = End.Y - Current.Y;
+
+		int32 Choices[UE_ARRAY_COUNT(Directions)];
+		float Weights[UE_ARRAY_COUNT(Directions)];
+		int32 NumChoices = 0;
+		float TotalWeight = 0.0f;
+
+		for (int32 Direction = 0; Direction < UE_ARRAY_COUNT(Directions); ++Direction)
+		{
+			if (!bCanMove[Direction])
+			{
+				continue;
+			}
+
+			const FIntPoint& Dir = Directions[Direction];
+			float Weight = 1.0f;
+			if ((Dir.X > 0 && DeltaX > 0) || (Dir.X < 0 && DeltaX < 0))
+			{
+				Weight += 3.0f;
+			}
+			if ((Dir.Y > 0 && DeltaY > 0) || (Dir.Y < 0 && DeltaY < 0))
+			{
+				Weight += 3.0f;
+			}
+
+			Choices[NumChoices] = Direction;
+			Weights[NumChoices] = Weight;
+			TotalWeight += Weight;
+			++NumChoices;
+		}
+
+		if (NumChoices == 0)
+		{
+			return INDEX_NONE;
+		}
+
+		const float RandomValue = Random.FRandRange(0.0f, TotalWeight);
+		float Sum = 0.0f;
+		for (int32 i = 0; i < NumChoices; ++i)
+		{
+			Sum += Weights[i];
+			if (RandomValue <= Sum)
+			{
+				return Choices[i];
+			}
+		}
+		return Choices[NumChoices - 1];
+	}
+
+	/** Kéo lại đường lời giải của một dây qua FFlowPuzzleBoard; true nếu mọi bước được chấp nhận và dây nối xong */
+	static bool ReplayWire(FFlowPuzzleBoard& Board, const FWirePair& Wire)
+	{
+		if (Wire.CurrentPath.Num() < 2 || !Board.BeginDrag(Wire.CurrentPath[0]))
+		{
+			return false;
+		}
+
+		for (int32 i = 1; i < Wire.CurrentPath.Num(); ++i)
+		{
+			const EFlowPuzzleMove Expected = i == Wire.CurrentPath.Num() - 1 ? EFlowPuzzleMove::Connected : EFlowPuzzleMove::Extended;
+			if (Board.UpdateDrag(Wire.CurrentPath[i]) != Expected)
+			{
+				return false;
+			}
+		}
+
+		const FWirePair* Placed = Board.GetGrid().FindWire(Wire.Color);
+		return Placed && Placed->bIsComplete && !Board.IsDragging();
+	}
+
+	static bool IsSameSolution(const TArray<FWirePair>& A, const TArray<FWirePair>& B)
+	{
+		if (A.Num() != B.Num())
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < A.Num(); ++i)
+		{
+			if (A[i].Color != B[i].Color || A[i].StartPoint != B[i].StartPoint || A[i].EndPoint != B[i].EndPoint || A[i].CurrentPath != B[i].CurrentPath)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Lưới 5 x 3 dựng tay để thử từng luật kéo dây */
+	static FFlowPuzzleGrid MakeValidationGrid()
+	{
+		// . R . R .
+		// B . . . B
+		// . . . . .
+		FFlowPuzzleGrid Grid;
+		Grid.Init(5, 3);
+
+		FWirePair Red;
+		Red.Color = EWireColor::Red;
+		Red.StartPoint = FIntPoint(1, 0);
+		Red.EndPoint = FIntPoint(3, 0);
+		Grid.Wires.Add(Red);
+
+		FWirePair Blue;
+		Blue.Color = EWireColor::Blue;
+		Blue.StartPoint = FIntPoint(0, 1);
+		Blue.EndPoint = FIntPoint(4, 1);
+		Grid.Wires.Add(Blue);
+
+		Grid.PlaceEndpoints();
+		return Grid;
+	}
+
+	// Số seed mỗi cỡ lưới cho console command và automation test
+	constexpr int32 DefaultValidationSeeds = 2000;
+
+	/** Generator, solver và luật kéo dây trên NumSeeds seed, không cần widget hay world. Test != null thì mỗi check fail là một lỗi của test */
+	static bool RunValidation(int32 NumSeeds, FAutomationTestBase* Test = nullptr)
+	{
+		int32 NumFailed = 0;
+		auto Check = [&NumFailed, Test](bool bCondition, const FString& Description)
+		{
+			if (!bCondition)
+			{
+				++NumFailed;
+				if (Test)
+				{
+					Test->AddError(Description);
+				}
+			}
+			UE_LOG(LogEscapeIT, Display, TEXT("FlowPuzzle: [%s] %s"), bCondition ? TEXT("PASS") : TEXT("FAIL"), *Description);
+		};
+
+		// ---- Moves ----
+		{
+			FFlowPuzzleBoard Board;
+			Board.SetGrid(MakeValidationGrid());
+
+			Check(!Board.BeginDrag(FIntPoint(2, 2)), TEXT("cannot start a drag on an empty cell"));
+
+			Check(Board.BeginDrag(FIntPoint(1, 0)) && Board.GetDragColor() == EWireColor::Red, TEXT("drag starts on an endpoint"));
+			Check(Board.UpdateDrag(FIntPoint(2, 1)) == EFlowPuzzleMove::Ignored, TEXT("diagonal step is ignored"));
+			Check(Board.UpdateDrag(FIntPoint(0, 0)) == EFlowPuzzleMove::Extended, TEXT("step onto an empty cell extends the wire"));
+			Check(Board.UpdateDrag(FIntPoint(0, 1)) == EFlowPuzzleMove::Cleared && !Board.IsDragging()
+				&& Board.GetGrid().FindWire(EWireColor::Red)->CurrentPath.Num() == 0
+				&& Board.GetGrid().GetCell(FIntPoint(0, 0))->CellType == ECellType::Empty,
+				TEXT("stepping onto another colour's endpoint clears the wire"));
+
+			Board.BeginDrag(FIntPoint(1, 0));
+			Board.UpdateDrag(FIntPoint(2, 0));
+			Check(Board.UpdateDrag(FIntPoint(1, 0)) == EFlowPuzzleMove::Backtracked
+				&& Board.GetGrid().GetCell(FIntPoint(2, 0))->CellType == ECellType::Empty,
+				TEXT("returning to the origin backtracks instead of connecting"));
+			Check(!Board.GetGrid().FindWire(EWireColor::Red)->bIsComplete, TEXT("wire looped back to its own start is not complete"));
+
+			Board.UpdateDrag(FIntPoint(2, 0));
+			Check(Board.UpdateDrag(FIntPoint(3, 0)) == EFlowPuzzleMove::Connected && !Board.IsDragging(), TEXT("reaching the other endpoint connects"));
+			Check(!Board.IsComplete(), TEXT("puzzle is not complete while a wire is open"));
+
+			Board.BeginDrag(FIntPoint(0, 1));
+			Board.UpdateDrag(FIntPoint(0, 2));
+			Board.UpdateDrag(FIntPoint(1, 2));
+			Check(Board.EndDrag() && Board.GetGrid().GetCell(FIntPoint(1, 2))->CellType == ECellType::Empty,
+				TEXT("releasing an unfinished wire clears it"));
+
+			Board.BeginDrag(FIntPoint(0, 1));
+			Board.UpdateDrag(FIntPoint(1, 1));
+			Board.UpdateDrag(FIntPoint(2, 1));
+			Board.UpdateDrag(FIntPoint(3, 1));
+			Check(Board.UpdateDrag(FIntPoint(4, 1)) == EFlowPuzzleMove::Connected && Board.IsComplete(), TEXT("connecting every wire completes the puzzle"));
+
+			Check(Board.BeginDrag(FIntPoint(2, 1)) && Board.UpdateDrag(FIntPoint(1, 1)) == EFlowPuzzleMove::Backtracked
+				&& !Board.IsComplete() && Board.GetGrid().FindWire(EWireColor::Blue)->CurrentPath.Num() == 2
+				&& Board.GetGrid().GetCell(FIntPoint(3, 1))->CellType == ECellType::Empty,
+				TEXT("dragging from the middle of a wire cuts it there"));
+
+			Check(Board.UpdateDrag(FIntPoint(3, 2)) == EFlowPuzzleMove::Ignored, TEXT("non-adjacent step is ignored"));
+
+			Board.UpdateDrag(FIntPoint(1, 2));
+			Board.UpdateDrag(FIntPoint(2, 2));
+			Board.UpdateDrag(FIntPoint(3, 2));
+			Board.UpdateDrag(FIntPoint(4, 2));
+			Check(Board.UpdateDrag(FIntPoint(4, 1)) == EFlowPuzzleMove::Connected && Board.IsComplete(), TEXT("re-routed wire reconnects"));
+
+			Board.BeginDrag(FIntPoint(1, 0));
+			Check(Board.UpdateDrag(FIntPoint(1, 1)) == EFlowPuzzleMove::Cleared, TEXT("stepping onto another colour's path clears the wire"));
+
+			Check(Board.ConsumeChangedCells().Num() > 0 && Board.ConsumeChangedCells().Num() == 0, TEXT("changed cells are reported once"));
+		}
+
+		// ---- Solver ----
+		{
+			const FFlowPuzzleGrid Grid = MakeValidationGrid();
+			Check(FFlowPuzzleSolver::IsSolvable(Grid), TEXT("hand-made puzzle is solvable"));
+			Check(!FFlowPuzzleSolver::HasPathBetweenPoints(Grid, FIntPoint(0, 0), FIntPoint(4, 0), { FIntPoint(0, 1), FIntPoint(1, 0) }),
+				TEXT("boxed-in corner has no path"));
+			Check(!FFlowPuzzleSolver::IsSolvable(Grid, 0.2f), TEXT("fill ratio rejects crowded puzzles"));
+		}
+
+		// ---- Generation ----
+		// 20 x 20 vượt dung lượng bitboard -> kiểm tra cả đường mảng ô
+		const FIntPoint Sizes[] = { FIntPoint(5, 5), FIntPoint(9, 9), FIntPoint(12, 8), FIntPoint(15, 15), FIntPoint(20, 20) };
+		for (const FIntPoint& Size : Sizes)
+		{
+			FFlowPuzzleSettings Settings;
+			Settings.Width = Size.X;
+			Settings.Height = Size.Y;
+			Settings.NumWirePairs = 4;
+
+			const int32 NumPairs = FFlowPuzzleGenerator::GetNumPairsToGenerate(Settings);
+			int32 NumGenerated = 0;
+			int32 NumInvalid = 0;
+			int32 NumUnsolvable = 0;
+			int32 NumNotReplayed = 0;
+			int32 NumNotDeterministic = 0;
+
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			for (int32 Seed = 1; Seed <= NumSeeds; ++Seed)
+			{
+				FRandomStream Random(Seed);
+				FFlowPuzzleGrid Grid;
+				TArray<FWirePair> Solution;
+				if (!FFlowPuzzleGenerator::Generate(Settings, Random, Grid, &Solution))
+				{
+					continue;
+				}
+				++NumGenerated;
+
+				// Puzzle chỉ có hai đầu mỗi dây, lời giải là các đường kề nhau không chồng lên nhau
+				bool bValid = Grid.Wires.Num() == NumPairs && Solution.Num() == NumPairs && Grid.GetNumCompleteWires() == 0;
+				TBitArray<> Used(false, Grid.NumCells());
+				for (const FWirePair& Wire : Solution)
+				{
+					bValid &= Wire.CurrentPath.Num() >= 2 && Wire.CurrentPath[0] == Wire.StartPoint && Wire.CurrentPath.Last() == Wire.EndPoint;
+					bValid &= FFlowPuzzleGenerator::GetDistanceBetweenPoints(Wire.StartPoint, Wire.EndPoint) >= Settings.MinimumPointDistance;
+					for (int32 i = 0; i < Wire.CurrentPath.Num(); ++i)
+					{
+						const int32 Index = Grid.GetCellIndex(Wire.CurrentPath[i]);
+						bValid &= Index != INDEX_NONE && !Used[Index] && (i == 0 || IsAdjacent(Wire.CurrentPath[i - 1], Wire.CurrentPath[i]));
+						if (Index != INDEX_NONE)
+						{
+							Used[Index] = true;
+						}
+					}
+				}
+				NumInvalid += bValid ? 0 : 1;
+
+				NumUnsolvable += FFlowPuzzleSolver::IsSolvable(Grid) ? 0 : 1;
+
+				// Kéo lại lời giải bằng luật của người chơi phải nối xong cả puzzle
+				FFlowPuzzleBoard Board;
+				Board.SetGrid(CopyTemp(Grid));
+				bool bReplayed = true;
+				for (const FWirePair& Wire : Solution)
+				{
+					bReplayed &= ReplayWire(Board, Wire);
+				}
+				NumNotReplayed += bReplayed && Board.IsComplete() ? 0 : 1;
+
+				// Cùng seed -> cùng puzzle, trên bitboard cũng như trên mảng ô
+				FFlowPuzzleSettings CellSettings = Settings;
+				CellSettings.bUseBitboards = false;
+				FRandomStream Again(Seed);
+				FFlowPuzzleGrid Regenerated;
+				TArray<FWirePair> RegeneratedSolution;
+				FFlowPuzzleGenerator::Generate(CellSettings, Again, Regenerated, &RegeneratedSolution);
+				NumNotDeterministic += IsSameSolution(Solution, RegeneratedSolution) ? 0 : 1;
+			}
+			const double MillisecondsPerSeed = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / FMath::Max(1, NumSeeds);
+
+			const FString SizeName = FString::Printf(TEXT("%dx%d"), Settings.Width, Settings.Height);
+			UE_LOG(LogEscapeIT, Display, TEXT("FlowPuzzle: %s generated %d / %d seed(s), %.3f ms per seed"), *SizeName, NumGenerated, NumSeeds, MillisecondsPerSeed);
+
+			Check(NumGenerated * 100 >= NumSeeds * 95, FString::Printf(TEXT("%s: generator succeeds for at least 95%% of seeds"), *SizeName));
+			Check(NumInvalid == 0, FString::Printf(TEXT("%s: solutions are disjoint adjacent paths between each pair (%d bad)"), *SizeName, NumInvalid));
+			Check(NumUnsolvable == 0, FString::Printf(TEXT("%s: solver accepts every generated puzzle (%d rejected)"), *SizeName, NumUnsolvable));
+			Check(NumNotReplayed == 0, FString::Printf(TEXT("%s: replaying the solution completes the puzzle (%d failed)"), *SizeName, NumNotReplayed));
+			Check(NumNotDeterministic == 0, FString::Printf(TEXT("%s: same seed gives the same puzzle on bitboard and cell grids (%d differ)"), *SizeName, NumNotDeterministic));
+		}
+
+		// ---- Async generation: ép cả đường worker lẫn đường đồng bộ ----
+		{
+			FFlowPuzzleSettings Settings;
+			Settings.Width = 9;
+			Settings.Height = 9;
+			Settings.NumWirePairs = 4;
+
+			const int32 Seed = 1234;
+			FRandomStream Random(Seed);
+			FFlowPuzzleGrid Expected;
+			FFlowPuzzleGenerator::Generate(Settings, Random, Expected);
+
+			FFlowPuzzleAsyncGenerator Generator;
+			FFlowPuzzleGrid Grid;
+			EFlowPuzzleGenerationPath Path = EFlowPuzzleGenerationPath::Synchronous;
+
+			// Worker xong trước khi Take
+			Generator.Start(Settings, Seed);
+			Generator.Wait();
+			Check(Generator.IsReady(), TEXT("Async: finished task is ready"));
+			Check(Generator.Take(Settings, Seed + 1, Grid, &Path) && Path == EFlowPuzzleGenerationPath::Worker, TEXT("Async: finished task is taken from the worker"));
+			Check(IsSameSolution(Grid.Wires, Expected.Wires), TEXT("Async: worker puzzle equals the synchronous puzzle for the same seed"));
+			Check(!Generator.IsPending(), TEXT("Async: Take clears the pending task"));
+
+			// Worker bị chặn bởi event chưa trigger -> Take phải sinh đồng bộ, cùng seed, không chờ
+			UE::Tasks::FTaskEvent Gate{ UE_SOURCE_LOCATION };
+			const UE::Tasks::FTask Blocker = UE::Tasks::Launch(UE_SOURCE_LOCATION, [] {}, UE::Tasks::Prerequisites(Gate));
+			Generator.Start(Settings, Seed, Blocker);
+			Check(Generator.IsPending() && !Generator.IsReady(), TEXT("Async: gated task is pending and not ready"));
+			Check(Generator.Take(Settings, Seed + 1, Grid, &Path) && Path == EFlowPuzzleGenerationPath::Synchronous, TEXT("Async: unfinished task falls back to synchronous generation"));
+			Check(IsSameSolution(Grid.Wires, Expected.Wires), TEXT("Async: synchronous fallback reuses the pending seed"));
+			Gate.Trigger();
+			Blocker.Wait();
+
+			// Settings khác -> bỏ kết quả của worker
+			FFlowPuzzleSettings OtherSettings = Settings;
+			OtherSettings.NumWirePairs = 3;
+			Generator.Start(Settings, Seed);
+			Generator.Wait();
+			Check(Generator.Take(OtherSettings, Seed, Grid, &Path) && Path == EFlowPuzzleGenerationPath::Synchronous && Grid.Wires.Num() == 3, TEXT("Async: result for other settings is discarded"));
+
+			// Hủy -> không còn task, Take dùng FallbackSeed
+			Generator.Start(Settings, Seed + 1);
+			Generator.Cancel();
+			Check(!Generator.IsPending(), TEXT("Async: Cancel drops the pending task"));
+			Check(Generator.Take(Settings, Seed, Grid, &Path) && Path == EFlowPuzzleGenerationPath::Synchronous && IsSameSolution(Grid.Wires, Expected.Wires), TEXT("Async: after Cancel, Take generates from the fallback seed"));
+		}
+
+		UE_LOG(LogEscapeIT, Display, TEXT("FlowPuzzle: validation %s (%d failed)"), NumFailed == 0 ? TEXT("passed") : TEXT("FAILED"), NumFailed);
+		return NumFailed == 0;
+	}
+
+	/** Thời gian sinh NumSeeds puzzle trên mảng ô và trên bitboard, lưới 5 x 5 tới 15 x 15 */
+	static void RunBenchmark(int32 NumSeeds)
+	{
+		UE_LOG(LogEscapeIT, Display, TEXT("FlowPuzzle: generation benchmark, %d seed(s) per size, %d wire pair(s)"), NumSeeds, FFlowPuzzleSettings().NumWirePairs);
+
+		for (int32 Size = 5; Size <= 15; ++Size)
+		{
+			FFlowPuzzleSettings Settings;
+			Settings.Width = Size;
+			Settings.Height = Size;
+
+			double Milliseconds[2] = {};
+			TArray<FWirePair> Solutions[2];
+			int32 NumGenerated = 0;
+			int32 NumDiffer = 0;
+
+			for (int32 Seed = 1; Seed <= NumSeeds; ++Seed)
+			{
+				// 0 = mảng ô (đường cũ), 1 = bitboard
+				for (int32 Engine = 0; Engine < 2; ++Engine)
+				{
+					Settings.bUseBitboards = Engine == 1;
+					FRandomStream Random(Seed);
+					FFlowPuzzleGrid Grid;
+
+					const uint64 StartCycles = FPlatformTime::Cycles64();
+					const bool bGenerated = FFlowPuzzleGenerator::Generate(Settings, Random, Grid, &Solutions[Engine]);
+					Milliseconds[Engine] += FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+					NumGenerated += bGenerated && Engine == 1 ? 1 : 0;
+				}
+				NumDiffer += IsSameSolution(Solutions[0], Solutions[1]) ? 0 : 1;
+			}
+
+			UE_LOG(LogEscapeIT, Display, TEXT("FlowPuzzle: %2dx%-2d cells %8.4f ms, bitboard %8.4f ms, x%5.2f  (%d generated, %d differ)"),
+				Size, Size, Milliseconds[0] / NumSeeds, Milliseconds[1] / NumSeeds,
+				Milliseconds[1] > 0.0 ? Milliseconds[0] / Milliseconds[1] : 0.0, NumGenerated, NumDiffer);
+		}
+	}
+
+	static FAutoConsoleCommand ValidateCommand(
+		TEXT("puzzle.FlowPuzzle.Validate"),
+		TEXT("puzzle.FlowPuzzle.Validate <NumSeeds>: kiểm tra generator, solver và luật kéo dây của puzzle nối dây trên NumSeeds seed mỗi cỡ lưới"),
+		FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+		{
+			RunValidation(Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : DefaultValidationSeeds);
+		}));
+
+	static FAutoConsoleCommand BenchmarkCommand(
+		TEXT("puzzle.FlowPuzzle.Benchmark"),
+		TEXT("puzzle.FlowPuzzle.Benchmark <NumSeeds>: so thời gian sinh puzzle trên mảng ô và trên bitboard, lưới 5x5 tới 15x15"),
+		FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+		{
+			RunBenchmark(Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000);
+		}));
+}
+
+// ============================================
+// GRID
+// ============================================
+
+void FFlowPuzzleGrid::Init(int32 InWidth, int32 InHeight)
+{
+	Width = FMath::Max(1, InWidth);
+	Height = FMath::Max(1, InHeight);
+
+	Wires.Reset();
+	Cells.SetNum(Width * Height);
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		for (int32 X = 0; X < Width; ++X)
+		{
+			Cells[Y * Width + X].GridPosition = FIntPoint(X, Y);
+		}
+	}
+
+	ResetCells();
+}
+
+FGridCell* FFlowPuzzleGrid::GetCell(FIntPoint Position)
+{
+	const int32 Index = GetCellIndex(Position);
+	return Index != INDEX_NONE ? &Cells[Index] : nullptr;
+}
+
+const FGridCell* FFlowPuzzleGrid::GetCell(FIntPoint Position) const
+{
+	const int32 Index = GetCellIndex(Position);
+	return Index != INDEX_NONE ? &Cells[Index] : nullptr;
+}
+
+FWirePair* FFlowPuzzleGrid::FindWire(EWireColor Color)
+{
+	return Wires.FindByPredicate([Color](const FWirePair& Wire) { return Wire.Color == Color; });
+}
+
+const FWirePair* FFlowPuzzleGrid::FindWire(EWireColor Color) const
+{
+	return Wires.FindByPredicate([Color](const FWirePair& Wire) { return Wire.Color == Color; });
+}
+
+void FFlowPuzzleGrid::ResetCells()
+{
+	for (FGridCell& Cell : Cells)
+	{
+		Cell.CellType = ECellType::Empty;
+		Cell.WireColor = EWireColor::None;
+		Cell.PathID = -1;
+		Cell.bIsConnected = false;
+	}
+}
+
+void FFlowPuzzleGrid::PlaceEndpoints()
+{
+	ResetCells();
+
+	for (FWirePair& Wire : Wires)
+	{
+		if (FGridCell* StartCell = GetCell(Wire.StartPoint))
+		{
+			StartCell->CellType = ECellType::StartPoint;
+			StartCell->WireColor = Wire.Color;
+		}
+
+		if (FGridCell* EndCell = GetCell(Wire.EndPoint))
+		{
+			EndCell->CellType = ECellType::EndPoint;
+			EndCell->WireColor = Wire.Color;
+		}
+
+		// Người chơi phải tự tìm đường
+		Wire.CurrentPath.Reset();
+		Wire.bIsComplete = false;
+	}
+}
+
+int32 FFlowPuzzleGrid::GetNumCompleteWires() const
+{
+	int32 NumComplete = 0;
+	for (const FWirePair& Wire : Wires)
+	{
+		NumComplete += Wire.bIsComplete ? 1 : 0;
+	}
+	return NumComplete;
+}
+
+bool FFlowPuzzleGrid::IsComplete() const
+{
+	return Wires.Num() > 0 && GetNumCompleteWires() == Wires.Num();
+}
+
+// ============================================
+// GENERATOR
+// ============================================
+
+int32 FFlowPuzzleGenerator::GetNumPairsToGenerate(const FFlowPuzzleSettings& Settings)
+{
+	const int32 NumPairs = FMath::Min(Settings.NumWirePairs, static_cast<int32>(UE_ARRAY_COUNT(FlowPuzzle::WireColors)));
+	return FMath::Max(0, FMath::Min(NumPairs, Settings.Width * Settings.Height / 2));
+}
+
+float FFlowPuzzleGenerator::GetDistanceBetweenPoints(FIntPoint A, FIntPoint B)
+{
+	const float DX = static_cast<float>(A.X - B.X);
+	const float DY = static_cast<float>(A.Y - B.Y);
+	return FMath::Sqrt(FMath::Square(DX) + FMath::Square(DY));
+}
+
+template<typename GridType>
+bool FFlowPuzzleGenerator::GenerateWires(const FFlowPuzzleSettings& Settings, FRandomStream& Random, GridType& Grid, int32 NumPairs, TArray<FWirePair>& OutWires)
+{
+	OutWires.Reserve(NumPairs);
+
+	TArray<FIntPoint> PathBuffer;
+	PathBuffer.Reserve(Grid.NumCells());
+
+	for (int32 Attempt = 0; Attempt < Settings.MaxPuzzleAttempts && !Settings.IsCancelled(); ++Attempt)
+	{
+		Grid.ResetCells();
+		OutWires.Reset();
+
+		// Vẽ đường đầy đủ cho từng dây; một dây kẹt -> làm lại cả puzzle
+		for (int32 i = 0; i < NumPairs; ++i)
+		{
+			FWirePair& NewWire = OutWires.AddDefaulted_GetRef();
+			NewWire.Color = FlowPuzzle::WireColors[i];
+
+			if (!GenerateCompletePath(Settings, Random, Grid, NewWire, PathBuffer))
+			{
+				break;
+			}
+		}
+
+		if (OutWires.Num() == NumPairs && OutWires.Last().bIsComplete)
+		{
+			return true;
+		}
+	}
+
+	OutWires.Reset();
+	return false;
+}
+
+template<typename GridType>
+bool FFlowPuzzleGenerator::GenerateCompletePath(const FFlowPuzzleSettings& Settings, FRandomStream& Random, GridType& Grid, FWirePair& OutWire, TArray<FIntPoint>& PathBuffer)
+{
+	const FIntPoint StartPoint = FindRandomEmptyCell(Random, Grid);
+	if (StartPoint.X < 0)
+	{
+		return false;
+	}
+
+	for (int32 Attempt = 0; Attempt < Settings.MaxPathAttempts; ++Attempt)
+	{
+		// Điểm cuối đủ xa điểm đầu
+		const FIntPoint EndPoint = FindRandomEmptyCell(Random, Grid);
+		if (EndPoint.X < 0 || EndPoint == StartPoint || GetDistanceBetweenPoints(StartPoint, EndPoint) < Settings.MinimumPointDistance)
+		{
+			continue;
+		}
+
+		if (GeneratePathBetweenPoints(Random, Grid, StartPoint, EndPoint, PathBuffer))
+		{
+			OutWire.StartPoint = StartPoint;
+			OutWire.EndPoint = EndPoint;
+			OutWire.CurrentPath = PathBuffer;
+			OutWire.bIsComplete = true;
+
+			MarkPathOnGrid(Grid, PathBuffer, OutWire.Color);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FFlowPuzzleGenerator::Generate(const FFlowPuzzleSettings& Settings, FRandomStream& Random, FFlowPuzzleGrid& OutGrid, TArray<FWirePair>* OutSolution)
+{
+	OutGrid.Init(Settings.Width, Settings.Height);
+
+	const int32 NumPairs = GetNumPairsToGenerate(Settings);
+	if (NumPairs <= 0)
+	{
+		return false;
+	}
+
+	TArray<FWirePair> GeneratedWires;
+	bool bGenerated = false;
+
+	if (Settings.bUseBitboards && FFlowPuzzleBitGrid::CanHold(OutGrid.GetWidth(), OutGrid.GetHeight()))
+	{
+		FFlowPuzzleBitGrid BitGrid;
+		BitGrid.Init(OutGrid.GetWidth(), OutGrid.GetHeight());
+		bGenerated = GenerateWires(Settings, Random, BitGrid, NumPairs, GeneratedWires);
+	}
+	else
+	{
+		bGenerated = GenerateWires(Settings, Random, OutGrid, NumPairs, GeneratedWires);
+	}
+
+	if (!bGenerated)
+	{
+		OutGrid.ResetCells();
+		return false;
+	}
+
+	if (OutSolution)
+	{
+		*OutSolution = GeneratedWires;
+	}
+
+	OutGrid.Wires = MoveTemp(GeneratedWires);
+	OutGrid.PlaceEndpoints();
+	return true;
+}
+
+bool FFlowPuzzleGenerator::GeneratePathBetweenPoints(FRandomStream& Random, const FFlowPuzzleGrid& Grid, FIntPoint Start, FIntPoint End, TArray<FIntPoint>& OutPath)
+{
+	OutPath.Reset();
+	OutPath.Add(Start);
+
+	// Random walk thiên về hướng tới End, không đi lại ô đã đi trong cùng đường
+	TBitArray<> Visited(false, Grid.NumCells());
+	Visited[Grid.GetCellIndex(Start)] = true;
+
+	FIntPoint Current = Start;
+	const int32 MaxSteps = Grid.NumCells() * 2;
+
+	for (int32 Step = 0; Step < MaxSteps && Current != End; ++Step)
+	{
+		bool bCanMove[UE_ARRAY_COUNT(FlowPuzzle::Directions)];
+		for (int32 Direction = 0; Direction < UE_ARRAY_COUNT(FlowPuzzle::Directions); ++Direction)
+		{
+			const FIntPoint Next = Current + FlowPuzzle::Directions[Direction];
+			const FGridCell* Cell = Grid.GetCell(Next);
+			bCanMove[Direction] = Cell && (Next == End || (Cell->CellType == ECellType::Empty && !Visited[Grid.GetCellIndex(Next)]));
+		}
+
+		// Ngõ cụt
+		const int32 Direction = FlowPuzzle::ChooseDirection(Random, Current, End, bCanMove);
+		if (Direction == INDEX_NONE)
+		{
+			return false;
+		}
+
+		Current += FlowPuzzle::Directions[Direction];
+		OutPath.Add(Current);
+		Visited[Grid.GetCellIndex(Current)] = true;
+	}
+
+	return Current == End;
+}
+
+bool FFlowPuzzleGenerator::GeneratePathBetweenPoints(FRandomStream& Random, const FFlowPuzzleBitGrid& Grid, FIntPoint Start, FIntPoint End, TArray<FIntPoint>& OutPath)
+{
+	OutPath.Reset();
+	OutPath.Add(Start);
+
+	// Ô còn đi vào được: trống và chưa đi trong đường này, cộng chính End
+	const int32 EndIndex = Grid.GetCellIndex(End);
+	int32 CurrentIndex = Grid.GetCellIndex(Start);
+	FFlowPuzzleBitboard Open = Grid.GetEmpty();
+	Open.Remove(CurrentIndex);
+	Open.Add(EndIndex);
+
+	FIntPoint Current = Start;
+	const int32 MaxSteps = Grid.NumCells() * 2;
+
+	for (int32 Step = 0; Step < MaxSteps && CurrentIndex != EndIndex; ++Step)
+	{
+		bool bCanMove[FFlowPuzzleBitGrid::NumDirections];
+		for (int32 Direction = 0; Direction < FFlowPuzzleBitGrid::NumDirections; ++Direction)
+		{
+			const int32 Next = Grid.GetNeighbor(CurrentIndex, Direction);
+			bCanMove[Direction] = Next != INDEX_NONE && Open.Contains(Next);
+		}
+
+		// Ngõ cụt
+		const int32 Direction = FlowPuzzle::ChooseDirection(Random, Current, End, bCanMove);
+		if (Direction == INDEX_NONE)
+		{
+			return false;
+		}
+
+		CurrentIndex = Grid.GetNeighbor(CurrentIndex, Direction);
+		Current += FlowPuzzle::Directions[Direction];
+		OutPath.Add(Current);
+		Open.Remove(CurrentIndex);
+	}
+
+	return CurrentIndex == EndIndex;
+}
+
+FIntPoint FFlowPuzzleGenerator::FindRandomEmptyCell(FRandomStream& Random, const FFlowPuzzleGrid& Grid)
+{
+	int32 NumEmpty = 0;
+	for (const FGridCell& Cell : Grid.Cells)
+	{
+		NumEmpty += Cell.CellType == ECellType::Empty ? 1 : 0;
+	}
+
+	if (NumEmpty == 0)
+	{
+		return FIntPoint(-1, -1);
+	}
+
+	// Ô trống thứ N theo thứ tự index, không cần mảng tạm
+	int32 Remaining = Random.RandRange(0, NumEmpty - 1);
+	for (const FGridCell& Cell : Grid.Cells)
+	{
+		if (Cell.CellType == ECellType::Empty && Remaining-- == 0)
+		{
+			return Cell.GridPosition;
+		}
+	}
+
+	return FIntPoint(-1, -1);
+}
+
+void FFlowPuzzleGenerator::MarkPathOnGrid(FFlowPuzzleGrid& Grid, const TArray<FIntPoint>& Path, EWireColor Color)
+{
+	for (int32 i = 0; i < Path.Num(); ++i)
+	{
+		if (FGridCell* Cell = Grid.GetCell(Path[i]))
+		{
+			Cell->CellType = i == 0 ? ECellType::StartPoint : (i == Path.Num() - 1 ? ECellType::EndPoint : ECellType::Path);
+			Cell->WireColor = Color;
+		}
+	}
+}
+
+FIntPoint FFlowPuzzleGenerator::FindRandomEmptyCell(FRandomStream& Random, const FFlowPuzzleBitGrid& Grid)
+{
+	const FFlowPuzzleBitboard Empty = Grid.GetEmpty();
+	const int32 NumEmpty = Empty.Num();
+	if (NumEmpty == 0)
+	{
+		return FIntPoint(-1, -1);
+	}
+
+	// Cùng lượt random với bản mảng ô: ô trống thứ N theo thứ tự index
+	const int32 Index = Empty.FindNth(Random.RandRange(0, NumEmpty - 1));
+	return FIntPoint(Index % Grid.GetWidth(), Index / Grid.GetWidth());
+}
+
+void FFlowPuzzleGenerator::MarkPathOnGrid(FFlowPuzzleBitGrid& Grid, const TArray<FIntPoint>& Path, EWireColor Color)
+{
+	for (const FIntPoint& Position : Path)
+	{
+		Grid.Occupy(Grid.GetCellIndex(Position), Color);
+	}
+}
+
+// ============================================
+// SOLVER
+// ============================================
+
+bool FFlowPuzzleSolver::HasPathBetweenPoints(const FFlowPuzzleGrid& Grid, FIntPoint Start, FIntPoint End, TConstArrayView<FIntPoint> BlockedPositions)
+{
+	if (!Grid.IsInside(Start) || !Grid.IsInside(End))
+	{
+		return false;
+	}
+
+	if (FFlowPuzzleBitGrid::CanHold(Grid.GetWidth(), Grid.GetHeight()))
+	{
+		FFlowPuzzleBitGrid BitGrid;
+		BitGrid.Init(Grid.GetWidth(), Grid.GetHeight());
+
+		FFlowPuzzleBitboard Passable = BitGrid.GetAllCells();
+		for (const FIntPoint& Blocked : BlockedPositions)
+		{
+			if (Grid.IsInside(Blocked))
+			{
+				Passable.Remove(Grid.GetCellIndex(Blocked));
+			}
+		}
+
+		return BitGrid.HasPath(Grid.GetCellIndex(Start), Grid.GetCellIndex(End), Passable);
+	}
+
+	TBitArray<> Visited(false, Grid.NumCells());
+	for (const FIntPoint& Blocked : BlockedPositions)
+	{
+		if (Grid.IsInside(Blocked) && Blocked != End)
+		{
+			Visited[Grid.GetCellIndex(Blocked)] = true;
+		}
+	}
+
+	// Queue là mảng + con trỏ đầu, không RemoveAt(0)
+	TArray<FIntPoint> Queue;
+	Queue.Reserve(Grid.NumCells());
+	Queue.Add(Start);
+	Visited[Grid.GetCellIndex(Start)] = true;
+
+	for (int32 Head = 0; Head < Queue.Num(); ++Head)
+	{
+		const FIntPoint Current = Queue[Head];
+		if (Current == End)
+		{
+			return true;
+		}
+
+		for (const FIntPoint& Dir : FlowPuzzle::Directions)
+		{
+			const FIntPoint Next = Current + Dir;
+			const int32 NextIndex = Grid.GetCellIndex(Next);
+			if (NextIndex != INDEX_NONE && !Visited[NextIndex])
+			{
+				Visited[NextIndex] = true;
+				Queue.Add(Next);
+			}
+		}
+	}
+
+	return false;
+}
+
+bool FFlowPuzzleSolver::IsSolvable(const FFlowPuzzleGrid& Grid, float MaxFillRatio)
+{
+	if (Grid.Wires.Num() == 0)
+	{
+		return false;
+	}
+
+	int32 TotalCellsNeeded = 0;
+	for (const FWirePair& Wire : Grid.Wires)
+	{
+		TotalCellsNeeded += FMath::Abs(Wire.EndPoint.X - Wire.StartPoint.X) + FMath::Abs(Wire.EndPoint.Y - Wire.StartPoint.Y) + 1;
+	}
+
+	if (TotalCellsNeeded > Grid.NumCells() * MaxFillRatio)
+	{
+		return false;
+	}
+
+	if (FFlowPuzzleBitGrid::CanHold(Grid.GetWidth(), Grid.GetHeight()))
+	{
+		// Đầu dây theo màu: vật cản của một dây = đầu của mọi màu khác
+		FFlowPuzzleBitGrid BitGrid;
+		BitGrid.Init(Grid.GetWidth(), Grid.GetHeight());
+		for (const FWirePair& Wire : Grid.Wires)
+		{
+			BitGrid.Occupy(Grid.GetCellIndex(Wire.StartPoint), Wire.Color);
+			BitGrid.Occupy(Grid.GetCellIndex(Wire.EndPoint), Wire.Color);
+		}
+
+		for (const FWirePair& Wire : Grid.Wires)
+		{
+			const FFlowPuzzleBitboard Blocked = BitGrid.GetOccupied().AndNot(BitGrid.GetColorCells(Wire.Color));
+			if (!BitGrid.HasPath(Grid.GetCellIndex(Wire.StartPoint), Grid.GetCellIndex(Wire.EndPoint), BitGrid.GetAllCells().AndNot(Blocked)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	TArray<FIntPoint, TInlineAllocator<16>> Blocked;
+	for (const FWirePair& Wire : Grid.Wires)
+	{
+		// Đầu dây màu khác là vật cản
+		Blocked.Reset();
+		for (const FWirePair& Other : Grid.Wires)
+		{
+			if (Other.Color != Wire.Color)
+			{
+				Blocked.Add(Other.StartPoint);
+				Blocked.Add(Other.EndPoint);
+			}
+		}
+
+		if (!HasPathBetweenPoints(Grid, Wire.StartPoint, Wire.EndPoint, Blocked))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// ============================================
+// BOARD
+// ============================================
+
+bool FFlowPuzzleBoard::Generate(const FFlowPuzzleSettings& Settings, FRandomStream& Random, TArray<FWirePair>* OutSolution)
+{
+	FFlowPuzzleGrid NewGrid;
+	const bool bGenerated = FFlowPuzzleGenerator::Generate(Settings, Random, NewGrid, OutSolution);
+	SetGrid(MoveTemp(NewGrid));
+	return bGenerated;
+}
+
+void FFlowPuzzleBoard::SetGrid(FFlowPuzzleGrid&& InGrid)
+{
+	Grid = MoveTemp(InGrid);
+
+	bIsDragging = false;
+	DragColor = EWireColor::None;
+	LastCellPosition = FIntPoint(-1, -1);
+
+	// View vẽ lại toàn bộ lưới
+	ChangedCells.Reset();
+	for (int32 Index = 0; Index < Grid.NumCells(); ++Index)
+	{
+		ChangedCells.Add(Index);
+	}
+}
+
+void FFlowPuzzleBoard::SetCell(FGridCell& Cell, ECellType Type, EWireColor Color, int32 PathID)
+{
+	Cell.CellType = Type;
+	Cell.WireColor = Color;
+	Cell.PathID = PathID;
+	ChangedCells.AddUnique(Grid.GetCellIndex(Cell.GridPosition));
+}
+
+void FFlowPuzzleBoard::StopDrag()
+{
+	bIsDragging = false;
+	DragColor = EWireColor::None;
+}
+
+bool FFlowPuzzleBoard::BeginDrag(FIntPoint Position)
+{
+	const FGridCell* Cell = Grid.GetCell(Position);
+	FWirePair* Wire = Cell ? Grid.FindWire(Cell->WireColor) : nullptr;
+	if (!Wire)
+	{
+		return false;
+	}
+
+	if (FlowPuzzle::IsEndpoint(*Cell))
+	{
+		// Kéo từ một đầu: vẽ lại cả dây từ đầu này
+		ClearWire(Wire->Color);
+		Wire->CurrentPath.Add(Position);
+		++CurrentPathID;
+	}
+	else if (Cell->CellType == ECellType::Path)
+	{
+		// Kéo từ giữa dây: giữ phần từ đầu tới ô này, vẽ tiếp từ đây
+		const int32 IndexInPath = Wire->CurrentPath.Find(Position);
+		if (IndexInPath == INDEX_NONE)
+		{
+			return false;
+		}
+
+		for (int32 i = Wire->CurrentPath.Num() - 1; i > IndexInPath; --i)
+		{
+			FGridCell& Removed = *Grid.GetCell(Wire->CurrentPath[i]);
+			if (Removed.CellType == ECellType::Path)
+			{
+				SetCell(Removed, ECellType::Empty, EWireColor::None, -1);
+			}
+		}
+		Wire->CurrentPath.SetNum(IndexInPath + 1);
+		Wire->bIsComplete = false;
+	}
+	else
+	{
+		return false;
+	}
+
+	bIsDragging = true;
+	DragColor = Wire->Color;
+	LastCellPosition = Position;
+	return true;
+}
+
+EFlowPuzzleMove FFlowPuzzleBoard::UpdateDrag(FIntPoint Position)
+{
+	if (!bIsDragging || !FlowPuzzle::IsAdjacent(Position, LastCellPosition))
+	{
+		return EFlowPuzzleMove::Ignored;
+	}
+
+	FGridCell* Cell = Grid.GetCell(Position);
+	FWirePair* Wire = Grid.FindWire(DragColor);
+	if (!Cell || !Wire)
+	{
+		return EFlowPuzzleMove::Ignored;
+	}
+
+	// Lùi lại ô đã đi (kể cả đầu xuất phát): xóa phần phía sau
+	const int32 IndexInPath = Wire->CurrentPath.Find(Position);
+	if (IndexInPath != INDEX_NONE)
+	{
+		for (int32 i = Wire->CurrentPath.Num() - 1; i > IndexInPath; --i)
+		{
+			FGridCell& Removed = *Grid.GetCell(Wire->CurrentPath[i]);
+			if (Removed.CellType == ECellType::Path)
+			{
+				SetCell(Removed, ECellType::Empty, EWireColor::None, -1);
+			}
+		}
+		Wire->CurrentPath.SetNum(IndexInPath + 1);
+		Wire->bIsComplete = false;
+		LastCellPosition = Position;
+		return EFlowPuzzleMove::Backtracked;
+	}
+
+	// Đường hoặc đầu dây màu khác: hủy cả dây đang kéo
+	if (Cell->CellType != ECellType::Empty && Cell->WireColor != DragColor)
+	{
+		ClearWire(DragColor);
+		StopDrag();
+		return EFlowPuzzleMove::Cleared;
+	}
+
+	if (FlowPuzzle::IsEndpoint(*Cell))
+	{
+		// Đầu kia cùng màu (đầu xuất phát đã rơi vào nhánh lùi lại ở trên)
+		Wire->CurrentPath.Add(Position);
+		Wire->bIsComplete = true;
+		StopDrag();
+		return EFlowPuzzleMove::Connected;
+	}
+
+	if (Cell->CellType == ECellType::Empty)
+	{
+		SetCell(*Cell, ECellType::Path, DragColor, CurrentPathID);
+		Wire->CurrentPath.Add(Position);
+		LastCellPosition = Position;
+		return EFlowPuzzleMove::Extended;
+	}
+
+	return EFlowPuzzleMove::Ignored;
+}
+
+bool FFlowPuzzleBoard::EndDrag()
+{
+	bool bCleared = false;
+
+	if (bIsDragging)
+	{
+		const FWirePair* Wire = Grid.FindWire(DragColor);
+		if (Wire && !Wire->bIsComplete)
+		{
+			ClearWire(DragColor);
+			bCleared = true;
+		}
+	}
+
+	StopDrag();
+	return bCleared;
+}
+
+void FFlowPuzzleBoard::ClearWire(EWireColor Color)
+{
+	FWirePair* Wire = Grid.FindWire(Color);
+	if (!Wire)
+	{
+		return;
+	}
+
+	for (const FIntPoint& Position : Wire->CurrentPath)
+	{
+		FGridCell& Cell = *Grid.GetCell(Position);
+		if (Cell.CellType == ECellType::Path)
+		{
+			SetCell(Cell, ECellType::Empty, EWireColor::None, -1);
+		}
+	}
+
+	Wire->CurrentPath.Reset();
+	Wire->bIsComplete = false;
+}
+
+// ============================================
+// AUTOMATION
+// ============================================
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFlowPuzzleValidationTest, "EscapeIT.Puzzle.FlowPuzzle.Validate",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFlowPuzzleValidationTest::RunTest(const FString& Parameters)
+{
+	return FlowPuzzle::RunValidation(FlowPuzzle::DefaultValidationSeeds, this);
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
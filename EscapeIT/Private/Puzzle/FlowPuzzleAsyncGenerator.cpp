@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Puzzle/FlowPuzzleAsyncGenerator.h"
+#include "EscapeIT.h"
+
+DECLARE_CYCLE_STAT(TEXT("FlowPuzzle Generate (worker)"), STAT_FlowPuzzleGenerateWorker, STATGROUP_EscapeIT);
+DECLARE_CYCLE_STAT(TEXT("FlowPuzzle Generate (sync)"), STAT_FlowPuzzleGenerateSync, STATGROUP_EscapeIT);
+
+FFlowPuzzleAsyncGenerator::~FFlowPuzzleAsyncGenerator()
+{
+	Cancel();
+}
+
+void FFlowPuzzleAsyncGenerator::Start(const FFlowPuzzleSettings& Settings, int32 Seed, const UE::Tasks::FTask& Prerequisite)
+{
+	Cancel();
+
+	State = MakeShared<FState, ESPMode::ThreadSafe>();
+	State->Settings = Settings;
+	State->Settings.CancelFlag = &State->bCancelled;
+	State->Seed = Seed;
+
+	// Worker giữ tham chiếu riêng tới state: hủy chỉ cần bật cờ và bỏ state, không chờ
+	auto Generate = [TaskState = State]()
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FlowPuzzleGenerateWorker);
+
+		FRandomStream Random(TaskState->Seed);
+		TaskState->bGenerated = FFlowPuzzleGenerator::Generate(TaskState->Settings, Random, TaskState->Grid);
+	};
+
+	Task = Prerequisite.IsValid()
+		? UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Generate), UE::Tasks::Prerequisites(Prerequisite))
+		: UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Generate));
+}
+
+void FFlowPuzzleAsyncGenerator::Cancel()
+{
+	if (State.IsValid())
+	{
+		State->bCancelled = true;
+		State.Reset();
+	}
+	Task = UE::Tasks::FTask();
+}
+
+void FFlowPuzzleAsyncGenerator::Wait() const
+{
+	if (Task.IsValid())
+	{
+		Task.Wait();
+	}
+}
+
+bool FFlowPuzzleAsyncGenerator::Take(const FFlowPuzzleSettings& Settings, int32 FallbackSeed, FFlowPuzzleGrid& OutGrid, EFlowPuzzleGenerationPath* OutPath)
+{
+	int32 Seed = FallbackSeed;
+
+	if (State.IsValid() && State->Settings.Matches(Settings))
+	{
+		if (Task.IsCompleted())
+		{
+			const bool bGenerated = State->bGenerated;
+			OutGrid = MoveTemp(State->Grid);
+			State.Reset();
+			Task = UE::Tasks::FTask();
+
+			if (OutPath)
+			{
+				*OutPath = EFlowPuzzleGenerationPath::Worker;
+			}
+			return bGenerated;
+		}
+
+		// Chưa xong: không chờ worker, sinh lại ngay với cùng seed
+		Seed = State->Seed;
+	}
+
+	Cancel();
+
+	if (OutPath)
+	{
+		*OutPath = EFlowPuzzleGenerationPath::Synchronous;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FlowPuzzleGenerateSync);
+
+	FFlowPuzzleSettings SyncSettings = Settings;
+	SyncSettings.CancelFlag = nullptr;
+	FRandomStream Random(Seed);
+	return FFlowPuzzleGenerator::Generate(SyncSettings, Random, OutGrid);
+}
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Puzzle/FlowPuzzleBitboard.h"
+
+void FFlowPuzzleBitGrid::Init(int32 InWidth, int32 InHeight)
+{
+	check(CanHold(InWidth, InHeight));
+
+	Width = InWidth;
+	Height = InHeight;
+
+	NeighborOffsets[0] = 1;
+	NeighborOffsets[1] = -1;
+	NeighborOffsets[2] = Width;
+	NeighborOffsets[3] = -Width;
+
+	AllCells.Reset();
+	for (FFlowPuzzleBitboard& Mask : EdgeMasks)
+	{
+		Mask.Reset();
+	}
+
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		for (int32 X = 0; X < Width; ++X)
+		{
+			const int32 Index = Y * Width + X;
+			AllCells.Add(Index);
+
+			if (X < Width - 1)
+			{
+				EdgeMasks[0].Add(Index);
+			}
+			if (X > 0)
+			{
+				EdgeMasks[1].Add(Index);
+			}
+			if (Y < Height - 1)
+			{
+				EdgeMasks[2].Add(Index);
+			}
+			if (Y > 0)
+			{
+				EdgeMasks[3].Add(Index);
+			}
+		}
+	}
+
+	ResetCells();
+}
+
+void FFlowPuzzleBitGrid::Occupy(int32 Index, EWireColor Color)
+{
+	Occupied.Add(Index);
+	ColorCells[static_cast<int32>(Color)].Add(Index);
+}
+
+void FFlowPuzzleBitGrid::ResetCells()
+{
+	Occupied.Reset();
+	for (FFlowPuzzleBitboard& Cells : ColorCells)
+	{
+		Cells.Reset();
+	}
+}
+
+bool FFlowPuzzleBitGrid::HasPath(int32 Start, int32 End, const FFlowPuzzleBitboard& Passable) const
+{
+	if (Start < 0 || Start >= NumCells() || End < 0 || End >= NumCells())
+	{
+		return false;
+	}
+
+	if (Start == End)
+	{
+		return true;
+	}
+
+	// Ô còn vào được và chưa thăm; mỗi ô vào hàng đợi tối đa một lần nên MaxCells là đủ
+	FFlowPuzzleBitboard Open = (Passable & AllCells);
+	Open.Add(End);
+	Open.Remove(Start);
+
+	TFlowPuzzleRingQueue<uint16, FFlowPuzzleBitboard::MaxCells> Queue;
+	Queue.Push(static_cast<uint16>(Start));
+
+	while (!Queue.IsEmpty())
+	{
+		const int32 Current = Queue.Pop();
+
+		for (int32 Direction = 0; Direction < NumDirections; ++Direction)
+		{
+			const int32 Next = GetNeighbor(Current, Direction);
+			if (Next == INDEX_NONE || !Open.Contains(Next))
+			{
+				continue;
+			}
+
+			if (Next == End)
+			{
+				return true;
+			}
+
+			Open.Remove(Next);
+			Queue.Push(static_cast<uint16>(Next));
+		}
+	}
+
+	return false;
+}
@@ -12,11 +12,6 @@ void UElectricCabinetWidget::NativeConstruct()
 {
     Super::NativeConstruct();
     
-    // Initialize dragging state variables
-    bIsDragging = false;
-    CurrentDragColor = EWireColor::None;
-    CurrentPathID = 0;
-    
     RemainingTime = RepairDuration;
     bTimerActive = true;
     bPuzzleFinished = false;
@@ -88,569 +83,59 @@ void UElectricCabinetWidget::NativeTick(const FGeometry& MyGeometry, float InDel
 
 void UElectricCabinetWidget::InitializePuzzle()
 {
-    // Clear all existing data
-    GridCells.Empty();
-    PositionToIndexMap.Empty();
-    CellBorders.Empty();
-    WirePairs.Empty();
-    
     RemainingTime = RepairDuration;
     bPuzzleFinished = false;
     bTimerActive = true;
     
-    // Create grid cells and initialize them as empty
-    for (int32 Y = 0; Y < GridHeight; Y++)
+    // Generate random puzzle with guaranteed solution (prewarmed on a worker thread if PrewarmPuzzle ran in time)
+    FFlowPuzzleGrid Grid;
+    EFlowPuzzleGenerationPath GenerationPath = EFlowPuzzleGenerationPath::Synchronous;
+    if (!PuzzleGenerator.Take(GetPuzzleSettings(), GetNextPuzzleSeed(), Grid, &GenerationPath))
     {
-        for (int32 X = 0; X < GridWidth; X++)
-        {
-            FGridCell Cell;
-            Cell.GridPosition = FIntPoint(X, Y);
-            Cell.CellType = ECellType::Empty;
-            Cell.WireColor = EWireColor::None;
-            Cell.PathID = -1;
-            Cell.bIsConnected = false;
-            
-            // Add cell and create position-to-index mapping
-            int32 Index = GridCells.Add(Cell);
-            PositionToIndexMap.Add(FIntPoint(X, Y), Index);
-        }
+        UE_LOG(LogTemp, Error, TEXT("Puzzle generation failed - no wire pairs created! Try: increase GridWidth/GridHeight or decrease NumberOfWirePairs"));
     }
+    Puzzle.SetGrid(MoveTemp(Grid));
     
-    // Generate random puzzle with guaranteed solution
-    GenerateRandomPuzzle();
-    
-    // Mark start and end points on the grid
-    for (FWirePair& Wire : WirePairs)
-    {
-        if (FGridCell* StartCell = GetCellAt(Wire.StartPoint))
-        {
-            StartCell->CellType = ECellType::StartPoint;
-            StartCell->WireColor = Wire.Color;
-        }
-        
-        if (FGridCell* EndCell = GetCellAt(Wire.EndPoint))
-        {
-            EndCell->CellType = ECellType::EndPoint;
-            EndCell->WireColor = Wire.Color;
-        }
-    }
+    UE_LOG(LogTemp, Log, TEXT("Puzzle ready (%s)"),
+           GenerationPath == EFlowPuzzleGenerationPath::Worker ? TEXT("prewarmed on worker") : TEXT("generated synchronously"));
     
     // Create visual representation
     CreateGridUI();
     
     // Update progress display
     UpdateProgressDisplay();
-    
-    // Log final result
-    if (WirePairs.Num() == 0)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Puzzle generation failed - no wire pairs created!"));
-    }
 }
 
-void UElectricCabinetWidget::GenerateRandomPuzzle()
+FFlowPuzzleSettings UElectricCabinetWidget::GetPuzzleSettings() const
 {
-    // Define available wire colors
-    TArray<EWireColor> FixedColors = {
-        EWireColor::Red,
-        EWireColor::Blue,
-        EWireColor::Yellow,
-        EWireColor::Green,
-        EWireColor::Orange
-    };
-    
-    // Limit number of wire pairs to available colors
-    int32 ActualPairs = FMath::Min(NumberOfWirePairs, FixedColors.Num());
-    
-    // Validate grid is large enough
-    int32 MinCellsNeeded = ActualPairs * 2;
-    int32 AvailableCells = GridWidth * GridHeight;
-    
-    if (AvailableCells < MinCellsNeeded)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Grid too small! Need %d cells but only have %d"), MinCellsNeeded, AvailableCells);
-        ActualPairs = AvailableCells / 2;
-        
-        if (ActualPairs <= 0)
-        {
-            return;
-        }
-    }
-    
-    // Try multiple times to generate a valid puzzle
-    int32 MaxPuzzleAttempts = 50;
-    bool bValidPuzzleFound = false;
-    
-    for (int32 Attempt = 0; Attempt < MaxPuzzleAttempts && !bValidPuzzleFound; Attempt++)
-    {
-        // Reset grid to empty state
-        ResetGridToEmpty();
-        
-        // Generate puzzle by drawing complete paths first
-        TArray<FWirePair> GeneratedWires;
-        bool bAllWiresPlaced = true;
-        
-        for (int32 i = 0; i < ActualPairs; i++)
-        {
-            FWirePair NewWire;
-            NewWire.Color = FixedColors[i];
-            
-            // Try to create a complete path for this wire
-            if (GenerateCompletePath(NewWire))
-            {
-                GeneratedWires.Add(NewWire);
-            }
-            else
-            {
-                bAllWiresPlaced = false;
-                break;
-            }
-        }
-        
-        // Check if all wires were successfully placed
-        if (bAllWiresPlaced && GeneratedWires.Num() == ActualPairs)
-        {
-            // Convert solution to puzzle (remove paths, keep only start/end)
-            ConvertSolutionToPuzzle(GeneratedWires);
-            
-            // Save generated puzzle
-            WirePairs = GeneratedWires;
-            bValidPuzzleFound = true;
-        }
-    }
-    
-    if (!bValidPuzzleFound)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Could not generate valid puzzle after %d attempts"), MaxPuzzleAttempts);
-        UE_LOG(LogTemp, Error, TEXT("Try: increase GridWidth/GridHeight or decrease NumberOfWirePairs"));
-    }
-}
-
-bool UElectricCabinetWidget::GenerateCompletePath(FWirePair& OutWire)
-{
-    // Find random empty cell for start point
-    FIntPoint StartPoint = FindRandomEmptyCell();
-    if (StartPoint.X < 0)
-    {
-        return false;
-    }
-    
-    // Try to create path from this start point
-    int32 MaxPathAttempts = 100;
-    
-    for (int32 Attempt = 0; Attempt < MaxPathAttempts; Attempt++)
-    {
-        // Find random empty cell for end point (far enough from start)
-        FIntPoint EndPoint = FindRandomEmptyCell();
-        if (EndPoint.X < 0)
-            continue;
-        
-        // Ensure start and end points are different
-        if (StartPoint == EndPoint)
-            continue;
-        
-        // Check distance requirement
-        float Distance = GetDistanceBetweenPoints(StartPoint, EndPoint);
-        if (Distance < MinimumPointDistance)
-            continue;
-        
-        // Try to generate path from Start to End
-        TArray<FIntPoint> GeneratedPath;
-        if (GeneratePathBetweenPoints(StartPoint, EndPoint, GeneratedPath))
-        {
-            // Success - mark entire path on grid
-            OutWire.StartPoint = StartPoint;
-            OutWire.EndPoint = EndPoint;
-            OutWire.CurrentPath = GeneratedPath;
-            OutWire.bIsComplete = true;
-            
-            // Mark all cells in path
-            MarkPathOnGrid(GeneratedPath, OutWire.Color);
-            
-            return true;
-        }
-    }
-    
-    return false;
-}
-
-bool UElectricCabinetWidget::GeneratePathBetweenPoints(FIntPoint Start, FIntPoint End, TArray<FIntPoint>& OutPath)
-{
-    OutPath.Empty();
-    
-    // Use biased random walk algorithm - random movement but prefer direction toward goal
-    TArray<FIntPoint> CurrentPath;
-    CurrentPath.Add(Start);
-    
-    FIntPoint Current = Start;
-    int32 MaxSteps = GridWidth * GridHeight * 2; // Limit steps to prevent infinite loop
-    int32 Steps = 0;
-    
-    TSet<FIntPoint> VisitedInThisPath; // Avoid revisiting cells in same path
-    VisitedInThisPath.Add(Start);
-    
-    while (Current != End && Steps < MaxSteps)
-    {
-        Steps++;
-        
-        // Calculate preferred direction (toward End)
-        int32 DeltaX = End.X - Current.X;
-        int32 DeltaY = End.Y - Current.Y;
-        
-        // Build list of possible directions with weights
-        TArray<FIntPoint> PossibleDirections;
-        TArray<float> DirectionWeights;
-        
-        // Four directions: Up, Down, Left, Right
-        TArray<FIntPoint> AllDirections = {
-            FIntPoint(1, 0),   // Right
-            FIntPoint(-1, 0),  // Left
-            FIntPoint(0, 1),   // Down
-            FIntPoint(0, -1)   // Up
-        };
-        
-        for (const FIntPoint& Dir : AllDirections)
-        {
-            FIntPoint Next = Current + Dir;
-            
-            // Check if within bounds
-            if (Next.X < 0 || Next.X >= GridWidth || Next.Y < 0 || Next.Y >= GridHeight)
-                continue;
-            
-            // Check if cell is available (or is destination)
-            FGridCell* Cell = GetCellAt(Next);
-            if (!Cell)
-                continue;
-            
-            bool bIsDestination = (Next == End);
-            bool bIsEmpty = (Cell->CellType == ECellType::Empty);
-            bool bNotVisitedYet = !VisitedInThisPath.Contains(Next);
-            
-            if (bIsDestination || (bIsEmpty && bNotVisitedYet))
-            {
-                PossibleDirections.Add(Dir);
-                
-                // Calculate weight - prefer directions toward goal
-                float Weight = 1.0f;
-                
-                // Increase weight if direction moves toward End
-                if ((Dir.X > 0 && DeltaX > 0) || (Dir.X < 0 && DeltaX < 0))
-                    Weight += 3.0f; // High priority for correct X direction
-                if ((Dir.Y > 0 && DeltaY > 0) || (Dir.Y < 0 && DeltaY < 0))
-                    Weight += 3.0f; // High priority for correct Y direction
-                
-                DirectionWeights.Add(Weight);
-            }
-        }
-        
-        // If no valid directions available, path generation failed
-        if (PossibleDirections.Num() == 0)
-        {
-            return false; // Dead end
-        }
-        
-        // Choose random direction with weights
-        FIntPoint ChosenDirection = ChooseWeightedRandom(PossibleDirections, DirectionWeights);
-        Current = Current + ChosenDirection;
-        
-        CurrentPath.Add(Current);
-        VisitedInThisPath.Add(Current);
-        
-        // Check if reached destination
-        if (Current == End)
-        {
-            OutPath = CurrentPath;
-            return true;
-        }
-    }
-    
-    // Path generation timeout
-    return false;
-}
-
-FIntPoint UElectricCabinetWidget::ChooseWeightedRandom(const TArray<FIntPoint>& Choices, const TArray<float>& Weights)
-{
-    if (Choices.Num() == 0)
-        return FIntPoint(0, 0);
-    
-    if (Choices.Num() != Weights.Num())
-    {
-        // If no weights provided, choose uniformly random
-        return Choices[FMath::RandRange(0, Choices.Num() - 1)];
-    }
-    
-    // Calculate total weight
-    float TotalWeight = 0.0f;
-    for (float W : Weights)
-        TotalWeight += W;
-    
-    // Handle edge case where total weight is zero
-    if (TotalWeight <= 0.0f)
-    {
-        return Choices[FMath::RandRange(0, Choices.Num() - 1)];
-    }
-    
-    // Choose random value in [0, TotalWeight)
-    float RandomValue = FMath::FRandRange(0.0f, TotalWeight);
-    
-    // Find corresponding choice
-    float CurrentSum = 0.0f;
-    for (int32 i = 0; i < Choices.Num(); i++)
-    {
-        CurrentSum += Weights[i];
-        if (RandomValue <= CurrentSum)
-            return Choices[i];
-    }
-    
-    // Fallback
-    return Choices.Last();
-}
-
-FIntPoint UElectricCabinetWidget::FindRandomEmptyCell()
-{
-    TArray<FIntPoint> EmptyCells;
-    
-    // Collect all empty cells
-    for (const FGridCell& Cell : GridCells)
-    {
-        if (Cell.CellType == ECellType::Empty)
-        {
-            EmptyCells.Add(Cell.GridPosition);
-        }
-    }
-    
-    if (EmptyCells.Num() == 0)
-    {
-        return FIntPoint(-1, -1); // No empty cells available
-    }
-    
-    // Choose random cell
-    int32 RandomIndex = FMath::RandRange(0, EmptyCells.Num() - 1);
-    return EmptyCells[RandomIndex];
-}
-
-void UElectricCabinetWidget::MarkPathOnGrid(const TArray<FIntPoint>& Path, EWireColor Color)
-{
-    for (int32 i = 0; i < Path.Num(); i++)
-    {
-        FGridCell* Cell = GetCellAt(Path[i]);
-        if (Cell)
-        {
-            // First cell is start point
-            if (i == 0)
-            {
-                Cell->CellType = ECellType::StartPoint;
-            }
-            // Last cell is end point
-            else if (i == Path.Num() - 1)
-            {
-                Cell->CellType = ECellType::EndPoint;
-            }
-            // Middle cells are path
-            else
-            {
-                Cell->CellType = ECellType::Path;
-            }
-            
-            Cell->WireColor = Color;
-        }
-    }
-}
-
-void UElectricCabinetWidget::ResetGridToEmpty()
-{
-    for (FGridCell& Cell : GridCells)
-    {
-        Cell.CellType = ECellType::Empty;
-        Cell.WireColor = EWireColor::None;
-        Cell.PathID = -1;
-        Cell.bIsConnected = false;
-    }
-}
-
-void UElectricCabinetWidget::ConvertSolutionToPuzzle(TArray<FWirePair>& Wires)
-{
-    // Reset grid
-    ResetGridToEmpty();
-    
-    // Only mark start and end points
-    for (FWirePair& Wire : Wires)
-    {
-        // Mark start point
-        FGridCell* StartCell = GetCellAt(Wire.StartPoint);
-        if (StartCell)
-        {
-            StartCell->CellType = ECellType::StartPoint;
-            StartCell->WireColor = Wire.Color;
-        }
-        
-        // Mark end point
-        FGridCell* EndCell = GetCellAt(Wire.EndPoint);
-        if (EndCell)
-        {
-            EndCell->CellType = ECellType::EndPoint;
-            EndCell->WireColor = Wire.Color;
-        }
-        
-        // Clear path - player must find it themselves
-        Wire.CurrentPath.Empty();
-        Wire.bIsComplete = false;
-    }
-}
-
-bool UElectricCabinetWidget::IsPuzzleSolvable(const TArray<FWirePair>& WiresToCheck)
-{
-    // Early validation
-    if (WiresToCheck.Num() == 0)
-    {
-        return false;
-    }
-    
-    // Check if each wire has at least one valid path
-    for (const FWirePair& Wire : WiresToCheck)
-    {
-        // Collect positions occupied by other wires' start/end points
-        TArray<FIntPoint> OccupiedPositions;
-        
-        for (const FWirePair& OtherWire : WiresToCheck)
-        {
-            if (OtherWire.Color != Wire.Color)
-            {
-                OccupiedPositions.Add(OtherWire.StartPoint);
-                OccupiedPositions.Add(OtherWire.EndPoint);
-            }
-        }
-
-        // Use BFS to check if path exists
-        if (!HasPathBetweenPoints(Wire.StartPoint, Wire.EndPoint, OccupiedPositions))
-        {
-            return false;
-        }
-    }
-    
-    // Check if there's enough space on grid
-    int32 TotalCellsNeeded = 0;
-    for (const FWirePair& Wire : WiresToCheck)
-    {
-        // Calculate minimum path length using Manhattan distance
-        int32 MinPathLength = FMath::Abs(Wire.EndPoint.X - Wire.StartPoint.X) +
-                             FMath::Abs(Wire.EndPoint.Y - Wire.StartPoint.Y) + 1;
-        TotalCellsNeeded += MinPathLength;
-    }
-    
-    // Don't use more than 80% of grid to avoid overcrowding
-    int32 TotalAvailableCells = GridWidth * GridHeight;
-    if (TotalCellsNeeded > TotalAvailableCells * 0.8f)
-    {
-        return false;
-    }
-    
-    return true;
+    // Same clamping as NativeConstruct, so settings taken before construction match the ones used after it
+    FFlowPuzzleSettings Settings;
+    Settings.Width = FMath::Max(1, GridWidth);
+    Settings.Height = FMath::Max(1, GridHeight);
+    Settings.NumWirePairs = FMath::Max(1, NumberOfWirePairs);
+    Settings.MinimumPointDistance = MinimumPointDistance;
+    return Settings;
 }
 
-bool UElectricCabinetWidget::HasPathBetweenPoints(FIntPoint Start, FIntPoint End, const TArray<FIntPoint>& BlockedPositions)
+int32 UElectricCabinetWidget::GetNextPuzzleSeed() const
 {
-    // Validate input
-    if (Start.X < 0 || Start.X >= GridWidth || Start.Y < 0 || Start.Y >= GridHeight ||
-        End.X < 0 || End.X >= GridWidth || End.Y < 0 || End.Y >= GridHeight)
-    {
-        return false;
-    }
-    
-    // Use Breadth-First Search (BFS)
-    TArray<FIntPoint> Queue;
-    TSet<FIntPoint> Visited;
-    
-    Queue.Add(Start);
-    Visited.Add(Start);
-    
-    // Four movement directions
-    TArray<FIntPoint> Directions = {
-        FIntPoint(0, 1),   // Down
-        FIntPoint(0, -1),  // Up
-        FIntPoint(1, 0),   // Right
-        FIntPoint(-1, 0),  // Left
-    };
-    
-    // BFS main loop
-    while (Queue.Num() > 0)
-    {
-        FIntPoint Current = Queue[0];
-        Queue.RemoveAt(0);
-
-        // Check if reached destination
-        if (Current == End)
-        {
-            return true;
-        }
-        
-        // Explore all neighboring cells
-        for (const FIntPoint& Dir : Directions)
-        {
-            FIntPoint Next = Current + Dir;
-            
-            // Check bounds
-            if (Next.X < 0 || Next.X >= GridWidth || Next.Y < 0 || Next.Y >= GridHeight)
-            {
-                continue;
-            }
-            
-            // Check if already visited
-            if (Visited.Contains(Next))
-            {
-                continue;
-            }
-            
-            // Check if blocked (allow going through if it's the destination)
-            if (Next != End && BlockedPositions.Contains(Next))
-            {
-                continue;
-            }
-            
-            // Add to exploration queue
-            Queue.Add(Next);
-            Visited.Add(Next);
-        }
-    }
-    
-    // No path found
-    return false;
+    return PuzzleSeed != 0 ? PuzzleSeed : FMath::Rand();
 }
 
-bool UElectricCabinetWidget::IsPositionValid(FIntPoint Position, const TArray<FIntPoint>& UsedPositions)
+void UElectricCabinetWidget::PrewarmPuzzle()
 {
-    // Check if within grid bounds
-    if (Position.X < 0 || Position.X >= GridWidth || Position.Y < 0 || Position.Y >= GridHeight)
-    {
-        return false;
-    }
-    
-    // Check if position is already used or too close to another point
-    for (const FIntPoint& Used : UsedPositions)
+    // Already showing a puzzle, or one is already being generated
+    if (IsInViewport() || PuzzleGenerator.IsPending())
     {
-        // Exact same position
-        if (Used == Position)
-        {
-            return false;
-        }
-        
-        // Too close to existing point
-        float Distance = GetDistanceBetweenPoints(Position, Used);
-        if (Distance < MinimumPointDistance)
-        {
-            return false;
-        }
+        return;
     }
     
-    return true;
+    PuzzleGenerator.Start(GetPuzzleSettings(), GetNextPuzzleSeed());
 }
 
-float UElectricCabinetWidget::GetDistanceBetweenPoints(FIntPoint A, FIntPoint B)
+void UElectricCabinetWidget::CancelPuzzlePrewarm()
 {
-    // Calculate Euclidean distance
-    const float dx = static_cast<float>(A.X - B.X);
-    const float dy = static_cast<float>(A.Y - B.Y);
-    return FMath::Sqrt(FMath::Square(dx) + FMath::Square(dy));
+    PuzzleGenerator.Cancel();
 }
 
 FString UElectricCabinetWidget::GetColorName(EWireColor Color)
@@ -679,10 +164,14 @@ void UElectricCabinetWidget::CreateGridUI()
     GridPanel->ClearChildren();
     CellBorders.Empty();
     
-    // Create border widget for each cell
-    for (int32 Y = 0; Y < GridHeight; Y++)
+    // Whole grid is drawn below
+    Puzzle.ConsumeChangedCells();
+    
+    // Create border widget for each cell (same Y * Width + X order as the puzzle grid)
+    const FFlowPuzzleGrid& Grid = Puzzle.GetGrid();
+    for (int32 Y = 0; Y < Grid.GetHeight(); Y++)
     {
-        for (int32 X = 0; X < GridWidth; X++)
+        for (int32 X = 0; X < Grid.GetWidth(); X++)
         {
             UBorder* CellBorder = NewObject<UBorder>(this);
             if (!CellBorder)
@@ -703,11 +192,7 @@ void UElectricCabinetWidget::CreateGridUI()
             CellBorders.Add(CellBorder);
             
             // Update visual
-            int32 Index = GetCellIndex(FIntPoint(X, Y));
-            if (Index >= 0)
-            {
-                UpdateCellVisual(Index);
-            }
+            UpdateCellVisual(Grid.GetCellIndex(FIntPoint(X, Y)));
         }
     }
 }
@@ -715,12 +200,13 @@ void UElectricCabinetWidget::CreateGridUI()
 void UElectricCabinetWidget::UpdateCellVisual(int32 CellIndex)
 {
     // Validate indices
-    if (!CellBorders.IsValidIndex(CellIndex) || !GridCells.IsValidIndex(CellIndex))
+    TConstArrayView<FGridCell> Cells = Puzzle.GetGrid().GetCells();
+    if (!CellBorders.IsValidIndex(CellIndex) || !Cells.IsValidIndex(CellIndex))
     {
         return;
     }
     
-    const FGridCell& Cell = GridCells[CellIndex];
+    const FGridCell& Cell = Cells[CellIndex];
     UBorder* Border = CellBorders[CellIndex];
     
     if (!Border)
@@ -777,7 +263,12 @@ FReply UElectricCabinetWidget::NativeOnMouseButtonDown(const FGeometry& InGeomet
             return FReply::Handled();
         }
         
-        StartDrag(GridPos);
+        // Can start dragging from either endpoint, or from an existing path to modify it
+        if (Puzzle.BeginDrag(GridPos))
+        {
+            UpdateChangedCells();
+            UpdateProgressDisplay();
+        }
         
         return FReply::Handled().CaptureMouse(this->TakeWidget());
     }
@@ -787,7 +278,7 @@ FReply UElectricCabinetWidget::NativeOnMouseButtonDown(const FGeometry& InGeomet
 
 FReply UElectricCabinetWidget::NativeOnMouseButtonUp(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent)
 {
-    if (InMouseEvent.GetEffectingButton() == EKeys::LeftMouseButton && bIsDragging)
+    if (InMouseEvent.GetEffectingButton() == EKeys::LeftMouseButton && Puzzle.IsDragging())
     {
         EndDrag();
         return FReply::Handled().ReleaseMouseCapture();
@@ -798,7 +289,7 @@ FReply UElectricCabinetWidget::NativeOnMouseButtonUp(const FGeometry& InGeometry
 
 FReply UElectricCabinetWidget::NativeOnMouseMove(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent)
 {
-    if (bIsDragging)
+    if (Puzzle.IsDragging())
     {
         FIntPoint GridPos = ScreenToGridPosition(InGeometry, InMouseEvent.GetScreenSpacePosition());
         
@@ -815,314 +306,48 @@ FReply UElectricCabinetWidget::NativeOnMouseMove(const FGeometry& InGeometry, co
     return Super::NativeOnMouseMove(InGeometry, InMouseEvent);
 }
 
-void UElectricCabinetWidget::StartDrag(FIntPoint CellPosition)
-{
-    FGridCell* Cell = GetCellAt(CellPosition);
-    if (!Cell)
-    {
-        return;
-    }
-    
-    // Can start dragging from BOTH start point AND end point
-    if (Cell->CellType == ECellType::StartPoint || Cell->CellType == ECellType::EndPoint)
-    {
-        bIsDragging = true;
-        CurrentDragColor = Cell->WireColor;
-        CurrentPathID++;
-        LastCellPosition = CellPosition;
-        
-        // Clear any existing path for this color
-        ClearPath(CurrentDragColor);
-        
-        // Initialize new path
-        for (FWirePair& Wire : WirePairs)
-        {
-            if (Wire.Color == CurrentDragColor)
-            {
-                Wire.CurrentPath.Empty();
-                Wire.CurrentPath.Add(CellPosition);
-                Wire.bIsComplete = false;
-                break;
-            }
-        }
-    }
-    // Can also start from existing path to modify it
-    else if (Cell->CellType == ECellType::Path)
-    {
-        for (FWirePair& Wire : WirePairs)
-        {
-            if (Wire.Color == Cell->WireColor)
-            {
-                int32 CellIndexInPath = Wire.CurrentPath.Find(CellPosition);
-                if (CellIndexInPath != INDEX_NONE)
-                {
-                    bIsDragging = true;
-                    CurrentDragColor = Cell->WireColor;
-                    LastCellPosition = CellPosition;
-                }
-                break;
-            }
-        }
-    }
-}
-
 void UElectricCabinetWidget::UpdateDrag(FIntPoint CellPosition)
 {
-    // Ignore if not dragging or position unchanged
-    if (!bIsDragging || CellPosition == LastCellPosition)
-        return;
-    
-    // Calculate movement delta
-    int32 DeltaX = FMath::Abs(CellPosition.X - LastCellPosition.X);
-    int32 DeltaY = FMath::Abs(CellPosition.Y - LastCellPosition.Y);
-    
-    // Only allow adjacent cell movement (no diagonal)
-    if ((DeltaX == 1 && DeltaY == 0) || (DeltaX == 0 && DeltaY == 1))
+    switch (Puzzle.UpdateDrag(CellPosition))
     {
-        FGridCell* Cell = GetCellAt(CellPosition);
-        
-        if (!Cell)
+        case EFlowPuzzleMove::Ignored:
             return;
         
-        // Find current wire
-        FWirePair* CurrentWire = nullptr;
-        for (FWirePair& Wire : WirePairs)
-        {
-            if (Wire.Color == CurrentDragColor)
-            {
-                CurrentWire = &Wire;
-                break;
-            }
-        }
-        
-        if (!CurrentWire)
-        {
-            return;
-        }
-
-        // Handle backtracking on existing path
-        if (Cell->CellType == ECellType::Path && Cell->WireColor == CurrentDragColor)
-        {
-            int32 CellIndexInPath = CurrentWire->CurrentPath.Find(CellPosition);
-
-            if (CellIndexInPath != INDEX_NONE && CellIndexInPath < CurrentWire->CurrentPath.Num() - 1)
+        case EFlowPuzzleMove::Connected:
+            UpdateChangedCells();
+            UpdateProgressDisplay();
+            
+            // Check if puzzle complete
+            if (Puzzle.IsComplete())
             {
-                int32 NumToRemove = CurrentWire->CurrentPath.Num() - CellIndexInPath - 1;
-                
-                for (int32 i = 0; i < NumToRemove; i++)
-                {
-                    FIntPoint PosToRemove = CurrentWire->CurrentPath.Last();
-                    FGridCell* CellToRemove = GetCellAt(PosToRemove);
-
-                    if (CellToRemove && CellToRemove->CellType == ECellType::Path)
-                    {
-                        CellToRemove->CellType = ECellType::Empty;
-                        CellToRemove->WireColor = EWireColor::None;
-                        CellToRemove->PathID = -1;
-                        
-                        int32 Index = GetCellIndex(PosToRemove);
-                        UpdateCellVisual(Index);
-                    }
-                    
-                    CurrentWire->CurrentPath.RemoveAt(CurrentWire->CurrentPath.Num() - 1);
-                }
-                
-                CurrentWire->bIsComplete = false;
-                LastCellPosition = CellPosition;
-                UpdateProgressDisplay();
-                return;
+                OnPuzzleCompleted.Broadcast();
             }
-        }
-        
-        // Check if blocked by another wire's path
-        if (IsCellBlockedByOtherPath(CellPosition, CurrentDragColor))
-        {
-            AutoClearCurrentPath();
             return;
-        }
         
-        // Check if trying to reach wrong color endpoint OR startpoint
-        if ((Cell->CellType == ECellType::EndPoint || Cell->CellType == ECellType::StartPoint) 
-            && Cell->WireColor != CurrentDragColor)
-        {
-            AutoClearCurrentPath();
+        default:
+            // Extended, backtracked, or cleared after touching another wire
+            UpdateChangedCells();
+            UpdateProgressDisplay();
             return;
-        }
-        
-        // Try to place path
-        if (CanPlacePath(CellPosition, CurrentDragColor))
-        {
-            // Successfully reached correct endpoint (can be either StartPoint or EndPoint)
-            if ((Cell->CellType == ECellType::EndPoint || Cell->CellType == ECellType::StartPoint) 
-                && Cell->WireColor == CurrentDragColor)
-            {
-                // Make sure we have at least moved from the starting point
-                if (CurrentWire->CurrentPath.Num() > 1)
-                {
-                    CurrentWire->CurrentPath.Add(CellPosition);
-                    CurrentWire->bIsComplete = true;
-                    bIsDragging = false;
-                    
-                    UpdateProgressDisplay();
-                    
-                    // Check if puzzle complete
-                    if (CheckPuzzleComplete())
-                    {
-                        OnPuzzleCompleted.Broadcast();
-                    }
-                }
-            }
-            // Extend path through empty cell
-            else if (Cell->CellType == ECellType::Empty)
-            {
-                Cell->CellType = ECellType::Path;
-                Cell->WireColor = CurrentDragColor;
-                Cell->PathID = CurrentPathID;
-                
-                int32 CellIndex = GetCellIndex(CellPosition);
-                UpdateCellVisual(CellIndex);
-                
-                CurrentWire->CurrentPath.Add(CellPosition);
-                LastCellPosition = CellPosition;
-            }
-        }
     }
 }
 
 void UElectricCabinetWidget::EndDrag()
 {
-    // If dragging was interrupted without completing the path, clear it
-    if (bIsDragging && CurrentDragColor != EWireColor::None)
-    {
-        // Find the wire being dragged
-        FWirePair* CurrentWire = nullptr;
-        for (FWirePair& Wire : WirePairs)
-        {
-            if (Wire.Color == CurrentDragColor)
-            {
-                CurrentWire = &Wire;
-                break;
-            }
-        }
-        
-        // If path is not complete, clear it
-        if (CurrentWire && !CurrentWire->bIsComplete)
-        {
-            ClearPath(CurrentDragColor);
-        }
-    }
-    
-    bIsDragging = false;
-    CurrentDragColor = EWireColor::None;
-}
-
-bool UElectricCabinetWidget::CanPlacePath(FIntPoint Position, EWireColor Color)
-{
-    FGridCell* Cell = GetCellAt(Position);
-    if (!Cell)
-        return false;
-    
-    // Can place on empty cells
-    if (Cell->CellType == ECellType::Empty)
-        return true;
-    
-    // Can place on matching endpoint OR startpoint
-    if ((Cell->CellType == ECellType::EndPoint || Cell->CellType == ECellType::StartPoint) 
-        && Cell->WireColor == Color)
-        return true;
-    
-    return false;
-}
-
-void UElectricCabinetWidget::AutoClearCurrentPath()
-{
-    if (CurrentDragColor == EWireColor::None)
-        return;
-    
-    ClearPath(CurrentDragColor);
-    
-    bIsDragging = false;
-    CurrentDragColor = EWireColor::None;
-    
-    UpdateProgressDisplay();
-}
-
-void UElectricCabinetWidget::ClearPath(EWireColor Color)
-{
-    // Remove all path cells of specified color
-    for (FGridCell& Cell : GridCells)
+    // If dragging was interrupted without completing the path, it is cleared
+    if (Puzzle.EndDrag())
     {
-        if (Cell.CellType == ECellType::Path && Cell.WireColor == Color)
-        {
-            Cell.CellType = ECellType::Empty;
-            Cell.WireColor = EWireColor::None;
-            Cell.PathID = -1;
-            
-            int32 Index = GetCellIndex(Cell.GridPosition);
-            UpdateCellVisual(Index);
-        }
+        UpdateChangedCells();
+        UpdateProgressDisplay();
     }
-    
-    // Clear wire's path array
-    for (FWirePair& Wire : WirePairs)
-    {
-        if (Wire.Color == Color)
-        {
-            Wire.CurrentPath.Empty();
-            Wire.bIsComplete = false;
-            break;
-        }
-    }
-    
-    // Update progress display after clearing
-    UpdateProgressDisplay();
 }
 
-bool UElectricCabinetWidget::IsCellBlockedByOtherPath(FIntPoint Position, EWireColor Color)
+void UElectricCabinetWidget::UpdateChangedCells()
 {
-    FGridCell* Cell = GetCellAt(Position);
-    if (!Cell)
-        return false;
-    
-    // Blocked if it's a different color path
-    if (Cell->CellType == ECellType::Path && Cell->WireColor != Color)
-    {
-        return true;
-    }
-    
-    // Blocked if it's different color start/end point
-    if ((Cell->CellType == ECellType::StartPoint || Cell->CellType == ECellType::EndPoint) 
-        && Cell->WireColor != Color)
+    for (const int32 CellIndex : Puzzle.ConsumeChangedCells())
     {
-        return true;
+        UpdateCellVisual(CellIndex);
     }
-    
-    return false;
-}
-
-bool UElectricCabinetWidget::CheckPuzzleComplete()
-{
-    // Check if all wires are complete
-    for (const FWirePair& Wire : WirePairs)
-    {
-        if (!Wire.bIsComplete)
-            return false;
-    }
-    
-    // if (WirePairs.Num() == 0)
-    //     return false;
-    
-    // Check if ALL cells are filled (no empty cells)
-    // for (const FGridCell& Grid : GridCells)
-    // {
-    //     if (Grid.CellType == ECellType::Empty)
-    //     {
-    //         return false;
-    //     }
-    // }
-    
-    return WirePairs.Num() > 0;
-    // return true;
 }
 
 void UElectricCabinetWidget::UpdateProgressDisplay()
@@ -1132,35 +357,12 @@ void UElectricCabinetWidget::UpdateProgressDisplay()
         return;
     }
     
-    // Count completed wires
-    int32 CompletedCount = 0;
-    for (const FWirePair& Wire : WirePairs)
-    {
-        if (Wire.bIsComplete)
-            CompletedCount++;
-    }
-    
     // Display progress
-    FString ProgressString = FString::Printf(TEXT("Progress: %d / %d"), CompletedCount, WirePairs.Num());
+    const FFlowPuzzleGrid& Grid = Puzzle.GetGrid();
+    FString ProgressString = FString::Printf(TEXT("Progress: %d / %d"), Grid.GetNumCompleteWires(), Grid.Wires.Num());
     ProgressText->SetText(FText::FromString(ProgressString));
 }
 
-FGridCell* UElectricCabinetWidget::GetCellAt(FIntPoint Position)
-{
-    int32* IndexPtr = PositionToIndexMap.Find(Position);
-    if (IndexPtr && GridCells.IsValidIndex(*IndexPtr))
-    {
-        return &GridCells[*IndexPtr];
-    }
-    return nullptr;
-}
-
-int32 UElectricCabinetWidget::GetCellIndex(FIntPoint Position)
-{
-    int32* IndexPtr = PositionToIndexMap.Find(Position);
-    return IndexPtr ? *IndexPtr : -1;
-}
-
 FIntPoint UElectricCabinetWidget::ScreenToGridPosition(const FGeometry& Geometry, const FVector2D& ScreenPosition)
 {
     if (!GridPanel)
@@ -1265,7 +467,7 @@ void UElectricCabinetWidget::OnTimerExpired()
     
     bTimerActive = false;
     bPuzzleFinished = true;
-    bIsDragging = false;
+    EndDrag();
     
     OnPuzzleTimedOut.Broadcast();
 
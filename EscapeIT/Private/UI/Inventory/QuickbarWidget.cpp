@@ -59,31 +59,11 @@ void UQuickbarWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
 {
     Super::NativeTick(MyGeometry, InDeltaTime);
 
-    if (!bIsInitialized || !FlashlightComponent) return;
-
-    if (!FlashlightComponent->IsEquipped()) return;
-    
-    bool bIsLightOn = FlashlightComponent->IsLightOn();
-
-    // Throttle battery checks for performance
-    BatteryCheckTimer += InDeltaTime;
-    
-    float UpdateInterval = bIsLightOn ? 0.05f : BATTERY_CHECK_INTERVAL;
-    
-    if (BatteryCheckTimer >= UpdateInterval)
+    // Battery bar/warning cập nhật theo event (OnBatteryChanged, OnFlashlightToggled...),
+    // tick chỉ còn chạy hiệu ứng pulse khi đang cảnh báo
+    if (bLowBatteryWarningActive)
     {
-        BatteryCheckTimer = 0.0f;
-        
-        if (CachedFlashlightSlot == -1)
-        {
-            CachedFlashlightSlot = FindFlashlightSlot();
-        }
-
-        if (CachedFlashlightSlot != -1)
-        {
-            UpdateBatteryBar();
-            UpdateLowBatteryWarning(InDeltaTime);
-        }
+        UpdateLowBatteryPulse();
     }
 }
 
@@ -348,6 +328,7 @@ void UQuickbarWidget::OnBatteryChanged(float CurrentBattery, float MaxBattery)
     if (FlashlightComponent && FlashlightComponent->IsEquipped()) 
     {
         UpdateBatteryBar();
+        UpdateLowBatteryWarning();
     }
 }
 
@@ -373,6 +354,8 @@ void UQuickbarWidget::OnFlashlightToggled(bool bIsOn)
         UpdateBatteryBar();
         SetBatteryPercentText();
     }
+
+    UpdateLowBatteryWarning();
 }
 
 void UQuickbarWidget::OnFlashlightStateChanged(EFlashlightState NewState)
@@ -447,6 +430,8 @@ void UQuickbarWidget::OnFlashlightStateChanged(EFlashlightState NewState)
         break;
     }
 
+    UpdateLowBatteryWarning();
+
     UE_LOG(LogTemp, Log, TEXT("QuickbarWidget: Flashlight state changed to %d"), (int32)NewState);
 }
 
@@ -737,8 +722,13 @@ void UQuickbarWidget::UpdateBatteryBar()
     SetBatteryPercentText();
 }
 
-void UQuickbarWidget::UpdateLowBatteryWarning(float DeltaTime)
+void UQuickbarWidget::UpdateLowBatteryWarning()
 {
+    if (CachedFlashlightSlot == -1)
+    {
+        CachedFlashlightSlot = FindFlashlightSlot();
+    }
+
     if (!FlashlightComponent || CachedFlashlightSlot == -1)
     {
         if (bLowBatteryWarningActive)
@@ -770,25 +760,12 @@ void UQuickbarWidget::UpdateLowBatteryWarning(float DeltaTime)
     bool bIsLightOn = FlashlightComponent->IsLightOn();
     bool bShouldWarn = (BatteryPercent < LowBatteryThreshold && bIsLightOn);
 
-    UInventorySlotWidget* FlashlightSlot = QuickbarSlots[CachedFlashlightSlot];
-    if (!FlashlightSlot || !FlashlightSlot->SlotBorder)
-    {
-        return;
-    }
-
     if (bShouldWarn)
     {
         if (!bLowBatteryWarningActive)
         {
             ActivateLowBatteryWarning();
         }
-
-        // Pulsing effect
-        float TimeSec = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0f;
-        float PulseValue = FMath::Sin(TimeSec * PulseSpeed) * 0.5f + 0.5f;
-        FLinearColor PulseColor = FMath::Lerp(CriticalBatteryColor, FLinearColor(0.1f, 0.0f, 0.0f, 1.0f), PulseValue);
-        
-        FlashlightSlot->SlotBorder->SetBrushColor(PulseColor);
     }
     else if (bLowBatteryWarningActive)
     {
@@ -797,6 +774,27 @@ void UQuickbarWidget::UpdateLowBatteryWarning(float DeltaTime)
     }
 }
 
+void UQuickbarWidget::UpdateLowBatteryPulse()
+{
+    if (!QuickbarSlots.IsValidIndex(CachedFlashlightSlot))
+    {
+        return;
+    }
+
+    UInventorySlotWidget* FlashlightSlot = QuickbarSlots[CachedFlashlightSlot];
+    if (!FlashlightSlot || !FlashlightSlot->SlotBorder)
+    {
+        return;
+    }
+
+    // Pulsing effect
+    float TimeSec = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0f;
+    float PulseValue = FMath::Sin(TimeSec * PulseSpeed) * 0.5f + 0.5f;
+    FLinearColor PulseColor = FMath::Lerp(CriticalBatteryColor, FLinearColor(0.1f, 0.0f, 0.0f, 1.0f), PulseValue);
+    
+    FlashlightSlot->SlotBorder->SetBrushColor(PulseColor);
+}
+
 void UQuickbarWidget::ActivateLowBatteryWarning()
 {
     bLowBatteryWarningActive = true;
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BehaviorTree/BehaviorTreeTypes.h"
+#include "UObject/ObjectKey.h"
+#include "AIDecisionTrace.generated.h"
+
+class UBTNode;
+class UBehaviorTreeComponent;
+
+enum class EAITraceEventType : uint8
+{
+	NodeActivated,
+	TaskFinished,
+	BlackboardChanged,
+	Stimulus
+};
+
+/**
+ * Một sự kiện quyết định của NPC, 28 byte.
+ * Id trỏ vào bảng chuỗi của trace (node / key / sense), Code và Value tùy theo Type:
+ * - TaskFinished: Code = EBTNodeResult
+ * - BlackboardChanged: Code = giá trị bool, Value = giá trị vector
+ * - Stimulus: Code = 1 nếu cảm nhận thành công, Value = vị trí stimulus
+ */
+struct FAITraceRecord
+{
+	uint32 Frame = 0;
+	float Time = 0.0f;
+	uint16 Agent = 0;
+	EAITraceEventType Type = EAITraceEventType::NodeActivated;
+	uint8 Code = 0;
+	uint32 Id = 0;
+	FVector3f Value = FVector3f::ZeroVector;
+};
+static_assert(sizeof(FAITraceRecord) == 28, "FAITraceRecord được ghi thẳng ra file, giữ layout cố định");
+
+/** Trace đã ghi ra đĩa: bảng chuỗi + bản ghi theo từng agent, cũ -> mới */
+struct ESCAPEIT_API FAIDecisionTraceFile
+{
+	struct FAgent
+	{
+		FString Name;
+		// Tổng số bản ghi từng có; lớn hơn Records.Num() nghĩa là ring buffer đã ghi đè phần đầu
+		uint64 TotalRecorded = 0;
+		TArray<FAITraceRecord> Records;
+	};
+
+	uint32 Seed = 0;
+	FString MapName;
+	TArray<FString> Strings;
+	TArray<FAgent> Agents;
+
+	bool Save(const FString& Path) const;
+	bool Load(const FString& Path);
+
+	const FString& GetString(uint32 Id) const;
+	FString DescribeRecord(const FAITraceRecord& Record) const;
+};
+
+/** Chi phí của recorder, để so trong benchmark */
+struct FAIDecisionTraceStats
+{
+	int64 NumRecords = 0;
+	double RecordSeconds = 0.0;
+};
+
+/**
+ * Ghi lại quyết định của NPC (node BT được kích hoạt, kết quả task, thay đổi blackboard, stimulus)
+ * vào ring buffer nhị phân theo từng agent. Chỉ ghi khi ai.Trace.Enabled = 1 hoặc có -AITrace.
+ *
+ * Ghi ra đĩa khi cần: ai.Trace.Flush [Path]. So hai trace cùng seed (-AITraceSeed=N):
+ *   UnrealEditor-Cmd EscapeIT.uproject -run=AITraceDiff -A=<trace> -B=<trace>
+ */
+UCLASS()
+class ESCAPEIT_API UAIDecisionTraceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UAIDecisionTraceSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Kiểm tra rẻ trước khi gọi Record* (không tra subsystem) */
+	static bool IsEnabled();
+
+	// ========================== RECORD ==========================
+	void RecordNodeActivated(const AActor* Agent, const UBTNode* Node);
+	void RecordTaskFinished(const AActor* Agent, const UBTNode* Node, EBTNodeResult::Type Result);
+	void RecordBlackboardChange(const AActor* Agent, FName Key, bool bValue, const FVector& Value);
+	void RecordStimulus(const AActor* Agent, FName Sense, bool bSensed, const FVector& Location);
+
+	// ========================== OUTPUT ==========================
+	/** Ghi toàn bộ ring buffer ra file. Path rỗng -> Saved/AITraces/<map>_<thời gian>.aitrace */
+	bool Flush(FString Path = FString());
+	void Reset();
+
+	const FAIDecisionTraceStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = FAIDecisionTraceStats(); }
+
+	/** Helper cho task BT: ghi kết quả nếu đang bật trace */
+	static void TraceTaskFinished(UBehaviorTreeComponent& OwnerComp, const UBTNode* Node, EBTNodeResult::Type Result);
+
+private:
+	struct FAgentTrace
+	{
+		FString Name;
+		uint64 TotalRecorded = 0;
+		int32 Capacity = 0;
+		int32 Head = 0;
+		TArray<FAITraceRecord> Ring;
+	};
+
+	FAITraceRecord& AddRecord(const AActor* Agent, EAITraceEventType Type);
+	uint32 InternString(const FString& String);
+	uint32 InternName(FName Name);
+	uint32 InternNode(const UBTNode* Node);
+
+	TArray<FAgentTrace> Agents;
+	TMap<TObjectKey<AActor>, uint16> AgentIndices;
+
+	TArray<FString> Strings;
+	TMap<FString, uint32> StringIds;
+	TMap<FName, uint32> NameIds;
+	TMap<FObjectKey, uint32> NodeIds;
+
+	uint32 Seed = 0;
+	uint64 StartFrame = 0;
+	FAIDecisionTraceStats Stats;
+};
@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "AIDirectorSubsystem.generated.h"
+
+/** Các hành vi đắt/kịch tính cần xin token từ director */
+UENUM(BlueprintType)
+enum class EAIDirectorToken : uint8
+{
+	Chase         UMETA(DisplayName = "Chase"),
+	Investigate   UMETA(DisplayName = "Investigate"),
+	JumpScare     UMETA(DisplayName = "Jump Scare"),
+	DoorBreach    UMETA(DisplayName = "Door Breach"),
+
+	Count         UMETA(Hidden)
+};
+
+/** Số token của một loại hành vi và cách nó co lại theo sanity / scare gần đây */
+USTRUCT(BlueprintType)
+struct FAIDirectorTokenSettings
+{
+	GENERATED_BODY()
+
+	// Số token khi player còn đủ sanity và chưa bị scare gần đây
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Director", meta = (ClampMin = "0"))
+	int32 MaxTokens = 1;
+
+	// Không bao giờ xuống dưới số này
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Director", meta = (ClampMin = "0"))
+	int32 MinTokens = 0;
+
+	// Hệ số khi sanity = 0, nội suy tuyến tính tới 1 khi sanity đầy (sanity thấp -> giảm áp lực)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Director", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float ScaleAtZeroSanity = 1.0f;
+
+	// Mỗi scare trong ScareHistoryWindow trừ bớt chừng này khỏi hệ số (chỉ chặn cấp mới, không thu hồi)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Director", meta = (ClampMin = "0.0"))
+	float ReductionPerRecentScare = 0.0f;
+
+	// Sau một scare, không cấp mới loại token này trong khoảng này (giây); holder hiện tại giữ tới khi release
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Director", meta = (ClampMin = "0.0"))
+	float CooldownAfterScare = 0.0f;
+};
+
+/**
+ * Pool token cho một loại hành vi. Không phụ thuộc world -> kiểm tra được độc lập (ai.Director.Validate, automation test EscapeIT.AI.Director).
+ * Holder có priority cao hơn có thể lấy token của holder thấp nhất khi pool đầy.
+ * Capacity thu hồi token thừa; AcquireLimit chỉ chặn cấp/giành mới (pacing sau scare không cắt ngang holder đang chạy).
+ */
+struct ESCAPEIT_API FAIDirectorTokenPool
+{
+	/** true nếu Holder đang giữ hoặc vừa được cấp token. OutRevoked = holder bị lấy mất token (nếu có) */
+	bool TryAcquire(FObjectKey Holder, float Priority, float PreemptMargin, FObjectKey* OutRevoked = nullptr);
+	bool Release(FObjectKey Holder);
+	bool Contains(FObjectKey Holder) const { return IndexOf(Holder) != INDEX_NONE; }
+
+	/** Đổi capacity; thu hồi token của holder priority thấp nhất nếu đang vượt */
+	void SetCapacity(int32 NewCapacity, TArray<FObjectKey>* OutRevoked = nullptr);
+
+	/** Chỉ cấp mới khi Num() < min(Capacity, NewLimit); không thu hồi holder hiện tại */
+	void SetAcquireLimit(int32 NewLimit) { AcquireLimit = FMath::Max(0, NewLimit); }
+
+	int32 GetCapacity() const { return Capacity; }
+	int32 GetAcquireLimit() const { return FMath::Min(Capacity, AcquireLimit); }
+	int32 Num() const { return Holders.Num(); }
+
+	void Reset() { Holders.Reset(); }
+
+	/** Bỏ holder đã bị destroy mà không release */
+	void RemoveStaleHolders();
+
+	/** Số token theo settings, sanity (0..1) và lịch sử scare. Không có scare -> capacity thu hồi; có -> giới hạn cấp mới */
+	static int32 ComputeCapacity(const FAIDirectorTokenSettings& Settings, float SanityPercent, int32 NumRecentScares, double TimeSinceLastScare);
+
+private:
+	int32 IndexOf(FObjectKey Holder) const;
+	int32 FindLowestPriority() const;
+
+	struct FHolder
+	{
+		FObjectKey Key;
+		float Priority = 0.0f;
+	};
+
+	// Vài phần tử -> mảng + tìm tuyến tính
+	TArray<FHolder, TInlineAllocator<4>> Holders;
+	int32 Capacity = 0;
+	int32 AcquireLimit = MAX_int32;
+};
+
+/**
+ * Director điều phối nhịp độ AI.
+ * Hành vi đắt hoặc kịch tính (đuổi, điều tra, jumpscare, phá cửa) phải xin token; số token co lại khi
+ * sanity của player thấp hoặc vừa bị scare. NPC không có token dùng hành vi rẻ thay thế
+ * (đứng nhìn thay vì đuổi, quay về phía tiếng động thay vì đi tới, không jumpscare).
+ *
+ * Task/service giữ token trong lúc chạy và kiểm tra HasToken mỗi tick: token có thể bị thu hồi khi
+ * capacity giảm hoặc khi NPC có priority cao hơn (gần player hơn) xin.
+ */
+UCLASS()
+class ESCAPEIT_API UAIDirectorSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UAIDirectorSubsystem();
+
+	virtual void Deinitialize() override;
+
+	static UAIDirectorSubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== TOKENS ==========================
+	/** Xin token cho Holder (thường là AI controller). Priority cao hơn thắng khi pool đầy */
+	bool TryAcquireToken(EAIDirectorToken Token, const UObject* Holder, float Priority = 0.0f);
+	void ReleaseToken(EAIDirectorToken Token, const UObject* Holder);
+
+	/** Gọi khi controller unpossess / bị destroy */
+	void ReleaseAllTokens(const UObject* Holder);
+
+	bool HasToken(EAIDirectorToken Token, const UObject* Holder);
+
+	int32 GetCapacity(EAIDirectorToken Token);
+	int32 GetNumHeld(EAIDirectorToken Token) const { return Pools[static_cast<int32>(Token)].Num(); }
+
+	// ========================== PACING ==========================
+	/** Báo một scare vừa xảy ra (jumpscare của NPC hoặc của level) */
+	void NotifyScare();
+
+	int32 GetNumRecentScares();
+
+	// ========================== SETTINGS ==========================
+	UPROPERTY(EditAnywhere, Category = "AI|Director")
+	FAIDirectorTokenSettings TokenSettings[static_cast<int32>(EAIDirectorToken::Count)];
+
+	// Scare cũ hơn khoảng này không còn tính (giây)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Director", meta = (ClampMin = "0.0"))
+	float ScareHistoryWindow = 60.0f;
+
+	// Priority phải hơn holder thấp nhất chừng này mới giành token, tránh hai NPC giành qua lại
+	// (task đuổi dùng priority = -khoảng cách tới player, nên đơn vị là cm)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Director", meta = (ClampMin = "0.0"))
+	float PreemptMargin = 200.0f;
+
+	// Capacity tính lại tối đa một lần trong khoảng này (giây)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Director", meta = (ClampMin = "0.0"))
+	float RefreshInterval = 0.5f;
+
+private:
+	/** Tính lại capacity từ sanity (thu hồi token thừa) và giới hạn cấp mới từ scare history */
+	void RefreshCapacities(bool bForce = false);
+	float GetPlayerSanityPercent();
+
+	FAIDirectorTokenPool Pools[static_cast<int32>(EAIDirectorToken::Count)];
+
+	TArray<double> ScareTimes;
+	double LastRefreshTime = -1.0;
+};
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Navigation/CrowdFollowingComponent.h"
+#include "AISignificanceSubsystem.generated.h"
+
+class ACharacter;
+
+/** Mức significance của NPC, Critical là cao nhất */
+UENUM(BlueprintType)
+enum class EAISignificance : uint8
+{
+	Critical    UMETA(DisplayName = "Critical"),    // Đang thấy/đuổi/điều tra player
+	High        UMETA(DisplayName = "High"),
+	Medium      UMETA(DisplayName = "Medium"),
+	Low         UMETA(DisplayName = "Low"),
+	Dormant     UMETA(DisplayName = "Dormant"), // Ngủ đông hẳn, xem ANPC::SetDormant
+
+	Count       UMETA(Hidden)
+};
+
+/** Tần suất update áp cho một mức significance */
+USTRUCT(BlueprintType)
+struct FAISignificanceLevelSettings
+{
+	GENERATED_BODY()
+
+	// NPC xa hơn khoảng này thì rơi xuống mức dưới (không dùng cho Critical và Dormant)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance", meta = (ClampMin = "0.0"))
+	float MaxDistance = 0.0f;
+
+	// 0 = tick mỗi frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance", meta = (ClampMin = "0.0"))
+	float BehaviorTreeTickInterval = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance", meta = (ClampMin = "0.0"))
+	float MovementTickInterval = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance", meta = (ClampMin = "0.0"))
+	float AnimationTickInterval = 0.0f;
+
+	// Tắt sight ở mức thấp; hearing luôn bật để NPC vẫn phản ứng với tiếng động
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance")
+	bool bSightEnabled = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance")
+	TEnumAsByte<ECrowdAvoidanceQuality::Type> CrowdAvoidanceQuality = ECrowdAvoidanceQuality::High;
+
+	// Tắt thì NPC chỉ là vật cản trong crowd, tự đi theo path thường (không tốn chi phí avoidance)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance")
+	bool bCrowdSimulationEnabled = true;
+
+	// Lên mức này thì load async montage của NPC (soft ref); ngủ đông thì bỏ giữ
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance")
+	bool bPreloadAnimations = true;
+};
+
+/**
+ * Chia NPC thành các mức significance theo khoảng cách tới player, việc có đang được render hay không
+ * và trạng thái BT (đang đuổi/điều tra -> Critical), rồi giảm tần suất tick BT, perception,
+ * movement, animation và chất lượng crowd avoidance cho các mức thấp.
+ * Lên mức thì áp ngay; xuống mức cần vượt ngưỡng thêm HysteresisDistance và ở mức cũ đủ MinTimeInLevel.
+ * NPC xa hơn MaxDistance của Low và không được render thì ngủ đông (Dormant): BT dừng, perception gỡ đăng ký,
+ * movement/mesh không tick; blackboard giữ nguyên để thức dậy tiếp tục như cũ. Tắt bằng ai.Significance.Dormancy 0.
+ * Tắt bằng ai.Significance.Enabled 0 để so sánh chi phí (stat EscapeIT).
+ */
+UCLASS()
+class ESCAPEIT_API UAISignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UAISignificanceSubsystem();
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UAISignificanceSubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== NPC ==========================
+	void RegisterNPC(ACharacter* NPC);
+	void UnregisterNPC(ACharacter* NPC);
+
+	/** Mức hiện tại của NPC; NPC chưa đăng ký -> Critical */
+	UFUNCTION(BlueprintPure, Category = "AI|Significance")
+	EAISignificance GetSignificance(const ACharacter* NPC) const;
+
+	UFUNCTION(BlueprintPure, Category = "AI|Significance")
+	int32 GetNumInLevel(EAISignificance Level) const;
+
+	// ========================== SETTINGS ==========================
+	// Theo thứ tự EAISignificance
+	UPROPERTY(EditAnywhere, Category = "AI|Significance")
+	FAISignificanceLevelSettings Levels[static_cast<int32>(EAISignificance::Count)];
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance", meta = (ClampMin = "0.0"))
+	float HysteresisDistance = 250.0f;
+
+	// Thời gian tối thiểu ở một mức trước khi được hạ xuống (giây)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance", meta = (ClampMin = "0.0"))
+	float MinTimeInLevel = 1.0f;
+
+	// NPC không được render trong khoảng này bị hạ thêm một mức
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance", meta = (ClampMin = "0.0"))
+	float RenderedTolerance = 0.5f;
+
+	// Chu kỳ đánh giá lại toàn bộ NPC (giây)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Significance", meta = (ClampMin = "0.0"))
+	float EvaluationInterval = 0.2f;
+
+private:
+	struct FSignificanceEntry
+	{
+		TWeakObjectPtr<ACharacter> NPC;
+		EAISignificance Level = EAISignificance::Critical;
+		float TimeInLevel = 0.0f;
+
+		// Chưa áp settings lần nào (controller có thể possess sau BeginPlay)
+		bool bApplied = false;
+	};
+
+	EAISignificance EvaluateLevel(const FSignificanceEntry& Entry, ACharacter* NPC) const;
+	EAISignificance GetDistanceLevel(float Distance, EAISignificance CurrentLevel) const;
+	/** Trả về false nếu NPC chưa có controller (sẽ thử lại ở lần đánh giá sau) */
+	bool ApplyLevel(ACharacter* NPC, EAISignificance Level) const;
+
+	TArray<FSignificanceEntry> Entries;
+	int32 LevelCounts[static_cast<int32>(EAISignificance::Count)] = {};
+	float TimeSinceEvaluation = 0.0f;
+
+	// Trạng thái cvar ở lần đánh giá trước, đổi thì áp lại cho mọi NPC
+	bool bWasEnabled = true;
+};
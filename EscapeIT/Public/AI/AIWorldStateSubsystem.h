@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "AIWorldStateSubsystem.generated.h"
+
+class ACharacter;
+class APawn;
+enum class EMovementState : uint8;
+
+/** Trạng thái người chơi chụp một lần mỗi frame */
+struct FAIPlayerSnapshot
+{
+	bool bValid = false;
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	FVector Forward = FVector::ForwardVector;
+	EMovementState Stance{};
+	bool bIsCrouched = false;
+
+	// Độ ồn hiện tại (loudness của noise gần nhất, giảm dần theo NoiseDecayPerSecond)
+	float NoiseLevel = 0.0f;
+};
+
+/**
+ * Snapshot thế giới dùng chung cho mọi NPC.
+ * Player được lấy một lần mỗi frame, khoảng cách/hướng tới từng NPC đã đăng ký tính theo batch (SoA)
+ * ở lần đọc đầu tiên trong frame. Service/task chỉ đọc giá trị đã tính sẵn.
+ */
+UCLASS()
+class ESCAPEIT_API UAIWorldStateSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	static UAIWorldStateSubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== NPC ==========================
+	void RegisterNPC(APawn* NPC);
+	void UnregisterNPC(APawn* NPC);
+
+	int32 GetNumNPCs() const { return NPCs.Num(); }
+
+	/** NPC đã đăng ký; có thể chứa NPC đã bị destroy nhưng chưa được dọn */
+	TConstArrayView<TWeakObjectPtr<APawn>> GetNPCs() const { return NPCs; }
+
+	// ========================== PLAYER ==========================
+	const FAIPlayerSnapshot& GetPlayerSnapshot();
+	ACharacter* GetPlayer();
+
+	/** Gọi từ AEscapeITCharacter mỗi khi phát ra noise */
+	void NotifyPlayerNoise(float Loudness);
+
+	// ========================== QUERIES ==========================
+	/** Khoảng cách NPC -> player (cm). NPC chưa đăng ký thì tính trực tiếp; không có player -> MAX_flt */
+	float GetDistanceToPlayer(const AActor* NPC);
+
+	/** Góc có dấu (độ) từ hướng nhìn của NPC tới player trên mặt phẳng XY, 0 = ngay phía trước */
+	float GetBearingToPlayer(const AActor* NPC);
+
+	bool IsPlayerWithin(const AActor* NPC, float Radius) { return GetDistanceToPlayer(NPC) <= Radius; }
+
+	// ========================== BENCHMARK ==========================
+	/**
+	 * Đăng ký lần lượt MaxNPCs/8, /4, /2 và MaxNPCs pawn tạm, mỗi cỡ chạy NumFrames frame và in chi phí đọc
+	 * khoảng cách kiểu cũ (mỗi service tự GetPlayerCharacter) so với đọc từ snapshot
+	 */
+	void RunBenchmark(int32 MaxNPCs, int32 NumFrames);
+
+	// ========================== SETTINGS ==========================
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|WorldState", meta = (ClampMin = "0.0"))
+	float NoiseDecayPerSecond = 1.0f;
+
+private:
+	/** Chụp player + tính batch cho mọi NPC, tối đa một lần mỗi frame */
+	void EnsureUpToDate();
+	void RemoveNPCAt(int32 Index);
+
+	FAIPlayerSnapshot PlayerSnapshot;
+	TWeakObjectPtr<ACharacter> Player;
+	uint64 CapturedFrame = MAX_uint64;
+
+	// Noise thô (chưa decay)
+	float LastNoiseLoudness = 0.0f;
+	double LastNoiseTime = -1.0;
+
+	// NPC lưu dạng SoA
+	TArray<TWeakObjectPtr<APawn>> NPCs;
+	TArray<TObjectKey<AActor>> NPCKeys;
+	TArray<FVector> NPCLocations;
+	TArray<FVector> NPCForwards;
+	TArray<float> DistancesToPlayer;
+	TArray<float> BearingsToPlayer;
+	TMap<TObjectKey<AActor>, int32> NPCIndices;
+};
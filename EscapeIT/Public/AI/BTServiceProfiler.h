@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "BTServiceProfiler.generated.h"
+
+class UBTNode;
+
+/** Lý do một service event-driven tính lại (bitmask, một lần chạy có thể có nhiều lý do) */
+enum class EBTServiceTrigger : uint8
+{
+	None           = 0,
+	Activation     = 1 << 0,
+	BlackboardKey  = 1 << 1,
+	PlayerMoved    = 1 << 2,
+	DistanceBand   = 1 << 3,
+	Requested      = 1 << 4,
+	Stale          = 1 << 5
+};
+ENUM_CLASS_FLAGS(EBTServiceTrigger);
+
+/** Thống kê của một service trong một behavior tree, cộng dồn qua mọi NPC chạy tree đó */
+struct FBTServiceProfile
+{
+	FString TreeName;
+	FString ServiceName;
+
+	// Số lần service được tick (kiểm tra trigger), số lần thật sự tính lại, số lần output đổi
+	int64 NumPolls = 0;
+	int64 NumRuns = 0;
+	int64 NumChanges = 0;
+
+	// Số lần chạy theo từng trigger, index = bit của EBTServiceTrigger
+	int64 NumRunsByTrigger[6] = {};
+
+	double RunSeconds = 0.0;
+};
+
+/**
+ * Đếm service event-driven (UBTService_EventDriven) chạy bao nhiêu lần và output đổi bao nhiêu lần,
+ * theo từng tree. Chỉ ghi khi ai.ServiceProfiler.Enabled = 1.
+ *   ai.ServiceProfiler.Dump   log bảng theo tree
+ *   ai.ServiceProfiler.Reset  xóa số liệu
+ */
+UCLASS()
+class ESCAPEIT_API UBTServiceProfilerSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	static UBTServiceProfilerSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Kiểm tra rẻ trước khi gọi Record* (không tra subsystem) */
+	static bool IsEnabled();
+
+	void RecordPoll(const UBTNode* Service);
+	void RecordRun(const UBTNode* Service, EBTServiceTrigger Triggers, bool bOutputChanged, double Seconds);
+
+	TConstArrayView<FBTServiceProfile> GetProfiles() const { return Profiles; }
+
+	void Dump() const;
+	void Reset();
+
+private:
+	FBTServiceProfile& FindOrAddProfile(const UBTNode* Service);
+
+	TArray<FBTServiceProfile> Profiles;
+
+	// Node template của service -> index trong Profiles (template dùng chung cho mọi NPC chạy tree)
+	TMap<FObjectKey, int32> ProfileIndices;
+};
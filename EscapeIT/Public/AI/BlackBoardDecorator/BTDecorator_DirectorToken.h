@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTDecorator.h"
+#include "AI/AIDirectorSubsystem.h"
+#include "BTDecorator_DirectorToken.generated.h"
+
+/**
+ * Chỉ cho nhánh chạy khi NPC xin được token của UAIDirectorSubsystem (vd. phá cửa).
+ * Giữ token tới khi nhánh kết thúc; token bị thu hồi thì abort nhánh để BT rơi về hành vi rẻ hơn.
+ */
+UCLASS()
+class ESCAPEIT_API UBTDecorator_DirectorToken : public UBTDecorator
+{
+	GENERATED_BODY()
+
+public:
+	UBTDecorator_DirectorToken();
+
+	virtual bool CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Director")
+	EAIDirectorToken Token = EAIDirectorToken::DoorBreach;
+
+	// NPC gần player hơn được ưu tiên khi hết token
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Director")
+	bool bPreferCloserToPlayer = true;
+};
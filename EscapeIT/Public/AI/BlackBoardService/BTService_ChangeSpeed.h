@@ -4,9 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "BehaviorTree/Services/BTService_BlackboardBase.h"
+#include "AI/NPC.h"
 #include "BTService_ChangeSpeed.generated.h"
 
-
+/**
+ * Đổi tốc độ NPC khi nhánh BT bắt đầu chạy.
+ * bUseSpeedProfile: dùng profile trên ANPC (tốc độ, gia tốc, crowd separation); tắt thì chỉ ghi Speed như cũ.
+ */
 UCLASS()
 class ESCAPEIT_API UBTService_ChangeSpeed : public UBTService_BlackboardBase
 {
@@ -18,5 +22,11 @@ public:
 
 private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (AllowPrivateAccess = "yes"))
+	bool bUseSpeedProfile = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (AllowPrivateAccess = "yes", EditCondition = "bUseSpeedProfile"))
+	ENPCSpeedProfile SpeedProfile = ENPCSpeedProfile::Chase;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (AllowPrivateAccess = "yes", EditCondition = "!bUseSpeedProfile"))
 	float Speed = 600.f;
 };
@@ -1,8 +1,19 @@
-﻿#include "BehaviorTree/BTService.h"
+﻿#pragma once
+
+#include "AI/BlackBoardService/BTService_EventDriven.h"
 #include "BTService_CheckPlayerDistance.generated.h"
 
+struct FBTCheckPlayerDistanceMemory : FBTEventDrivenServiceMemory
+{
+    // Giá trị đã ghi vào bCanJumpScare, không đọc lại từ blackboard mỗi lần
+    bool bCanJumpScare = false;
+};
+
+// Bật bCanJumpScare khi player trong TriggerDistance và director cấp token JumpScare.
+// Chỉ tính lại khi player đi qua ngưỡng TriggerDistance; trong tầm thì tính lại mỗi lần kiểm tra
+// (chờ token, hoặc xem token còn không vì director có thể thu hồi khi sanity tụt)
 UCLASS()
-class ESCAPEIT_API UBTService_CheckPlayerDistance : public UBTService
+class ESCAPEIT_API UBTService_CheckPlayerDistance : public UBTService_EventDriven
 {
     GENERATED_BODY()
 
@@ -13,5 +24,12 @@ public:
     UPROPERTY(EditAnywhere, Category = "JumpScare")
     float TriggerDistance = 200.0f;
 
-    virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+    virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+    virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTCheckPlayerDistanceMemory); }
+    virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+    virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
+
+protected:
+    virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+    virtual bool Recompute(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 };
\ No newline at end of file
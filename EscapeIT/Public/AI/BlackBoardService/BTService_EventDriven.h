@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTService.h"
+#include "AI/NPCBlackboardSchema.h"
+#include "AI/BTServiceProfiler.h"
+#include "BTService_EventDriven.generated.h"
+
+// Trạng thái trigger của service cho từng NPC; lớp con mở rộng bằng cách kế thừa struct này
+struct FBTEventDrivenServiceMemory
+{
+	// Vị trí player / band khoảng cách ở lần tính lại gần nhất
+	FVector LastPlayerLocation = FVector::ZeroVector;
+	bool bHadPlayer = false;
+	int32 DistanceBand = INDEX_NONE;
+
+	double LastRunTime = 0.0;
+
+	// Mới được kích hoạt -> luôn tính ở lần tick đầu tiên
+	EBTServiceTrigger PendingTriggers = EBTServiceTrigger::Activation;
+};
+
+/**
+ * Service chỉ tính lại khi thứ nó phụ thuộc thật sự đổi, thay vì chạy lại mỗi Interval:
+ * - key blackboard được theo dõi đổi giá trị (observer, tính lại ở tick kế tiếp của tree)
+ * - player đi xa hơn PlayerMoveThreshold kể từ lần tính trước
+ * - khoảng cách NPC -> player chuyển sang band khác trong DistanceBands
+ * Interval chỉ còn là chu kỳ kiểm tra tín hiệu world (so vài số đã có sẵn trong UAIWorldStateSubsystem).
+ * Số lần kiểm tra / tính lại / output đổi được đếm theo tree bởi UBTServiceProfilerSubsystem.
+ */
+UCLASS(Abstract)
+class ESCAPEIT_API UBTService_EventDriven : public UBTService
+{
+	GENERATED_BODY()
+
+public:
+	UBTService_EventDriven();
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTEventDrivenServiceMemory); }
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+	/** Tính lại và ghi blackboard. Trả về true nếu output thật sự đổi (cho profiler) */
+	virtual bool Recompute(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) PURE_VIRTUAL(UBTService_EventDriven::Recompute, return false;);
+
+	/** Tính lại ở lần kiểm tra kế tiếp dù không có trigger (vd. xin token thất bại, cần thử lại) */
+	void RequestRecompute(uint8* NodeMemory) const;
+
+	// Key trong schema NPC mà service phụ thuộc (đặt trong constructor của lớp con)
+	TArray<ENPCBlackboardKey> ObservedSchemaKeys;
+
+	// Key khác cần theo dõi, chọn trong editor
+	UPROPERTY(EditAnywhere, Category = "Service|Triggers")
+	TArray<FBlackboardKeySelector> ObservedKeys;
+
+	UPROPERTY(EditAnywhere, Category = "Service|Triggers")
+	bool bTriggerOnPlayerMove = false;
+
+	UPROPERTY(EditAnywhere, Category = "Service|Triggers", meta = (ClampMin = "0.0", EditCondition = "bTriggerOnPlayerMove"))
+	float PlayerMoveThreshold = 100.0f;
+
+	// Ngưỡng khoảng cách tới player (cm, tăng dần); đi qua một ngưỡng = trigger
+	UPROPERTY(EditAnywhere, Category = "Service|Triggers")
+	TArray<float> DistanceBands;
+
+	// Tính lại ít nhất mỗi khoảng này dù không có trigger (giây, 0 = không bao giờ)
+	UPROPERTY(EditAnywhere, Category = "Service|Triggers", meta = (ClampMin = "0.0"))
+	float MaxStaleTime = 0.0f;
+
+private:
+	EBlackboardNotificationResult OnObservedKeyChanged(const UBlackboardComponent& BlackboardComp, FBlackboard::FKey ChangedKeyID);
+
+	/** Key ID đã resolve cho blackboard của NPC (schema + ObservedKeys) */
+	void GatherObservedKeyIds(const UBlackboardComponent& BlackboardComp, TArray<FBlackboard::FKey, TInlineAllocator<8>>& OutKeyIds) const;
+
+	/** Index band của Distance trong DistanceBands (0 = gần hơn ngưỡng đầu tiên) */
+	int32 GetDistanceBand(float Distance) const;
+};
@@ -3,20 +3,27 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "BehaviorTree/Services/BTService_BlackboardBase.h"
+#include "AI/BlackBoardService/BTService_EventDriven.h"
 #include "BTService_UpdatePlayerLocation.generated.h"
 
 /**
- * 
+ * Ghi vị trí player vào key đã chọn khi NPC thấy player.
+ * Chỉ ghi lại khi CanSeePlayer đổi hoặc player đi xa hơn PlayerMoveThreshold.
  */
 UCLASS()
-class ESCAPEIT_API UBTService_UpdatePlayerLocation : public UBTService_BlackboardBase
+class ESCAPEIT_API UBTService_UpdatePlayerLocation : public UBTService_EventDriven
 {
 	GENERATED_BODY()
 	
 public:
 		UBTService_UpdatePlayerLocation();
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
 	
 protected:
-	virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+	virtual bool Recompute(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	// Giữ tên của UBTService_BlackboardBase để BT asset cũ không mất key đã chọn
+	UPROPERTY(EditAnywhere, Category = "Blackboard")
+	FBlackboardKeySelector BlackboardKey;
 };
@@ -3,8 +3,20 @@
 
 #include "CoreMinimal.h"
 #include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "AI/ChaseMovementSubsystem.h"
 #include "BTTask_ChasePlayer.generated.h"
 
+struct FBTChasePlayerMemory
+{
+	// Đang giữ token Chase của director (false = chỉ đứng nhìn)
+	bool bHasChaseToken = false;
+};
+
+/**
+ * Đuổi player qua UChaseMovementSubsystem.
+ * Chỉ NPC giữ token Chase của UAIDirectorSubsystem mới thật sự đuổi; NPC còn lại đứng nhìn player và
+ * xin lại token mỗi tick (NPC gần hơn được ưu tiên).
+ */
 UCLASS()
 class ESCAPEIT_API UBTTask_ChasePlayer : public UBTTask_BlackboardBase
 {
@@ -16,8 +28,23 @@ public:
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+	virtual void OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult) override;
+
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTChasePlayerMemory); }
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
 
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
 	float AcceptanceRadius = 100.f;
+
+	// Ngưỡng repath; AcceptanceRadius ở trên ghi đè giá trị trong này
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
+	FChaseRepathSettings RepathSettings;
+
+private:
+	void UpdateChaseTarget(UBehaviorTreeComponent& OwnerComp, UChaseMovementSubsystem& ChaseMovement) const;
+
+	/** Xin/giữ token Chase; chuyển giữa đuổi thật và đứng nhìn khi token đổi chủ */
+	bool UpdateChaseToken(UBehaviorTreeComponent& OwnerComp, FBTChasePlayerMemory& Memory, UChaseMovementSubsystem& ChaseMovement) const;
 };
\ No newline at end of file
@@ -4,10 +4,17 @@
 
 #include "CoreMinimal.h"
 #include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "AI/NavQuerySubsystem.h"
 #include "BTTask_FindRandomLocation.generated.h"
 
+// Batch nav query đang chờ của từng NPC
+struct FBTFindRandomLocationMemory
+{
+	uint32 BatchId = 0;
+};
+
 /**
- * 
+ * Tìm điểm ngẫu nhiên trên navmesh quanh NPC qua UNavQuerySubsystem (latent, không query đồng bộ).
  */
 UCLASS()
 class ESCAPEIT_API UBTTask_FindRandomLocation : public UBTTask_BlackboardBase
@@ -17,8 +24,15 @@ class ESCAPEIT_API UBTTask_FindRandomLocation : public UBTTask_BlackboardBase
 public:
 	explicit UBTTask_FindRandomLocation(FObjectInitializer const& ObjectInitializer);
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTFindRandomLocationMemory); }
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
 
 private:
+	void OnQueryComplete(TConstArrayView<FNavQueryResult> Results, TWeakObjectPtr<UBehaviorTreeComponent> WeakOwnerComp);
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (AllowPrivateAccess = "true"))
 	float SearchRadius = 1500.f;
 };
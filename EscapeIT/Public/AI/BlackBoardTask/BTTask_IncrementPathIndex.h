@@ -6,6 +6,12 @@
 #include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
 #include "BTTask_IncrementPathIndex.generated.h"
 
+// Chiều đi của từng NPC; giữ trong NodeMemory để các NPC dùng chung tree không đổi chiều của nhau
+struct FBTIncrementPathIndexMemory
+{
+	bool bReverse = false;
+};
+
 /**
  * 
  */
@@ -18,9 +24,14 @@ public:
 	explicit UBTTask_IncrementPathIndex(FObjectInitializer const& ObjectInitializer);
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTIncrementPathIndexMemory); }
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
+	virtual void DescribeRuntimeValues(const UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTDescriptionVerbosity::Type Verbosity, TArray<FString>& Values) const override;
+
+	bool IsBiDirectional() const { return bBiDirectional; }
+
 private:
-	enum class EDirectionType { Forward, Reverse };
-	EDirectionType Direction = EDirectionType::Forward;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (AllowPrivateAccess = "true"))
 	bool bBiDirectional = false;
@@ -6,8 +6,11 @@
 #include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
 #include "BTTask_InvestigateSound.generated.h"
 
+class AAIController;
+
 /**
- * 
+ * Đi tới vị trí tiếng động. Cần token Investigate của UAIDirectorSubsystem; không có token (hoặc bị thu hồi)
+ * thì chỉ quay về phía tiếng động rồi Succeeded để BT chạy tiếp.
  */
 UCLASS()
 class ESCAPEIT_API UBTTask_InvestigateSound : public UBTTask_BlackboardBase
@@ -18,10 +21,14 @@ public:
 	UBTTask_InvestigateSound(FObjectInitializer const& ObjectInitializer);
 	
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
 	
 	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category="AI")
 	float AcceptanceRadius  = 100.0f;
 	
 private:
+	/** Hành vi rẻ khi không có token: quay mặt về phía tiếng động tại chỗ */
+	static void FaceLocation(AAIController& AICon, const FVector& Location);
+
 	virtual void OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult) override;
 };
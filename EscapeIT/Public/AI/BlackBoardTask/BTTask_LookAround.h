@@ -6,6 +6,12 @@
 #include "BehaviorTree/BTTaskNode.h"
 #include "BTTask_LookAround.generated.h"
 
+// State riêng cho từng NPC (node task được dùng chung giữa mọi instance của tree)
+struct FBTLookAroundMemory
+{
+	float ElapsedTime = 0.0f;
+};
+
 UCLASS()
 class ESCAPEIT_API UBTTask_LookAround : public UBTTaskNode
 {
@@ -16,10 +22,12 @@ public:
 
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTLookAroundMemory); }
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
+	virtual void DescribeRuntimeValues(const UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTDescriptionVerbosity::Type Verbosity, TArray<FString>& Values) const override;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
 	float LookAroundDuration = 3.0f;
-
-private:
-	float ElapsedTime = 0.0f;
 };
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "AITypes.h"
+#include "BTTask_MoveAlongPatrolRoute.generated.h"
+
+// State riêng cho từng NPC
+struct FBTMoveAlongPatrolRouteMemory
+{
+	// Patrol point vừa đi tới (INDEX_NONE = chưa đi lần nào)
+	int32 LastIndex = INDEX_NONE;
+	FAIRequestID MoveId;
+};
+
+/**
+ * Đi tới patrol point ở key đã chọn (index).
+ * Nếu NPC đang đứng ở point kề trước đó thì đi theo path đã bake trong UPatrolRouteSubsystem,
+ * không search path; lần đầu hoặc khi lệch route thì MoveTo như bình thường.
+ * Thay cho cặp Find Path Point + Move To trong patrol tree.
+ */
+UCLASS()
+class ESCAPEIT_API UBTTask_MoveAlongPatrolRoute : public UBTTask_BlackboardBase
+{
+	GENERATED_BODY()
+
+public:
+	explicit UBTTask_MoveAlongPatrolRoute(FObjectInitializer const& ObjectInitializer);
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTMoveAlongPatrolRouteMemory); }
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
+	virtual void DescribeRuntimeValues(const UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTDescriptionVerbosity::Type Verbosity, TArray<FString>& Values) const override;
+
+protected:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
+	float AcceptanceRadius = 50.0f;
+
+	// NPC cách đầu segment xa hơn khoảng này thì coi như lệch route và search path bình thường
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (ClampMin = "0.0"))
+	float SegmentStartTolerance = 150.0f;
+};
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/Tasks/BTTask_BlackboardBase.h"
+#include "AITypes.h"
+#include "BTTask_TacticalSearch.generated.h"
+
+// Kế hoạch lục soát riêng cho từng NPC
+struct FBTTacticalSearchMemory
+{
+	static constexpr int32 MaxPoints = 8;
+
+	FVector Points[MaxPoints];
+	int32 NumPoints = 0;
+	int32 CurrentPoint = 0;
+	FAIRequestID MoveId;
+};
+
+/**
+ * Lục soát sau khi mất dấu player: lấy kế hoạch từ UTacticalSearchSubsystem (tactical graph đã bake)
+ * quanh vị trí ở key đã chọn rồi lần lượt đi tới từng điểm.
+ * Fail ngay nếu level chưa bake graph, để tree rơi về nhánh Investigate Sound / Find Random Location cũ.
+ */
+UCLASS()
+class ESCAPEIT_API UBTTask_TacticalSearch : public UBTTask_BlackboardBase
+{
+	GENERATED_BODY()
+
+public:
+	explicit UBTTask_TacticalSearch(FObjectInitializer const& ObjectInitializer);
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTTacticalSearchMemory); }
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
+	virtual void DescribeRuntimeValues(const UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTDescriptionVerbosity::Type Verbosity, TArray<FString>& Values) const override;
+
+protected:
+	virtual void OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 NumSearchPoints = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI")
+	float AcceptanceRadius = 75.0f;
+
+private:
+	/** Đi tới điểm CurrentPoint trở đi; bỏ qua điểm không tới được. False nếu đã hết điểm */
+	bool MoveToNextPoint(AAIController& AICon, FBTTacticalSearchMemory& Memory) const;
+};
@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "AITypes.h"
+#include "ChaseMovementSubsystem.generated.h"
+
+class AAIController;
+struct FPathFollowingResult;
+
+/** Ngưỡng repath cho một NPC đang đuổi */
+USTRUCT(BlueprintType)
+struct FChaseRepathSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Chase")
+	float AcceptanceRadius = 100.0f;
+
+	// Target phải lệch khỏi goal của path hiện tại ít nhất chừng này mới tìm path mới
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Chase", meta = (ClampMin = "0.0"))
+	float RepathDistance = 150.0f;
+
+	// Không repath nhanh hơn khoảng này (giây)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Chase", meta = (ClampMin = "0.0"))
+	float MinRepathInterval = 0.3f;
+
+	// Quá khoảng này thì repath kể cả khi target chỉ lệch ít (giây)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Chase", meta = (ClampMin = "0.0"))
+	float MaxRepathInterval = 2.0f;
+
+	// Target nhìn thẳng được trên navmesh -> đi thẳng, không search
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Chase")
+	bool bUseDirectMoveWhenClear = true;
+};
+
+UENUM(BlueprintType)
+enum class EChaseMoveStatus : uint8
+{
+	None        UMETA(DisplayName = "None"),
+	Pending     UMETA(DisplayName = "Pending"),
+	Moving      UMETA(DisplayName = "Moving"),
+	Reached     UMETA(DisplayName = "Reached"),
+	Failed      UMETA(DisplayName = "Failed")
+};
+
+/** Số liệu để so sánh chi phí pathfinding (stat EscapeIT hiển thị bản theo frame) */
+USTRUCT(BlueprintType)
+struct FChaseMovementStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI|Chase")
+	int32 PathSearches = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI|Chase")
+	int32 DirectMoves = 0;
+
+	// Target lệch ít, chỉ dời điểm cuối trong corridor của path đang đi
+	UPROPERTY(BlueprintReadOnly, Category = "AI|Chase")
+	int32 CorridorReuses = 0;
+
+	// Repath bị đẩy sang frame sau vì hết budget
+	UPROPERTY(BlueprintReadOnly, Category = "AI|Chase")
+	int32 Deferred = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI|Chase")
+	float PathSearchesPerSecond = 0.0f;
+};
+
+/**
+ * Lớp di chuyển cho NPC đuổi người chơi.
+ * - Chỉ repath khi target lệch quá RepathDistance hoặc quá MaxRepathInterval
+ * - Target lệch ít mà vẫn nằm trong corridor của path đang đi thì dời điểm cuối của path đó, không search
+ * - Target thấy thẳng trên navmesh thì đi thẳng, không search
+ * - Path search chạy async qua UNavigationSystemV1::FindPathAsync, tối đa MaxPathRequestsPerFrame mỗi frame cho toàn world
+ */
+UCLASS()
+class ESCAPEIT_API UChaseMovementSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UChaseMovementSubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== CHASERS ==========================
+	void StartChase(AAIController* Controller, const FChaseRepathSettings& Settings);
+	void StopChase(AAIController* Controller);
+
+	/** TargetActor != null thì bám theo actor, ngược lại đi tới TargetLocation (vị trí cuối cùng biết được) */
+	void SetChaseTarget(AAIController* Controller, const AActor* TargetActor, const FVector& TargetLocation);
+
+	/** Reached/Failed theo FPathFollowingResult của move hiện tại (Success -> Reached, còn lại -> Failed) */
+	EChaseMoveStatus GetChaseStatus(const AAIController* Controller) const;
+
+	// ========================== STATS ==========================
+	UFUNCTION(BlueprintPure, Category = "AI|Chase")
+	FChaseMovementStats GetStats() const { return Stats; }
+
+	UFUNCTION(BlueprintCallable, Category = "AI|Chase")
+	void ResetStats();
+
+	int32 GetNumChasers() const { return Chasers.Num(); }
+
+	// ========================== SETTINGS ==========================
+	// Budget path search async cho toàn world mỗi frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Chase", meta = (ClampMin = "1"))
+	int32 MaxPathRequestsPerFrame = 4;
+
+private:
+	struct FChaser
+	{
+		TWeakObjectPtr<AAIController> Controller;
+		FChaseRepathSettings Settings;
+
+		TWeakObjectPtr<const AActor> TargetActor;
+		FVector TargetLocation = FVector::ZeroVector;
+
+		// Goal của path/move đang chạy
+		FVector PathGoal = FVector::ZeroVector;
+		float TimeSinceRepath = 0.0f;
+
+		uint32 PendingQueryId = INVALID_NAVQUERYID;
+		FVector PendingGoal = FVector::ZeroVector;
+
+		bool bMoveIssued = false;
+		bool bPathFailed = false;
+
+		// Move do subsystem ra lệnh và kết quả move kết thúc gần nhất (move cũ bị abort khi repath mang ID cũ)
+		FAIRequestID MoveRequestId;
+		FAIRequestID FinishedMoveId;
+		bool bFinishedMoveSucceeded = false;
+
+		FDelegateHandle MoveFinishedHandle;
+	};
+
+	FChaser* FindChaser(const AAIController* Controller);
+	const FChaser* FindChaser(const AAIController* Controller) const;
+
+	bool NeedsRepath(const FChaser& Chaser, const FVector& Goal) const;
+
+	void BindMoveFinished(FChaser& Chaser, AAIController& Controller);
+	void UnbindMoveFinished(FChaser& Chaser);
+	void OnMoveFinished(FAIRequestID RequestID, const FPathFollowingResult& Result, TWeakObjectPtr<const AAIController> Controller);
+
+	/** Ghi ID move vừa ra lệnh; không tìm được chaser (đã StopChase trong lúc MoveTo) thì bỏ qua */
+	void RecordMoveRequest(const AAIController* Controller, FAIRequestID RequestId);
+
+	/** Dời điểm cuối của FNavMeshPath đang đi tới Goal nếu Goal nằm trong corridor và đoạn cuối vẫn đi thẳng được */
+	bool TryReuseCorridor(AAIController& Controller, const FVector& Goal) const;
+
+	/** Trả về true nếu đã gửi một path search async (tính vào budget) */
+	bool IssueRepath(int32 ChaserIndex);
+	void OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
+	TArray<FChaser> Chasers;
+
+	// Index chaser cần repath trong frame hiện tại (giữ capacity giữa các frame)
+	TArray<int32> RepathCandidates;
+
+	bool bIsTicking = false;
+
+	FChaseMovementStats Stats;
+	float StatsWindowTime = 0.0f;
+	int32 StatsWindowSearches = 0;
+};
@@ -8,6 +8,37 @@
 #include "BehaviorTree/BehaviorTree.h"
 #include "NPC.generated.h"
 
+class UNPCPerceptionProfile;
+struct FStreamableHandle;
+
+/** Bộ tốc độ theo trạng thái BT, chọn bằng UBTService_ChangeSpeed */
+UENUM(BlueprintType)
+enum class ENPCSpeedProfile : uint8
+{
+    Patrol,
+    Investigate,
+    Search,
+    Chase,
+
+    Count UMETA(Hidden)
+};
+
+USTRUCT(BlueprintType)
+struct FNPCSpeedProfileSettings
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Speed", meta = (ClampMin = "0.0"))
+    float MaxWalkSpeed = 200.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Speed", meta = (ClampMin = "0.0"))
+    float MaxAcceleration = 2048.0f;
+
+    // Trọng số giữ khoảng cách với NPC khác trong crowd; thấp thì chen qua chỗ hẹp nhanh hơn
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Speed", meta = (ClampMin = "0.0"))
+    float CrowdSeparationWeight = 2.0f;
+};
+
 UCLASS()
 class ESCAPEIT_API ANPC : public ACharacter
 {
@@ -15,7 +46,7 @@ class ESCAPEIT_API ANPC : public ACharacter
 
 public:
     // Sets default values for this character's properties
-    ANPC();
+    explicit ANPC(const FObjectInitializer& ObjectInitializer);
 
     // Called every frame
     virtual void Tick(float DeltaTime) override;
@@ -26,11 +57,47 @@ public:
     // Lấy BehaviorTree, PatrolPath, v.v... nếu bạn cần
     UBehaviorTree* GetBehaviorTree() const;
     APaTrolPath* GetPatrolPath() const;
+    /** Montage đã preload; chưa load xong thì load đồng bộ (có thể khựng, log warning) */
     UAnimMontage* GetMontage() const;
+    UAnimMontage* GetAttackMontage(int32 Index) const;
+    int32 GetNumAttackMontages() const { return AttackMontages.Num(); }
+
+    /** Load async các montage (soft ref). Gọi từ UAISignificanceSubsystem khi NPC lên mức significance cao */
+    void PreloadAnimations();
+
+    /** Bỏ giữ montage để GC dọn (NPC ngủ đông / vào pool) */
+    void ReleaseAnimations();
+
+    /** Áp tốc độ/gia tốc của profile lên movement và trọng số separation lên crowd agent */
+    void SetSpeedProfile(ENPCSpeedProfile Profile);
+    ENPCSpeedProfile GetSpeedProfile() const { return SpeedProfile; }
+
+    UNPCPerceptionProfile* GetPerceptionProfile() const { return PerceptionProfile; }
+
+    /**
+     * Ngủ đông: BT và perception dừng (xem ANPC_AIController::SetDormant), actor/movement/mesh không tick,
+     * capsule chỉ còn query, mesh tắt collision. Blackboard, target memory và move đang dở giữ nguyên.
+     * Gọi từ UAISignificanceSubsystem (mức Dormant) và UNPCSpawnPoolSubsystem.
+     */
+    void SetDormant(bool bDormant);
+    bool IsDormant() const { return bIsDormant; }
+
+    // ========================== POOL ==========================
+    /** Đặt trước FinishSpawning hoặc khi lấy lại từ pool */
+    void SetPatrolPath(APaTrolPath* InPatrolPath) { PatrolPath = InPatrolPath; }
+
+    /** Cất vào pool: ngủ đông, ẩn, tắt collision, gỡ khỏi các subsystem AI. Pawn và controller được giữ lại */
+    void DeactivateToPool();
+
+    /** Lấy ra từ pool: đặt lại vị trí/patrol path, reset blackboard và chạy lại BT từ đầu */
+    void ActivateFromPool(const FTransform& SpawnTransform, APaTrolPath* InPatrolPath);
+
+    bool IsPooled() const { return bIsPooled; }
 
 protected:
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
     // Behavior Tree gán trong Editor
@@ -41,7 +108,32 @@ private:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (AllowPrivateAccess = "true"))
     APaTrolPath* PatrolPath;
 
-    // AnimMontage nếu bạn muốn NPC dùng
+    // AnimMontage nếu bạn muốn NPC dùng (soft ref: chỉ load khi NPC đủ significance)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animation, meta = (AllowPrivateAccess = "true"))
+    TSoftObjectPtr<UAnimMontage> Montage;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animation, meta = (AllowPrivateAccess = "true"))
-    UAnimMontage* Montage;
+    TArray<TSoftObjectPtr<UAnimMontage>> AttackMontages;
+
+    TSharedPtr<FStreamableHandle> AnimationLoadHandle;
+
+    // Theo thứ tự ENPCSpeedProfile
+    UPROPERTY(EditAnywhere, Category = "AI|Speed", meta = (AllowPrivateAccess = "true"))
+    FNPCSpeedProfileSettings SpeedProfiles[static_cast<int32>(ENPCSpeedProfile::Count)];
+
+    ENPCSpeedProfile SpeedProfile = ENPCSpeedProfile::Patrol;
+
+    // Perception theo archetype, áp khi controller possess (null -> giá trị mặc định)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Perception", meta = (AllowPrivateAccess = "true"))
+    TObjectPtr<UNPCPerceptionProfile> PerceptionProfile;
+
+    void RegisterWithAISubsystems();
+    void UnregisterFromAISubsystems();
+
+    bool bIsDormant = false;
+    bool bIsPooled = false;
+
+    // Collision lúc thức, khôi phục khi hết ngủ đông
+    TEnumAsByte<ECollisionEnabled::Type> AwakeCapsuleCollision = ECollisionEnabled::QueryAndPhysics;
+    TEnumAsByte<ECollisionEnabled::Type> AwakeMeshCollision = ECollisionEnabled::QueryOnly;
 };
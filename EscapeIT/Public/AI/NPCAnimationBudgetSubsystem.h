@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NPCAnimationBudgetSubsystem.generated.h"
+
+class UNPCSkeletalMeshComponent;
+
+/** Animation budget đã tiêu thực tế, để benchmark kiểm tra */
+struct FNPCAnimationBudgetStats
+{
+	int32 NumFrames = 0;
+	int32 NumFramesOverBudget = 0;
+
+	// Frame mà ngay cả tick rate tối đa cho mọi mesh vẫn vượt budget (quá nhiều mesh)
+	int32 NumSaturatedFrames = 0;
+
+	double TotalMeasuredMs = 0.0;
+	double MaxMeasuredMs = 0.0;
+
+	// Chỉ tính frame không saturated: đây là phần allocator phải giữ trong budget
+	double TotalUnsaturatedMs = 0.0;
+};
+
+/**
+ * Chia budget animation (ms game thread mỗi frame, ai.AnimBudget.BudgetMs) cho mesh của mọi NPC.
+ * NPC được render và NPC đang đuổi/điều tra (significance Critical) được ưu tiên, xa player thì giảm dần.
+ * Mỗi mesh nhận một tick rate (update 1 trong N frame) sao cho tổng chi phí ước lượng vừa budget;
+ * mesh đang được render và tick rate không quá cao thì nội suy giữa các lần update, mesh khuất bị ép LOD thấp nhất
+ * để evaluate ít bone hơn. Tắt bằng ai.AnimBudget.Enabled 0 (mesh tick full rate như cũ).
+ */
+UCLASS()
+class ESCAPEIT_API UNPCAnimationBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UNPCAnimationBudgetSubsystem* Get(const UObject* WorldContextObject);
+	static bool IsEnabled();
+	static float GetBudgetMs();
+
+	// ========================== COMPONENTS ==========================
+	void RegisterComponent(UNPCSkeletalMeshComponent* Component);
+	void UnregisterComponent(UNPCSkeletalMeshComponent* Component);
+
+	int32 GetNumComponents() const { return Entries.Num(); }
+
+	const FNPCAnimationBudgetStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = FNPCAnimationBudgetStats(); }
+
+	// ========================== SETTINGS ==========================
+	// Tick rate thấp nhất (update 1 trong N frame)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Animation Budget", meta = (ClampMin = "1", ClampMax = "30"))
+	int32 MaxTickRate = 8;
+
+	// NPC đang đuổi/điều tra không bị giảm quá mức này (montage tấn công phải mượt)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Animation Budget", meta = (ClampMin = "1", ClampMax = "30"))
+	int32 MaxCriticalTickRate = 2;
+
+	// Tick rate cao hơn thì không nội suy: pose nhảy nhưng đỡ tốn (chỉ gặp ở NPC xa)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Animation Budget", meta = (ClampMin = "1", ClampMax = "30"))
+	int32 MaxInterpolatedTickRate = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Animation Budget", meta = (ClampMin = "1.0"))
+	float VisibleWeight = 4.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Animation Budget", meta = (ClampMin = "1.0"))
+	float CriticalWeight = 8.0f;
+
+	// Trọng số nhân với 1 / (1 + khoảng cách tới player / DistanceFalloff), đơn vị cm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Animation Budget", meta = (ClampMin = "1.0"))
+	float DistanceFalloff = 1500.0f;
+
+	// Mesh không được render (và không Critical) bị ép LOD thấp nhất
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Animation Budget")
+	bool bForceLowestLODOffscreen = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Animation Budget", meta = (ClampMin = "0.0"))
+	float RenderedTolerance = 0.2f;
+
+private:
+	struct FBudgetEntry
+	{
+		TWeakObjectPtr<UNPCSkeletalMeshComponent> Component;
+		float Weight = 0.0f;
+		float Cost = 0.0f;
+		float AccumulatedDeltaTime = 0.0f;
+		uint8 TickRate = 1;
+
+		// Rải các mesh cùng tick rate ra các frame khác nhau
+		uint8 FrameOffset = 0;
+		bool bRendered = false;
+		bool bCritical = false;
+		bool bForcedLOD = false;
+		bool bActive = false;
+	};
+
+	void TakeControl(UNPCSkeletalMeshComponent& Component) const;
+	void ReleaseControl(UNPCSkeletalMeshComponent& Component) const;
+
+	/** Cập nhật ưu tiên rồi chia budget theo trọng số; trả về chi phí tối thiểu có thể (mọi mesh ở tick rate tối đa) */
+	float Allocate();
+	void Apply(FBudgetEntry& Entry, float DeltaTime) const;
+	void RecordStats(float MinimumCostMs);
+
+	TArray<FBudgetEntry> Entries;
+	TArray<int32> SortedIndices;
+	uint8 NextFrameOffset = 0;
+
+	// Trạng thái cvar ở frame trước, đổi thì trả/lấy lại quyền điều khiển mesh
+	bool bWasEnabled = true;
+
+	FNPCAnimationBudgetStats Stats;
+};
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "NPCBehaviorTreeComponent.generated.h"
+
+/**
+ * BehaviorTreeComponent có thể giảm tần suất tick theo significance của NPC.
+ * Không dùng SetComponentTickInterval vì BT tự đặt lại interval khi lên lịch tick;
+ * thay vào đó gom DeltaTime lại và chỉ chạy tree khi đủ MinTickInterval.
+ * Khi bật trace (UAIDecisionTraceSubsystem), ghi lại node đang chạy mỗi khi nó đổi sau một lần tick.
+ */
+UCLASS()
+class ESCAPEIT_API UNPCBehaviorTreeComponent : public UBehaviorTreeComponent
+{
+	GENERATED_BODY()
+
+public:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** 0 = tick theo lịch của BT như bình thường */
+	void SetMinTickInterval(float Interval);
+	float GetMinTickInterval() const { return MinTickInterval; }
+
+private:
+	float MinTickInterval = 0.0f;
+	float PendingDeltaTime = 0.0f;
+
+	// Node đã ghi vào trace gần nhất (chỉ so địa chỉ)
+	const UBTNode* LastTracedNode = nullptr;
+};
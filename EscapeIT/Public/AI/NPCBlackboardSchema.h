@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+
+/** Các key mà code C++ của NPC đọc/ghi trực tiếp */
+enum class ENPCBlackboardKey : uint8
+{
+	CanSeePlayer,
+	IsPlayerBeingChased,
+	LastHeardLocation,
+	HasHeardSound,
+	IsInvestigating,
+	CanJumpScare,
+
+	Count
+};
+
+/** Mô tả một key trong schema */
+struct FNPCBlackboardKeyDesc
+{
+	ENPCBlackboardKey Key;
+	FName Name;
+	TSubclassOf<UBlackboardKeyType> KeyType;
+
+	// Giá trị mặc định (dùng field tương ứng với KeyType)
+	bool bDefaultBool = false;
+	FVector DefaultVector = FVector::ZeroVector;
+};
+
+namespace NPCBlackboard
+{
+	/** Toàn bộ schema, theo thứ tự ENPCBlackboardKey */
+	ESCAPEIT_API TConstArrayView<FNPCBlackboardKeyDesc> GetSchema();
+
+	ESCAPEIT_API const FNPCBlackboardKeyDesc& GetKeyDesc(ENPCBlackboardKey Key);
+
+	/** Kiểm tra asset có đủ key với đúng kiểu. Trả về false và điền OutErrors nếu không khớp */
+	ESCAPEIT_API bool ValidateBlackboardAsset(const UBlackboardData& Asset, TArray<FString>& OutErrors);
+}
+
+/**
+ * Key ID đã resolve cho một blackboard asset.
+ * Resolve một lần cho mỗi asset rồi cache, thay vì tra FName -> ID ở mỗi lần Get/Set.
+ */
+class ESCAPEIT_API FNPCBlackboardKeys
+{
+public:
+	FNPCBlackboardKeys();
+
+	/** Key ID đã cache cho asset (resolve ở lần gọi đầu). Asset null -> mọi key invalid */
+	static const FNPCBlackboardKeys& Get(const UBlackboardData* Asset);
+
+	FBlackboard::FKey operator[](ENPCBlackboardKey Key) const { return KeyIds[static_cast<int32>(Key)]; }
+
+private:
+	void Resolve(const UBlackboardData* Asset);
+
+	FBlackboard::FKey KeyIds[static_cast<int32>(ENPCBlackboardKey::Count)];
+};
+
+/**
+ * Accessor có kiểu cho blackboard của NPC.
+ * Dùng tạm trên stack: FNPCBlackboard BB(OwnerComp.GetBlackboardComponent()); BB.SetCanSeePlayer(true);
+ */
+class ESCAPEIT_API FNPCBlackboard
+{
+public:
+	explicit FNPCBlackboard(UBlackboardComponent* InComponent);
+
+	bool IsValid() const { return Component != nullptr; }
+
+	bool GetCanSeePlayer() const { return GetBool(ENPCBlackboardKey::CanSeePlayer); }
+	void SetCanSeePlayer(bool bValue) const { SetBool(ENPCBlackboardKey::CanSeePlayer, bValue); }
+
+	bool GetIsPlayerBeingChased() const { return GetBool(ENPCBlackboardKey::IsPlayerBeingChased); }
+	void SetIsPlayerBeingChased(bool bValue) const { SetBool(ENPCBlackboardKey::IsPlayerBeingChased, bValue); }
+
+	FVector GetLastHeardLocation() const { return GetVector(ENPCBlackboardKey::LastHeardLocation); }
+	void SetLastHeardLocation(const FVector& Value) const { SetVector(ENPCBlackboardKey::LastHeardLocation, Value); }
+
+	bool GetHasHeardSound() const { return GetBool(ENPCBlackboardKey::HasHeardSound); }
+	void SetHasHeardSound(bool bValue) const { SetBool(ENPCBlackboardKey::HasHeardSound, bValue); }
+
+	bool GetIsInvestigating() const { return GetBool(ENPCBlackboardKey::IsInvestigating); }
+	void SetIsInvestigating(bool bValue) const { SetBool(ENPCBlackboardKey::IsInvestigating, bValue); }
+
+	bool GetCanJumpScare() const { return GetBool(ENPCBlackboardKey::CanJumpScare); }
+	void SetCanJumpScare(bool bValue) const { SetBool(ENPCBlackboardKey::CanJumpScare, bValue); }
+
+	/** Đưa mọi key trong schema về giá trị mặc định */
+	void ResetToDefaults() const;
+
+private:
+	bool GetBool(ENPCBlackboardKey Key) const;
+	void SetBool(ENPCBlackboardKey Key, bool bValue) const;
+	FVector GetVector(ENPCBlackboardKey Key) const;
+	void SetVector(ENPCBlackboardKey Key, const FVector& Value) const;
+
+	UBlackboardComponent* Component = nullptr;
+	const FNPCBlackboardKeys& Keys;
+};
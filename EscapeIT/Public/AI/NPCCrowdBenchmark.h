@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AI/AISignificanceSubsystem.h"
+#include "NPCCrowdBenchmark.generated.h"
+
+class ANPC;
+class AAIController;
+class APaTrolPath;
+class UBTNode;
+class UBTTask_IncrementPathIndex;
+class UBehaviorTreeComponent;
+class UStaticMesh;
+
+/**
+ * Benchmark crowd movement: spawn NumAgents NPC ở các SpawnPoint, cho đi qua lại giữa SpawnPoint và GoalPoint
+ * (đặt sao cho phải đi qua chỗ hẹp) trong Duration giây rồi log chi phí frame, số lần NPC bị kẹt
+ * và độ lệch trung bình khỏi path.
+ * Đặt trong một map benchmark; chạy headless:
+ *   UnrealEditor EscapeIT.uproject /Game/Maps/CrowdBenchmark -game -nullrhi -unattended -CrowdBenchmark
+ * Không có map đặt sẵn: dùng map rỗng của engine và spawn benchmark bằng console, map test được dựng bằng code
+ * (sàn, tường ngăn có hai chỗ hẹp, NavMeshBoundsVolume, navmesh build lúc runtime, patrol path qua hai chỗ hẹp):
+ *   UnrealEditor EscapeIT.uproject /Engine/Maps/Entry -game -nullrhi -unattended -CrowdBenchmark
+ *     -CrowdBenchmarkNPC=/Game/AI/BP_NPC.BP_NPC_C -ExecCmds="ai.CrowdBenchmark.Spawn"
+ * -CrowdBenchmarkNPC=<class path> thay cho NPCClass (mặc định ANPC, không có BT/mesh của Blueprint).
+ * -CrowdBenchmark tự bắt đầu khi BeginPlay và thoát game khi xong, exit code 1 nếu độ trễ sight vượt MaxSightLatency.
+ * -CrowdBenchmarkAgents=N thay cho NumAgents (vd. 100 observer cho test độ trễ sight).
+ * Thêm -ExecCmds="ai.NPC.CrowdAvoidance 0" để so sánh khi tắt crowd avoidance.
+ * -CrowdBenchmarkBT giữ BT của NPC chạy (không ra lệnh move) để đo chi phí AI đầy đủ; kèm -AITrace để đo
+ * chi phí của UAIDecisionTraceSubsystem, -AITraceFile=<path> ghi trace ra file khi xong.
+ * -CrowdBenchmarkChase (vd. kèm -CrowdBenchmarkAgents=50): mọi agent đuổi một target chạy qua lại giữa SpawnPoints[0]
+ * và GoalPoints[0]. Nửa đầu Duration dùng MoveTo có pathfinding mỗi frame (như BTTask_ChasePlayer cũ), nửa sau đi qua
+ * UChaseMovementSubsystem -> log path search/giây và chi phí game thread của từng nửa.
+ * -CrowdBenchmarkLOD: BT chạy như -CrowdBenchmarkBT (mặc định 200 agent); nửa đầu tắt ai.Significance.Enabled, nửa sau bật
+ * -> log chi phí game thread (bỏ WarmupSeconds đầu mỗi nửa) và số agent trung bình ở từng mức significance.
+ * -CrowdBenchmarkSoak (kèm -CrowdBenchmarkDuration=600 -benchmark để chạy nhanh hơn thời gian thực): BT thật của mọi agent
+ * chạy với fixed step SoakStepSeconds, bắt đầu lệch nhau và từ patrol index khác nhau. Mỗi frame kiểm tra timer của
+ * LookAround và chiều của IncrementPathIndex trong NodeMemory của từng agent, cuối cùng kiểm tra không node dùng chung
+ * nào bị đổi byte (member C++ lẫn UPROPERTY); log ms/agent/frame, exit code 1 nếu có state bị lẫn giữa các agent.
+ * Mesh của mọi agent đi qua UNPCAnimationBudgetSubsystem: exit code 1 nếu chi phí animation trung bình vượt
+ * ai.AnimBudget.BudgetMs quá MaxAnimationBudgetOverrun (bỏ qua frame mà budget không thể đủ dù tick rate tối đa).
+ */
+UCLASS()
+class ESCAPEIT_API ANPCCrowdBenchmark : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ANPCCrowdBenchmark();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "AI|Benchmark")
+	void StartBenchmark();
+
+	UFUNCTION(BlueprintCallable, Category = "AI|Benchmark")
+	void StopBenchmark();
+
+	// Class NPC dùng để spawn (BT bị dừng, benchmark tự ra lệnh move)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark")
+	TSubclassOf<ANPC> NPCClass;
+
+	// Dựng map test bằng code quanh actor; tự bật khi SpawnPoints/GoalPoints trống hoặc có -CrowdBenchmarkGenerateMap
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark")
+	bool bGenerateTestMap = false;
+
+	// Kích thước sàn của map test (cm); tường ngăn ở giữa chia thành hai phòng nối bằng hai chỗ hẹp
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (EditCondition = "bGenerateTestMap"))
+	FVector2D TestMapSize = FVector2D(8000.0f, 4000.0f);
+
+	// Bề rộng mỗi chỗ hẹp trên tường ngăn (cm)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (EditCondition = "bGenerateTestMap", ClampMin = "100.0"))
+	float TestMapChokepointWidth = 300.0f;
+
+	// Giữ BT chạy thay vì ra lệnh move; số liệu kẹt/độ lệch path không được đo
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark")
+	bool bRunBehaviorTree = false;
+
+	// So sánh chase MoveTo mỗi frame với UChaseMovementSubsystem (thay cho đi qua lại)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark")
+	bool bChaseBenchmark = false;
+
+	// Tốc độ target bị đuổi (cm/s), cỡ tốc độ chạy của player
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "0.0"))
+	float ChaseTargetSpeed = 450.0f;
+
+	// So chi phí BT của mọi agent khi tắt/bật significance LOD
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark")
+	bool bCompareSignificanceLOD = false;
+
+	// Bỏ qua đầu mỗi nửa khi so sánh (chờ significance áp xong mức mới)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "0.0"))
+	float WarmupSeconds = 2.0f;
+
+	// Soak BT thật với fixed step và kiểm tra state của node không bị lẫn giữa các agent
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark")
+	bool bSoakBenchmark = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "0.001"))
+	float SoakStepSeconds = 1.0f / 30.0f;
+
+	// BT của từng agent bắt đầu ngẫu nhiên trong khoảng này -> LookAround/patrol của các agent chồng lên nhau ở pha khác nhau
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "0.0"))
+	float SoakStartStagger = 5.0f;
+
+	// Patrol path gán cho mọi agent khi soak (để trống = giữ patrol path của NPCClass)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark")
+	TObjectPtr<APaTrolPath> SoakPatrolPath;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "1"))
+	int32 NumAgents = 200;
+
+	// Local space, giống APaTrolPath
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (MakeEditWidget = "true"))
+	TArray<FVector> SpawnPoints;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (MakeEditWidget = "true"))
+	TArray<FVector> GoalPoints;
+
+	// NPC được rải ngẫu nhiên trong bán kính này quanh SpawnPoint
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "0.0"))
+	float SpawnRadius = 400.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "1.0"))
+	float Duration = 60.0f;
+
+	// Đang có move mà chậm hơn StuckSpeed liên tục StuckTime giây -> tính một lần kẹt
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "0.0"))
+	float StuckSpeed = 10.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "0.0"))
+	float StuckTime = 2.0f;
+
+	// Độ trễ phát hiện tối đa cho phép của UNPCSightSubsystem (giây)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "0.0"))
+	float MaxSightLatency = 0.5f;
+
+	// Tỉ lệ cho phép vượt animation budget (trung bình trên các frame budget đủ được)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Benchmark", meta = (ClampMin = "0.0"))
+	float MaxAnimationBudgetOverrun = 0.1f;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	struct FAgent
+	{
+		TWeakObjectPtr<ANPC> NPC;
+		bool bHeadingToGoal = true;
+		float SlowTime = 0.0f;
+		bool bCountedStuck = false;
+		bool bEverStuck = false;
+
+		// Soak
+		float StartDelay = 0.0f;
+		bool bLogicStarted = true;
+		// ElapsedTime của LookAround lúc thấy agent vào task (<0: không ở LookAround) và thời gian mô phỏng từ đó
+		float LookAroundBaseElapsed = -1.0f;
+		float LookAroundObservedTime = 0.0f;
+		float LastLookAroundElapsed = 0.0f;
+		int32 LastPathIndex = INDEX_NONE;
+		int32 LastPathStep = 0;
+	};
+
+	enum class EChasePhase : uint8
+	{
+		// MoveTo có pathfinding mỗi frame cho mọi agent
+		PerFrameMoveTo,
+		// UChaseMovementSubsystem
+		Throttled,
+		Num
+	};
+
+	struct FChasePhaseStats
+	{
+		int32 NumFrames = 0;
+		float Seconds = 0.0f;
+		double TotalGameThreadMs = 0.0;
+		double MaxGameThreadMs = 0.0;
+		int32 PathSearches = 0;
+		int32 DirectMoves = 0;
+		int32 CorridorReuses = 0;
+		int32 Deferred = 0;
+	};
+
+	/** Dựng sàn/tường, navmesh dynamic + bounds volume, patrol path; navmesh build xong mới spawn agent */
+	bool GenerateTestMap();
+	AActor* SpawnTestBlock(UStaticMesh* Mesh, const FVector& LocalCenter, const FVector& Size);
+	bool IsTestNavMeshReady() const;
+
+	void IssueMove(FAgent& Agent) const;
+	void BeginChasePhase(EChasePhase Phase);
+	void TickChase(float DeltaSeconds, double GameThreadMs);
+	void ReportChaseResults() const;
+
+	struct FSignificancePhaseStats
+	{
+		int32 NumFrames = 0;
+		double TotalGameThreadMs = 0.0;
+		double MaxGameThreadMs = 0.0;
+		int64 LevelSamples[static_cast<int32>(EAISignificance::Count)] = {};
+	};
+
+	void SetSignificanceLOD(bool bEnabled);
+	void TickSignificanceComparison(double GameThreadMs);
+	void ReportSignificanceResults() const;
+
+	void BeginSoak();
+	void EndSoak();
+	void TickSoak(float DeltaSeconds);
+	void StartSoakAgent(FAgent& Agent, ANPC& NPC, UBehaviorTreeComponent& BTComp);
+	void CheckSoakAgent(FAgent& Agent, const ANPC& NPC, UBehaviorTreeComponent& BTComp, float DeltaSeconds);
+	void AddSoakViolation(const FAgent& Agent, const FString& Description);
+	bool ReportSoakResults() const;
+	/** Log kết quả; trả về false nếu vượt ngưỡng */
+	bool ReportResults() const;
+	bool ReportAnimationBudget() const;
+
+	TArray<FAgent> Agents;
+
+	bool bRunning = false;
+	bool bQuitWhenDone = false;
+	bool bTestMapGenerated = false;
+	bool bWaitingForNavMesh = false;
+	float NavMeshWaitTime = 0.0f;
+	bool bDormancyWasEnabled = true;
+	float ElapsedTime = 0.0f;
+
+	// Số liệu
+	int32 NumFrames = 0;
+	double TotalGameThreadMs = 0.0;
+	double MaxGameThreadMs = 0.0;
+	int32 NumStuckEvents = 0;
+	double TotalDeviation = 0.0;
+	int64 NumDeviationSamples = 0;
+	int32 NumArrivals = 0;
+
+	EChasePhase ChasePhase = EChasePhase::PerFrameMoveTo;
+	FChasePhaseStats ChasePhaseStats[(int32)EChasePhase::Num];
+	// 0..2: đi từ SpawnPoints[0] tới GoalPoints[0] rồi quay lại
+	float ChaseTargetPhase = 0.0f;
+	FVector ChaseTargetLocation = FVector::ZeroVector;
+
+	FSignificancePhaseStats SignificancePhaseStats[2];
+	bool bSignificanceLODActive = false;
+	bool bSignificanceWasEnabled = true;
+	float SignificancePhaseStartTime = 0.0f;
+
+	// Byte của node không instanced lúc bắt đầu soak (cả member C++ không phải UPROPERTY);
+	// node dùng chung mà đổi byte = state bị lẫn giữa agent
+	struct FSoakNodeSnapshot
+	{
+		TWeakObjectPtr<const UBTNode> Node;
+		TArray<uint8> Bytes;
+	};
+	TArray<FSoakNodeSnapshot> SoakNodeSnapshots;
+	TWeakObjectPtr<const UBTTask_IncrementPathIndex> SoakPathIndexTask;
+	FName SoakPathIndexKey;
+	bool bSoakFixedStepWasEnabled = false;
+	double SoakSavedFixedDeltaTime = 0.0;
+	int32 NumLookAroundSamples = 0;
+	int32 NumPathIndexSteps = 0;
+	int32 NumCrowdPathSamples = 0;
+	int32 NumSoakViolations = 0;
+};
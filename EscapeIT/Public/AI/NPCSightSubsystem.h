@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "WorldCollision.h"
+#include "NPCSightSubsystem.generated.h"
+
+class ANPC_AIController;
+struct FNPCPerceptionSettings;
+
+/** Độ trễ phát hiện: từ lúc player vào tầm nhìn tới lúc trace xác nhận thấy */
+USTRUCT(BlueprintType)
+struct FNPCSightLatencyStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI|Sight")
+	int32 NumDetections = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI|Sight")
+	float AverageLatency = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI|Sight")
+	float MaxLatency = 0.0f;
+
+	// Số lần phát hiện chậm hơn MaxDetectionLatency
+	UPROPERTY(BlueprintReadOnly, Category = "AI|Sight")
+	int32 NumOverBudget = 0;
+};
+
+/**
+ * Sight của NPC thay cho UAISense_Sight: kiểm tra bán kính/góc nhìn trên game thread (rẻ),
+ * còn line-of-sight dùng async trace với budget MaxTracesPerFrame cho toàn world.
+ * Observer được xếp ưu tiên theo khoảng cách tới player, thời gian từ lần trace trước và việc vừa thấy player gần đây.
+ * Kết quả thấy/mất dấu được gửi vào ANPC_AIController như một stimulus sight bình thường.
+ */
+UCLASS()
+class ESCAPEIT_API UNPCSightSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UNPCSightSubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== OBSERVERS ==========================
+	/** Đăng ký lại thì chỉ cập nhật settings */
+	void RegisterObserver(ANPC_AIController* Controller, const FNPCPerceptionSettings& Settings);
+	void UnregisterObserver(ANPC_AIController* Controller);
+
+	/** Tắt sight của một NPC (significance thấp); đang thấy player thì báo mất dấu */
+	void SetObserverEnabled(ANPC_AIController* Controller, bool bEnabled);
+
+	int32 GetNumObservers() const { return Observers.Num(); }
+	bool IsObserverRegistered(const ANPC_AIController* Controller) const { return ObserverIndices.Contains(Controller); }
+
+	// ========================== STATS ==========================
+	UFUNCTION(BlueprintPure, Category = "AI|Sight")
+	FNPCSightLatencyStats GetLatencyStats() const;
+
+	UFUNCTION(BlueprintCallable, Category = "AI|Sight")
+	void ResetLatencyStats();
+
+	// ========================== SETTINGS ==========================
+	// Budget async trace cho toàn world mỗi frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Sight", meta = (ClampMin = "1"))
+	int32 MaxTracesPerFrame = 16;
+
+	// Observer vừa thấy player trong SightMaxAge được nhân ưu tiên với hệ số này
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Sight", meta = (ClampMin = "1.0"))
+	float RecentlySeenPriorityScale = 4.0f;
+
+	// Mốc để đếm NumOverBudget (giây)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Sight", meta = (ClampMin = "0.0"))
+	float MaxDetectionLatency = 0.25f;
+
+private:
+	struct FObserver
+	{
+		TWeakObjectPtr<ANPC_AIController> Controller;
+		TObjectKey<ANPC_AIController> Key;
+
+		// Settings đã đổi sang dạng so sánh trực tiếp
+		float SightRadius = 0.0f;
+		float LoseSightRadius = 0.0f;
+		float CosHalfAngle = 0.0f;
+		float AutoSuccessRangeSq = 0.0f;
+		float MaxAge = 0.0f;
+
+		bool bEnabled = true;
+		bool bSeen = false;
+		FVector LastSeenLocation = FVector::ZeroVector;
+		double LastSeenTime = -1.0;
+		double LastCheckTime = -1.0;
+
+		// Lần đầu player vào tầm nhìn mà chưa được xác nhận (-1 = không có)
+		double CandidateSince = -1.0;
+
+		FTraceHandle PendingTrace;
+		uint64 PendingTraceFrame = 0;
+	};
+
+	struct FCandidate
+	{
+		float Priority;
+		int32 Index;
+
+		bool operator<(const FCandidate& Other) const { return Priority > Other.Priority; }
+	};
+
+	void RemoveObserverAt(int32 Index);
+	void SetSeen(FObserver& Observer, AActor* Target, bool bSeen, const FVector& Location, double Now);
+
+	TArray<FObserver> Observers;
+	TMap<TObjectKey<ANPC_AIController>, int32> ObserverIndices;
+
+	// Giữ capacity giữa các frame
+	TArray<FCandidate> Candidates;
+
+	int32 NumDetections = 0;
+	double TotalLatency = 0.0;
+	float MaxLatency = 0.0f;
+	int32 NumOverBudget = 0;
+};
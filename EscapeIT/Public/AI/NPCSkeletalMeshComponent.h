@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "NPCSkeletalMeshComponent.generated.h"
+
+/**
+ * Mesh của NPC: đo chi phí tick animation trên game thread và để UNPCAnimationBudgetSubsystem
+ * quyết định tick rate, nội suy và LOD evaluate (qua external tick rate control của URO).
+ */
+UCLASS(ClassGroup = (Rendering), meta = (BlueprintSpawnableComponent))
+class ESCAPEIT_API UNPCSkeletalMeshComponent : public USkeletalMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	UNPCSkeletalMeshComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** Chi phí trung bình của một lần update animation đầy đủ (ms), không tính frame bị bỏ qua */
+	float GetEstimatedUpdateCostMs() const { return EstimatedUpdateCostMs; }
+
+	/** Chi phí lần tick gần nhất (ms) và frame của nó */
+	float GetLastTickCostMs() const { return LastTickCostMs; }
+	uint64 GetLastTickFrame() const { return LastTickFrame; }
+
+	/** Gọi bởi budget subsystem: frame tới có update animation hay chỉ nội suy/giữ pose */
+	void SetBudgetedUpdate(bool bUpdate);
+
+private:
+	// Ước lượng ban đầu trước khi đo được lần nào
+	float EstimatedUpdateCostMs = 0.1f;
+	float LastTickCostMs = 0.0f;
+	uint64 LastTickFrame = 0;
+	bool bBudgetedUpdate = true;
+};
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "NPCSpawnPoint.generated.h"
+
+class ANPC;
+class APaTrolPath;
+
+/**
+ * Điểm spawn NPC đặt trong level. UNPCSpawnPoolSubsystem lấy NPC từ pool khi player tới gần
+ * và cất lại khi player đã đi xa, thay cho NPC đặt sẵn sống suốt cả level.
+ */
+UCLASS()
+class ESCAPEIT_API ANPCSpawnPoint : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ANPCSpawnPoint();
+
+	/** Bật theo tiến độ (trigger, puzzle xong...). Tắt không thu hồi NPC đang sống */
+	UFUNCTION(BlueprintCallable, Category = "AI|Spawn")
+	void SetSpawnEnabled(bool bEnabled) { bSpawnEnabled = bEnabled; }
+
+	UFUNCTION(BlueprintPure, Category = "AI|Spawn")
+	bool IsSpawnEnabled() const { return bSpawnEnabled; }
+
+	TSubclassOf<ANPC> GetNPCClass() const { return NPCClass; }
+	APaTrolPath* GetPatrolPath() const { return PatrolPath; }
+	float GetActivationDistance() const { return ActivationDistance; }
+	float GetDeactivationDistance() const { return FMath::Max(DeactivationDistance, ActivationDistance); }
+	bool IsSpawnOnce() const { return bSpawnOnce; }
+	bool ShouldPrewarm() const { return bPrewarm; }
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI|Spawn", meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<ANPC> NPCClass;
+
+	// Null -> giữ patrol path của NPC lấy từ pool
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI|Spawn", meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<APaTrolPath> PatrolPath;
+
+	// Player vào trong khoảng này thì spawn
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI|Spawn", meta = (ClampMin = "0.0", AllowPrivateAccess = "true"))
+	float ActivationDistance = 3000.0f;
+
+	// NPC xa player hơn khoảng này (và không đang đuổi/điều tra, không được render) thì cất vào pool
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI|Spawn", meta = (ClampMin = "0.0", AllowPrivateAccess = "true"))
+	float DeactivationDistance = 5000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI|Spawn", meta = (AllowPrivateAccess = "true"))
+	bool bSpawnEnabled = true;
+
+	// NPC đã bị cất thì không spawn lại (khu vực player đã đi qua)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI|Spawn", meta = (AllowPrivateAccess = "true"))
+	bool bSpawnOnce = false;
+
+	// Spawn sẵn một NPC ẩn vào pool lúc BeginPlay để lần spawn đầu không bị khựng
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI|Spawn", meta = (AllowPrivateAccess = "true"))
+	bool bPrewarm = true;
+};
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "NPCSpawnPoolSubsystem.generated.h"
+
+class ANPC;
+class ANPCSpawnPoint;
+class APaTrolPath;
+
+/**
+ * Spawn NPC từ ANPCSpawnPoint theo tiến độ của player và tái sử dụng pawn + controller đã cất.
+ * NPC cất vào pool được ngủ đông và ẩn (ANPC::DeactivateToPool), lấy ra thì reset blackboard và
+ * chạy lại BT từ đầu, không phải spawn/possess lại.
+ */
+UCLASS()
+class ESCAPEIT_API UNPCSpawnPoolSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UNPCSpawnPoolSubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== SPAWN POINTS ==========================
+	void RegisterSpawnPoint(ANPCSpawnPoint* Point);
+	void UnregisterSpawnPoint(ANPCSpawnPoint* Point);
+
+	// ========================== POOL ==========================
+	/** NPC đã cất cùng class nếu có, không thì spawn mới (kèm controller) */
+	ANPC* AcquireNPC(TSubclassOf<ANPC> NPCClass, const FTransform& SpawnTransform, APaTrolPath* PatrolPath);
+	void ReleaseNPC(ANPC* NPC);
+
+	/** Spawn sẵn Count NPC vào pool, đặt ẩn ở ParkTransform */
+	void Prewarm(TSubclassOf<ANPC> NPCClass, int32 Count, const FTransform& ParkTransform);
+
+	int32 GetNumActive() const;
+	int32 GetNumPooled() const;
+
+	// ========================== SETTINGS ==========================
+	// Chu kỳ kiểm tra khoảng cách tới các spawn point (giây)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Spawn", meta = (ClampMin = "0.0"))
+	float EvaluationInterval = 0.5f;
+
+	// Số NPC từ spawn point sống cùng lúc tối đa
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Spawn", meta = (ClampMin = "0"))
+	int32 MaxActiveNPCs = 8;
+
+	// NPC được render trong khoảng này thì chưa cất (tránh biến mất trước mắt player)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Spawn", meta = (ClampMin = "0.0"))
+	float RenderedTolerance = 1.0f;
+
+private:
+	struct FSpawnSlot
+	{
+		TWeakObjectPtr<ANPCSpawnPoint> Point;
+		TWeakObjectPtr<ANPC> NPC;
+
+		// bSpawnOnce và NPC đã bị cất
+		bool bSpent = false;
+	};
+
+	ANPC* SpawnNPC(TSubclassOf<ANPC> NPCClass, const FTransform& SpawnTransform, APaTrolPath* PatrolPath);
+	void UpdateStats() const;
+
+	TArray<FSpawnSlot> Slots;
+	TMap<TObjectKey<UClass>, TArray<TWeakObjectPtr<ANPC>>> FreeNPCs;
+	float TimeSinceEvaluation = 0.0f;
+};
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Perception/AIPerceptionTypes.h"
+#include "Perception/AISense.h"
+
+/**
+ * Những gì NPC nhớ về một mục tiêu: vị trí biết được gần nhất, vận tốc ước lượng,
+ * độ tin cậy giảm dần sau khi mất dấu và giác quan đã cung cấp thông tin.
+ */
+struct ESCAPEIT_API FNPCTargetMemory
+{
+	TWeakObjectPtr<AActor> Actor;
+
+	FVector LastKnownLocation = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+
+	// 1 khi đang cảm nhận được, giảm về 0 sau khi mất dấu
+	float Confidence = 0.0f;
+
+	// Strength của stimulus gần nhất (loudness với hearing)
+	float Strength = 0.0f;
+
+	FAISenseID SourceSense;
+	double LastSensedTime = -1.0;
+	bool bCurrentlySensed = false;
+
+	bool IsValid() const { return Confidence > 0.0f; }
+
+	/** Ghi nhận một lần cảm nhận. Vận tốc ước lượng từ vị trí trước nếu không truyền vào */
+	void Sense(const FVector& Location, double Time, FAISenseID Sense, float InStrength, const FVector* KnownVelocity = nullptr);
+
+	/** Mất dấu: giữ vị trí/vận tốc cuối, bắt đầu giảm confidence */
+	void Lose() { bCurrentlySensed = false; }
+
+	/** Giảm confidence khi không còn cảm nhận; về 0 thì quên hẳn */
+	void Decay(float DeltaSeconds, float DecayPerSecond);
+
+	/** Vị trí dự đoán sau Seconds giây kể từ lần cuối thấy */
+	FVector PredictLocation(float Seconds) const { return LastKnownLocation + Velocity * Seconds; }
+
+	void Reset() { *this = FNPCTargetMemory(); }
+};
+
+/**
+ * Gửi stimulus tới handler theo FAISenseID thay vì so sánh tên sense bằng string.
+ */
+class ESCAPEIT_API FNPCStimulusRouter
+{
+public:
+	using FHandler = TFunction<void(AActor*, const FAIStimulus&)>;
+
+	void Register(FAISenseID Sense, FHandler Handler);
+
+	template<typename TSense>
+	void Register(FHandler Handler) { Register(UAISense::GetSenseID<TSense>(), MoveTemp(Handler)); }
+
+	/** Trả về false nếu sense chưa có handler */
+	bool Dispatch(AActor* Actor, const FAIStimulus& Stimulus) const;
+
+private:
+	// Index = FAISenseID
+	TArray<FHandler> Handlers;
+};
@@ -5,8 +5,14 @@
 #include "CoreMinimal.h"
 #include "AIController.h"
 #include "Perception/AIPerceptionTypes.h"
+#include "BehaviorTree/BehaviorTreeTypes.h"
+#include "AI/NPCTargetMemory.h"
+#include "Navigation/CrowdFollowingComponent.h"
+#include "Data/SettingsTypes.h"
 #include "NPC_AIController.generated.h"
 
+struct FS_GameplaySettings;
+
 /**
  * 
  */
@@ -18,14 +24,103 @@ class ESCAPEIT_API ANPC_AIController : public AAIController
 public:
 	explicit ANPC_AIController(FObjectInitializer const& ObjectInitializer);
 
+	/** Gọi từ UAISignificanceSubsystem khi NPC đổi mức significance */
+	void SetUpdateRates(float BehaviorTreeTickInterval, bool bSightEnabled);
+
+	/**
+	 * Chất lượng avoidance của crowd agent. bSimulationEnabled = false -> chỉ là vật cản cho NPC khác.
+	 * Đổi trạng thái simulation khi đang di chuyển bị hoãn tới lúc move hiện tại kết thúc.
+	 */
+	void SetCrowdAvoidance(ECrowdAvoidanceQuality::Type Quality, bool bSimulationEnabled);
+
+	/**
+	 * Phần ngủ đông của controller (gọi qua ANPC::SetDormant): pause BT và move đang chạy, gỡ sight observer,
+	 * tắt hearing, dừng sync blackboard, trả token director. Blackboard và target memory giữ nguyên.
+	 */
+	void SetDormant(bool bDormant);
+	bool IsDormant() const { return bIsDormant; }
+
+	/** NPC lấy lại từ pool: quên memory, blackboard về mặc định, chạy lại BT từ gốc */
+	void ResetForReuse();
+
+	const FNPCTargetMemory& GetPlayerMemory() const { return PlayerMemory; }
+
+	/** Gọi từ UNPCSightSubsystem khi trace xác nhận thấy/mất dấu; đi qua cùng đường với stimulus perception */
+	void NotifySightChanged(AActor* Target, bool bSeen, const FVector& Location);
+	const FNPCTargetMemory& GetNoiseMemory() const { return NoiseMemory; }
+
+	/**
+	 * Gọi từ USoundPropagationSubsystem khi noise tới được NPC qua phòng/cửa; Location là portal tiếng vọng qua.
+	 * Đi qua cùng đường với stimulus hearing của perception.
+	 */
+	void NotifyNoiseHeard(AActor* Instigator, const FVector& Location, float Loudness);
+
+	/** Tầm nghe hiện tại (cm) theo perception profile và độ khó */
+	float GetHearingRange() const;
+
 protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+	virtual void OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result) override;
+
+	// Blackboard được ghi từ target memory theo chu kỳ này, không phải ở mỗi perception update
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Perception", meta = (ClampMin = "0.01"))
+	float BlackboardSyncInterval = 0.1f;
+
+	// Confidence của player giảm mỗi giây sau khi mất dấu
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Perception", meta = (ClampMin = "0.0"))
+	float PlayerConfidenceDecayPerSecond = 0.2f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Perception", meta = (ClampMin = "0.0"))
+	float NoiseConfidenceDecayPerSecond = 0.1f;
+
 private:
-	class UAISenseConfig_Sight* SightConfig;
 	class UAISenseConfig_Hearing* HearConfig;
 
 	void SetupPerceptionSystem();
 
+	/** Áp perception profile của NPC đang possess theo độ khó hiện tại (sight -> UNPCSightSubsystem, hearing -> perception) */
+	void ApplyPerceptionProfile();
+	EE_DifficultyLevel GetCurrentDifficulty() const;
+
+	UFUNCTION()
+	void HandleGameplaySettingsChanged(const FS_GameplaySettings& NewSettings);
+
 	UFUNCTION()
 	void OnTargetDetected(AActor* Actor, FAIStimulus const Stimulus);
+
+	// ========================== STIMULUS HANDLERS ==========================
+	void RegisterStimulusHandlers();
+	void HandleSightStimulus(AActor* Actor, const FAIStimulus& Stimulus);
+
+	/** Chỉ nhận noise mới khi to hơn noise đang nhớ (đã decay) */
+	void HandleHearingStimulus(AActor* Actor, const FAIStimulus& Stimulus);
+
+	/** Cập nhật/decay memory rồi ghi vào blackboard */
+	void SyncBlackboardFromMemory();
+
+	// ========================== DECISION TRACE ==========================
+	/** Trace đang bật -> theo dõi mọi key trong schema để ghi thay đổi blackboard */
+	void StartDecisionTrace();
+	EBlackboardNotificationResult OnTracedBlackboardKeyChanged(const UBlackboardComponent& BlackboardComp, FBlackboard::FKey ChangedKeyID);
+
+	FNPCStimulusRouter StimulusRouter;
+
+	FNPCTargetMemory PlayerMemory;
+	FNPCTargetMemory NoiseMemory;
+
+	// Noise mới chưa được ghi vào blackboard
+	bool bNoiseMemoryDirty = false;
+
+	FTimerHandle BlackboardSyncTimer;
+	double LastSyncTime = -1.0;
+
+	// Trạng thái crowd chờ áp khi NPC dừng (không đổi được giữa lúc đang đi theo path)
+	TOptional<ECrowdSimulationState> PendingCrowdSimulationState;
+
+	// Giá trị significance muốn, áp lại khi sight observer được đăng ký lại sau ngủ đông
+	bool bSightUpdatesEnabled = true;
+	bool bIsDormant = false;
 };
@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "Engine/EngineBaseTypes.h"
+#include "NavQuerySubsystem.generated.h"
+
+class ANavigationData;
+
+enum class ENavQueryType : uint8
+{
+	// Điểm ngẫu nhiên đi tới được trong Radius quanh Start
+	RandomReachablePoint,
+
+	// Chiếu Start lên navmesh trong Extent
+	Project,
+
+	// Chiều dài path Start -> End
+	PathLength,
+
+	// Raycast trên navmesh Start -> End
+	Raycast
+};
+
+struct FNavQuery
+{
+	ENavQueryType Type = ENavQueryType::Project;
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	float Radius = 0.0f;
+	FVector Extent = FVector(50.0f, 50.0f, 250.0f);
+
+	static FNavQuery RandomReachablePoint(const FVector& Origin, float Radius) { FNavQuery Q; Q.Type = ENavQueryType::RandomReachablePoint; Q.Start = Origin; Q.Radius = Radius; return Q; }
+	static FNavQuery Project(const FVector& Point) { FNavQuery Q; Q.Type = ENavQueryType::Project; Q.Start = Point; return Q; }
+	static FNavQuery PathLength(const FVector& From, const FVector& To) { FNavQuery Q; Q.Type = ENavQueryType::PathLength; Q.Start = From; Q.End = To; return Q; }
+	static FNavQuery Raycast(const FVector& From, const FVector& To) { FNavQuery Q; Q.Type = ENavQueryType::Raycast; Q.Start = From; Q.End = To; return Q; }
+};
+
+struct FNavQueryResult
+{
+	bool bSuccess = false;
+
+	// RandomReachablePoint/Project: điểm tìm được. Raycast: điểm chạm (hoặc End nếu không chạm)
+	FVector Location = FVector::ZeroVector;
+
+	// PathLength
+	float PathLength = 0.0f;
+
+	// Raycast: true nếu tia bị chặn
+	bool bHit = false;
+};
+
+DECLARE_DELEGATE_OneParam(FOnNavQueryBatchComplete, TConstArrayView<FNavQueryResult>);
+
+/**
+ * Chạy nav query theo batch thay vì gọi đồng bộ trên game thread.
+ * Navmesh tĩnh: query chạy trên worker thread, game thread chỉ gửi batch và trả kết quả.
+ * Navmesh build lúc runtime: không đọc an toàn từ worker được, chạy trên game thread trong GameThreadBudgetMs mỗi frame.
+ * Callback luôn được gọi trên game thread, trong budget, ở frame sau khi batch xong.
+ */
+UCLASS()
+class ESCAPEIT_API UNavQuerySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UNavQuerySubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== BATCH ==========================
+	/** Trả về id của batch (0 = không gửi được) */
+	uint32 SubmitBatch(TArray<FNavQuery> Queries, FOnNavQueryBatchComplete OnComplete);
+
+	/** Huỷ batch; callback sẽ không được gọi */
+	void CancelBatch(uint32 BatchId);
+
+	int32 GetNumPendingQueries() const { return NumPendingQueries; }
+
+	/** Thời gian game thread của subsystem ở frame trước (gom kết quả worker + Tick) */
+	double GetLastFrameGameThreadMs() const { return LastFrameGameThreadMs; }
+
+	// ========================== STRESS ==========================
+	/**
+	 * Gửi NumQueries query (đủ 4 loại) quanh player. Mỗi frame tới khi batch trả kết quả đo thời gian game thread
+	 * của subsystem, cuối cùng so frame tệ nhất với MaxGameThreadMs (FAILED nếu vượt)
+	 */
+	void RunStressTest(int32 NumQueries, float MaxGameThreadMs);
+
+	// ========================== SETTINGS ==========================
+	// Thời gian tối đa trên game thread mỗi frame (chạy query khi không dùng worker + gọi callback)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Navigation", meta = (ClampMin = "0.01"))
+	float GameThreadBudgetMs = 0.5f;
+
+	// Số query tối đa gửi cho worker mỗi frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Navigation", meta = (ClampMin = "1"))
+	int32 MaxWorkerQueriesPerFrame = 512;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Navigation")
+	bool bUseWorkerThreads = true;
+
+	/** Thực thi một query; an toàn trên worker khi navmesh không bị sửa trong lúc chạy */
+	static void ExecuteQuery(const ANavigationData& NavData, const FNavQuery& Query, FNavQueryResult& OutResult);
+
+private:
+	struct FBatch
+	{
+		uint32 Id = 0;
+		TArray<FNavQuery> Queries;
+		TArray<FNavQueryResult> Results;
+		FOnNavQueryBatchComplete OnComplete;
+
+		// Query tiếp theo chưa được chạy/gửi đi
+		int32 NextQuery = 0;
+
+		// Query đã có kết quả (worker ghi, game thread đọc sau khi task xong)
+		int32 NumCompleted = 0;
+
+		bool bCancelled = false;
+	};
+
+	/** Đoạn query của một batch được gửi cho worker */
+	struct FWorkItem
+	{
+		TSharedPtr<FBatch> Batch;
+		int32 First = 0;
+		int32 Count = 0;
+	};
+
+	void HandleWorldTickStart(UWorld* TickedWorld, ELevelTick TickType, float DeltaSeconds);
+
+	const ANavigationData* GetNavData() const;
+	bool CanUseWorkerThreads(const ANavigationData& NavData) const;
+
+	/** Chạy/gửi query và trả callback trong GameThreadBudgetMs */
+	void TickQueries();
+
+	/** Gom kết quả của task worker đã xong */
+	void CollectWorkerResults();
+	void DispatchToWorkers(const ANavigationData& NavData);
+	void RunOnGameThread(const ANavigationData& NavData, double EndTime);
+	void DeliverCompletedBatches(double EndTime);
+
+	/** Ghi chi phí frame vừa xong vào stress test đang chạy, report khi batch đã trả kết quả */
+	void UpdateStressTest();
+
+	TArray<TSharedPtr<FBatch>> Batches;
+	uint32 NextBatchId = 1;
+	int32 NumPendingQueries = 0;
+
+	// Chỉ một task worker mỗi lúc; game thread không đụng tới InFlight cho tới khi task xong
+	UE::Tasks::FTask WorkerTask;
+	TArray<FWorkItem> InFlight;
+
+	FDelegateHandle WorldTickStartHandle;
+	FDelegateHandle PreGarbageCollectHandle;
+
+	// Cộng dồn từ HandleWorldTickStart tới hết Tick của frame hiện tại
+	double FrameGameThreadMs = 0.0;
+	double LastFrameGameThreadMs = 0.0;
+
+	struct FStressRun
+	{
+		uint32 BatchId = 0;
+		int32 NumQueries = 0;
+		float MaxGameThreadMs = 0.0f;
+		double StartTime = 0.0;
+
+		int32 NumFrames = 0;
+		double TotalGameThreadMs = 0.0;
+		double PeakGameThreadMs = 0.0;
+
+		// INDEX_NONE cho tới khi callback của batch chạy
+		int32 NumSucceeded = INDEX_NONE;
+	};
+	FStressRun Stress;
+};
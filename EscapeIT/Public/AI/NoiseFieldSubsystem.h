@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "NoiseFieldSubsystem.generated.h"
+
+class FAutomationTestBase;
+
+UENUM(BlueprintType)
+enum class ENoiseSource : uint8
+{
+	Footstep     UMETA(DisplayName = "Footstep"),
+	Jump         UMETA(DisplayName = "Jump"),
+	Door         UMETA(DisplayName = "Door"),
+	DroppedItem  UMETA(DisplayName = "Dropped Item"),
+	JumpScare    UMETA(DisplayName = "Jump Scare"),
+	Other        UMETA(DisplayName = "Other")
+};
+
+/** Một điểm nóng: các noise gần nhau gộp lại, loudness giảm dần theo thời gian */
+struct FNoiseCluster
+{
+	// Tâm có trọng số theo loudness của các event đã gộp
+	FVector Location = FVector::ZeroVector;
+
+	// Loudness hiện tại (đã decay)
+	float Loudness = 0.0f;
+
+	// Nguồn/instigator của event to nhất trong cluster
+	ENoiseSource Source = ENoiseSource::Other;
+	TWeakObjectPtr<AActor> Instigator;
+
+	int32 NumEvents = 0;
+
+	// Tổng trọng số dùng để dời tâm
+	float Weight = 0.0f;
+
+	// Có event mới từ lần report trước
+	bool bPendingReport = false;
+};
+
+/**
+ * Gom noise từ footstep, cửa, đồ rơi, jumpscare... thành vài cluster.
+ * Thay vì mỗi event gọi thẳng UAISense_Hearing (fan-out tới mọi listener), mỗi ReportInterval
+ * chỉ report tối đa MaxReportsPerInterval cluster to nhất có event mới.
+ * Level đã bake sound portal graph -> report qua USoundPropagationSubsystem (theo phòng/cửa).
+ */
+UCLASS()
+class ESCAPEIT_API UNoiseFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UNoiseFieldSubsystem();
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UNoiseFieldSubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== NOISE ==========================
+	/** Loudness gốc nhân với hệ số của Surface trước khi gộp */
+	void ReportNoise(const FVector& Location, float Loudness, AActor* Instigator, ENoiseSource Source, EPhysicalSurface Surface = SurfaceType_Default);
+
+	UFUNCTION(BlueprintCallable, Category = "AI|Noise", meta = (DisplayName = "Report Noise"))
+	void K2_ReportNoise(FVector Location, float Loudness, AActor* Instigator, ENoiseSource Source) { ReportNoise(Location, Loudness, Instigator, Source); }
+
+	float GetSurfaceMultiplier(EPhysicalSurface Surface) const;
+
+	/** Loudness còn lại sau Seconds giây */
+	float GetDecayedLoudness(float Loudness, float Seconds) const { return FMath::Max(0.0f, Loudness - DecayPerSecond * Seconds); }
+
+	TConstArrayView<FNoiseCluster> GetClusters() const { return Clusters; }
+
+	// ========================== VALIDATION ==========================
+	/**
+	 * Kiểm tra gộp cluster, thay cluster khi đầy, decay và việc cluster chưa được report còn chờ tới lần sau.
+	 * Chạy trên cluster tạm (không gửi noise cho listener); cluster và settings hiện tại được khôi phục sau đó.
+	 * Test != null thì mỗi check fail là một lỗi của test (automation test EscapeIT.AI.NoiseField).
+	 */
+	bool RunValidation(FAutomationTestBase* Test = nullptr);
+
+	// ========================== SETTINGS ==========================
+	// Event cách tâm cluster trong khoảng này thì gộp vào
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Noise", meta = (ClampMin = "0.0"))
+	float ClusterRadius = 400.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Noise", meta = (ClampMin = "1"))
+	int32 MaxClusters = 8;
+
+	// Loudness giảm tuyến tính mỗi giây
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Noise", meta = (ClampMin = "0.0"))
+	float DecayPerSecond = 0.5f;
+
+	// Dưới mức này thì bỏ event/cluster
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Noise", meta = (ClampMin = "0.0"))
+	float MinLoudness = 0.05f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Noise", meta = (ClampMin = "0.0"))
+	float ReportInterval = 0.2f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Noise", meta = (ClampMin = "1"))
+	int32 MaxReportsPerInterval = 2;
+
+	// Hệ số loudness theo bề mặt (SurfaceType1..6 giống UFootstepComponent); không có -> 1
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Noise")
+	TMap<TEnumAsByte<EPhysicalSurface>, float> SurfaceLoudness;
+
+private:
+	/** Giảm loudness theo thời gian và bỏ cluster dưới MinLoudness */
+	void DecayClusters(float DeltaTime);
+
+	/** Lấy tối đa MaxReportsPerInterval cluster to nhất có event mới; chỉ các cluster này hết pending */
+	void CollectPendingReports(TArray<FNoiseCluster, TInlineAllocator<4>>& OutReports);
+
+	void ReportPendingClusters();
+
+	TArray<FNoiseCluster> Clusters;
+
+	// Index cluster cần report (giữ capacity giữa các lần)
+	TArray<int32> PendingReports;
+
+	float TimeSinceReport = 0.0f;
+};
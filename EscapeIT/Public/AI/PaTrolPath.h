@@ -17,6 +17,9 @@ public:
 
 	FVector GetPatrolPoint(int const index) const;
 	int Num() const;
+
+	/** Điểm local space; dùng khi dựng path bằng code (vd. map test của ANPCCrowdBenchmark) */
+	void SetPatrolPoints(TArray<FVector> InPatrolPoints) { PatrolPoints = MoveTemp(InPatrolPoints); }
 private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI", meta = (MakeEditWidget = "true", AllowPrivateAccess = "true"))
 	TArray<FVector> PatrolPoints;
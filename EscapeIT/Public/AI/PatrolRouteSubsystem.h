@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "PatrolRouteSubsystem.generated.h"
+
+class APaTrolPath;
+class ANavigationData;
+
+/** Path navmesh đã tính sẵn giữa hai patrol point liên tiếp */
+struct FBakedPatrolSegment
+{
+	// Điểm của path (world space), đầu = point From, cuối = point To
+	TArray<FVector> PathPoints;
+
+	float Length = 0.0f;
+	float Cost = 0.0f;
+
+	// Path đầy đủ (không partial) tới được point To
+	bool bReachable = false;
+};
+
+/** Patrol route đã bake: point world space + segment i -> (i + 1) % Num */
+struct FBakedPatrolRoute
+{
+	// Đã chiếu lên navmesh nếu được
+	TArray<FVector> WorldPoints;
+
+	// Point không chiếu được lên navmesh
+	TArray<bool> bPointOnNavmesh;
+
+	TArray<FBakedPatrolSegment> Segments;
+
+	// Chiều dài một vòng (tổng các segment tới được)
+	float TotalLength = 0.0f;
+
+	int32 NumUnreachableSegments = 0;
+	int32 NumOffNavmeshPoints = 0;
+
+	bool IsValidIndex(int32 Index) const { return WorldPoints.IsValidIndex(Index); }
+
+	/**
+	 * Segment giữa hai point kề nhau (theo chiều nào cũng được).
+	 * bOutReversed = true nếu phải đi ngược PathPoints của segment trả về.
+	 */
+	const FBakedPatrolSegment* FindSegment(int32 FromIndex, int32 ToIndex, bool& bOutReversed) const;
+};
+
+/**
+ * Bake APaTrolPath thành point world space + path navmesh cho từng segment, một lần cho mỗi lần build navmesh.
+ * NPC đi theo path đã bake (UBTTask_MoveAlongPatrolRoute) nên không phải search path lúc runtime.
+ */
+UCLASS()
+class ESCAPEIT_API UPatrolRouteSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	static UPatrolRouteSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Route đã bake (bake ở lần gọi đầu hoặc sau khi navmesh build lại). Null nếu không có navmesh */
+	const FBakedPatrolRoute* GetRoute(const APaTrolPath* PatrolPath);
+
+	/** Bake không cache; dùng cho commandlet */
+	static bool BakeRoute(UWorld* World, const APaTrolPath& PatrolPath, FBakedPatrolRoute& OutRoute);
+
+	/** Gọi mỗi lần NPC đi theo segment đã bake thay vì search path */
+	void NotifyBakedSegmentUsed();
+
+	int32 GetNumQueriesSaved() const { return NumQueriesSaved; }
+	int32 GetNumBakedRoutes() const { return Routes.Num(); }
+
+private:
+	/** Navmesh build lại -> bỏ toàn bộ route, bake lại ở lần dùng tới */
+	UFUNCTION()
+	void HandleNavigationGenerationFinished(ANavigationData* NavData);
+
+	TMap<TObjectKey<APaTrolPath>, TUniquePtr<FBakedPatrolRoute>> Routes;
+
+	int32 NumQueriesSaved = 0;
+};
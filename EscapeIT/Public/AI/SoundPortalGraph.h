@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SoundPortalGraph.generated.h"
+
+class ADoor;
+
+USTRUCT(BlueprintType)
+struct ESCAPEIT_API FSoundPortalBakeSettings
+{
+	GENERATED_BODY()
+
+	// Dò phòng ở hai bên cửa cách tâm cửa khoảng này (dọc trục X rồi trục Y của actor)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|SoundPropagation", meta = (ClampMin = "1.0"))
+	float ProbeDistance = 100.0f;
+
+	// Điểm dò nâng lên khỏi pivot của cửa (pivot thường nằm sát sàn)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|SoundPropagation", meta = (ClampMin = "0.0"))
+	float ProbeHeight = 100.0f;
+};
+
+/**
+ * Room-and-portal graph cho lan truyền âm thanh, đã bake từ ASoundRoomVolume, ADoor và ASoundPortalPoint.
+ * Phòng là box có hướng (transform + bounds local của volume); điểm không nằm trong phòng nào thuộc
+ * "bên ngoài" (index = NumRooms()). Portal nối đúng hai phòng; danh sách portal của phòng i lưu dạng CSR
+ * trong [RoomPortalOffsets[i], RoomPortalOffsets[i + 1]), có cả phòng bên ngoài.
+ */
+USTRUCT()
+struct ESCAPEIT_API FSoundPortalGraph
+{
+	GENERATED_BODY()
+
+	// ---- Phòng (SoA), sắp theo Priority giảm dần: phòng lồng trong phòng khác được tìm thấy trước ----
+	UPROPERTY(VisibleAnywhere, Category = "AI|SoundPropagation")
+	TArray<FName> RoomNames;
+
+	UPROPERTY()
+	TArray<FTransform> RoomTransforms;
+
+	UPROPERTY()
+	TArray<FBox> RoomBounds;
+
+	// ---- Portal (SoA) ----
+	UPROPERTY(VisibleAnywhere, Category = "AI|SoundPropagation")
+	TArray<FVector> PortalLocations;
+
+	UPROPERTY()
+	TArray<int32> PortalRoomA;
+
+	UPROPERTY()
+	TArray<int32> PortalRoomB;
+
+	// Soft: graph không bị stream theo cell, không được kéo mọi cửa trong World Partition theo. Null = lối đi hở
+	UPROPERTY(VisibleAnywhere, Category = "AI|SoundPropagation")
+	TArray<TSoftObjectPtr<ADoor>> PortalDoors;
+
+	// Penalty cố định của lối đi hở (cửa thì tính theo trạng thái lúc chạy)
+	UPROPERTY()
+	TArray<float> PortalBasePenalties;
+
+	UPROPERTY()
+	TArray<int32> RoomPortalOffsets;
+
+	UPROPERTY()
+	TArray<int32> RoomPortals;
+
+	int32 NumRooms() const { return RoomTransforms.Num(); }
+	int32 NumPortals() const { return PortalLocations.Num(); }
+	int32 GetOutsideRoom() const { return NumRooms(); }
+
+	bool IsValid() const
+	{
+		return NumRooms() > 0 && RoomBounds.Num() == NumRooms() && RoomPortalOffsets.Num() == NumRooms() + 2;
+	}
+
+	TConstArrayView<int32> GetRoomPortals(int32 Room) const
+	{
+		return MakeArrayView(RoomPortals.GetData() + RoomPortalOffsets[Room], RoomPortalOffsets[Room + 1] - RoomPortalOffsets[Room]);
+	}
+
+	/** Phòng đầu tiên chứa Location, GetOutsideRoom() nếu không có */
+	int32 FindRoom(const FVector& Location) const;
+
+	/** Thêm phòng từ transform + bounds local */
+	int32 AddRoom(FName Name, const FTransform& Transform, const FBox& LocalBounds);
+
+	/** Thêm portal giữa hai phòng khác nhau; gọi BuildRoomPortals sau khi thêm xong */
+	int32 AddPortal(const FVector& Location, int32 RoomA, int32 RoomB, const TSoftObjectPtr<ADoor>& Door, float BasePenalty);
+
+	/** Dựng CSR phòng -> portal từ PortalRoomA/B */
+	void BuildRoomPortals();
+
+	void Reset() { *this = FSoundPortalGraph(); }
+};
+
+/**
+ * Giữ sound portal graph đã bake của level (ghi bởi SoundPortalBake commandlet, lưu cùng map).
+ * Đăng ký với USoundPropagationSubsystem khi BeginPlay.
+ */
+UCLASS()
+class ESCAPEIT_API ASoundPortalGraphActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ASoundPortalGraphActor();
+
+	const FSoundPortalGraph& GetGraph() const { return Graph; }
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|SoundPropagation")
+	FSoundPortalBakeSettings BakeSettings;
+
+	UPROPERTY(VisibleAnywhere, Category = "AI|SoundPropagation")
+	FSoundPortalGraph Graph;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SoundPortalPoint.generated.h"
+
+/**
+ * Lối đi hở giữa hai ASoundRoomVolume (cổng vòm, cửa sổ vỡ, ống thông gió) - chỗ không có ADoor.
+ * Đặt ở giữa lối đi, trục X hoặc Y hướng sang hai phòng. Chỉ dùng lúc bake (SoundPortalBake commandlet).
+ */
+UCLASS()
+class ESCAPEIT_API ASoundPortalPoint : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ASoundPortalPoint();
+
+	float GetPenalty() const { return Penalty; }
+
+private:
+	// Quãng đường (cm) cộng thêm khi âm thanh đi qua: 0 = lối đi trống, lớn hơn cho lỗ thông gió/cửa sổ
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI", meta = (ClampMin = "0.0", AllowPrivateAccess = "true"))
+	float Penalty = 0.0f;
+};
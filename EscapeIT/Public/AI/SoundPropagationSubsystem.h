@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AI/SoundPortalGraph.h"
+#include "SoundPropagationSubsystem.generated.h"
+
+class ADoor;
+class ASoundRoomVolume;
+class ASoundPortalPoint;
+
+/** Kết quả bake để commandlet báo cáo */
+struct FSoundPortalBakeReport
+{
+	int32 NumRooms = 0;
+	int32 NumDoorPortals = 0;
+	int32 NumOpenPortals = 0;
+
+	// Cửa/lối đi mà hai bên không thuộc hai phòng khác nhau (index trong mảng đầu vào)
+	TArray<int32> UnlinkedDoors;
+	TArray<int32> UnlinkedOpenings;
+
+	// Phòng không có portal nào: âm thanh không vào/ra được
+	TArray<int32> IsolatedRooms;
+};
+
+/** Âm thanh đi từ nguồn tới listener theo graph */
+struct FSoundPropagationResult
+{
+	// Quãng đường qua các portal, đã cộng penalty; MAX_flt nếu không có đường hoặc đường thẳng đã quá tầm nghe
+	float EffectiveDistance = MAX_flt;
+
+	// Loudness nhân với tỉ lệ đường thẳng / đường thật: tường và cửa đóng làm tiếng nhỏ đi
+	float Loudness = 0.0f;
+
+	// Chỗ listener nghe thấy tiếng: portal cuối cùng âm thanh đi qua, hoặc chính nguồn nếu cùng phòng
+	FVector PerceivedLocation = FVector::ZeroVector;
+	int32 ArrivalPortal = INDEX_NONE;
+
+	int32 SourceRoom = INDEX_NONE;
+	int32 ListenerRoom = INDEX_NONE;
+};
+
+/**
+ * Tính đường âm thanh trên một FSoundPortalGraph. Không phụ thuộc world -> kiểm tra được độc lập
+ * (ai.SoundPropagation.Validate).
+ *
+ * Khoảng cách portal -> portal (Dijkstra trên graph portal, cạnh = đường thẳng giữa hai portal cùng phòng
+ * + nửa penalty mỗi đầu) được cache theo từng hàng, chỉ tính khi cần; đổi penalty một portal xóa cache.
+ */
+struct ESCAPEIT_API FSoundPropagationSolver
+{
+	void Initialize(const FSoundPortalGraph& Graph);
+	void Reset();
+
+	int32 NumPortals() const { return Penalties.Num(); }
+
+	/** Đổi penalty (cm) của portal; cache chỉ bị xóa khi giá trị thật sự đổi */
+	void SetPortalPenalty(int32 Portal, float Penalty);
+	float GetPortalPenalty(int32 Portal) const { return Penalties[Portal]; }
+
+	/** Từ portal From qua tới portal To, gồm nửa penalty hai đầu và penalty các portal ở giữa. MAX_flt nếu không tới được */
+	float GetPortalDistance(int32 From, int32 To);
+
+	/** true nếu listener nghe được: EffectiveDistance <= HearingRange * Loudness (giống UAISense_Hearing) */
+	bool Propagate(const FSoundPortalGraph& Graph, const FVector& Source, const FVector& Listener, float Loudness, float HearingRange,
+		FSoundPropagationResult& OutResult);
+
+	/** Số hàng đã tính lại từ lần Initialize (để benchmark thấy cache có tác dụng) */
+	int32 GetNumRowsBuilt() const { return NumRowsBuilt; }
+
+private:
+	void BuildRow(int32 Portal);
+
+	TArray<float> Penalties;
+
+	// Portal kề nhau (chung một phòng), CSR
+	TArray<int32> LinkOffsets;
+	TArray<int32> LinkTargets;
+	TArray<float> LinkDistances;
+
+	// NumPortals x NumPortals, hàng i hợp lệ khi ValidRows[i]
+	TArray<float> Distances;
+	TBitArray<> ValidRows;
+
+	struct FOpenPortal
+	{
+		float Cost;
+		int32 Portal;
+
+		bool operator<(const FOpenPortal& Other) const { return Cost < Other.Cost; }
+	};
+	TArray<FOpenPortal> OpenList;
+
+	int32 NumRowsBuilt = 0;
+};
+
+/**
+ * Lan truyền noise theo phòng và portal thay vì đường thẳng: NPC không nghe xuyên tường, cửa đóng/khóa
+ * làm tiếng nhỏ đi, và NPC đi tới cửa mà tiếng vọng qua thay vì tới thẳng nguồn.
+ * Level chưa bake graph -> UNoiseFieldSubsystem dùng UAISense_Hearing như cũ.
+ */
+UCLASS()
+class ESCAPEIT_API USoundPropagationSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	static USoundPropagationSubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== GRAPH ==========================
+	void RegisterGraph(const ASoundPortalGraphActor* GraphActor);
+	void UnregisterGraph(const ASoundPortalGraphActor* GraphActor);
+
+	/** Graph đang dùng, null nếu level chưa bake */
+	const FSoundPortalGraph* GetGraph() const;
+
+	/** Bake graph từ volume, cửa và lối đi hở; dùng cho commandlet. Trả về false nếu không có phòng nào */
+	static bool BakeGraph(TConstArrayView<const ASoundRoomVolume*> Rooms, TConstArrayView<const ADoor*> Doors,
+		TConstArrayView<const ASoundPortalPoint*> Openings, const FSoundPortalBakeSettings& Settings,
+		FSoundPortalGraph& OutGraph, FSoundPortalBakeReport& OutReport);
+
+	// ========================== PROPAGATION ==========================
+	/** Trạng thái cửa được đọc lại tối đa một lần mỗi frame trước khi tính */
+	bool Propagate(const FVector& Source, const FVector& Listener, float Loudness, float HearingRange, FSoundPropagationResult& OutResult);
+
+	/**
+	 * Gửi noise tới từng NPC đã đăng ký với UAIWorldStateSubsystem theo graph (NPC ngủ đông bị bỏ qua).
+	 * false nếu level chưa bake -> caller tự report qua UAISense_Hearing.
+	 */
+	bool BroadcastNoise(const FVector& Location, float Loudness, AActor* Instigator);
+
+	/** Chạy NumQueries lần Propagate giữa các điểm ngẫu nhiên trong phòng, log thời gian trung bình/tối đa (console + commandlet) */
+	void RunBenchmark(int32 NumQueries);
+
+	// ========================== SETTINGS ==========================
+	// Penalty (cm) cộng vào quãng đường khi âm thanh đi qua cửa
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|SoundPropagation", meta = (ClampMin = "0.0"))
+	float OpenDoorPenalty = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|SoundPropagation", meta = (ClampMin = "0.0"))
+	float ClosedDoorPenalty = 1500.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|SoundPropagation", meta = (ClampMin = "0.0"))
+	float LockedDoorPenalty = 2500.0f;
+
+private:
+	/** Đọc trạng thái cửa hiện tại vào penalty của solver */
+	void RefreshPortalPenalties();
+	float GetDoorPenalty(const ADoor* Door) const;
+
+	TWeakObjectPtr<const ASoundPortalGraphActor> GraphActor;
+
+	// Cửa đã resolve từ soft pointer của graph (cửa chưa load -> coi như đóng)
+	TArray<TWeakObjectPtr<ADoor>> PortalDoors;
+
+	FSoundPropagationSolver Solver;
+	uint64 RefreshedFrame = MAX_uint64;
+};
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Volume.h"
+#include "SoundRoomVolume.generated.h"
+
+/**
+ * Một phòng cho lan truyền âm thanh. Bake thành box có hướng (bounds local của brush), nên brush
+ * không phải hình hộp thì chia thành nhiều volume. Chỉ dùng lúc bake (SoundPortalBake commandlet).
+ */
+UCLASS()
+class ESCAPEIT_API ASoundRoomVolume : public AVolume
+{
+	GENERATED_BODY()
+
+public:
+	ASoundRoomVolume();
+
+	int32 GetPriority() const { return Priority; }
+
+private:
+	// Volume chồng lên nhau: priority cao hơn thắng (tủ, phòng nhỏ nằm trong hành lang lớn)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI", meta = (AllowPrivateAccess = "true"))
+	int32 Priority = 0;
+};
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TacticalSearchGraph.generated.h"
+
+UENUM(BlueprintType)
+enum class ETacticalNodeType : uint8
+{
+	Room,
+	Doorway,
+	HidingSpot,
+
+	Count UMETA(Hidden)
+};
+
+USTRUCT(BlueprintType)
+struct ESCAPEIT_API FTacticalSearchBakeSettings
+{
+	GENERATED_BODY()
+
+	// Chỉ nối hai node cách nhau (đường thẳng) không quá khoảng này
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "0.0"))
+	float MaxLinkDistance = 2500.0f;
+
+	// Path navmesh dài hơn đường thẳng quá hệ số này thì không nối (đi vòng qua node khác)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "1.0"))
+	float MaxDetourFactor = 1.6f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "0.0"))
+	float MaxSightDistance = 3000.0f;
+
+	// Độ cao mắt so với node khi trace sight line
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "0.0"))
+	float EyeHeight = 150.0f;
+};
+
+/**
+ * Tactical graph đã bake cho một level: node (phòng, cửa, chỗ nấp), cạnh đi được trên navmesh và sight line.
+ * Cạnh/sight line lưu dạng CSR: của node i nằm trong [Offsets[i], Offsets[i + 1]).
+ */
+USTRUCT()
+struct ESCAPEIT_API FTacticalSearchGraph
+{
+	GENERATED_BODY()
+
+	// ---- Node (SoA), vị trí đã chiếu lên navmesh ----
+	UPROPERTY(VisibleAnywhere, Category = "AI|TacticalSearch")
+	TArray<FVector> NodeLocations;
+
+	UPROPERTY(VisibleAnywhere, Category = "AI|TacticalSearch")
+	TArray<ETacticalNodeType> NodeTypes;
+
+	UPROPERTY(VisibleAnywhere, Category = "AI|TacticalSearch")
+	TArray<float> NodeWeights;
+
+	// ---- Cạnh đi được, cost = chiều dài path navmesh ----
+	UPROPERTY()
+	TArray<int32> EdgeOffsets;
+
+	UPROPERTY()
+	TArray<int32> EdgeTargets;
+
+	UPROPERTY()
+	TArray<float> EdgeCosts;
+
+	// ---- Sight line: đứng ở node i nhìn thấy node nào ----
+	UPROPERTY()
+	TArray<int32> SightOffsets;
+
+	UPROPERTY()
+	TArray<int32> SightTargets;
+
+	int32 Num() const { return NodeLocations.Num(); }
+
+	bool IsValid() const
+	{
+		return Num() > 0 && EdgeOffsets.Num() == Num() + 1 && SightOffsets.Num() == Num() + 1;
+	}
+
+	TConstArrayView<int32> GetNeighbors(int32 Node) const
+	{
+		return MakeArrayView(EdgeTargets.GetData() + EdgeOffsets[Node], EdgeOffsets[Node + 1] - EdgeOffsets[Node]);
+	}
+
+	TConstArrayView<float> GetNeighborCosts(int32 Node) const
+	{
+		return MakeArrayView(EdgeCosts.GetData() + EdgeOffsets[Node], EdgeOffsets[Node + 1] - EdgeOffsets[Node]);
+	}
+
+	TConstArrayView<int32> GetVisibleNodes(int32 Node) const
+	{
+		return MakeArrayView(SightTargets.GetData() + SightOffsets[Node], SightOffsets[Node + 1] - SightOffsets[Node]);
+	}
+
+	/** Node gần Location nhất trong MaxDistance, INDEX_NONE nếu không có */
+	int32 FindNearestNode(const FVector& Location, float MaxDistance) const;
+
+	void Reset() { *this = FTacticalSearchGraph(); }
+};
+
+/**
+ * Giữ tactical graph đã bake của level (ghi bởi TacticalSearchBake commandlet, lưu cùng map).
+ * Đăng ký với UTacticalSearchSubsystem khi BeginPlay.
+ */
+UCLASS()
+class ESCAPEIT_API ATacticalSearchGraphActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATacticalSearchGraphActor();
+
+	const FTacticalSearchGraph& GetGraph() const { return Graph; }
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch")
+	FTacticalSearchBakeSettings BakeSettings;
+
+	UPROPERTY(VisibleAnywhere, Category = "AI|TacticalSearch")
+	FTacticalSearchGraph Graph;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AI/TacticalSearchGraph.h"
+#include "TacticalSearchPoint.generated.h"
+
+/**
+ * Điểm đặt tay trong level cho tactical search graph (phòng, cửa, chỗ nấp).
+ * Chỉ dùng lúc bake (TacticalSearchBake commandlet), không có trong bản cook.
+ */
+UCLASS()
+class ESCAPEIT_API ATacticalSearchPoint : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATacticalSearchPoint();
+
+	ETacticalNodeType GetNodeType() const { return NodeType; }
+	float GetSearchWeight() const { return SearchWeight; }
+
+private:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI", meta = (AllowPrivateAccess = "true"))
+	ETacticalNodeType NodeType = ETacticalNodeType::Room;
+
+	// Nhân thêm vào trọng số theo loại node (chỗ nấp "ngon" hơn thì để cao)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI", meta = (ClampMin = "0.0", AllowPrivateAccess = "true"))
+	float SearchWeight = 1.0f;
+};
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AI/TacticalSearchGraph.h"
+#include "TacticalSearchSubsystem.generated.h"
+
+class ATacticalSearchPoint;
+
+/** Kết quả bake để commandlet báo cáo */
+struct FTacticalSearchBakeReport
+{
+	int32 NumNodes = 0;
+	int32 NumEdges = 0;
+	int32 NumSightLines = 0;
+	int32 NumNavQueries = 0;
+
+	// Point không chiếu được lên navmesh / node không có cạnh nào
+	TArray<int32> OffNavmeshNodes;
+	TArray<int32> IsolatedNodes;
+};
+
+/**
+ * Lập kế hoạch lục soát sau khi NPC mất dấu player, dựa trên tactical graph đã bake của level.
+ * Dijkstra từ node gần vị trí cuối cùng, rồi chọn tham lam node có điểm cao nhất (loại node, khoảng cách,
+ * hướng player chạy); node nhìn thấy được từ điểm đã chọn coi như đã lục soát.
+ * Không sample navmesh ngẫu nhiên, không query navmesh lúc runtime.
+ */
+UCLASS()
+class ESCAPEIT_API UTacticalSearchSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	static UTacticalSearchSubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== GRAPH ==========================
+	void RegisterGraph(const ATacticalSearchGraphActor* GraphActor);
+	void UnregisterGraph(const ATacticalSearchGraphActor* GraphActor);
+
+	/** Graph đang dùng, null nếu level chưa bake */
+	const FTacticalSearchGraph* GetGraph() const;
+
+	/** Bake graph từ các marker; dùng cho commandlet. Trả về false nếu không có navmesh */
+	static bool BakeGraph(UWorld* World, TConstArrayView<const ATacticalSearchPoint*> Points, const FTacticalSearchBakeSettings& Settings,
+		FTacticalSearchGraph& OutGraph, FTacticalSearchBakeReport& OutReport);
+
+	// ========================== PLANNING ==========================
+	/**
+	 * Ghi các điểm cần lục soát (theo thứ tự) vào OutPoints, tối đa OutPoints.Num().
+	 * LastKnownVelocity dùng để ưu tiên hướng player đang chạy. Trả về số điểm đã ghi.
+	 */
+	int32 PlanSearch(const FVector& LastKnownLocation, const FVector& LastKnownVelocity, TArrayView<FVector> OutPoints);
+
+	/** Lập NumPlans kế hoạch từ vị trí ngẫu nhiên quanh các node, log thời gian trung bình/tối đa (console + commandlet) */
+	void RunBenchmark(int32 NumPlans);
+
+	// ========================== SETTINGS ==========================
+	// Vị trí cuối cùng cách node gần nhất xa hơn khoảng này thì không lập kế hoạch
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "0.0"))
+	float MaxStartDistance = 1500.0f;
+
+	// Chỉ xét node có path cost (cm) từ node bắt đầu không quá khoảng này
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "0.0"))
+	float MaxSearchCost = 6000.0f;
+
+	// Path cost tại đó điểm của node giảm một nửa
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "1.0"))
+	float CostFalloff = 1500.0f;
+
+	// Điểm cộng tối đa cho node nằm đúng hướng player đang chạy
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "0.0"))
+	float HeadingBias = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "0.0"))
+	float RoomWeight = 0.6f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "0.0"))
+	float DoorwayWeight = 0.3f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|TacticalSearch", meta = (ClampMin = "0.0"))
+	float HidingSpotWeight = 1.0f;
+
+private:
+	float GetTypeWeight(ETacticalNodeType Type) const;
+
+	TWeakObjectPtr<const ATacticalSearchGraphActor> GraphActor;
+
+	// Bộ nhớ tạm của planner, giữ lại giữa các lần gọi để không cấp phát
+	struct FOpenNode
+	{
+		float Cost;
+		int32 Node;
+
+		bool operator<(const FOpenNode& Other) const { return Cost < Other.Cost; }
+	};
+
+	TArray<float> Costs;
+	TArray<float> Scores;
+	TArray<int32> Reached;
+	TArray<FOpenNode> OpenList;
+	TBitArray<> Cleared;
+};
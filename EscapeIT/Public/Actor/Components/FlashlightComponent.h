@@ -4,6 +4,7 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Data/ItemData.h"
+#include "Data/BatteryProfile.h"
 #include "FlashlightComponent.generated.h"
 
 // Forward declarations
@@ -39,6 +40,7 @@ public:
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
@@ -62,8 +64,13 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Flashlight|Battery")
     void AddBatteryCharge(float ChargePercent);
 
+    /** Lắp pin mới (FreshCharge 0..1). Trả về ID pin vừa tháo (vẫn còn trong UBatterySubsystem), invalid nếu pin cũ đã cạn */
     UFUNCTION(BlueprintCallable, Category = "Flashlight|Battery")
-    void ReplaceBattery();
+    FGuid ReplaceBattery(float FreshCharge = 1.0f);
+
+    /** Lắp một viên pin đã có trong UBatterySubsystem (pin lấy từ inventory), giữ nguyên charge/tuổi của nó. Trả về như ReplaceBattery */
+    UFUNCTION(BlueprintCallable, Category = "Flashlight|Battery")
+    FGuid SwapBattery(FGuid NewBatteryId);
 
     // ============================================
     // PUBLIC API - Getters
@@ -96,6 +103,9 @@ public:
     UFUNCTION(BlueprintPure, Category = "Flashlight|Battery")
     bool IsBatteryDepleted() const;
 
+    UFUNCTION(BlueprintPure, Category = "Flashlight|Battery")
+    FGuid GetInstalledBatteryId() const { return InstalledBatteryId; }
+
     UFUNCTION(BlueprintPure, Category = "Flashlight")
     UAnimMontage* GetEquipAnimation() const { return EquipFlashlightAnim; }
 
@@ -131,6 +141,11 @@ public:
     // CONFIGURATION - Battery
     // ============================================
 
+    // Curve xả pin. Để trống = xả tuyến tính theo ItemData.BatteryDuration
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Flashlight|Battery")
+    TObjectPtr<UBatteryProfile> BatteryProfile;
+
+    // Ngưỡng (%) - bị ghi đè bởi BatteryProfile nếu có
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Flashlight|Battery", meta = (ClampMin = "0", ClampMax = "100"))
     float LowBatteryThreshold = 20.0f;
 
@@ -225,11 +240,20 @@ private:
     // PRIVATE - Battery Management
     // ============================================
 
-    void UpdateBattery(float DeltaTime);
+    void InstallNewBattery(float InitialCharge);
+    void InstallBattery(FGuid BatteryId);
+    FGuid EjectBattery();
+    void OnBatteryInstalled();
     void HandleBatteryDepleted();
     void HandleBatteryLow();
     float CalculateTargetIntensity() const;
 
+    UFUNCTION()
+    void HandleBatteryChargeChanged(FGuid BatteryId, float Charge);
+
+    UFUNCTION()
+    void HandleBatteryLevelChanged(FGuid BatteryId, EBatteryLevel NewLevel);
+
     // ============================================
     // PRIVATE - Audio
     // ============================================
@@ -265,9 +289,10 @@ private:
     bool bLowBatterySoundPlayed = false;
     bool bIsFadingLight = false;
 
-    // Battery tracking
+    // Battery tracking (CurrentBattery là bản mirror từ UBatterySubsystem, tính bằng giây)
     float CurrentBattery = 0.0f;
     float LastBatteryPercentage = 100.0f;
+    FGuid InstalledBatteryId;
 
     // Visual effects
     float FlickerTimer = 0.0f;
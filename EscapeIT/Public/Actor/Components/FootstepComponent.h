@@ -81,6 +81,19 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Footstep|Sounds", meta = (AllowPrivateAccess = "true"))
 	TObjectPtr<USoundBase> FootstepCarpetSFX;
 
+	// ==================== AI NOISE ====================
+
+	// Loudness gửi cho UNoiseFieldSubsystem mỗi bước (nhân thêm hệ số bề mặt)
+	UPROPERTY(EditAnywhere, Category = "Footstep|Noise")
+	float FootstepNoiseLoudness = 0.5f;
+
+	UPROPERTY(EditAnywhere, Category = "Footstep|Noise")
+	float SprintNoiseMultiplier = 1.5f;
+
+	// Đi chậm hơn mức này thì bước chân không gây noise cho AI
+	UPROPERTY(EditAnywhere, Category = "Footstep|Noise")
+	float MinNoiseSpeed = 200.0f;
+
 	// ==================== VOLUME MODIFIERS ====================
 	
 	UPROPERTY(EditAnywhere, Category = "Footstep|Volume")
@@ -111,4 +124,7 @@ private:
 
 	/** Check if character should play footsteps */
 	bool ShouldPlayFootstep() const;
+
+	/** Report footstep noise to the AI noise field */
+	void ReportFootstepNoise(const FHitResult& HitResult) const;
 };
\ No newline at end of file
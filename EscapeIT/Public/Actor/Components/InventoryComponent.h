@@ -67,6 +67,10 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory|Audio")
     TObjectPtr<USoundBase> CannotDropSound;
 
+    // Noise gửi cho AI khi làm rơi đồ
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory|Audio")
+    float DropNoiseLoudness = 0.6f;
+
     // ========================================================================
     // INVENTORY DATA
     // ========================================================================
@@ -121,6 +125,10 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Inventory")
     bool UseItem(FName ItemID);
 
+    /** Thêm một viên pin đã dùng (ID trong UBatterySubsystem) vào inventory, giữ charge/tuổi của nó */
+    UFUNCTION(BlueprintCallable, Category = "Inventory")
+    bool AddBatteryItem(FName ItemID, FGuid BatteryId);
+
     UFUNCTION(BlueprintCallable, Category = "Inventory")
     void RemoveSlotAndUpdateReferences(int32 SlotIndexToRemove);
     
@@ -288,6 +296,12 @@ protected:
     void ValidateInventoryIntegrity();
     void DebugPrintQuickbarState() const;
 
+    /**
+     * Bỏ một viên pin ItemID khỏi inventory. Ưu tiên pin mới (trả về ID invalid),
+     * hết pin mới thì lấy pin đã dùng còn nhiều charge nhất (trả về ID của nó, entry vẫn giữ trong UBatterySubsystem)
+     */
+    FGuid RemoveBatteryUnit(FName ItemID);
+
 private:
     // ========================================================================
     // CACHED REFERENCES
@@ -21,6 +21,7 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	virtual void Tick(float DeltaTime) override;
@@ -100,6 +101,10 @@ public:
 		meta = (ClampMin = "0.0", ClampMax = "1.0"))
 	float PauseAtProgress = 0.5f; // Tạm dừng ở 50% animation
 
+	// Cửa tự mở là door breach: phải có token DoorBreach của AI director, chưa có thì thử lại sau khoảng này
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Creepy Door|General", meta = (ClampMin = "0.1"))
+	float BreachRetryInterval = 2.0f;
+
 	// ============================================================================
 	// MAIN FUNCTIONS
 	// ============================================================================
@@ -127,15 +132,20 @@ protected:
 	// Shadow state
 	float ShadowMoveProgress;
 	UMaterialInstanceDynamic* ShadowDynamicMaterial; // FIX: Lưu material để tránh leak
+	int32 ShadowOpacityTrackId = INDEX_NONE; // Track opacity trong UMaterialParameterAnimator
 
 	// Door state
 	bool bHasPaused;
 
+	// Đang giữ token DoorBreach trong lúc chuỗi mở cửa chạy
+	bool bHoldsBreachToken = false;
+
 	// Timers
 	FTimerHandle ShakeTimerHandle;
 	FTimerHandle LightFlickerTimerHandle;
 	FTimerHandle PauseTimerHandle;
 	FTimerHandle RandomCloseTimerHandle;
+	FTimerHandle BreachRetryTimerHandle;
 
 	// ============================================================================
 	// INTERNAL FUNCTIONS
@@ -167,6 +177,10 @@ protected:
 	// Sound
 	void PlayCreepySound(USoundBase* Sound);
 
+	// AI director
+	bool AcquireBreachToken();
+	void ReleaseBreachToken();
+
 	// FIX: Helper function
 	void ClearAllTimers();
 };
\ No newline at end of file
@@ -53,6 +53,10 @@ public:
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Door")
     float AnimationDuration;
+
+    // Noise gửi cho AI khi mở/đóng cửa
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Door|AI")
+    float DoorNoiseLoudness = 0.8f;
     
     // ========================= DOOR FUNCTIONS ===========================
     
@@ -18,6 +18,21 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	
+	// Player vào tầm tương tác -> sinh puzzle trước trên worker thread
+	virtual void OnInteractionBeginOverlap_Implementation(
+		UPrimitiveComponent* OverlappedComponent,
+		AActor* OtherActor,
+		UPrimitiveComponent* OtherComp,
+		int32 OtherBodyIndex,
+		bool bFromSweep,
+		const FHitResult& SweepResult) override;
+
+	virtual void OnInteractionEndOverlap_Implementation(
+		UPrimitiveComponent* OverlappedComponent,
+		AActor* OtherActor,
+		UPrimitiveComponent* OtherComp,
+		int32 OtherBodyIndex) override;
 
 public:	
 	virtual void Tick(float DeltaTime) override;
@@ -44,8 +59,14 @@ private:
 	UFUNCTION()
 	void OnPuzzleCompleted();
 	
+	bool EnsurePuzzleWidget(APlayerController* PlayerController);
+	
 	void ShowPuzzleWidget(APlayerController* PlayerController);
 	
+	bool NeedsRepair() const;
+	
+	void PrewarmPuzzle(APlayerController* PlayerController);
+	
 	void HidePuzzleWidget();
 	
 	void OnDoorOpenFinished();
@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Kismet/KismetMathLibrary.h"
 #include "GhostActor.generated.h"
 
 UCLASS()
@@ -14,6 +15,7 @@ public:
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
     virtual void Tick(float DeltaTime) override;
@@ -79,10 +81,19 @@ public:
     UFUNCTION(BlueprintImplementableEvent, Category = "Ghost|Jumpscare")
     void OnJumpscareTriggered();
 
+    // Event khi đèn pin của người chơi bắt đầu / thôi chiếu vào ghost
+    UFUNCTION(BlueprintImplementableEvent, Category = "Ghost|Flashlight")
+    void OnFlashlightBeamChanged(bool bIsLit);
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ghost|Flashlight")
+    float FlashlightTargetRadius = 60.0f;
+
 private:
     // === STATE VARIABLES ===
     float CurrentFadeValue = 0.0f;
-    float FadeTimer = 0.0f;
+    float FadeFromValue = 0.0f; // Fade progress khi bắt đầu track hiện tại
+    float FadeToValue = 0.0f;
+    int32 FadeTrackId = INDEX_NONE; // Track opacity trong UMaterialParameterAnimator
     float LifetimeTimer = 0.0f;
     FVector InitialLocation;
     float FloatOffset = 0.0f;
@@ -98,10 +109,15 @@ private:
     TArray<class UMaterialInstanceDynamic*> DynamicMaterials;
 
     // === INTERNAL FUNCTIONS ===
-    void UpdateFade(float DeltaTime);
+    void UpdateFade();
     void UpdateRotation(float DeltaTime);
     void CreateDynamicMaterials();
-    void UpdateMaterialOpacity(float Opacity);
+    void StartMaterialFade(float FromValue, float ToValue, float Duration, EEasingFunc::Type EasingFunc, TFunction<void()>&& OnFinished);
+    void OnFadeInFinished();
+    void OnFadeOutFinished();
     void StartFadeOut();
     void TriggerJumpscare(); // Hàm thực thi jumpscare
+
+    UFUNCTION()
+    void HandleIlluminationChanged(AActor* Target, bool bIsLit);
 };
\ No newline at end of file
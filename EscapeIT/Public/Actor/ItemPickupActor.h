@@ -51,6 +51,10 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item", meta = (ClampMin = "1"))
     int32 Quantity = 1;
 
+    // Pin đã dùng bị thả ra: ID trong UBatterySubsystem để nhặt lại vẫn giữ charge/tuổi (invalid = pin mới)
+    UPROPERTY(BlueprintReadWrite, Category = "Item")
+    FGuid BatteryId;
+
     // ============================================
     // INTERACTION
     // ============================================
@@ -94,6 +94,10 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Audio")
 	TArray<TObjectPtr<USoundBase>> JumpscareSounds;
 
+	// Noise gửi cho AI khi jumpscare bắt đầu
+	UPROPERTY(EditAnywhere, Category = "Audio")
+	float JumpscareNoiseLoudness = 1.5f;
+
 	UPROPERTY(EditAnywhere, Category = "Audio | Heartbeat")
 	TObjectPtr<USoundBase> HeartbeatSound;
 
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AITraceDiffCommandlet.generated.h"
+
+/**
+ * So hai trace quyết định của NPC (ai.Trace.Flush) ghi từ cùng seed, in ra chỗ lệch đầu tiên.
+ * Chạy headless:
+ *   UnrealEditor-Cmd EscapeIT.uproject -run=AITraceDiff -A=<trace> -B=<trace> [-Context=5] [-CompareFrames] [-Tolerance=1.0]
+ * Agent được ghép theo tên. Trả về 0 nếu giống nhau, 1 nếu lệch, 2 nếu không đọc được file.
+ */
+UCLASS()
+class ESCAPEIT_API UAITraceDiffCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAITraceDiffCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
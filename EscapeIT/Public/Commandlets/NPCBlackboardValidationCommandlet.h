@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "NPCBlackboardValidationCommandlet.generated.h"
+
+/**
+ * Kiểm tra blackboard asset của mọi Behavior Tree với schema trong NPCBlackboardSchema.h.
+ * Chạy headless:
+ *   UnrealEditor-Cmd EscapeIT.uproject -run=NPCBlackboardValidation [-Path=/Game/AI]
+ * Trả về 1 nếu có asset không khớp schema (dùng được trong CI).
+ */
+UCLASS()
+class ESCAPEIT_API UNPCBlackboardValidationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UNPCBlackboardValidationCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
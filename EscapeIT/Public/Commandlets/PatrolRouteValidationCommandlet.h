@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PatrolRouteValidationCommandlet.generated.h"
+
+/**
+ * Bake mọi APaTrolPath trong map bằng navmesh đã lưu trong level và báo:
+ * point không nằm trên navmesh, segment không tới được, chiều dài route và số nav query tiết kiệm mỗi vòng.
+ * Chạy headless:
+ *   UnrealEditor-Cmd EscapeIT.uproject -run=PatrolRouteValidation [-Map=/Game/Maps/Level1+/Game/Maps/Level2] [-Path=/Game]
+ * Trả về 1 nếu có route lỗi (dùng được trong CI).
+ */
+UCLASS()
+class ESCAPEIT_API UPatrolRouteValidationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPatrolRouteValidationCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
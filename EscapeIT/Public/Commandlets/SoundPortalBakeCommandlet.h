@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SoundPortalBakeCommandlet.generated.h"
+
+/**
+ * Bake sound portal graph (phòng từ ASoundRoomVolume, portal từ ADoor và ASoundPortalPoint) vào
+ * ASoundPortalGraphActor (tạo mới nếu chưa có) rồi lưu map.
+ * Chạy headless:
+ *   UnrealEditor-Cmd EscapeIT.uproject -run=SoundPortalBake [-Map=/Game/Maps/Level1+/Game/Maps/Level2] [-Path=/Game] [-NoSave] [-Benchmark=10000]
+ * -Benchmark tính N đường âm thanh trên graph vừa bake và log thời gian mỗi lần.
+ * Trả về 1 nếu có cửa/lối đi không nằm giữa hai phòng khác nhau; phòng không có portal nào chỉ bị cảnh báo.
+ */
+UCLASS()
+class ESCAPEIT_API USoundPortalBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USoundPortalBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
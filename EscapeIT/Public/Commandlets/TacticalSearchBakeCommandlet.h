@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TacticalSearchBakeCommandlet.generated.h"
+
+/**
+ * Bake tactical search graph (node, cạnh navmesh, sight line) từ các ATacticalSearchPoint trong map
+ * vào ATacticalSearchGraphActor (tạo mới nếu chưa có) rồi lưu map.
+ * Chạy headless:
+ *   UnrealEditor-Cmd EscapeIT.uproject -run=TacticalSearchBake [-Map=/Game/Maps/Level1+/Game/Maps/Level2] [-Path=/Game] [-NoSave] [-Benchmark=10000]
+ * -Benchmark lập N kế hoạch lục soát trên graph vừa bake và log thời gian mỗi lần.
+ * Trả về 1 nếu có point nằm ngoài navmesh hoặc không nối được với point nào.
+ */
+UCLASS()
+class ESCAPEIT_API UTacticalSearchBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTacticalSearchBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
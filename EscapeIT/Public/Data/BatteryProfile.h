@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "BatteryProfile.generated.h"
+
+class UCurveFloat;
+
+// ============================================================================
+// BATTERY LEVEL (thay cho threshold hard-code trong FlashlightComponent)
+// ============================================================================
+
+UENUM(BlueprintType)
+enum class EBatteryLevel : uint8
+{
+    Normal      UMETA(DisplayName = "Normal"),
+    Low         UMETA(DisplayName = "Low"),
+    Critical    UMETA(DisplayName = "Critical"),
+    Depleted    UMETA(DisplayName = "Depleted")
+};
+
+// ============================================================================
+// BATTERY PROFILE - curve asset mô tả cách pin xả
+// ============================================================================
+
+/**
+ * Mô hình xả pin theo curve:
+ *   dCharge/dt = -Discharge(Charge) * Temperature(T) / AgeCapacity(OnTime) / RatedRuntime
+ * Curve để trống = hệ số 1 (xả tuyến tính như cũ).
+ * Khi tắt đèn, phần charge bị "nén" (RecoveryFraction) hồi lại dần theo RecoveryTimeConstant.
+ */
+UCLASS(BlueprintType)
+class ESCAPEIT_API UBatteryProfile : public UPrimaryDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    // Thời gian chạy danh định (giây) khi mọi hệ số = 1 (GDD: 120s)
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Battery|Discharge", meta = (ClampMin = "1.0"))
+    float RatedRuntimeSeconds = 120.0f;
+
+    // X: charge (0..1), Y: hệ số tốc độ xả. Pin cũ xả nhanh ở đầu và cuối -> curve hình chữ U
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Battery|Discharge")
+    TObjectPtr<UCurveFloat> DischargeCurve;
+
+    // X: nhiệt độ (°C), Y: hệ số tốc độ xả (lạnh -> xả nhanh hơn)
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Battery|Discharge")
+    TObjectPtr<UCurveFloat> TemperatureCurve;
+
+    // X: tổng thời gian đã dùng (giờ), Y: dung lượng còn lại (1 = mới)
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Battery|Discharge")
+    TObjectPtr<UCurveFloat> AgeCapacityCurve;
+
+    // Phần charge xả ra bị "nén" tạm thời và hồi lại khi tắt đèn (0 = không bounce)
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Battery|Recovery", meta = (ClampMin = "0.0", ClampMax = "0.5"))
+    float RecoveryFraction = 0.1f;
+
+    // Hằng số thời gian (giây) của quá trình hồi
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Battery|Recovery", meta = (ClampMin = "0.1"))
+    float RecoveryTimeConstant = 8.0f;
+
+    // Ngưỡng (0..1)
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Battery|Thresholds", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float LowThreshold = 0.2f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Battery|Thresholds", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float CriticalThreshold = 0.05f;
+
+    /** Hệ số xả tổng hợp tại charge/nhiệt độ/tuổi cho trước */
+    float GetDrainMultiplier(float Charge, float TemperatureCelsius, float OnTimeSeconds) const;
+
+    /** Tích phân curve để ra thời gian chạy thực tế từ đầy tới cạn (giây, không tính recovery) */
+    UFUNCTION(BlueprintPure, Category = "Battery")
+    float EstimateRuntimeSeconds(float TemperatureCelsius = 20.0f, float OnTimeSeconds = 0.0f) const;
+
+    EBatteryLevel GetLevelForCharge(float Charge) const;
+};
@@ -509,6 +509,11 @@ struct FInventorySlot
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     int32 RemainingUses = -1;
 
+    // Battery items: used batteries in this stack (one UBatterySubsystem ID each, never more than Quantity).
+    // Units without an ID are fresh batteries
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    TArray<FGuid> BatteryIds;
+
     FInventorySlot()
         : ItemID(NAME_None)
         , Quantity(0)
@@ -541,5 +546,6 @@ struct FInventorySlot
         Quantity = 0;
         CurrentDurability = -1.0f;
         RemainingUses = -1;
+        BatteryIds.Reset();
     }
 };
\ No newline at end of file
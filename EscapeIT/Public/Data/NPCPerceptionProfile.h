@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Data/SettingsTypes.h"
+#include "NPCPerceptionProfile.generated.h"
+
+// ============================================================================
+// PERCEPTION SETTINGS - giá trị áp cho một NPC khi possess
+// ============================================================================
+
+USTRUCT(BlueprintType)
+struct FNPCPerceptionSettings
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception|Sight", meta = (ClampMin = "0.0"))
+    float SightRadius = 1000.0f;
+
+    // Đã thấy player thì phải ra xa hơn khoảng này mới mất dấu
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception|Sight", meta = (ClampMin = "0.0"))
+    float LoseSightRadius = 1025.0f;
+
+    // Nửa góc nhìn (độ) tính từ hướng mặt NPC
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception|Sight", meta = (ClampMin = "0.0", ClampMax = "180.0"))
+    float PeripheralVisionAngleDegrees = 90.0f;
+
+    // Trong khoảng thời gian này sau lần thấy cuối, NPC được ưu tiên trace trước (giây)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception|Sight", meta = (ClampMin = "0.0"))
+    float SightMaxAge = 5.0f;
+
+    // Player đã bị thấy và còn trong bán kính này quanh vị trí thấy cuối -> vẫn thấy, không cần trace
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception|Sight", meta = (ClampMin = "0.0"))
+    float AutoSuccessRangeFromLastSeenLocation = 520.0f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Perception|Hearing", meta = (ClampMin = "0.0"))
+    float HearingRange = 3000.0f;
+};
+
+// ============================================================================
+// PERCEPTION PROFILE - một asset cho mỗi archetype NPC
+// ============================================================================
+
+/**
+ * Thông số perception của một archetype NPC (gán trên ANPC), áp khi controller possess.
+ * Độ khó có override riêng thì dùng override; không có thì lấy Settings nhân AIDetectionMultiplier của độ khó.
+ */
+UCLASS(BlueprintType)
+class ESCAPEIT_API UNPCPerceptionProfile : public UPrimaryDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Perception")
+    FNPCPerceptionSettings Settings;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Perception|Difficulty")
+    TMap<EE_DifficultyLevel, FNPCPerceptionSettings> DifficultyOverrides;
+
+    // Không có override -> nhân bán kính sight/hearing với AIDetectionMultiplier của độ khó
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Perception|Difficulty")
+    bool bScaleByDifficultyMultiplier = true;
+
+    UFUNCTION(BlueprintPure, Category = "Perception")
+    FNPCPerceptionSettings GetSettingsForDifficulty(EE_DifficultyLevel Difficulty) const;
+
+    /** Profile null -> giá trị mặc định của FNPCPerceptionSettings, vẫn nhân theo độ khó */
+    static FNPCPerceptionSettings ResolveSettings(const UNPCPerceptionProfile* Profile, EE_DifficultyLevel Difficulty);
+};
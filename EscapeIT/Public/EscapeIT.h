@@ -5,4 +5,7 @@
 #include "CoreMinimal.h"
 
 /** Main log category used across the project */
-DECLARE_LOG_CATEGORY_EXTERN(LogEscapeIT, Log, All);
\ No newline at end of file
+DECLARE_LOG_CATEGORY_EXTERN(LogEscapeIT, Log, All);
+
+/** Stat group for the project's runtime systems (stat EscapeIT) */
+DECLARE_STATS_GROUP(TEXT("EscapeIT"), STATGROUP_EscapeIT, STATCAT_Advanced);
@@ -22,6 +22,7 @@ class UFootstepComponent;
 class UStaminaComponent;
 class UAnimMontage;
 class AFlashlight;
+enum class ENoiseSource : uint8;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
@@ -155,7 +156,7 @@ protected:
 	/** Handle jump end */
 	void DoJumpEnd();
 	
-	void MakeNoise(float Loudness, FVector NoiseLocation);
+	void MakeNoise(float Loudness, FVector NoiseLocation, ENoiseSource Source);
 
 	// ==================== MOVEMENT ACTIONS ====================
 
@@ -262,18 +263,11 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement|Landing")
 	float HeavyLandingThreshold = 600.0f;
 	
-	// ==================== FOOTSTEP PROPERTIES ====================
-	// Loudness settings - có thể adjust trong Blueprint
+	// ==================== NOISE PROPERTIES ====================
+	// Loudness settings - có thể adjust trong Blueprint (noise footstep nằm ở UFootstepComponent)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Sound")
 	float JumpNoiseLoudness = 1.0f;
-    
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Sound")
-	float FootstepNoiseLoudness = 0.5f;
-    
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AI|Sound")
-	float FootstepNoiseInterval = 0.5f; // Footstep mỗi 0.5 giây
 
-	void MakeFootstepNoise();
 	// ==================== STATE FLAGS ====================
 
 	/** Is character currently sprinting */
@@ -346,6 +340,5 @@ private:
 	UFUNCTION()
 	void OnBatteryDepleted();
 	
-	float TimeSinceLastFootstep = 0.0f;
 	FGenericTeamId TeamId = FGenericTeamId(0);
 };
\ No newline at end of file
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "Data/BatteryProfile.h"
+#include "BatterySubsystem.generated.h"
+
+/** Trạng thái của một viên pin cụ thể (ID ổn định suốt game) */
+USTRUCT(BlueprintType)
+struct FBatteryState
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Battery")
+	FGuid BatteryId;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Battery")
+	TObjectPtr<UBatteryProfile> Profile = nullptr;
+
+	// Charge hiển thị (0..1)
+	UPROPERTY(BlueprintReadOnly, Category = "Battery")
+	float Charge = 1.0f;
+
+	// Charge bị nén tạm thời, hồi lại khi tắt tải
+	UPROPERTY(BlueprintReadOnly, Category = "Battery")
+	float Depression = 0.0f;
+
+	// Tổng thời gian đã chạy có tải (giây) - dùng cho AgeCapacityCurve
+	UPROPERTY(BlueprintReadOnly, Category = "Battery")
+	float OnTimeSeconds = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Battery")
+	float RatedRuntimeSeconds = 120.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Battery")
+	bool bUnderLoad = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Battery")
+	EBatteryLevel Level = EBatteryLevel::Normal;
+
+	// Phần trăm nguyên đã broadcast lần cuối (tránh bắn event mỗi frame)
+	int32 LastBroadcastPercent = 100;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnBatteryChargeChanged, FGuid, BatteryId, float, Charge);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnBatteryLevelChanged, FGuid, BatteryId, EBatteryLevel, NewLevel);
+
+/**
+ * GameInstance subsystem giữ trạng thái từng viên pin và mô phỏng xả/hồi theo UBatteryProfile.
+ * Thay vì UI/Flashlight poll mỗi tick, subsystem đẩy event khi % thay đổi và khi vượt ngưỡng.
+ */
+UCLASS()
+class ESCAPEIT_API UBatterySubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// ========================== LIFECYCLE ==========================
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return !IsTemplate() && ActiveBatteryCount > 0; }
+	virtual bool IsTickableWhenPaused() const override { return false; }
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+	static UBatterySubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== BATTERIES ==========================
+	/** Tạo pin mới. Profile null = xả tuyến tính; RatedRuntimeOverride > 0 ghi đè thời gian danh định */
+	UFUNCTION(BlueprintCallable, Category = "Battery")
+	FGuid CreateBattery(UBatteryProfile* Profile, float InitialCharge = 1.0f, float RatedRuntimeOverride = 0.0f);
+
+	UFUNCTION(BlueprintCallable, Category = "Battery")
+	void RemoveBattery(FGuid BatteryId);
+
+	UFUNCTION(BlueprintCallable, Category = "Battery")
+	void SetBatteryLoad(FGuid BatteryId, bool bUnderLoad);
+
+	UFUNCTION(BlueprintCallable, Category = "Battery")
+	void AddCharge(FGuid BatteryId, float ChargeAmount);
+
+	UFUNCTION(BlueprintPure, Category = "Battery")
+	bool GetBatteryState(FGuid BatteryId, FBatteryState& OutState) const;
+
+	UFUNCTION(BlueprintPure, Category = "Battery")
+	float GetCharge(FGuid BatteryId) const;
+
+	/** Mô phỏng một bước cho state, dùng chung cho Tick và cho simulate offline (không cần world) */
+	static void StepBattery(FBatteryState& State, const UBatteryProfile& Profile, float DeltaTime, float TemperatureCelsius);
+
+	// ========================== EVENTS ==========================
+	UPROPERTY(BlueprintAssignable, Category = "Battery|Events")
+	FOnBatteryChargeChanged OnBatteryChargeChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "Battery|Events")
+	FOnBatteryLevelChanged OnBatteryLevelChanged;
+
+	// ========================== ENVIRONMENT ==========================
+	// Nhiệt độ môi trường (°C) - level lạnh (tầng hầm) có thể hạ xuống
+	UPROPERTY(BlueprintReadWrite, Category = "Battery")
+	float AmbientTemperature = 20.0f;
+
+private:
+	/** Event của một pin sau một bước mô phỏng, broadcast sau khi đã cập nhật xong state */
+	struct FBatteryChangeEvent
+	{
+		FGuid BatteryId;
+		float Charge = 0.0f;
+		EBatteryLevel Level = EBatteryLevel::Normal;
+		bool bChargeChanged = false;
+		bool bLevelChanged = false;
+	};
+
+	/** Cập nhật Level/LastBroadcastPercent của state, trả về true nếu có event cần broadcast */
+	static bool CollectChanges(FBatteryState& State, EBatteryLevel OldLevel, FBatteryChangeEvent& OutEvent);
+	void BroadcastChanges(const FBatteryChangeEvent& Event);
+	void RefreshActiveCount();
+
+	UPROPERTY()
+	TMap<FGuid, FBatteryState> Batteries;
+
+	// Profile mặc định (tuyến tính) cho pin không có profile
+	UPROPERTY()
+	TObjectPtr<UBatteryProfile> LinearProfile;
+
+	// Số pin đang có tải hoặc đang hồi -> 0 thì không tick
+	int32 ActiveBatteryCount = 0;
+};
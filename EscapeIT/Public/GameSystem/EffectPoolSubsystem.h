@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EffectPoolSubsystem.generated.h"
+
+class UFXSystemAsset;
+class UFXSystemComponent;
+class UParticleSystem;
+class UParticleSystemComponent;
+class UNiagaraSystem;
+class UNiagaraComponent;
+
+/** Giới hạn spawn cho một effect asset */
+USTRUCT(BlueprintType)
+struct FEffectPoolSettings
+{
+	GENERATED_BODY()
+
+	// Số instance đang chạy tối đa, spawn vượt quá sẽ bị bỏ (tính là overflow)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Effect Pool", meta = (ClampMin = "1"))
+	int32 MaxLiveInstances = 6;
+
+	// Số component tạo sẵn khi prewarm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Effect Pool", meta = (ClampMin = "0"))
+	int32 WarmInstances = 2;
+
+	// Bỏ spawn nếu xa camera hơn khoảng này (0 = không giới hạn)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Effect Pool", meta = (ClampMin = "0.0"))
+	float MaxSpawnDistance = 4000.0f;
+
+	// Bỏ spawn nếu nằm ngoài góc nhìn camera
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Effect Pool")
+	bool bCullOutsideView = true;
+
+	// Trong bán kính này luôn spawn dù nằm ngoài góc nhìn (tia lửa ngay sau lưng vẫn nghe/thấy ánh sáng)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Effect Pool", meta = (ClampMin = "0.0"))
+	float AlwaysRelevantRadius = 500.0f;
+
+	// Effect loop không tự kết thúc: tắt sau ngần này giây để trả component về pool (0 = không nhận effect loop)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Effect Pool", meta = (ClampMin = "0.0"))
+	float LoopingTimeout = 5.0f;
+
+	/** Effect scare/jumpscare: luôn spawn, không cull theo khoảng cách hay góc nhìn */
+	static FEffectPoolSettings AlwaysRelevant()
+	{
+		FEffectPoolSettings Settings;
+		Settings.MaxSpawnDistance = 0.0f;
+		Settings.bCullOutsideView = false;
+		return Settings;
+	}
+};
+
+/** Thống kê dùng pool (cũng được đẩy lên "stat EscapeIT") */
+USTRUCT(BlueprintType)
+struct FEffectPoolStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Effect Pool")
+	int32 Spawned = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Effect Pool")
+	int32 Reused = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Effect Pool")
+	int32 Overflowed = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Effect Pool")
+	int32 Culled = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Effect Pool")
+	int32 Live = 0;
+};
+
+/**
+ * World subsystem giữ sẵn các particle component (Cascade và Niagara) theo từng effect asset.
+ * Thay cho UGameplayStatics::SpawnEmitterAtLocation ở các effect one-shot (tia lửa điện, ghost appear,
+ * window burst): component được tái sử dụng khi effect kết thúc thay vì tạo/huỷ mỗi lần.
+ */
+UCLASS()
+class ESCAPEIT_API UEffectPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	static UEffectPoolSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Ghi đè giới hạn cho một asset, nên gọi trước lần spawn đầu */
+	void ConfigureEffect(UFXSystemAsset* Effect, const FEffectPoolSettings& Settings);
+
+	/** Tạo sẵn WarmInstances component cho asset */
+	void Prewarm(UFXSystemAsset* Effect);
+
+	/**
+	 * Spawn effect từ pool. Trả về nullptr nếu bị cull bởi khoảng cách/góc nhìn, vượt MaxLiveInstances
+	 * hoặc effect loop khi LoopingTimeout = 0. Effect loop bị tắt sau LoopingTimeout giây.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Effect Pool")
+	UFXSystemComponent* SpawnEffectAtLocation(UFXSystemAsset* Effect, FVector Location, FRotator Rotation = FRotator::ZeroRotator);
+
+	UFUNCTION(BlueprintCallable, Category = "Effect Pool")
+	FEffectPoolStats GetStats(UFXSystemAsset* Effect) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Effect Pool")
+	FEffectPoolStats GetTotalStats() const;
+
+	/** Trả mọi component đang chạy về pool */
+	UFUNCTION(BlueprintCallable, Category = "Effect Pool")
+	void ReleaseAll();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Effect Pool")
+	FEffectPoolSettings DefaultSettings;
+
+private:
+	struct FEffectPool
+	{
+		FEffectPoolSettings Settings;
+		TArray<TObjectPtr<UFXSystemComponent>> FreeComponents;
+		TArray<TObjectPtr<UFXSystemComponent>> LiveComponents;
+		FEffectPoolStats Stats;
+	};
+
+	FEffectPool& FindOrAddPool(UFXSystemAsset* Effect);
+	UFXSystemComponent* CreatePooledComponent(UFXSystemAsset* Effect);
+	bool PassesRelevancy(const FEffectPoolSettings& Settings, const FVector& Location) const;
+	void ReturnToPool(UFXSystemComponent* Component);
+	void ClearLoopingTimeout(UFXSystemComponent* Component);
+	static bool IsLoopingEffect(const UFXSystemAsset* Effect);
+
+	UFUNCTION()
+	void OnCascadeFinished(UParticleSystemComponent* Component);
+
+	UFUNCTION()
+	void OnNiagaraFinished(UNiagaraComponent* Component);
+
+	// Key không giữ reference (map không phải UPROPERTY); asset còn sống nhờ actor dùng effect và component trong AllComponents
+	TMap<TObjectKey<UFXSystemAsset>, FEffectPool> Pools;
+
+	// Timer tắt effect loop đang chạy (component nằm trong AllComponents nên không cần giữ reference ở đây)
+	TMap<UFXSystemComponent*, FTimerHandle> LoopingTimeouts;
+
+	// Giữ reference cho GC (FEffectPool không phải USTRUCT)
+	UPROPERTY()
+	TArray<TObjectPtr<UFXSystemComponent>> AllComponents;
+};
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlashlightIlluminationSubsystem.generated.h"
+
+class USpotLightComponent;
+
+/** Cone của đèn pin trong frame hiện tại */
+USTRUCT(BlueprintType)
+struct FFlashlightBeam
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Flashlight|Beam")
+	bool bActive = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Flashlight|Beam")
+	FVector Origin = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Flashlight|Beam")
+	FVector Direction = FVector::ForwardVector;
+
+	// Nửa góc ngoài của spot light (độ)
+	UPROPERTY(BlueprintReadOnly, Category = "Flashlight|Beam")
+	float HalfAngleDegrees = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Flashlight|Beam")
+	float Range = 0.0f;
+
+	// Cường độ sau khi scale theo pin, chuẩn hoá 0..1 theo NormalIntensity
+	UPROPERTY(BlueprintReadOnly, Category = "Flashlight|Beam")
+	float EffectiveIntensity = 0.0f;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnFlashlightIlluminationChanged, AActor*, Target, bool, bIsLit);
+
+/**
+ * Dịch vụ trả lời câu hỏi "actor này có đang bị đèn pin chiếu không?".
+ * UFlashlightComponent publish beam một lần mỗi frame, gameplay (ghost, NPC, jumpscare) đăng ký target
+ * để nhận event enter/exit hoặc hỏi trực tiếp theo batch.
+ * Occlusion trace được giới hạn MaxOcclusionTracesPerFrame và chia đều giữa các frame (round-robin).
+ */
+UCLASS()
+class ESCAPEIT_API UFlashlightIlluminationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UFlashlightIlluminationSubsystem* Get(const UObject* WorldContextObject);
+
+	// ========================== BEAM ==========================
+	/** Gọi từ UFlashlightComponent mỗi frame. Beam tự tắt nếu SpotLight bị destroy mà không ai gọi ClearBeam */
+	void PublishBeam(const USpotLightComponent* SpotLight, float EffectiveIntensity, const AActor* IgnoredActor);
+
+	/** Đèn tắt / bị cất */
+	void ClearBeam();
+
+	UFUNCTION(BlueprintPure, Category = "Flashlight|Illumination")
+	FFlashlightBeam GetBeam() const { return Beam; }
+
+	// ========================== QUERIES ==========================
+	/** Kiểm tra sphere có nằm trong cone (không trace occlusion) */
+	UFUNCTION(BlueprintPure, Category = "Flashlight|Illumination")
+	bool IsSphereInBeam(FVector Center, float Radius = 0.0f) const;
+
+	/** Batch: OutInBeam[i] = sphere (Centers[i], Radius) có nằm trong cone */
+	void QuerySpheresInBeam(TConstArrayView<FVector> Centers, float Radius, TArray<bool>& OutInBeam) const;
+
+	/** Trạng thái đã tính (kể cả occlusion) của target đã đăng ký */
+	UFUNCTION(BlueprintPure, Category = "Flashlight|Illumination")
+	bool IsTargetLit(const AActor* Target) const;
+
+	// ========================== TARGETS ==========================
+	UFUNCTION(BlueprintCallable, Category = "Flashlight|Illumination")
+	void RegisterTarget(AActor* Target, float Radius = 50.0f, bool bRequireLineOfSight = true);
+
+	UFUNCTION(BlueprintCallable, Category = "Flashlight|Illumination")
+	void UnregisterTarget(AActor* Target);
+
+	int32 GetNumTargets() const { return Targets.Num(); }
+
+	/** Đăng ký NumTargets actor tạm, quét beam qua NumFrames frame và in thời gian Tick / batch query. Target thật được cất riêng, không nhận event */
+	void RunBenchmark(int32 NumTargets, int32 NumFrames);
+
+	UPROPERTY(BlueprintAssignable, Category = "Flashlight|Illumination")
+	FOnFlashlightIlluminationChanged OnIlluminationChanged;
+
+	// ========================== SETTINGS ==========================
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flashlight|Illumination", meta = (ClampMin = "0"))
+	int32 MaxOcclusionTracesPerFrame = 8;
+
+	// Dưới mức này coi như đèn không đủ sáng để "chiếu" ai (pin gần hết)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flashlight|Illumination", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float MinEffectiveIntensity = 0.05f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flashlight|Illumination")
+	TEnumAsByte<ECollisionChannel> OcclusionChannel = ECC_Visibility;
+
+private:
+	/** Test cone, occlusion trace và event enter/exit cho các target đã đăng ký */
+	void UpdateTargets();
+	void SetBeamCone(const FVector& Origin, const FVector& Direction, float HalfAngleDegrees, float Range, float EffectiveIntensity);
+	bool IsSphereInBeamInternal(const FVector& Center, float Radius) const;
+	bool TraceLineOfSight(const AActor* Target, const FVector& TargetLocation) const;
+	void RemoveTargetAt(int32 Index);
+
+	FFlashlightBeam Beam;
+
+	// Giá trị cache của cone để test không cần trig
+	float CosHalfAngle = 1.0f;
+	float SinHalfAngle = 0.0f;
+	TWeakObjectPtr<const AActor> BeamOwner;
+
+	// Spot light đã publish beam; bị destroy (owner EndPlay, unload level) thì beam cũ không còn giá trị
+	TWeakObjectPtr<const USpotLightComponent> BeamSource;
+
+	// Target lưu dạng SoA, vòng test cone chỉ đọc mảng liền nhau
+	TArray<TWeakObjectPtr<AActor>> Targets;
+	TArray<float> TargetRadii;
+	TArray<bool> TargetRequiresLOS;
+	TArray<bool> TargetHasLOS;
+	TArray<bool> TargetLit;
+	TArray<FVector> TargetLocations;
+	TArray<bool> TargetInCone;
+
+	int32 OcclusionCursor = 0;
+};
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "MaterialParameterAnimator.generated.h"
+
+class UMaterialInstanceDynamic;
+class UCurveFloat;
+
+/**
+ * Mô tả một track animate scalar parameter trên một MID.
+ * Alpha chạy 0 -> 1 trong Duration, giá trị = Lerp(From, To, Curve(Alpha)).
+ */
+struct FMaterialParameterTrackDesc
+{
+	TWeakObjectPtr<UMaterialInstanceDynamic> Material;
+	FName ParameterName;
+
+	float From = 0.0f;
+	float To = 1.0f;
+	float Duration = 1.0f;
+
+	// Nếu có curve thì dùng curve (time 0..1), nếu không dùng EasingFunc
+	TWeakObjectPtr<UCurveFloat> Curve;
+	TEnumAsByte<EEasingFunc::Type> EasingFunc = EEasingFunc::Linear;
+	float BlendExp = 2.0f;
+
+	// Owner dùng cho pause/cancel theo nhóm (ghost, door...)
+	TWeakObjectPtr<UObject> Owner;
+
+	// Gọi sau khi track hoàn tất, kể cả khi material bị GC giữa chừng (không gọi khi bị cancel).
+	// Track có Owner chỉ gọi khi Owner còn sống
+	TFunction<void()> OnCompleted;
+};
+
+/**
+ * World subsystem gom tất cả animation material parameter (fade, opacity, emissive pulse)
+ * vào một lượt update duy nhất mỗi frame.
+ * - Parameter index được cache theo từng material, không phải lookup theo FName mỗi tick
+ * - Track xong tự động bị gỡ
+ * - Pause/Resume theo owner chỉ cần một lần gọi
+ */
+UCLASS()
+class ESCAPEIT_API UMaterialParameterAnimator : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// ========================== LIFECYCLE ==========================
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickableWhenPaused() const override { return false; }
+
+	static UMaterialParameterAnimator* Get(const UObject* WorldContextObject);
+
+	// ========================== TRACKS ==========================
+	/** Đăng ký track mới, trả về ID (INDEX_NONE nếu material/parameter không hợp lệ) */
+	int32 AddTrack(FMaterialParameterTrackDesc&& Desc);
+
+	/** Huỷ track, không gọi OnCompleted */
+	void CancelTrack(int32 TrackId);
+
+	/** Huỷ mọi track của owner; trạng thái pause của owner giữ nguyên */
+	void CancelTracksForOwner(const UObject* Owner);
+
+	/** Tạm dừng / tiếp tục mọi track của owner (kể cả track thêm sau này) */
+	void SetOwnerPaused(const UObject* Owner, bool bPaused);
+
+	bool IsTrackActive(int32 TrackId) const;
+
+	/** Alpha tuyến tính (0..1) của track, -1 nếu track không còn */
+	float GetTrackAlpha(int32 TrackId) const;
+
+	int32 GetNumActiveTracks() const { return Tracks.Num(); }
+
+private:
+	struct FActiveTrack
+	{
+		int32 Id = INDEX_NONE;
+		TWeakObjectPtr<UMaterialInstanceDynamic> Material;
+		int32 ParameterIndex = INDEX_NONE;
+		float From = 0.0f;
+		float To = 1.0f;
+		float InvDuration = 1.0f;
+		float Alpha = 0.0f;
+		TWeakObjectPtr<UCurveFloat> Curve;
+		TEnumAsByte<EEasingFunc::Type> EasingFunc = EEasingFunc::Linear;
+		float BlendExp = 2.0f;
+		TWeakObjectPtr<UObject> Owner;
+		TFunction<void()> OnCompleted;
+		bool bPaused = false;
+	};
+
+	/** Lấy index của parameter, cache theo material để các track sau không phải tìm lại */
+	int32 ResolveParameterIndex(UMaterialInstanceDynamic* Material, FName ParameterName, float InitialValue);
+
+	float EvaluateTrack(const FActiveTrack& Track) const;
+
+	TArray<FActiveTrack> Tracks;
+
+	// TrackId -> index trong Tracks (cập nhật khi swap-remove)
+	TMap<int32, int32> TrackIdToIndex;
+
+	// Cache FName -> parameter index theo material
+	TMap<TWeakObjectPtr<UMaterialInstanceDynamic>, TMap<FName, int32>> ParameterIndexCache;
+
+	// Owner đang pause (track mới của owner này sẽ bắt đầu ở trạng thái pause)
+	TSet<TWeakObjectPtr<UObject>> PausedOwners;
+
+	int32 NextTrackId = 1;
+
+	void RemoveTrackAt(int32 Index);
+};
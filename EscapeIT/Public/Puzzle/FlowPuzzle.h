@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "Data/FlowPuzzleTypes.h"
+#include <atomic>
+
+struct FFlowPuzzleBitGrid;
+
+/**
+ * Lõi của puzzle nối dây (ElectricCabinet), tách khỏi UMG: chỉ là dữ liệu + hàm, không UObject, không state toàn cục.
+ * Mọi random đi qua FRandomStream truyền vào -> cùng seed cho cùng puzzle, chạy được trên thread khác
+ * và kiểm tra được độc lập (puzzle.FlowPuzzle.Validate, puzzle.FlowPuzzle.Benchmark, automation test EscapeIT.Puzzle.FlowPuzzle).
+ */
+
+struct FFlowPuzzleSettings
+{
+	int32 Width = 9;
+	int32 Height = 9;
+
+	// Giới hạn bởi số màu dây có sẵn (5)
+	int32 NumWirePairs = 4;
+
+	// Khoảng cách tối thiểu (ô, Euclid) giữa hai đầu của cùng một dây
+	float MinimumPointDistance = 1.5f;
+
+	// Số lần thử dựng cả puzzle / thử chọn điểm cuối cho một dây
+	int32 MaxPuzzleAttempts = 50;
+	int32 MaxPathAttempts = 100;
+
+	// Sinh trên FFlowPuzzleBitGrid khi lưới đủ nhỏ; false = luôn dùng mảng FGridCell (để benchmark so sánh).
+	// Hai cách dùng cùng chuỗi random nên cho cùng puzzle với cùng seed.
+	bool bUseBitboards = true;
+
+	// Generator dừng giữa chừng (trả về false) khi cờ này bật; dùng cho task sinh nền bị hủy
+	const std::atomic<bool>* CancelFlag = nullptr;
+
+	bool IsCancelled() const { return CancelFlag && CancelFlag->load(std::memory_order_relaxed); }
+
+	/** Cùng tham số sinh (bỏ qua CancelFlag) -> cùng seed cho cùng puzzle */
+	bool Matches(const FFlowPuzzleSettings& Other) const
+	{
+		return Width == Other.Width && Height == Other.Height && NumWirePairs == Other.NumWirePairs
+			&& MinimumPointDistance == Other.MinimumPointDistance && MaxPuzzleAttempts == Other.MaxPuzzleAttempts
+			&& MaxPathAttempts == Other.MaxPathAttempts && bUseBitboards == Other.bUseBitboards;
+	}
+};
+
+/** Lưới ô + các cặp dây. Ô (X, Y) nằm ở index Y * Width + X */
+struct ESCAPEIT_API FFlowPuzzleGrid
+{
+	/** Tạo lưới Width x Height toàn ô trống, xóa mọi dây */
+	void Init(int32 InWidth, int32 InHeight);
+
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+	int32 NumCells() const { return Cells.Num(); }
+
+	bool IsInside(FIntPoint Position) const
+	{
+		return Position.X >= 0 && Position.X < Width && Position.Y >= 0 && Position.Y < Height;
+	}
+
+	/** INDEX_NONE nếu nằm ngoài lưới */
+	int32 GetCellIndex(FIntPoint Position) const
+	{
+		return IsInside(Position) ? Position.Y * Width + Position.X : INDEX_NONE;
+	}
+
+	FGridCell* GetCell(FIntPoint Position);
+	const FGridCell* GetCell(FIntPoint Position) const;
+	TConstArrayView<FGridCell> GetCells() const { return Cells; }
+
+	FWirePair* FindWire(EWireColor Color);
+	const FWirePair* FindWire(EWireColor Color) const;
+
+	/** Mọi ô về trống (giữ nguyên dây) */
+	void ResetCells();
+
+	/** Xóa đường, chỉ giữ điểm đầu/cuối của từng dây trên lưới */
+	void PlaceEndpoints();
+
+	int32 GetNumCompleteWires() const;
+
+	/** Mọi dây đã nối (puzzle rỗng không tính là xong) */
+	bool IsComplete() const;
+
+	TArray<FWirePair> Wires;
+
+private:
+	friend struct FFlowPuzzleGenerator;
+
+	int32 Width = 0;
+	int32 Height = 0;
+	TArray<FGridCell> Cells;
+};
+
+/**
+ * Sinh puzzle chắc chắn giải được: vẽ trước đường đầy đủ cho từng dây (random walk thiên về đích),
+ * rồi xóa đường chỉ giữ hai đầu.
+ */
+struct ESCAPEIT_API FFlowPuzzleGenerator
+{
+	/**
+	 * Ghi puzzle vào OutGrid (lưới Settings.Width x Settings.Height). OutSolution (nếu có) nhận các dây kèm đường đã vẽ.
+	 * Trả về false nếu hết số lần thử mà không đặt được mọi dây, hoặc Settings.CancelFlag bật -> OutGrid không có dây nào.
+	 */
+	static bool Generate(const FFlowPuzzleSettings& Settings, FRandomStream& Random, FFlowPuzzleGrid& OutGrid, TArray<FWirePair>* OutSolution = nullptr);
+
+	/** Số cặp dây thật sự sinh: giới hạn bởi số màu và số ô */
+	static int32 GetNumPairsToGenerate(const FFlowPuzzleSettings& Settings);
+
+	static float GetDistanceBetweenPoints(FIntPoint A, FIntPoint B);
+
+private:
+	// GridType = FFlowPuzzleGrid hoặc FFlowPuzzleBitGrid
+	template<typename GridType>
+	static bool GenerateWires(const FFlowPuzzleSettings& Settings, FRandomStream& Random, GridType& Grid, int32 NumPairs, TArray<FWirePair>& OutWires);
+
+	template<typename GridType>
+	static bool GenerateCompletePath(const FFlowPuzzleSettings& Settings, FRandomStream& Random, GridType& Grid, FWirePair& OutWire, TArray<FIntPoint>& PathBuffer);
+
+	static bool GeneratePathBetweenPoints(FRandomStream& Random, const FFlowPuzzleGrid& Grid, FIntPoint Start, FIntPoint End, TArray<FIntPoint>& OutPath);
+	static bool GeneratePathBetweenPoints(FRandomStream& Random, const FFlowPuzzleBitGrid& Grid, FIntPoint Start, FIntPoint End, TArray<FIntPoint>& OutPath);
+	static FIntPoint FindRandomEmptyCell(FRandomStream& Random, const FFlowPuzzleGrid& Grid);
+	static FIntPoint FindRandomEmptyCell(FRandomStream& Random, const FFlowPuzzleBitGrid& Grid);
+	static void MarkPathOnGrid(FFlowPuzzleGrid& Grid, const TArray<FIntPoint>& Path, EWireColor Color);
+	static void MarkPathOnGrid(FFlowPuzzleBitGrid& Grid, const TArray<FIntPoint>& Path, EWireColor Color);
+};
+
+/** Kiểm tra nhanh điều kiện cần để giải được (không tìm lời giải đầy đủ) */
+struct ESCAPEIT_API FFlowPuzzleSolver
+{
+	/** BFS 4 hướng từ Start tới End, không đi qua BlockedPositions (trừ chính End). Lưới nhỏ chạy trên FFlowPuzzleBitGrid */
+	static bool HasPathBetweenPoints(const FFlowPuzzleGrid& Grid, FIntPoint Start, FIntPoint End, TConstArrayView<FIntPoint> BlockedPositions);
+
+	/**
+	 * Mỗi dây có đường tới đầu kia mà không đi qua đầu dây màu khác, và tổng độ dài tối thiểu (Manhattan)
+	 * không vượt MaxFillRatio số ô của lưới.
+	 */
+	static bool IsSolvable(const FFlowPuzzleGrid& Grid, float MaxFillRatio = 1.0f);
+};
+
+/** Kết quả một bước kéo dây */
+enum class EFlowPuzzleMove : uint8
+{
+	// Không đổi gì: không kéo, ô không kề, ô đã thuộc dây mà không phải lùi lại
+	Ignored,
+	// Đi thêm vào một ô trống
+	Extended,
+	// Quay lại ô đã đi, phần đường phía sau bị xóa
+	Backtracked,
+	// Chạm đầu kia cùng màu: dây nối xong, dừng kéo
+	Connected,
+	// Chạm đường hoặc đầu dây màu khác: cả dây bị xóa, dừng kéo
+	Cleared
+};
+
+/**
+ * Puzzle đang chơi: lưới + luật kéo dây. View (UElectricCabinetWidget) chỉ chuyển input thành ô lưới
+ * rồi vẽ lại các ô trả về từ ConsumeChangedCells().
+ */
+class ESCAPEIT_API FFlowPuzzleBoard
+{
+public:
+	/** Sinh puzzle mới; false nếu generator thất bại (lưới trống, không có dây) */
+	bool Generate(const FFlowPuzzleSettings& Settings, FRandomStream& Random, TArray<FWirePair>* OutSolution = nullptr);
+
+	/** Dùng lưới đã sinh sẵn (vd. từ thread khác) */
+	void SetGrid(FFlowPuzzleGrid&& InGrid);
+
+	const FFlowPuzzleGrid& GetGrid() const { return Grid; }
+
+	// ========================== MOVES ==========================
+	/** Bắt đầu kéo từ một đầu dây (vẽ lại dây đó từ đầu) hoặc từ một ô trên đường (cắt phần phía sau). false nếu ô không kéo được */
+	bool BeginDrag(FIntPoint Position);
+
+	/** Kéo tới ô Position; chỉ nhận ô kề cạnh ô cuối cùng */
+	EFlowPuzzleMove UpdateDrag(FIntPoint Position);
+
+	/** Thả chuột: dây chưa nối bị xóa. Trả về true nếu có dây bị xóa */
+	bool EndDrag();
+
+	/** Xóa đường của một dây (giữ hai đầu) */
+	void ClearWire(EWireColor Color);
+
+	bool IsDragging() const { return bIsDragging; }
+	EWireColor GetDragColor() const { return DragColor; }
+
+	bool IsComplete() const { return Grid.IsComplete(); }
+
+	/** Index các ô đổi trạng thái từ lần gọi trước */
+	TArray<int32> ConsumeChangedCells() { return MoveTemp(ChangedCells); }
+
+private:
+	void SetCell(FGridCell& Cell, ECellType Type, EWireColor Color, int32 PathID);
+	void StopDrag();
+
+	FFlowPuzzleGrid Grid;
+
+	bool bIsDragging = false;
+	EWireColor DragColor = EWireColor::None;
+	int32 CurrentPathID = 0;
+	FIntPoint LastCellPosition = FIntPoint(-1, -1);
+
+	TArray<int32> ChangedCells;
+};
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Puzzle/FlowPuzzle.h"
+#include "Tasks/Task.h"
+
+/** Puzzle lấy từ đâu (log + kiểm tra) */
+enum class EFlowPuzzleGenerationPath : uint8
+{
+	// Task nền đã xong trước khi cần
+	Worker,
+	// Chưa có task, task chưa xong hoặc khác settings: sinh ngay trên thread gọi
+	Synchronous
+};
+
+/**
+ * Sinh puzzle trên worker thread trước khi cần (vd. lúc cửa tủ điện đang mở), hủy được.
+ * Task chỉ giữ state riêng của nó (shared pointer), nên Cancel() và destructor không phải chờ worker.
+ * Take() luôn trả về puzzle: dùng kết quả của worker nếu đã xong, nếu không thì hủy task và sinh đồng bộ
+ * với cùng seed -> ra cùng một puzzle dù đi đường nào.
+ */
+class ESCAPEIT_API FFlowPuzzleAsyncGenerator
+{
+public:
+	~FFlowPuzzleAsyncGenerator();
+
+	/** Bắt đầu sinh nền; task cũ (nếu có) bị hủy. Worker chỉ chạy sau Prerequisite nếu có */
+	void Start(const FFlowPuzzleSettings& Settings, int32 Seed, const UE::Tasks::FTask& Prerequisite = UE::Tasks::FTask());
+
+	/** Hủy task đang chạy và bỏ kết quả */
+	void Cancel();
+
+	/** Đã Start và chưa Take/Cancel */
+	bool IsPending() const { return State.IsValid(); }
+
+	/** Task nền đã xong, Take() sẽ không phải sinh đồng bộ */
+	bool IsReady() const { return State.IsValid() && Task.IsCompleted(); }
+
+	/** Chờ task nền xong (không dùng trên game thread ngoài kiểm tra) */
+	void Wait() const;
+
+	/**
+	 * Lấy puzzle cho Settings. Seed của task đang chờ được dùng lại cho đường đồng bộ; không có task thì dùng FallbackSeed.
+	 * Trả về false nếu generator thất bại.
+	 */
+	bool Take(const FFlowPuzzleSettings& Settings, int32 FallbackSeed, FFlowPuzzleGrid& OutGrid, EFlowPuzzleGenerationPath* OutPath = nullptr);
+
+private:
+	struct FState
+	{
+		FFlowPuzzleSettings Settings;
+		int32 Seed = 0;
+
+		std::atomic<bool> bCancelled{ false };
+
+		// Chỉ worker ghi; game thread đọc sau khi Task xong
+		FFlowPuzzleGrid Grid;
+		bool bGenerated = false;
+	};
+
+	TSharedPtr<FState, ESPMode::ThreadSafe> State;
+	UE::Tasks::FTask Task;
+};
@@ -0,0 +1,182 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/FlowPuzzleTypes.h"
+
+/** Tập ô của một lưới tối đa MaxCells ô, một bit mỗi ô (index Y * Width + X như FFlowPuzzleGrid) */
+struct FFlowPuzzleBitboard
+{
+	static constexpr int32 MaxCells = 256;
+	static constexpr int32 NumWords = MaxCells / 64;
+
+	uint64 Words[NumWords] = {};
+
+	bool Contains(int32 Index) const { return (Words[Index >> 6] >> (Index & 63)) & 1; }
+	void Add(int32 Index) { Words[Index >> 6] |= uint64(1) << (Index & 63); }
+	void Remove(int32 Index) { Words[Index >> 6] &= ~(uint64(1) << (Index & 63)); }
+
+	void Reset()
+	{
+		for (uint64& Word : Words)
+		{
+			Word = 0;
+		}
+	}
+
+	/** Số ô trong tập (popcount) */
+	int32 Num() const
+	{
+		int32 Count = 0;
+		for (const uint64 Word : Words)
+		{
+			Count += static_cast<int32>(FPlatformMath::CountBits(Word));
+		}
+		return Count;
+	}
+
+	/** Index của ô thứ N (đếm từ 0, theo thứ tự index); INDEX_NONE nếu tập có ít hơn N + 1 ô */
+	int32 FindNth(int32 N) const
+	{
+		for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+		{
+			uint64 Word = Words[WordIndex];
+			const int32 Count = static_cast<int32>(FPlatformMath::CountBits(Word));
+			if (N >= Count)
+			{
+				N -= Count;
+				continue;
+			}
+
+			// Bỏ N bit thấp nhất, bit thấp nhất còn lại là ô cần tìm
+			for (; N > 0; --N)
+			{
+				Word &= Word - 1;
+			}
+			return WordIndex * 64 + static_cast<int32>(FPlatformMath::CountTrailingZeros64(Word));
+		}
+		return INDEX_NONE;
+	}
+
+	FFlowPuzzleBitboard operator|(const FFlowPuzzleBitboard& Other) const
+	{
+		FFlowPuzzleBitboard Result;
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			Result.Words[i] = Words[i] | Other.Words[i];
+		}
+		return Result;
+	}
+
+	FFlowPuzzleBitboard operator&(const FFlowPuzzleBitboard& Other) const
+	{
+		FFlowPuzzleBitboard Result;
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			Result.Words[i] = Words[i] & Other.Words[i];
+		}
+		return Result;
+	}
+
+	/** Các ô thuộc tập này mà không thuộc Other */
+	FFlowPuzzleBitboard AndNot(const FFlowPuzzleBitboard& Other) const
+	{
+		FFlowPuzzleBitboard Result;
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			Result.Words[i] = Words[i] & ~Other.Words[i];
+		}
+		return Result;
+	}
+};
+
+/** Hàng đợi FIFO dung lượng cố định trên stack (Capacity là lũy thừa của 2), không cấp phát heap */
+template<typename ElementType, int32 Capacity>
+class TFlowPuzzleRingQueue
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity phải là lũy thừa của 2");
+
+public:
+	bool IsEmpty() const { return Head == Tail; }
+	int32 Num() const { return static_cast<int32>(Tail - Head); }
+
+	void Push(ElementType Item)
+	{
+		check(Num() < Capacity);
+		Items[Tail++ & (Capacity - 1)] = Item;
+	}
+
+	ElementType Pop()
+	{
+		check(!IsEmpty());
+		return Items[Head++ & (Capacity - 1)];
+	}
+
+private:
+	ElementType Items[Capacity];
+	uint32 Head = 0;
+	uint32 Tail = 0;
+};
+
+/**
+ * Lưới của generator/solver dạng bitboard: mỗi màu dây một bitboard ô đã chiếm, ô kề được kiểm tra
+ * bằng mask cạnh lưới thay vì so tọa độ. Chỉ dùng cho lưới tối đa FFlowPuzzleBitboard::MaxCells ô (16 x 16);
+ * lưới lớn hơn dùng mảng FGridCell của FFlowPuzzleGrid.
+ */
+struct ESCAPEIT_API FFlowPuzzleBitGrid
+{
+	// Cùng thứ tự với hướng đi của generator: phải, trái, xuống, lên
+	static constexpr int32 NumDirections = 4;
+
+	static bool CanHold(int32 InWidth, int32 InHeight)
+	{
+		return InWidth > 0 && InHeight > 0 && InWidth * InHeight <= FFlowPuzzleBitboard::MaxCells;
+	}
+
+	/** Lưới InWidth x InHeight không có ô nào bị chiếm; CanHold(InWidth, InHeight) phải đúng */
+	void Init(int32 InWidth, int32 InHeight);
+
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+	int32 NumCells() const { return Width * Height; }
+
+	int32 GetCellIndex(FIntPoint Position) const
+	{
+		return Position.X >= 0 && Position.X < Width && Position.Y >= 0 && Position.Y < Height ? Position.Y * Width + Position.X : INDEX_NONE;
+	}
+
+	/** Ô kề theo hướng Direction (0..3), INDEX_NONE nếu ra ngoài lưới */
+	int32 GetNeighbor(int32 Index, int32 Direction) const
+	{
+		return EdgeMasks[Direction].Contains(Index) ? Index + NeighborOffsets[Direction] : INDEX_NONE;
+	}
+
+	const FFlowPuzzleBitboard& GetAllCells() const { return AllCells; }
+	const FFlowPuzzleBitboard& GetOccupied() const { return Occupied; }
+	const FFlowPuzzleBitboard& GetColorCells(EWireColor Color) const { return ColorCells[static_cast<int32>(Color)]; }
+	FFlowPuzzleBitboard GetEmpty() const { return AllCells.AndNot(Occupied); }
+
+	void Occupy(int32 Index, EWireColor Color);
+
+	/** Bỏ mọi ô đã chiếm (giữ kích thước lưới) */
+	void ResetCells();
+
+	/** BFS 4 hướng từ Start tới End chỉ qua các ô thuộc Passable (End luôn đi vào được), hàng đợi trên stack */
+	bool HasPath(int32 Start, int32 End, const FFlowPuzzleBitboard& Passable) const;
+
+private:
+	int32 Width = 0;
+	int32 Height = 0;
+
+	FFlowPuzzleBitboard AllCells;
+
+	// Ô có ô kề theo từng hướng (không nằm ở cạnh lưới phía đó)
+	FFlowPuzzleBitboard EdgeMasks[NumDirections];
+	int32 NeighborOffsets[NumDirections] = {};
+
+	FFlowPuzzleBitboard Occupied;
+
+	// Index = EWireColor
+	FFlowPuzzleBitboard ColorCells[static_cast<int32>(EWireColor::Orange) + 1];
+};
@@ -4,6 +4,8 @@
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
 #include "Data/FlowPuzzleTypes.h"
+#include "Puzzle/FlowPuzzle.h"
+#include "Puzzle/FlowPuzzleAsyncGenerator.h"
 #include "Components/UniformGridPanel.h"
 #include "Components/Border.h"
 #include "Components/Button.h"
@@ -45,6 +47,13 @@ public:
     void ResumeTimer();
     void ResetTimer();
     
+    // Start generating the next puzzle on a worker thread (player in range / door opening).
+    // NativeConstruct takes the result, or generates synchronously if it is not ready yet.
+    void PrewarmPuzzle();
+    void CancelPuzzlePrewarm();
+    
+    FFlowPuzzleSettings GetPuzzleSettings() const;
+    
 protected:
     virtual void NativeConstruct() override;
     virtual void NativeDestruct() override;
@@ -70,6 +79,10 @@ protected:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Puzzle Settings")
     float RepairDuration = 30.0f;
     
+    // 0 = random puzzle every time the widget opens; other values always give the same puzzle
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Puzzle Settings")
+    int32 PuzzleSeed = 0;
+    
 private:
     // Widget components
     UPROPERTY(meta = (BindWidget))
@@ -93,65 +106,35 @@ private:
     UPROPERTY(meta=(BindWidgetAnim),Transient)
     UWidgetAnimation* HideAnim;
     
-    UPROPERTY()
-    TArray<FGridCell> GridCells;
-    
-    UPROPERTY()
-    TMap<FIntPoint, int32> PositionToIndexMap;
-    
     UPROPERTY()
     TArray<class UBorder*> CellBorders;
     
-    UPROPERTY()
-    TArray<FWirePair> WirePairs;
+    // Grid, wires and drag rules; the widget only maps input to cells and redraws what changed
+    FFlowPuzzleBoard Puzzle;
     
-    bool bIsDragging;
-    EWireColor CurrentDragColor;
-    int32 CurrentPathID;
-    FIntPoint LastCellPosition;
+    // Puzzle generated ahead of NativeConstruct by PrewarmPuzzle
+    FFlowPuzzleAsyncGenerator PuzzleGenerator;
     
     float RemainingTime;
     bool bTimerActive;
     bool bPuzzleFinished;
     
     void InitializePuzzle();
-    void GenerateRandomPuzzle();
+    int32 GetNextPuzzleSeed() const;
     void CreateGridUI();
     
-    bool IsPuzzleSolvable(const TArray<FWirePair>& WiresToCheck);
-    bool HasPathBetweenPoints(FIntPoint Start, FIntPoint End, const TArray<FIntPoint>& BlockedPositions);
-    
-    bool IsPositionValid(FIntPoint Position, const TArray<FIntPoint>& UsedPositions);
-    float GetDistanceBetweenPoints(FIntPoint A, FIntPoint B);
-    
     void UpdateCellVisual(int32 CellIndex);
+    void UpdateChangedCells();
     FLinearColor GetColorForWireType(EWireColor WireColor);
     
-    void StartDrag(FIntPoint CellPosition);
     void UpdateDrag(FIntPoint CellPosition);
     void EndDrag();
     
-    bool CanPlacePath(FIntPoint Position, EWireColor Color);
-    void ClearPath(EWireColor Color);
-    void AutoClearCurrentPath();
-    bool IsCellBlockedByOtherPath(FIntPoint Position, EWireColor Color);
-    
-    bool CheckPuzzleComplete();
     void UpdateProgressDisplay();
     
-    FGridCell* GetCellAt(FIntPoint Position);
-    int32 GetCellIndex(FIntPoint Position);
     FIntPoint ScreenToGridPosition(const FGeometry& Geometry, const FVector2D& ScreenPosition);
     FString GetColorName(EWireColor Color);
     
-    bool GenerateCompletePath(FWirePair& OutWire);
-    bool GeneratePathBetweenPoints(FIntPoint Start, FIntPoint End, TArray<FIntPoint>& OutPath);
-    FIntPoint ChooseWeightedRandom(const TArray<FIntPoint>& Choices, const TArray<float>& Weights);
-    FIntPoint FindRandomEmptyCell();
-    void MarkPathOnGrid(const TArray<FIntPoint>& Path, EWireColor Color);
-    void ResetGridToEmpty();
-    void ConvertSolutionToPuzzle(TArray<FWirePair>& Wires);
-    
     void UpdateRepairedPuzzleTime();
     void OnRepairedPuzzleCountDown(float DeltaTime); 
     void OnTimerExpired();
@@ -149,7 +149,8 @@ protected:
     void UnbindAllEvents();
     void UpdateBatteryBarVisibility();
     void UpdateBatteryBar();
-    void UpdateLowBatteryWarning(float DeltaTime);
+    void UpdateLowBatteryWarning();
+    void UpdateLowBatteryPulse();
     void ResetSlotVisuals(int32 SlotIndex);
     void ActivateLowBatteryWarning();
     void DeactivateLowBatteryWarning();
@@ -188,9 +189,7 @@ private:
     int32 CurrentSelectedSlot = -1;
     int32 CachedFlashlightSlot = -1;
     bool bLowBatteryWarningActive = false;
-    float BatteryCheckTimer = 0.0f;
     
-    static constexpr float BATTERY_CHECK_INTERVAL = 0.1f;
     static constexpr float MEDIUM_BATTERY_THRESHOLD = 50.0f;
     static constexpr float LOW_BATTERY_VISUAL_THRESHOLD = 20.0f;
     